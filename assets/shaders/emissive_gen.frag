@@ -23,7 +23,9 @@ out vec4 outFragColor;
 // Uniforms
 uniform usampler2D uMaterialIdTexture;
 uniform sampler2D uBlurWeightsTexture;
-uniform Material uMaterials[20];
+layout(std140) uniform MaterialsBlock {
+	Material uMaterials[20];
+};
 
 // Main
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -1,11 +1,24 @@
 #version 330
 
+// Structs
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+struct Material {
+	vec3 diffuse;
+	vec3 specular;
+	vec3 emissive;
+	float shininess;
+	float opaque;
+};
+
 // Input, output and uniforms
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 // Input
 in vec3 vsPos;
 in vec3 vsNormal;
+in vec4 currClipPos;
+in vec4 prevClipPos;
 
 // Uniforms
 uniform float uFarPlaneDist;
@@ -15,10 +28,15 @@ layout(location = 0) out vec4 outFragLinearDepth;
 layout(location = 1) out vec4 outFragNormal;
 layout(location = 2) out uint outFragMaterialId;
 layout(location = 3) out float outBlurWeights;
+layout(location = 4) out vec4 outFragEmissive; // Only attached if emissive is fused into this pass
+layout(location = 5) out vec2 outFragVelocity; // Only attached if temporal upsampling is enabled
 
 // Uniforms
 uniform uint uMaterialId;
 uniform float uBlurWeight;
+layout(std140) uniform MaterialsBlock {
+	Material uMaterials[20];
+};
 
 // Main
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -29,4 +47,10 @@ void main()
 	outFragNormal = vec4(vsNormal, 1.0);
 	outFragMaterialId = uMaterialId;
 	outBlurWeights = uBlurWeight;
+	outFragEmissive = vec4(uMaterials[uMaterialId].emissive * uBlurWeight, 1.0);
+
+	// Screen space motion since the previous frame in uv coordinates
+	vec2 currUV = (currClipPos.xy / currClipPos.w) * 0.5;
+	vec2 prevUV = (prevClipPos.xy / prevClipPos.w) * 0.5;
+	outFragVelocity = currUV - prevUV;
 }
\ No newline at end of file
@@ -8,8 +8,15 @@ uniform mat4 uViewMatrix;
 uniform mat4 uModelMatrix;
 uniform mat4 uNormalMatrix; // inverse(transpose(modelViewMatrix)) for non-uniform scaling
 
+// Motion vectors, both view projection matrices are without temporal jitter
+uniform mat4 uPrevModelMatrix;
+uniform mat4 uUnjitteredViewProjMatrix;
+uniform mat4 uPrevViewProjMatrix;
+
 out vec3 vsPos;
 out vec3 vsNormal;
+out vec4 currClipPos;
+out vec4 prevClipPos;
 
 void main()
 {
@@ -17,4 +24,6 @@ void main()
 	vsPos = (modelViewMatrix * vec4(inPosition, 1)).xyz;
 	vsNormal = normalize((uNormalMatrix * vec4(inNormal, 0)).xyz);
 	gl_Position = uProjMatrix * modelViewMatrix * vec4(inPosition, 1);
+	currClipPos = uUnjitteredViewProjMatrix * uModelMatrix * vec4(inPosition, 1);
+	prevClipPos = uPrevViewProjMatrix * uPrevModelMatrix * vec4(inPosition, 1);
 }
\ No newline at end of file
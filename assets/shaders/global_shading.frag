@@ -26,13 +26,47 @@ uniform float uFarPlaneDist;
 uniform sampler2D uLinearDepthTexture;
 uniform sampler2D uNormalTexture;
 uniform usampler2D uMaterialIdTexture;
-uniform sampler2D uTransparencyTexture;
+uniform sampler2D uTransparencyTexture; // Accumulation and revealage if OIT is used
+uniform sampler2D uTransparencyWeightTexture; // Only used with OIT
 uniform sampler2D uSpotlightShadingTexture;
-//uniform sampler2D uLightShaftsTexture;
+uniform sampler2D uLightShaftsTexture; // Low resolution, linear depth in alpha
 uniform sampler2D uBlurredEmissiveTexture;
 
-uniform Material uMaterials[20];
+layout(std140) uniform MaterialsBlock {
+	Material uMaterials[20];
+};
 uniform vec3 uAmbientLight;
+uniform vec2 uLightShaftsUVFactor; // uvCoord to light shafts uv, the sub-rects may differ slightly
+uniform vec2 uLightShaftsRectDim; // Sub-rect of the light shafts texture rendered to this frame
+uniform bool uLightShafts = false;
+uniform bool uOrderIndependentTransparency = false;
+
+// Helper functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Depth aware upsample of the light shafts
+//
+// The 4 nearest low resolution texels are weighted bilinearly as usual, but also by how close
+// their depth is to the depth of this pixel. This avoids bleeding light shafts across edges.
+vec3 upsampleLightShafts(vec2 lightShaftsUV, float linDepth)
+{
+	ivec2 maxTexel = ivec2(uLightShaftsRectDim) - ivec2(1);
+	vec2 texelPos = lightShaftsUV * vec2(textureSize(uLightShaftsTexture, 0)) - vec2(0.5);
+	ivec2 base = ivec2(floor(texelPos));
+	vec2 f = texelPos - floor(texelPos);
+
+	vec4 s00 = texelFetch(uLightShaftsTexture, clamp(base, ivec2(0), maxTexel), 0);
+	vec4 s10 = texelFetch(uLightShaftsTexture, clamp(base + ivec2(1, 0), ivec2(0), maxTexel), 0);
+	vec4 s01 = texelFetch(uLightShaftsTexture, clamp(base + ivec2(0, 1), ivec2(0), maxTexel), 0);
+	vec4 s11 = texelFetch(uLightShaftsTexture, clamp(base + ivec2(1, 1), ivec2(0), maxTexel), 0);
+
+	vec4 bilinearWeights = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+	vec4 relDepthDiffs = abs(vec4(s00.a, s10.a, s01.a, s11.a) - vec4(linDepth)) / max(linDepth, 0.0001);
+	vec4 weights = bilinearWeights / (relDepthDiffs + vec4(0.001));
+
+	vec3 sum = s00.rgb * weights.x + s10.rgb * weights.y + s01.rgb * weights.z + s11.rgb * weights.w;
+	return sum / dot(weights, vec4(1.0));
+}
 
 // Main
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -47,8 +81,17 @@ void main()
 	Material mtl = uMaterials[materialId];
 
 	vec4 transparency = texture(uTransparencyTexture, uvCoord);
+	if (uOrderIndependentTransparency) {
+		// Weighted average of the transparent colors, covering all but the revealed background
+		float weightSum = texture(uTransparencyWeightTexture, uvCoord).r;
+		transparency = vec4(transparency.rgb / max(weightSum, 1e-5), 1.0 - transparency.a);
+	}
 	vec3 spotlightShading = texture(uSpotlightShadingTexture, uvCoord).rgb;
-	//vec3 lightShafts = texture(uLightShaftsTexture, uvCoord).rgb;
+	vec3 lightShafts = vec3(0);
+	if (uLightShafts) {
+		float linDepth = texture(uLinearDepthTexture, uvCoord).r;
+		lightShafts = upsampleLightShafts(uvCoord * uLightShaftsUVFactor, linDepth);
+	}
 	vec3 blurredEmissive = texture(uBlurredEmissiveTexture, uvCoord).rgb;
 
 	// Ambient lighting
@@ -62,7 +105,7 @@ void main()
 	shading += mtl.emissive;
 
 	shading = transparency.rgb * transparency.a + (1 - transparency.a) * shading;
-	//shading += lightShafts;
+	shading += lightShafts;
 
 	outFragColor = vec4(shading, 1.0);
 }
\ No newline at end of file
@@ -31,9 +31,11 @@ uniform sampler2D uLinearDepthTexture;
 uniform sampler2DShadow uShadowMap;
 uniform Spotlight uSpotlight;
 
-uniform int uNumSamples = 128;
+uniform int uNumSamples = 32;
+uniform int uMinSamples = 8; // Only used by dynamic sampling
 uniform float uMaxDist = 5.0;
 uniform float uScaleFactor = 1.0;
+uniform int uFrameIndex = 0;
 
 // Helper functions
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -64,6 +66,22 @@ float calcLightAttenuation(vec3 samplePos)
 	return smoothstep(uSpotlight.softAngleCos, uSpotlight.sharpAngleCos, dot(lightToSampleDir, uSpotlight.vsDir));
 }
 
+// Offset in [0, 1) of the first sample along the ray, given in fractions of a sample step
+//
+// Neighbouring pixels start at different offsets (4x4 interleaved pattern), so each 4x4 block
+// together covers 16 times as many positions along the ray as a single pixel. The pattern is
+// shifted every frame, the temporal resolve pass then accumulates the offsets over time.
+float interleavedSampleOffset()
+{
+	const float BAYER[16] = float[16](0.0, 8.0, 2.0, 10.0,
+	                                  12.0, 4.0, 14.0, 6.0,
+	                                  3.0, 11.0, 1.0, 9.0,
+	                                  15.0, 7.0, 13.0, 5.0);
+	ivec2 p = ivec2(gl_FragCoord.xy) & 3;
+	float bayer = (BAYER[p.y * 4 + p.x] + 0.5) / 16.0;
+	return fract(bayer + float(uFrameIndex) * 0.618034);
+}
+
 // Intersection test
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -331,10 +349,12 @@ void main()
 	vec2 shadowMapSize = vec2(textureSize(uShadowMap, 0));
 	vec2 diff = abs((endShadowCoord.xy / endShadowCoord.w) - (startShadowCoord.xy / startShadowCoord.w));
 	vec2 texelDiff = diff * shadowMapSize;
-	int numSamples = clamp(int(max(texelDiff.x, texelDiff.y)), 16, uNumSamples);
+	int numSamples = clamp(int(max(texelDiff.x, texelDiff.y)), uMinSamples, uNumSamples);
 
-	float sampleStep = (endT - startT) / float(numSamples - 1);
-	float interpStep = 1.0 / float(numSamples - 1);
+	// Stratified sampling, one sample at a jittered position within each step
+	float sampleStep = (endT - startT) / float(numSamples);
+	float interpStep = 1.0 / float(numSamples);
+	float jitter = interleavedSampleOffset();
 
 	// Precompute light dissipation variables
 	vec3 startLightToSample = startPos - uSpotlight.vsPos;
@@ -348,7 +368,7 @@ void main()
 	float factor = 0.0;
 	for (int i = 0; i < numSamples; ++i) {
 
-		float interp = interpStep * float(i);
+		float interp = interpStep * (float(i) + jitter);
 
 		vec4 sampleShadowCoord = mix(startShadowCoord, endShadowCoord, interp);
 		float shadowSample = textureProj(uShadowMap, sampleShadowCoord);
@@ -0,0 +1,72 @@
+#version 330
+
+// Input, output and uniforms
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Input
+in vec2 uvCoord;
+in vec3 nonNormRayDir;
+
+// Output
+out vec4 outFragColor; // rgb = light shafts, a = linear depth used for the upsample and next frame
+
+// Uniforms
+uniform float uFarPlaneDist;
+uniform sampler2D uLinearDepthTexture;
+uniform sampler2D uLightShaftsTexture; // Ray marched this frame, same resolution as output
+uniform vec2 uLightShaftsRectDim; // Sub-rect of the light shafts texture rendered to this frame
+uniform sampler2D uHistoryTexture; // Resolved last frame
+
+uniform mat4 uCurrToPrevViewMatrix;
+uniform mat4 uPrevProjMatrix;
+uniform vec2 uHistoryUVScale; // Sub-rect of the history texture rendered to last frame
+uniform bool uHistoryValid = false;
+
+uniform float uHistoryWeight = 0.9;
+uniform float uMaxRelativeDepthDiff = 0.05; // History is discarded if depth differs more
+
+// Main
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void main()
+{
+	float linDepth = texture(uLinearDepthTexture, uvCoord).r;
+	vec3 vsPos = uFarPlaneDist * linDepth * nonNormRayDir / abs(nonNormRayDir.z);
+
+	// This frame's result and the range of its 3x3 neighbourhood, the neighbourhood covers most
+	// of the interleaved sample offsets so history outside of it is likely stale.
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	ivec2 maxTexel = ivec2(uLightShaftsRectDim) - ivec2(1);
+	vec3 current = texelFetch(uLightShaftsTexture, texel, 0).rgb;
+	vec3 neighbourMin = current;
+	vec3 neighbourMax = current;
+	for (int y = -1; y <= 1; ++y) {
+		for (int x = -1; x <= 1; ++x) {
+			vec3 neighbour = texelFetch(uLightShaftsTexture, clamp(texel + ivec2(x, y), ivec2(0), maxTexel), 0).rgb;
+			neighbourMin = min(neighbourMin, neighbour);
+			neighbourMax = max(neighbourMax, neighbour);
+		}
+	}
+
+	// Reproject into last frame
+	vec4 prevVsPos = uCurrToPrevViewMatrix * vec4(vsPos, 1.0);
+	vec4 prevClipPos = uPrevProjMatrix * prevVsPos;
+	vec2 prevUV = (prevClipPos.xy / prevClipPos.w) * 0.5 + 0.5;
+	float expectedDepth = -prevVsPos.z / uFarPlaneDist;
+
+	vec3 result = current;
+	bool onScreen = all(greaterThanEqual(prevUV, vec2(0.0))) && all(lessThanEqual(prevUV, vec2(1.0)));
+	if (uHistoryValid && onScreen) {
+		vec2 historyUVMax = uHistoryUVScale - vec2(0.5) / vec2(textureSize(uHistoryTexture, 0));
+		vec4 history = texture(uHistoryTexture, min(prevUV * uHistoryUVScale, historyUVMax));
+
+		// Disocclusion test, the surface seen last frame must be the one seen now
+		float relDepthDiff = abs(history.a - expectedDepth) / max(expectedDepth, 0.0001);
+		if (relDepthDiff < uMaxRelativeDepthDiff) {
+			vec3 clampedHistory = clamp(history.rgb, neighbourMin, neighbourMax);
+			result = mix(current, clampedHistory, uHistoryWeight);
+		}
+	}
+
+	outFragColor = vec4(result, linDepth);
+}
\ No newline at end of file
@@ -39,7 +39,9 @@ uniform sampler2D uLinearDepthTexture;
 uniform sampler2D uNormalTexture;
 uniform usampler2D uMaterialIdTexture;
 
-uniform Material uMaterials[20];
+layout(std140) uniform MaterialsBlock {
+	Material uMaterials[20];
+};
 
 uniform Spotlight uSpotlight;
 uniform sampler2DShadow uShadowMap;
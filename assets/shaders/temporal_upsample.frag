@@ -0,0 +1,109 @@
+#version 330
+
+// Input, output and uniforms
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Input
+in vec2 uvCoord;
+
+// Output
+out vec4 outFragColor;
+
+// Uniforms
+uniform sampler2D uColorTexture;
+uniform sampler2D uVelocityTexture;
+uniform sampler2D uLinearDepthTexture;
+uniform sampler2D uHistoryTexture;
+
+uniform vec2 uRenderRes; // The rendered sub-rect of the input textures
+uniform vec2 uOutputRes;
+uniform vec2 uColorUVScale;
+uniform vec2 uJitter; // In render pixels, geometry was offset by this amount
+uniform bool uHistoryValid = false;
+
+uniform float uMaxCurrentWeight = 0.2;
+
+// Helper functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Catmull-Rom filtered history, keeps it from getting blurrier every time it is resampled. Uses
+// bilinear filtering to get away with 9 instead of 16 samples.
+vec3 sampleHistoryCatmullRom(vec2 uv)
+{
+	vec2 samplePos = uv * uOutputRes;
+	vec2 texPos1 = floor(samplePos - 0.5) + 0.5;
+	vec2 f = samplePos - texPos1;
+
+	vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+	vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+	vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+	vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+	vec2 w12 = w1 + w2;
+	vec2 texPos0 = (texPos1 - 1.0) / uOutputRes;
+	vec2 texPos3 = (texPos1 + 2.0) / uOutputRes;
+	vec2 texPos12 = (texPos1 + w2 / w12) / uOutputRes;
+
+	vec3 result = vec3(0.0);
+	result += texture(uHistoryTexture, vec2(texPos0.x, texPos0.y)).rgb * w0.x * w0.y;
+	result += texture(uHistoryTexture, vec2(texPos12.x, texPos0.y)).rgb * w12.x * w0.y;
+	result += texture(uHistoryTexture, vec2(texPos3.x, texPos0.y)).rgb * w3.x * w0.y;
+
+	result += texture(uHistoryTexture, vec2(texPos0.x, texPos12.y)).rgb * w0.x * w12.y;
+	result += texture(uHistoryTexture, vec2(texPos12.x, texPos12.y)).rgb * w12.x * w12.y;
+	result += texture(uHistoryTexture, vec2(texPos3.x, texPos12.y)).rgb * w3.x * w12.y;
+
+	result += texture(uHistoryTexture, vec2(texPos0.x, texPos3.y)).rgb * w0.x * w3.y;
+	result += texture(uHistoryTexture, vec2(texPos12.x, texPos3.y)).rgb * w12.x * w3.y;
+	result += texture(uHistoryTexture, vec2(texPos3.x, texPos3.y)).rgb * w3.x * w3.y;
+
+	return max(result, vec3(0.0));
+}
+
+// Main
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void main()
+{
+	// The rendered pixel whose (jittered) sample position is closest to this output pixel
+	vec2 renderPos = uvCoord * uRenderRes;
+	ivec2 maxTexel = ivec2(uRenderRes) - ivec2(1);
+	ivec2 nearest = clamp(ivec2(floor(renderPos + uJitter)), ivec2(0), maxTexel);
+
+	// Color range of the neighbourhood and the closest surface, whose motion is used so that
+	// edges of moving objects are not left behind.
+	vec3 current = texelFetch(uColorTexture, nearest, 0).rgb;
+	vec3 neighbourMin = current;
+	vec3 neighbourMax = current;
+	ivec2 closestTexel = nearest;
+	float closestDepth = texelFetch(uLinearDepthTexture, nearest, 0).r;
+	for (int y = -1; y <= 1; ++y) {
+		for (int x = -1; x <= 1; ++x) {
+			ivec2 texel = clamp(nearest + ivec2(x, y), ivec2(0), maxTexel);
+			vec3 neighbour = texelFetch(uColorTexture, texel, 0).rgb;
+			neighbourMin = min(neighbourMin, neighbour);
+			neighbourMax = max(neighbourMax, neighbour);
+
+			float depth = texelFetch(uLinearDepthTexture, texel, 0).r;
+			if (depth < closestDepth) {
+				closestDepth = depth;
+				closestTexel = texel;
+			}
+		}
+	}
+	vec2 velocity = texelFetch(uVelocityTexture, closestTexel, 0).rg;
+
+	vec2 prevUV = uvCoord - velocity;
+	bool onScreen = all(greaterThanEqual(prevUV, vec2(0.0))) && all(lessThanEqual(prevUV, vec2(1.0)));
+	if (!uHistoryValid || !onScreen) {
+		outFragColor = vec4(texture(uColorTexture, uvCoord * uColorUVScale).rgb, 1.0);
+		return;
+	}
+
+	// Weight of the new sample by its distance to this output pixel, in output pixels
+	vec2 sampleOffset = (renderPos - (vec2(nearest) + 0.5 - uJitter)) * (uOutputRes / uRenderRes);
+	float currentWeight = uMaxCurrentWeight * exp(-2.29 * dot(sampleOffset, sampleOffset));
+
+	vec3 history = clamp(sampleHistoryCatmullRom(prevUV), neighbourMin, neighbourMax);
+	outFragColor = vec4(mix(history, current, currentWeight), 1.0);
+}
\ No newline at end of file
@@ -23,7 +23,9 @@ out vec4 outFragColor;
 
 // Uniforms
 uniform uint uMaterialId;
-uniform Material uMaterials[20];
+layout(std140) uniform MaterialsBlock {
+	Material uMaterials[20];
+};
 uniform vec3 uAmbientLight;
 
 // Main
@@ -0,0 +1,48 @@
+#version 330
+
+// Structs
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+struct Material {
+	vec3 diffuse;
+	vec3 specular;
+	vec3 emissive;
+	float shininess;
+	float opaque;
+};
+
+// Input, output and uniforms
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Input
+in vec3 vsPos;
+flat in uint materialId;
+
+// Output
+out vec4 outFragAccumulation; // rgb = weighted premultiplied color, a = revealage
+out float outFragWeight; // Sum of alpha * weight, used to normalize the accumulated color
+
+// Uniforms
+layout(std140) uniform MaterialsBlock {
+	Material uMaterials[20];
+};
+uniform vec3 uAmbientLight;
+
+// Main
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void main()
+{
+	Material mtl = uMaterials[materialId];
+	vec3 color = mtl.diffuse * uAmbientLight + mtl.emissive;
+	float alpha = mtl.opaque;
+
+	// Weighted blended OIT (McGuire & Bavoil), closer surfaces get a larger weight so they
+	// dominate the average when several overlap. Depth is in view space units.
+	float z = -vsPos.z;
+	float weight = clamp(10.0 / (1e-5 + pow(z / 2.0, 2.0) + pow(z / 10.0, 6.0)), 1e-2, 3e3);
+
+	// The alpha channel is blended separately as Da * (1 - Sa), giving the revealage
+	outFragAccumulation = vec4(color * alpha * weight, alpha);
+	outFragWeight = alpha * weight;
+}
\ No newline at end of file
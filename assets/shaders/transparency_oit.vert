@@ -0,0 +1,39 @@
+#version 330
+
+// Structs
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+struct Instance {
+	mat4 modelMatrix;
+	uvec4 materialId; // Only x is used, padded to match std140
+};
+
+// Input, output and uniforms
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Input
+in vec3 inPosition;
+in vec3 inNormal;
+
+// Output
+out vec3 vsPos;
+flat out uint materialId;
+
+// Uniforms
+uniform mat4 uProjMatrix;
+uniform mat4 uViewMatrix;
+layout(std140) uniform InstancesBlock {
+	Instance uInstances[128];
+};
+
+// Main
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void main()
+{
+	Instance instance = uInstances[gl_InstanceID];
+	vec4 vsPosition = uViewMatrix * instance.modelMatrix * vec4(inPosition, 1);
+	vsPos = vsPosition.xyz;
+	materialId = instance.materialId.x;
+	gl_Position = uProjMatrix * vsPosition;
+}
\ No newline at end of file
@@ -4,16 +4,22 @@
 
 #include "sfz/gl/Alignment.hpp"
 #include "sfz/gl/Context.hpp"
+#include "sfz/gl/FenceRing.hpp"
 #include "sfz/gl/FontRenderer.hpp"
 #include "sfz/gl/Framebuffer.hpp"
+#include "sfz/gl/FramePacer.hpp"
 #include "sfz/gl/GLUtils.hpp"
+#include "sfz/gl/GpuMemoryTracker.hpp"
 #include "sfz/gl/PostProcessQuad.hpp"
 #include "sfz/gl/Program.hpp"
+#include "sfz/gl/RenderTargetPool.hpp"
 #include "sfz/gl/SimpleModel.hpp"
 #include "sfz/gl/Spotlight.hpp"
 #include "sfz/gl/SpriteBatch.hpp"
 #include "sfz/gl/SSAO.hpp"
+#include "sfz/gl/StateCache.hpp"
 #include "sfz/gl/Texture.hpp"
+#include "sfz/gl/TextureContainer.hpp"
 #include "sfz/gl/TextureEnums.hpp"
 #include "sfz/gl/TexturePacker.hpp"
 #include "sfz/gl/TextureRegion.hpp"
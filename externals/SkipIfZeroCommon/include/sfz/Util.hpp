@@ -2,9 +2,14 @@
 #ifndef SFZ_UTIL_HPP
 #define SFZ_UTIL_HPP
 
+#include "sfz/util/AssetArchive.hpp"
+#include "sfz/util/ByteIO.hpp"
 #include "sfz/util/FrametimeStats.hpp"
 #include "sfz/util/IniParser.hpp"
 #include "sfz/util/IO.hpp"
+#include "sfz/util/MappedFile.hpp"
+#include "sfz/util/OrderStatisticTree.hpp"
+#include "sfz/util/SPSCQueue.hpp"
 #include "sfz/util/StopWatch.hpp"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef SFZ_GL_FENCE_RING_HPP
+#define SFZ_GL_FENCE_RING_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace gl {
+
+using std::uint32_t;
+using std::vector;
+
+// FenceRing class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief A fixed capacity FIFO of sync fences, retired oldest first
+ *
+ * Each fence occupies a slot in [0, capacity()), which stays the same until the fence is retired.
+ * Owners keep whatever they need per fence (e.g. a buffer range or a query) in their own arrays
+ * indexed by slot. Blocking waits flush the command stream and are retried every 100ms until the
+ * fence is signaled, so they never give up on a slow GPU.
+ *
+ * Requires a current OpenGL context for its entire lifetime.
+ */
+class FenceRing final {
+public:
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	FenceRing() noexcept = default;
+	FenceRing(const FenceRing&) = delete;
+	FenceRing& operator= (const FenceRing&) = delete;
+
+	explicit FenceRing(uint32_t capacity) noexcept;
+	FenceRing(FenceRing&& other) noexcept;
+	FenceRing& operator= (FenceRing&& other) noexcept;
+	~FenceRing() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	inline uint32_t capacity() const noexcept { return uint32_t(mFences.size()); }
+	inline uint32_t size() const noexcept { return mSize; }
+	inline bool isEmpty() const noexcept { return mSize == 0; }
+	inline bool isFull() const noexcept { return mSize == capacity(); }
+
+	/** @brief The slot of the oldest fence, undefined if empty */
+	inline uint32_t oldestSlot() const noexcept { return mOldest; }
+
+	/** @brief The slot the next inserted fence will occupy, undefined if full */
+	inline uint32_t nextSlot() const noexcept { return (mOldest + mSize) % capacity(); }
+
+	/** @brief Inserts a fence after all commands issued so far, the ring must not be full */
+	uint32_t insert() noexcept;
+
+	/**
+	 * @brief Blocks until the oldest fence is signaled and removes it, does nothing if empty
+	 * @return false if the wait failed (e.g. lost context), the fence is removed anyway so the
+	 *         caller can't get stuck
+	 */
+	bool retireOldest() noexcept;
+
+	/** @brief Whether retireOldest() would return immediately, i.e. signaled or failed */
+	bool isOldestSignaled() const noexcept;
+
+	/** @brief Removes all fences that are already signaled, never blocks */
+	void retireSignaled() noexcept;
+
+private:
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	vector<void*> mFences; // GLsync, nullptr for empty slots
+	uint32_t mOldest = 0;
+	uint32_t mSize = 0;
+};
+
+} // namespace gl
+#endif
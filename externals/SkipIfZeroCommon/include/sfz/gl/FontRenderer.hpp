@@ -7,17 +7,24 @@
 #include "sfz/gl/SpriteBatch.hpp"
 #include "sfz/gl/TextureEnums.hpp"
 #include "sfz/math/Vector.hpp"
+#include "sfz/util/AssetArchive.hpp"
 
 #include <cstddef> // size_t
 #include <cstdint> // uint8_t
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace gl {
 
 using std::size_t;
 using std::uint8_t;
 using std::uint32_t;
+using std::uint64_t;
 
 using sfz::AABB2D;
+using sfz::AssetView;
 using sfz::vec2;
 using sfz::vec4;
 
@@ -37,7 +44,21 @@ public:
 
 	FontRenderer(const char* fontPath, uint32_t texWidth, uint32_t texHeight,
 	             float fontSize, size_t numCharsPerBatch,
-	             TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16) noexcept;
+	             TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16,
+	             const char* atlasCachePath = nullptr) noexcept;
+
+	/**
+	 * @brief Creates the font atlas from a TTF file already in memory, e.g. a view of an AssetArchive
+	 * The data is only needed during construction.
+	 * @param name only used in error messages and for the GpuMemoryTracker
+	 * @param atlasCachePath optional file the baked atlas is stored in. On later runs the atlas is
+	 *                       loaded from it instead of being baked, unless the font file, size or
+	 *                       atlas dimensions have changed since it was written.
+	 */
+	FontRenderer(const AssetView& ttfFile, const char* name, uint32_t texWidth, uint32_t texHeight,
+	             float fontSize, size_t numCharsPerBatch,
+	             TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16,
+	             const char* atlasCachePath = nullptr) noexcept;
 	~FontRenderer() noexcept;
 
 	// Public methods
@@ -46,7 +67,12 @@ public:
 	void begin(const AABB2D& camera) noexcept;
 	void begin(vec2 cameraPosition, vec2 cameraDimensions) noexcept;
 
-	/** @return The position to write the next char at. */
+	/**
+	 * @brief Writes the text, laid out only the first time it's written or measured
+	 * The layout of the most recently used strings is cached independently of size and alignment,
+	 * so repeatedly writing the same text (e.g. labels, shadows) only copies the cached glyphs.
+	 * @return The position to write the next char at.
+	 */
 	float write(vec2 position, float size, const char* text) noexcept;
 
 	void writeBitmapFont(vec2 position, vec2 dimensions) noexcept;
@@ -54,6 +80,7 @@ public:
 	void end(uint32_t fbo, vec2 viewportDimensions, vec4 textColor) noexcept;
 	void end(uint32_t fbo, const AABB2D& viewport, vec4 textColor) noexcept;
 
+	/** @brief Measures the text, which is laid out and cached in the same way as in write() */
 	float measureStringWidth(float size, const char* text) const noexcept;
 
 	// Getters / setters
@@ -66,6 +93,31 @@ public:
 	inline void verticalAlign(VerticalAlign align) noexcept { mVertAlign = align; }
 
 private:
+	// Private types
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	struct CachedGlyph final {
+		vec2 pos, dim; // At font size, relative to the start of the text
+		TextureRegion texRegion;
+	};
+
+	struct CachedTextRun final {
+		uint64_t hash;
+		std::string text;
+		float width; // At font size
+		std::vector<CachedGlyph> glyphs;
+	};
+
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Returns the cached layout of the text, laying it out if it's not in the cache */
+	const CachedTextRun& textRun(const char* text) const noexcept;
+	void layoutTextRun(CachedTextRun& run, const char* text, size_t length) const noexcept;
+
+	void createFontTexture(const uint8_t* ttfData, size_t ttfSize, const char* name, uint32_t texWidth,
+	                       uint32_t texHeight, TextureFiltering filtering, const char* atlasCachePath) noexcept;
+
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -73,12 +125,16 @@ private:
 	static const uint32_t LAST_CHAR = 246; // inclusive
 	static const uint32_t CHAR_COUNT = LAST_CHAR - FIRST_CHAR + 1;
 	static const uint32_t UNKNOWN_CHAR = '?';
+	static const size_t TEXT_RUN_CACHE_CAPACITY = 256;
 
 	const float mFontSize;
 	vec2 mPixelToUV;
 	uint32_t mFontTexture;
+	uint32_t mMemoryId = 0; // See GpuMemoryTracker
 	void* const mPackedChars; // Type is implementation defined
 	SpriteBatch mSpriteBatch;
+	mutable std::list<CachedTextRun> mTextRuns; // Most recently used first
+	mutable std::unordered_map<uint64_t, std::list<CachedTextRun>::iterator> mTextRunMap;
 	HorizontalAlign mHorizAlign = HorizontalAlign::LEFT;
 	VerticalAlign mVertAlign = VerticalAlign::MIDDLE;
 };
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef SFZ_GL_FRAME_PACER_HPP
+#define SFZ_GL_FRAME_PACER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "sfz/gl/FenceRing.hpp"
+#include "sfz/util/FrametimeStats.hpp"
+
+namespace gl {
+
+using std::int64_t;
+using std::size_t;
+using std::uint32_t;
+
+// FramePacer class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Limits the number of frames the CPU may submit ahead of the GPU using sync fences
+ *
+ * A fence is inserted after each buffer swap with frameSubmitted(). waitForFrameSlot() blocks
+ * until less than maxFramesInFlight() fences are still pending, so with 1 frame in flight the CPU
+ * waits for the GPU to finish the previous frame before starting the next one (lowest latency),
+ * while 2 or 3 allow the CPU to run ahead for better throughput.
+ *
+ * Two statistics are recorded: the time the CPU spent blocked in waitForFrameSlot() and the
+ * GPU completion latency, i.e. the time from a frame being submitted until the GPU finished it.
+ * The latter is measured on the GPU's clock with a GL_TIMESTAMP query written together with the
+ * fence, so it doesn't depend on when the fence happens to be polled.
+ *
+ * Requires a current OpenGL context for its entire lifetime.
+ */
+class FramePacer final {
+public:
+	// Constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	FramePacer() = delete;
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator= (const FramePacer&) = delete;
+
+	FramePacer(uint32_t maxFramesInFlight, size_t numStatsSamples = 120) noexcept;
+	~FramePacer() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Blocks until another frame may be submitted, call before starting a new frame. */
+	void waitForFrameSlot() noexcept;
+
+	/** @brief Inserts a fence for the frame just submitted, call directly after swapping buffers. */
+	void frameSubmitted() noexcept;
+
+	/** @brief Sets the max number of frames in flight, clamped to [1, MAX_FRAMES_IN_FLIGHT]. */
+	void maxFramesInFlight(uint32_t maxFramesInFlight) noexcept;
+
+	inline uint32_t maxFramesInFlight() const noexcept { return mMaxFramesInFlight; }
+	inline uint32_t numFramesInFlight() const noexcept { return mFences.size(); }
+	inline const sfz::FrametimeStats& cpuWaitStats() const noexcept { return mCpuWaitStats; }
+	inline const sfz::FrametimeStats& gpuLatencyStats() const noexcept { return mGpuLatencyStats; }
+
+private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void retireOldest() noexcept;
+	void retireSignaled() noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	// A fence per pending frame, the timestamps are indexed by the fence's slot
+	FenceRing mFences;
+	uint32_t mTimestampQueries[MAX_FRAMES_IN_FLIGHT];
+	int64_t mSubmitGpuTimes[MAX_FRAMES_IN_FLIGHT]; // GL_TIMESTAMP when submitted, nanoseconds
+	uint32_t mMaxFramesInFlight;
+
+	sfz::FrametimeStats mCpuWaitStats, mGpuLatencyStats;
+};
+
+} // namespace gl
+#endif
\ No newline at end of file
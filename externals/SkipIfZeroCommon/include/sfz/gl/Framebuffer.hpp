@@ -2,6 +2,7 @@
 #ifndef SFZ_GL_FRAMEBUFFER_HPP
 #define SFZ_GL_FRAMEBUFFER_HPP
 
+#include <cstddef>
 #include <cstdint>
 
 #include "sfz/math/Vector.hpp"
@@ -12,6 +13,7 @@ using sfz::vec2;
 using sfz::vec2i;
 using sfz::vec4;
 using std::int32_t;
+using std::size_t;
 using std::uint32_t;
 
 class Framebuffer; // Forward declare Framebuffer class
@@ -134,6 +136,20 @@ public:
 
 	Framebuffer build() const noexcept;
 
+	// Comparison & size estimation
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Two builders are equal if they would build framebuffers with identical attachments */
+	bool operator== (const FramebufferBuilder& other) const noexcept;
+	bool operator!= (const FramebufferBuilder& other) const noexcept;
+
+	/**
+	 * @brief Estimates the GPU memory used by a framebuffer built by this builder
+	 * Three component formats and 24-bit depth are assumed to be padded to four components/bytes,
+	 * which is what most drivers do. The actual size is implementation defined.
+	 */
+	size_t estimatedSizeBytes() const noexcept;
+
 private:
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -238,6 +254,7 @@ private:
 	uint32_t mStencilBuffer = 0;
 	uint32_t mStencilTexture = 0;
 	vec2i mDim{-1};
+	uint32_t mMemoryId = 0; // See GpuMemoryTracker
 };
 
 // Framebuffer helper functions
@@ -0,0 +1,112 @@
+#pragma once
+#ifndef SFZ_GL_GPU_MEMORY_TRACKER_HPP
+#define SFZ_GL_GPU_MEMORY_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gl {
+
+using std::size_t;
+using std::uint32_t;
+using std::vector;
+
+// GpuMemoryCategory enum
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+enum class GpuMemoryCategory : uint32_t {
+	TEXTURE = 0, // Textures loaded from files and atlases (TexturePacker, FontRenderer)
+	FRAMEBUFFER, // All attachments of framebuffers, including shadow maps and pooled targets
+	MESH, // Vertex and index buffers of SimpleModels
+	SPRITE_BATCH // Vertex, index and streaming buffers of SpriteBatches
+};
+
+const uint32_t NUM_GPU_MEMORY_CATEGORIES = 4;
+
+const char* to_string(GpuMemoryCategory category) noexcept;
+
+// GpuMemoryTracker structs
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+struct GpuAllocation final {
+	uint32_t id = 0;
+	GpuMemoryCategory category = GpuMemoryCategory::TEXTURE;
+	size_t bytes = 0;
+	char label[64]; // Null terminated, truncated from the front if too long to keep file names
+};
+
+struct GpuMemoryStats final {
+	size_t bytes[NUM_GPU_MEMORY_CATEGORIES] = {0, 0, 0, 0};
+	uint32_t numAllocations[NUM_GPU_MEMORY_CATEGORIES] = {0, 0, 0, 0};
+	size_t totalBytes = 0;
+	size_t peakTotalBytes = 0;
+};
+
+// GpuMemoryTracker class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Keeps track of the estimated GPU memory used by the sfz::gl resource classes
+ *
+ * Texture, Framebuffer, TexturePacker, FontRenderer, SimpleModel and SpriteBatch add an
+ * allocation when they create their GL objects and remove it again when they are destroyed.
+ * Sizes are estimates based on formats and dimensions (mipmaps add a third), drivers are free to
+ * pad or compress, so the totals are mostly useful for finding where memory goes.
+ *
+ * Not thread safe, like the GL resources themselves it should only be used from the thread owning
+ * the GL context.
+ */
+class GpuMemoryTracker final {
+public:
+	// Singleton instance
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static GpuMemoryTracker& INSTANCE() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Adds an allocation and returns its id, which is never 0. */
+	uint32_t add(GpuMemoryCategory category, const char* label, size_t bytes) noexcept;
+
+	/** @brief Removes the allocation with the specified id, 0 is silently ignored. */
+	void remove(uint32_t id) noexcept;
+
+	/** @brief Prints all allocations to stdout, largest first, followed by the category totals. */
+	void printReport() const noexcept;
+
+	inline const GpuMemoryStats& stats() const noexcept { return mStats; }
+	inline const vector<GpuAllocation>& allocations() const noexcept { return mAllocations; }
+
+private:
+	// Private constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	GpuMemoryTracker(const GpuMemoryTracker&) = delete;
+	GpuMemoryTracker& operator= (const GpuMemoryTracker&) = delete;
+
+	GpuMemoryTracker() noexcept = default;
+	~GpuMemoryTracker() noexcept = default;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	vector<GpuAllocation> mAllocations;
+	GpuMemoryStats mStats;
+	uint32_t mNextId = 1;
+};
+
+// Size estimation functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Estimates the size of a 2D texture
+ * Three channel textures are assumed to be padded to four channels, a full mipmap chain adds a
+ * third of the base level.
+ */
+size_t estimatedTextureSizeBytes(int width, int height, int numChannels, size_t bytesPerChannel,
+                                 bool mipmapped) noexcept;
+
+} // namespace gl
+#endif
\ No newline at end of file
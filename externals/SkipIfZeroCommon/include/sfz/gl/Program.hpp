@@ -2,6 +2,7 @@
 #ifndef SFZ_GL_SHADER_PROGRAM_HPP
 #define SFZ_GL_SHADER_PROGRAM_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -17,6 +18,8 @@ using sfz::mat2;
 using sfz::mat3;
 using sfz::mat4;
 
+using std::int32_t;
+using std::size_t;
 using std::string;
 using std::uint32_t;
 
@@ -33,6 +36,8 @@ using std::uint32_t;
  * vec3 nonNormRayDir: non-normalized ray direction for each pixel
  * In order to calculate nonNormRayDir the "uniform mat4 uInvProjMatrix" needs to be set with
  * the inverse projection matrix. Can safely be ignored if nonNormRayDir won't be used.
+ * uvCoord is multiplied by "uniform vec2 uUVScale" (defaults to 1), which allows rendering from
+ * and to the lower left sub-rect of larger textures by setting it to subRectDim / textureDim.
  */
 class Program final {
 public:
@@ -68,6 +73,21 @@ public:
 	                        void(*bindAttribFragFunc)(uint32_t shaderProgram) = nullptr) noexcept;
 	static Program postProcessFromFile(const char* postProcessPath) noexcept;
 
+	/**
+	 * @brief Constructs an OpenGL program given sources in memory, e.g. views of an AssetArchive
+	 * The sources don't need to be null terminated. The file paths are only stored for reload(),
+	 * which reads the sources from them and keeps the current program if they don't exist.
+	 * @param *Src the source for a specific shader
+	 * @param *Length the length of the source in bytes
+	 * @param *Path the path to the file with the same source as *Src
+	 */
+
+	static Program fromMemory(const char* vertexSrc, size_t vertexLength, const char* vertexPath,
+	                          const char* fragmentSrc, size_t fragmentLength, const char* fragmentPath,
+	                          void(*bindAttribFragFunc)(uint32_t shaderProgram) = nullptr) noexcept;
+	static Program postProcessFromMemory(const char* postProcessSrc, size_t postProcessLength,
+	                                     const char* postProcessPath) noexcept;
+
 	// Public methods
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -98,6 +118,18 @@ public:
 	~Program() noexcept;
 
 private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/**
+	 * Compiles and links the shaders, the geometry shader is optional (nullptr). The lengths are in
+	 * bytes, or negative if the source is null terminated.
+	 */
+	static Program fromSourceWithLengths(const char* vertexSrc, int32_t vertexLength,
+	                                     const char* geometrySrc, int32_t geometryLength,
+	                                     const char* fragmentSrc, int32_t fragmentLength,
+	                                     void(*bindAttribFragFunc)(uint32_t shaderProgram)) noexcept;
+
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -129,6 +161,12 @@ private:
  */
 uint32_t compileShader(const char* source, uint32_t shaderType) noexcept;
 
+/**
+ * @brief Compiles shader from a source which isn't necessarily null terminated
+ * @param length the length of the source in bytes, negative if it is null terminated
+ */
+uint32_t compileShader(const char* source, int32_t length, uint32_t shaderType) noexcept;
+
 /** Links an OpenGL program and returns whether succesful or not. */
 bool linkProgram(uint32_t program) noexcept;
 
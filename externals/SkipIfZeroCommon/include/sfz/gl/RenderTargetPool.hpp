@@ -0,0 +1,104 @@
+#pragma once
+#ifndef SFZ_GL_RENDER_TARGET_POOL_HPP
+#define SFZ_GL_RENDER_TARGET_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sfz/gl/Framebuffer.hpp"
+
+namespace gl {
+
+using std::size_t;
+using std::uint32_t;
+using std::unique_ptr;
+using std::vector;
+
+// RenderTargetPoolStats struct
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** @brief Estimated memory usage of the pool, see FramebufferBuilder::estimatedSizeBytes(). */
+struct RenderTargetPoolStats final {
+	size_t bytesAllocated = 0; // All framebuffers owned by the pool, in use or not
+	size_t bytesInUse = 0; // Currently acquired framebuffers
+	size_t peakBytesInUse = 0; // Highest value of bytesInUse since the last newFrame()
+	uint32_t numTargets = 0;
+	uint32_t numCreatedThisFrame = 0;
+};
+
+// RenderTargetPool class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Pool of transient framebuffers, keyed by their FramebufferBuilder settings
+ *
+ * Passes acquire the framebuffers they render to and release them as soon as their contents are
+ * no longer needed, at which point they can be handed out again to any later pass asking for an
+ * identical framebuffer. Memory is thus only needed for the targets alive at the same time, not
+ * for every target used during a frame.
+ *
+ * The contents of an acquired framebuffer are undefined, and any external attachments made
+ * after acquiring must be detached again before releasing. Framebuffers that haven't been
+ * acquired for MAX_UNUSED_FRAMES frames are destroyed by newFrame(), which should be called once
+ * per frame before rendering starts.
+ */
+class RenderTargetPool final {
+public:
+	// Singleton instance
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static RenderTargetPool& INSTANCE() noexcept;
+
+	// Constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const uint32_t MAX_UNUSED_FRAMES = 120;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Returns a free framebuffer matching the builder, creating it if necessary. */
+	Framebuffer& acquire(const FramebufferBuilder& builder) noexcept;
+
+	/** @brief Returns a framebuffer previously returned by acquire() to the pool. */
+	void release(const Framebuffer& framebuffer) noexcept;
+
+	/** @brief Destroys long unused framebuffers and resets the per frame statistics. */
+	void newFrame() noexcept;
+
+	/** @brief Destroys all framebuffers not currently in use, e.g. before the GL context is. */
+	void clear() noexcept;
+
+	inline const RenderTargetPoolStats& stats() const noexcept { return mStats; }
+
+private:
+	// Private constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool& operator= (const RenderTargetPool&) = delete;
+
+	RenderTargetPool() noexcept = default;
+	~RenderTargetPool() noexcept = default;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	struct Entry final {
+		FramebufferBuilder builder;
+		Framebuffer framebuffer;
+		size_t sizeBytes = 0;
+		uint32_t framesUnused = 0;
+		bool inUse = false;
+	};
+
+	void destroyEntry(size_t index) noexcept;
+
+	vector<unique_ptr<Entry>> mEntries;
+	RenderTargetPoolStats mStats;
+};
+
+} // namespace gl
+#endif
\ No newline at end of file
@@ -28,7 +28,12 @@ enum class ScalingAlgorithm : int32_t {
 	GRID_4X4_BILINEAR = 5,
 	BICUBIC_BSPLINE = 6,
 	LANCZOS_2 = 7,
-	LANCZOS_3 = 8
+	LANCZOS_3 = 8,
+
+	// Same kernels as above, but applied as a horizontal and a vertical pass with weights from a
+	// precomputed table. I.e. 2N instead of N² taps per pixel, at the cost of an extra target.
+	LANCZOS_2_SEPARABLE = 9,
+	LANCZOS_3_SEPARABLE = 10
 };
 
 const char* to_string(ScalingAlgorithm algorithm) noexcept;
@@ -56,6 +61,14 @@ public:
 	
 	void scale(uint32_t dstFBO, const AABB2D& dstViewport, uint32_t srcTex, vec2 srcDimensions) noexcept;
 
+	/**
+	 * @brief Scales the lower left srcRectDimensions sub-rect of the source texture
+	 * Used when only part of a larger texture has been rendered to, e.g. with dynamic resolution.
+	 * The filters never sample outside of the sub-rect.
+	 */
+	void scale(uint32_t dstFBO, const AABB2D& dstViewport, uint32_t srcTex, vec2 srcDimensions,
+	           vec2 srcRectDimensions) noexcept;
+
 	void changeScalingAlgorithm(ScalingAlgorithm newAlgo) noexcept;
 
 	// Getters
@@ -64,13 +77,29 @@ public:
 	inline ScalingAlgorithm scalingAlgorithm() const noexcept { return mScalingAlgorithm; }
 
 private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void scaleSeparable(uint32_t dstFBO, const AABB2D& dstViewport, uint32_t srcTex, vec2 srcDimensions,
+	                    vec2 srcRectDimensions) noexcept;
+
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
+	// Filter weights of each tap for a number of sampling positions (phases) between two texels,
+	// rebuilt whenever the source or destination size along its axis changes.
+	struct WeightTable final {
+		uint32_t texture = 0;
+		int32_t numPhases = 0;
+		int32_t srcSize = -1, dstSize = -1;
+	};
+
 	PostProcessQuad mQuad;
 	ScalingAlgorithm mScalingAlgorithm;
 	Program mProgram;
 	uint32_t mSamplerObject = 0;
+	int32_t mNumTaps = 0; // Separable algorithms only
+	WeightTable mWeights[2]; // Horizontal & vertical, separable algorithms only
 };
 
 } // namespace gl
@@ -9,6 +9,7 @@
 namespace gl {
 
 using std::size_t;
+using std::uint8_t;
 using std::uint32_t;
 using std::unique_ptr;
 
@@ -33,9 +34,17 @@ public:
 	SimpleModel() noexcept = default;
 	SimpleModel(const SimpleModel&) = delete;
 	SimpleModel& operator= (const SimpleModel&) = delete;
-	~SimpleModel() noexcept = default;
+	~SimpleModel() noexcept;
 	
 	SimpleModel(const char* basePath, const char* filename) noexcept;
+
+	/**
+	 * @brief Parses a model file already in memory, e.g. a view of an AssetArchive
+	 * @param name only used in error messages and for the GpuMemoryTracker
+	 * @param mtlBasePath the directory to look for .mtl files in, if nullptr the model doesn't get
+	 *                    any materials and all material ids are -1
+	 */
+	SimpleModel(const char* name, const uint8_t* data, size_t size, const char* mtlBasePath = nullptr) noexcept;
 	SimpleModel(SimpleModel&& other) noexcept;
 	SimpleModel& operator= (SimpleModel&& other) noexcept;
 	
@@ -44,6 +53,9 @@ public:
 
 	void render() noexcept;
 
+	/** @brief Renders numInstances copies of the model, shaders tell them apart by gl_InstanceID */
+	void renderInstanced(uint32_t numInstances) noexcept;
+
 private:
 	// Private classes
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -83,6 +95,7 @@ private:
 	unique_ptr<VAORenderingInfo[]> mVAORenderingInfos = nullptr;
 	unique_ptr<VAOBufferInfo[]> mVAOBufferInfos = nullptr; // Destroyed before mVAORenderingInfos
 	size_t mNumVAOs = 0;
+	uint32_t mMemoryId = 0; // See GpuMemoryTracker
 };
 
 } // namespace gl
@@ -4,9 +4,9 @@
 
 #include <cstddef> // size_t
 #include <cstdint>
-#include <memory>
 
 #include "sfz/geometry/AABB2D.hpp"
+#include "sfz/gl/FenceRing.hpp"
 #include "sfz/gl/Program.hpp"
 #include "sfz/gl/TextureRegion.hpp"
 #include "sfz/math/Matrix.hpp"
@@ -22,11 +22,20 @@ using sfz::mat3;
 using std::int32_t;
 using std::size_t;
 using std::uint32_t;
-using std::unique_ptr;
 
 // SpriteBatch
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
+/**
+ * @brief Draws textured quads with one instanced draw call per batch
+ *
+ * The sprites are written directly into a mapped stream buffer which is used as a ring, each
+ * begin() reserves room for a full batch after the previous one and end() only consumes what was
+ * drawn. A fence is inserted after each batch and only waited on when the ring has wrapped around
+ * to a batch the GPU might still read, so flushing many small batches per frame is cheap. The
+ * buffer is persistently mapped if ARB_buffer_storage is available, otherwise the reserved range
+ * is mapped unsynchronized between begin() and end().
+ */
 class SpriteBatch final {
 public:
 	// Constructors & destructors
@@ -71,6 +80,23 @@ public:
 	inline const gl::Program& shaderProgram() const noexcept { return mShader; }
 
 private:
+	// Private types & constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	struct Sprite final {
+		mat3 transform;
+		vec4 uv;
+	};
+
+	static const size_t RING_SIZE_IN_BATCHES = 3;
+	static const uint32_t MAX_PENDING_BATCHES = 128;
+
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void reserveBatch() noexcept;
+	void waitForRange(size_t begin, size_t end) noexcept;
+
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -81,9 +107,19 @@ private:
 	gl::Program mShader;
 	int32_t mTextureUniformLoc = 0;
 	uint32_t mVAO;
-	uint32_t mVertexBuffer, mIndexBuffer, mTransformBuffer, mUVBuffer;
-	unique_ptr<mat3[]> mTransformArray;
-	unique_ptr<vec4[]> mUVArray;
+	uint32_t mVertexBuffer, mIndexBuffer, mStreamBuffer;
+	uint32_t mMemoryId = 0; // See GpuMemoryTracker
+
+	// The stream buffer, sizes and offsets in bytes
+	bool mPersistent = false;
+	void* mPersistentPtr = nullptr; // The entire buffer if persistently mapped
+	Sprite* mSprites = nullptr; // The current batch, only mapped between begin() and end()
+	size_t mRingSize = 0;
+	size_t mBatchOffset = 0; // Start of the current batch, the next one is reserved after it
+
+	// A fence after each batch and the range it read, indexed by the fence's slot
+	FenceRing mFences;
+	size_t mFenceBegins[MAX_PENDING_BATCHES], mFenceEnds[MAX_PENDING_BATCHES];
 };
 
 } // namespace sfz
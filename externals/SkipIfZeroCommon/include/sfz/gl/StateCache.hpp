@@ -0,0 +1,118 @@
+#pragma once
+#ifndef SFZ_GL_STATE_CACHE_HPP
+#define SFZ_GL_STATE_CACHE_HPP
+
+#include <cstdint>
+
+#include "sfz/geometry/AABB2D.hpp"
+#include "sfz/math/Vector.hpp"
+
+namespace gl {
+
+using sfz::AABB2D;
+using sfz::vec2;
+using sfz::vec2i;
+using std::int32_t;
+using std::uint32_t;
+
+// StateCacheStats struct
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** @brief Number of state changes forwarded to OpenGL and skipped since the last reset. */
+struct StateCacheStats final {
+	uint32_t numIssued = 0;
+	uint32_t numSkipped = 0;
+};
+
+// StateCache class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Shadows a small subset of OpenGL state and skips redundant state changes
+ *
+ * Cached state: GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE and GL_STENCIL_TEST capabilities, the current
+ * program, the framebuffer bound to GL_FRAMEBUFFER, the viewport, the active texture unit and the
+ * GL_TEXTURE_2D binding of the first MAX_TEXTURE_UNITS texture units. Other capabilities and
+ * texture units are passed straight through to OpenGL.
+ *
+ * The cache only knows about changes made through it. Code that modifies any of the cached state
+ * directly with OpenGL calls must call invalidate() afterwards, and newFrame() should be called
+ * once per frame before rendering starts. Deleting a program, framebuffer or texture through the
+ * sfz::gl classes automatically removes it from the cache so that recycled names are rebound.
+ */
+class StateCache final {
+public:
+	// Singleton instance
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static StateCache& INSTANCE() noexcept;
+
+	// Constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const uint32_t MAX_TEXTURE_UNITS = 16;
+
+	// State changing methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void enable(uint32_t capability) noexcept;
+	void disable(uint32_t capability) noexcept;
+	void useProgram(uint32_t program) noexcept;
+	void bindFramebuffer(uint32_t fbo) noexcept;
+	void viewport(int32_t x, int32_t y, int32_t width, int32_t height) noexcept;
+	void viewport(vec2i dimensions) noexcept;
+	void viewport(vec2 dimensions) noexcept;
+	void viewport(const AABB2D& viewport) noexcept;
+
+	/** @brief Binds a GL_TEXTURE_2D texture to the specified texture unit (0 == GL_TEXTURE0). */
+	void bindTexture(uint32_t unit, uint32_t texture) noexcept;
+
+	// Invalidation & statistics
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Forgets all cached state, the next change of any kind will be issued. */
+	void invalidate() noexcept;
+
+	/** @brief Invalidates the cache and resets the statistics, call once per frame. */
+	void newFrame() noexcept;
+
+	void onProgramDeleted(uint32_t program) noexcept;
+	void onFramebufferDeleted(uint32_t fbo) noexcept;
+	void onTextureDeleted(uint32_t texture) noexcept;
+
+	inline const StateCacheStats& stats() const noexcept { return mStats; }
+	inline void resetStats() noexcept { mStats = StateCacheStats{}; }
+
+private:
+	// Private constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	StateCache(const StateCache&) = delete;
+	StateCache& operator= (const StateCache&) = delete;
+
+	StateCache() noexcept;
+
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void setCapability(uint32_t capability, bool enabled) noexcept;
+	void activeTexture(uint32_t unit) noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const uint32_t NUM_CAPABILITIES = 4;
+	static const uint32_t UNKNOWN = 0xFFFFFFFFu;
+
+	uint32_t mCapabilities[NUM_CAPABILITIES]; // 0 = disabled, 1 = enabled, UNKNOWN
+	uint32_t mProgram;
+	uint32_t mFramebuffer;
+	int32_t mViewport[4];
+	bool mViewportKnown;
+	uint32_t mActiveTextureUnit;
+	uint32_t mTextures[MAX_TEXTURE_UNITS];
+	StateCacheStats mStats;
+};
+
+} // namespace gl
+#endif
\ No newline at end of file
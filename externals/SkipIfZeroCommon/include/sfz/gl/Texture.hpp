@@ -2,6 +2,7 @@
 #ifndef SFZ_GL_TEXTURE_HPP
 #define SFZ_GL_TEXTURE_HPP
 
+#include <cstddef>
 #include <cstdint>
 
 #include "sfz/geometry/AABB2D.hpp"
@@ -10,6 +11,8 @@
 namespace gl {
 
 using sfz::AABB2D;
+using std::size_t;
+using std::uint8_t;
 using std::uint32_t;
 
 class Texture final {
@@ -20,6 +23,25 @@ public:
 	static Texture fromFile(const char* path, TextureFormat format = TextureFormat::RGBA,
 	                        TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16) noexcept;
 
+	/**
+	 * @brief Decodes an image file (e.g. a png) already in memory, such as a view of an AssetArchive
+	 * @param name only used in error messages and for the GpuMemoryTracker
+	 */
+	static Texture fromMemory(const uint8_t* data, size_t size, const char* name,
+	                          TextureFormat format = TextureFormat::RGBA,
+	                          TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16) noexcept;
+
+	/**
+	 * @brief Uploads a container baked by bakeTextureContainer(), one upload per mip level
+	 * Nothing is decoded or generated at runtime. Fails if the container is block compressed and
+	 * the driver doesn't support S3TC, the caller should then fall back to the source image.
+	 * @param name only used in error messages and for the GpuMemoryTracker
+	 * @param maxLevel the last mip level uploaded, the levels after it are never sampled
+	 */
+	static Texture fromContainer(const uint8_t* data, size_t size, const char* name,
+	                             TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16,
+	                             uint32_t maxLevel = ~0u) noexcept;
+
 	// Public methods
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	
@@ -44,6 +66,7 @@ public:
 private:
 	uint32_t mHandle = 0;
 	AABB2D mDim;
+	uint32_t mMemoryId = 0; // See GpuMemoryTracker
 };
 
 } // namespace gl
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef SFZ_GL_TEXTURE_CONTAINER_HPP
+#define SFZ_GL_TEXTURE_CONTAINER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sfz/gl/TextureEnums.hpp"
+
+namespace gl {
+
+using std::size_t;
+using std::string;
+using std::uint8_t;
+using std::uint32_t;
+using std::vector;
+
+// Texture containers
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// A texture container holds an image baked offline, ready to be uploaded with one call per mip
+// level: already flipped for OpenGL, with the full mip chain down to 1x1 and optionally block
+// compressed. Loaded with Texture::fromContainer().
+
+enum class TextureContainerFormat : uint32_t {
+	R8 = 1,
+	RG8 = 2,
+	RGB8 = 3,
+	RGBA8 = 4,
+	BC1_RGB = 5, // GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 8 bytes per 4x4 block
+	BC3_RGBA = 6 // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16 bytes per 4x4 block
+};
+
+/** @brief A mip level of a parsed container, points into the container's data */
+struct TextureContainerLevel final {
+	int width, height;
+	const uint8_t* data;
+	size_t size;
+};
+
+struct TextureContainerInfo final {
+	TextureContainerFormat format;
+	int width, height;
+	vector<TextureContainerLevel> levels; // Level 0 first
+};
+
+inline bool isCompressed(TextureContainerFormat format) noexcept
+{
+	return format == TextureContainerFormat::BC1_RGB || format == TextureContainerFormat::BC3_RGBA;
+}
+
+/** @brief The size of a single level in the specified format */
+size_t textureContainerLevelSize(TextureContainerFormat format, int width, int height) noexcept;
+
+/**
+ * @brief Parses and validates a container, the levels point into data
+ * @return false if the container is damaged, of an unknown version or format
+ */
+bool parseTextureContainer(const uint8_t* data, size_t size, TextureContainerInfo& infoOut) noexcept;
+
+/**
+ * @brief Bakes a container from raw pixels
+ * @param pixels the image with the first row at the top, i.e. as stored in an image file
+ * @param compress whether to block compress RGB and RGBA images, BC1 is used for images without
+ *                 (or with completely opaque) alpha and BC3 for the others. Gray images are never
+ *                 compressed.
+ */
+vector<uint8_t> bakeTextureContainer(const uint8_t* pixels, int width, int height, int numChannels,
+                                     bool compress) noexcept;
+
+/**
+ * @brief Decodes an image file (e.g. a png) and bakes a container from it
+ * @return an empty vector if the image couldn't be decoded
+ */
+vector<uint8_t> bakeTextureContainerFromImage(const uint8_t* data, size_t size, const char* name,
+                                              TextureFormat format, bool compress) noexcept;
+
+/** @brief The name the baked container of an image is stored as, "a/b.png" -> "a/b.sfztex" */
+string bakedTextureName(const string& imageName) noexcept;
+
+} // namespace gl
+#endif
\ No newline at end of file
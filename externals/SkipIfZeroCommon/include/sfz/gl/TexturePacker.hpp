@@ -5,8 +5,10 @@
 #include <sfz/gl/Texture.hpp>
 #include <sfz/gl/TextureEnums.hpp>
 #include <sfz/gl/TextureRegion.hpp>
+#include <sfz/util/AssetArchive.hpp>
 
 #include <cstddef> // size_t
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -16,8 +18,10 @@ namespace gl {
 using std::size_t;
 using std::vector;
 using std::string;
+using std::uint8_t;
 using std::uint32_t;
 using std::unordered_map;
+using sfz::AssetView;
 
 // TexturePacker
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -29,19 +33,40 @@ public:
 
 	TexturePacker() noexcept = delete;
 	TexturePacker(const TexturePacker&) noexcept = delete;
-	TexturePacker(TexturePacker&&) noexcept = delete;
 	TexturePacker& operator= (const TexturePacker&) noexcept = delete;
-	TexturePacker& operator= (TexturePacker&&) noexcept = delete;
+
+	TexturePacker(TexturePacker&& other) noexcept;
+	TexturePacker& operator= (TexturePacker&& other) noexcept;
 
 	TexturePacker(const string& dirPath, const vector<string>& filenames, int padding = 1,
 	              size_t suggestedWidth = 256, size_t suggestedHeight = 256,
 	              TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16) noexcept;
-	~TexturePacker() noexcept;
+
+	/**
+	 * @brief Packs images files already in memory, e.g. views of an AssetArchive
+	 * @param name only used in error messages and for the GpuMemoryTracker
+	 * @param files the contents of the image files, in the same order as the filenames
+	 * @param padding empty texels around each image, also limits the mip levels used, see
+	 *                atlasMaxMipLevel()
+	 */
+	TexturePacker(const string& name, const vector<string>& filenames, const vector<AssetView>& files,
+	              int padding = 1, size_t suggestedWidth = 256, size_t suggestedHeight = 256,
+	              TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16) noexcept;
+
+	/**
+	 * @brief Loads an atlas packed at build time by bakeTextureAtlas(), no packing is done
+	 * isValid() returns false if the atlas is damaged or its texture can't be used by the driver,
+	 * in which case the caller should pack the images instead.
+	 * @param name only used in error messages and for the GpuMemoryTracker
+	 */
+	TexturePacker(const AssetView& bakedAtlas, const string& name,
+	              TextureFiltering filtering = TextureFiltering::ANISOTROPIC_16) noexcept;
 
 	// Public methods
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	inline uint32_t texture() const noexcept { return mTexture; }
+	inline bool isValid() const noexcept { return mTexture.isValid(); }
+	inline uint32_t texture() const noexcept { return mTexture.handle(); }
 	inline size_t textureWidth() const noexcept { return mWidth; }
 	inline size_t textureHeight() const noexcept { return mHeight; }
 	inline const vector<string>& filenames() const noexcept { return mFilenames; }
@@ -51,11 +76,51 @@ private:
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	uint32_t mTexture;
-	size_t mWidth, mHeight;
+	Texture mTexture;
+	size_t mWidth = 0, mHeight = 0;
 	vector<string> mFilenames;
 	unordered_map<string, TextureRegion> mTextureRegionMap;
 };
 
+// Baked atlases
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** @brief A parsed baked atlas, the container points into the atlas' data */
+struct TextureAtlasInfo final {
+	int padding;
+	int width, height;
+	vector<string> filenames;
+	unordered_map<string, TextureRegion> regions;
+	const uint8_t* container;
+	size_t containerSize;
+};
+
+/**
+ * @brief The last mip level that doesn't bleed between the images of an atlas, log2(padding)
+ * The padding is halved at each level, so at level log2(padding) there is a single texel left
+ * between the images. Atlases are only uploaded down to this level (GL_TEXTURE_MAX_LEVEL).
+ */
+uint32_t atlasMaxMipLevel(int padding) noexcept;
+
+/**
+ * @brief Parses and validates a baked atlas, including the texture container after the regions
+ * @return false if the atlas is damaged or of an unknown version
+ */
+bool parseTextureAtlas(const uint8_t* data, size_t size, TextureAtlasInfo& infoOut) noexcept;
+
+/**
+ * @brief Packs the images like TexturePacker and returns the result as a baked atlas
+ * A baked atlas is the region table followed by the atlas image as a texture container (see
+ * TextureContainer.hpp), so it can be loaded in one read with a single upload per mip level.
+ * @param compress whether to block compress the atlas image, see bakeTextureContainer()
+ * @return an empty vector if any of the images couldn't be decoded
+ */
+vector<uint8_t> bakeTextureAtlas(const vector<string>& filenames, const vector<AssetView>& files,
+                                 int padding = 1, size_t suggestedWidth = 256, size_t suggestedHeight = 256,
+                                 bool compress = false) noexcept;
+
+/** @brief The name the baked atlas of a directory is stored as, "a/b/" -> "a/b.sfzatlas" */
+string bakedAtlasName(const string& dirPath) noexcept;
+
 } // namespace sfz
 #endif
\ No newline at end of file
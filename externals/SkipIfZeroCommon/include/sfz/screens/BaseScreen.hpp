@@ -12,6 +12,8 @@
 #include "sfz/sdl/Window.hpp"
 #include "sfz/math/Vector.hpp"
 
+namespace gl { class FramePacer; }
+
 namespace sfz {
 
 using std::int32_t;
@@ -66,6 +68,7 @@ struct UpdateState final {
 	unordered_map<int32_t, sdl::GameControllerState> controllersLastFrameState;
 	sdl::Mouse rawMouse;
 	float delta;
+	const gl::FramePacer* framePacer = nullptr; // Owned by the game loop, never null inside it
 };
 
 // BaseScreen
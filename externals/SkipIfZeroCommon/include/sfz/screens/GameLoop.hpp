@@ -2,6 +2,7 @@
 #ifndef SFZ_SCREENS_GAME_LOOP_HPP
 #define SFZ_SCREENS_GAME_LOOP_HPP
 
+#include <cstdint>
 #include <memory>
 
 #include "sfz/screens/BaseScreen.hpp"
@@ -10,8 +11,15 @@
 namespace sfz {
 
 using std::shared_ptr;
+using std::uint32_t;
 
-void runGameLoop(sdl::Window& window, shared_ptr<BaseScreen> initialScreen);
+/**
+ * @brief Runs the game loop until a screen requests to quit
+ * At most maxFramesInFlight (clamped to [1, 3]) frames are allowed to be queued up on the GPU,
+ * see gl::FramePacer. Requires a current OpenGL context.
+ */
+void runGameLoop(sdl::Window& window, shared_ptr<BaseScreen> initialScreen,
+                 uint32_t maxFramesInFlight = 2);
 
 } // namesapce sfz
 
@@ -0,0 +1,104 @@
+#pragma once
+#ifndef SFZ_UTIL_ASSET_ARCHIVE_HPP
+#define SFZ_UTIL_ASSET_ARCHIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sfz/util/MappedFile.hpp"
+
+namespace sfz {
+
+using std::size_t;
+using std::string;
+using std::uint8_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+// AssetView struct
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** @brief A read-only view of the contents of a single asset, data is nullptr if it wasn't found */
+struct AssetView final {
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+
+	inline bool isValid() const noexcept { return data != nullptr; }
+	inline const char* str() const noexcept { return reinterpret_cast<const char*>(data); }
+};
+
+// AssetArchive class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief A memory mapped archive containing many assets, written by writeAssetArchive()
+ *
+ * Opening a single archive avoids the cost of opening and seeking in every asset file separately,
+ * which dominates loading time on slow disks and network drives. The index is sorted by the hash
+ * of the asset names, so lookups are a binary search without any allocations. The returned views
+ * point straight into the mapping and stay valid until the archive is destroyed.
+ *
+ * Asset names are paths relative to the directory the archive was packed from, using '/' as
+ * separator, e.g. "shaders/gbuffer_gen.vert".
+ */
+class AssetArchive final {
+public:
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	AssetArchive(const AssetArchive&) = delete;
+	AssetArchive& operator= (const AssetArchive&) = delete;
+
+	AssetArchive() noexcept = default;
+	AssetArchive(AssetArchive&& other) noexcept;
+	AssetArchive& operator= (AssetArchive&& other) noexcept;
+
+	/** @brief Opens the archive, isValid() returns false if it's missing or damaged */
+	explicit AssetArchive(const char* path) noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	inline bool isValid() const noexcept { return mFile.isValid(); }
+	inline uint32_t numEntries() const noexcept { return mNumEntries; }
+
+	/** @brief Returns the asset with the specified name, or an invalid view if there is none */
+	AssetView find(const char* name) const noexcept;
+
+	/** @brief Returns the name of the i:th entry in the index (which is sorted by hash) */
+	const char* entryName(uint32_t index) const noexcept;
+
+private:
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	MappedFile mFile;
+	uint32_t mNumEntries = 0;
+};
+
+// Asset archive functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** @brief The hash the archive index is sorted by (64-bit FNV-1a of the name) */
+uint64_t assetNameHash(const char* name) noexcept;
+
+/**
+ * @brief Packs the specified files into an archive which can be opened by AssetArchive
+ * @param rootPath the directory the names are relative to, including a trailing separator
+ * @param names the files to pack, '\' is converted to '/' in the stored names
+ * @return whether successful or not, the archive is not created if any file couldn't be read
+ */
+bool writeAssetArchive(const char* archivePath, const char* rootPath, const vector<string>& names) noexcept;
+
+/**
+ * @brief Packs assets already in memory, e.g. ones converted by the packer
+ * @param contents the contents of the asset with the same index in names
+ */
+bool writeAssetArchive(const char* archivePath, const vector<string>& names,
+                       const vector<AssetView>& contents) noexcept;
+
+} // namespace sfz
+#endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef SFZ_UTIL_BYTE_IO_HPP
+#define SFZ_UTIL_BYTE_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sfz {
+
+using std::size_t;
+using std::uint8_t;
+using std::uint16_t;
+using std::uint32_t;
+using std::uint64_t;
+
+// Little-endian reading and writing
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Binary files written by sfz (asset archives, texture containers, atlases and so on) are always
+// little-endian regardless of platform. The pointers don't need to be aligned.
+
+inline uint16_t readU16(const uint8_t* ptr) noexcept;
+inline uint32_t readU32(const uint8_t* ptr) noexcept;
+inline uint64_t readU64(const uint8_t* ptr) noexcept;
+inline float readF32(const uint8_t* ptr) noexcept;
+
+inline void writeU16(uint8_t* ptr, uint16_t value) noexcept;
+inline void writeU32(uint8_t* ptr, uint32_t value) noexcept;
+inline void writeU64(uint8_t* ptr, uint64_t value) noexcept;
+inline void writeF32(uint8_t* ptr, float value) noexcept;
+
+// Hashing
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** @brief 32-bit FNV-1a, only meant for checksums and hash tables, not for security */
+inline uint32_t fnv1a32(const uint8_t* data, size_t numBytes) noexcept;
+
+/** @brief 64-bit FNV-1a, only meant for checksums and hash tables, not for security */
+inline uint64_t fnv1a64(const uint8_t* data, size_t numBytes) noexcept;
+
+} // namespace sfz
+
+#include "sfz/util/ByteIO.inl"
+#endif
@@ -0,0 +1,79 @@
+#include <cstring>
+
+namespace sfz {
+
+// Little-endian reading and writing
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+inline uint16_t readU16(const uint8_t* ptr) noexcept
+{
+	return uint16_t(ptr[0] | (ptr[1] << 8));
+}
+
+inline uint32_t readU32(const uint8_t* ptr) noexcept
+{
+	return uint32_t(ptr[0]) | (uint32_t(ptr[1]) << 8) | (uint32_t(ptr[2]) << 16)
+	     | (uint32_t(ptr[3]) << 24);
+}
+
+inline uint64_t readU64(const uint8_t* ptr) noexcept
+{
+	return uint64_t(readU32(ptr)) | (uint64_t(readU32(ptr + 4)) << 32);
+}
+
+inline float readF32(const uint8_t* ptr) noexcept
+{
+	const uint32_t bits = readU32(ptr);
+	float value;
+	std::memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+inline void writeU16(uint8_t* ptr, uint16_t value) noexcept
+{
+	ptr[0] = uint8_t(value);
+	ptr[1] = uint8_t(value >> 8);
+}
+
+inline void writeU32(uint8_t* ptr, uint32_t value) noexcept
+{
+	for (int i = 0; i < 4; ++i) ptr[i] = uint8_t(value >> (8 * i));
+}
+
+inline void writeU64(uint8_t* ptr, uint64_t value) noexcept
+{
+	writeU32(ptr, uint32_t(value));
+	writeU32(ptr + 4, uint32_t(value >> 32));
+}
+
+inline void writeF32(uint8_t* ptr, float value) noexcept
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(float));
+	writeU32(ptr, bits);
+}
+
+// Hashing
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+inline uint32_t fnv1a32(const uint8_t* data, size_t numBytes) noexcept
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < numBytes; ++i) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+inline uint64_t fnv1a64(const uint8_t* data, size_t numBytes) noexcept
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < numBytes; ++i) {
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+} // namespace sfz
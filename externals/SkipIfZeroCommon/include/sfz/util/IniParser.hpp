@@ -4,19 +4,26 @@
 
 #include <cstdint>
 #include <limits>
-#include <map>
 #include <string>
+#include <vector>
 
 namespace sfz {
 
 using std::int32_t;
 using std::numeric_limits;
 using std::string;
-using std::map;
+using std::uint32_t;
+using std::vector;
 
 // IniParser class
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
+/**
+ * @brief Reads and writes ini files
+ * The whole file is kept as a single string, items only store offsets into it. Nothing is
+ * allocated per item when loading or looking up values, and changed values are appended to the
+ * end of the text. Items keep the order they had in the file, new items are added after them.
+ */
 class IniParser final {
 public:
 
@@ -34,61 +41,97 @@ public:
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 	bool load() noexcept;
+
+	/** @brief Writes the file, does nothing (and returns true) if no item changed since load() */
 	bool save() noexcept;
 
+	/** @brief Returns whether any item was added or changed since the file was loaded or saved */
+	inline bool isDirty() const noexcept { return mDirty; }
+
 	// Info about a specific item
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	bool itemExists(const string& section, const string& key) const noexcept;
-	bool itemIsBool(const string& section, const string& key) const noexcept;
-	bool itemIsInt(const string& section, const string& key) const noexcept;
-	bool itemIsFloat(const string& section, const string& key) const noexcept;
+	bool itemExists(const char* section, const char* key) const noexcept;
+	bool itemIsBool(const char* section, const char* key) const noexcept;
+	bool itemIsInt(const char* section, const char* key) const noexcept;
+	bool itemIsFloat(const char* section, const char* key) const noexcept;
 
 	// Getters
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	string getString(const string& section, const string& key,
+	string getString(const char* section, const char* key,
 	                 const string& defaultValue = "") const noexcept;
 
-	bool getBool(const string& section, const string& key,
+	bool getBool(const char* section, const char* key,
 	             bool defaultValue = false) const noexcept;
 
-	int32_t getInt(const string& section, const string& key,
+	int32_t getInt(const char* section, const char* key,
 	               int32_t defaultValue = 0) const noexcept;
 
-	float getFloat(const string& section, const string& key,
+	float getFloat(const char* section, const char* key,
 	               float defaultValue = 0.0f) const noexcept;
 
 	// Setters
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	void setString(const string& section, const string& key, const string& value) noexcept;
-	void setBool(const string& section, const string& key, bool value) noexcept;
-	void setInt(const string& section, const string& key, int32_t value) noexcept;
-	void setFloat(const string& section, const string& key, float value) noexcept;
+	// Setting an item to the value it already has doesn't mark the parser as dirty
+	void setString(const char* section, const char* key, const char* value) noexcept;
+	void setBool(const char* section, const char* key, bool value) noexcept;
+	void setInt(const char* section, const char* key, int32_t value) noexcept;
+	void setFloat(const char* section, const char* key, float value) noexcept;
 
 	// Sanitizers
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	string sanitizeString(const string& section, const string& key,
+	string sanitizeString(const char* section, const char* key,
 	                      const string& defaultValue = "") noexcept;
 
-	bool sanitizeBool(const string& section, const string& key,
+	bool sanitizeBool(const char* section, const char* key,
 	                  bool defaultValue = false) noexcept;
 
-	int32_t sanitizeInt(const string& section, const string& key,
+	int32_t sanitizeInt(const char* section, const char* key,
 	                    int32_t defaultValue = 0,
 	                    int32_t minValue = numeric_limits<int32_t>::min(),
 	                    int32_t maxValue = numeric_limits<int32_t>::max()) noexcept;
 
-	float sanitizeFloat(const string& section, const string& key,
+	float sanitizeFloat(const char* section, const char* key,
 	                    float defaultValue = 0.0f,
 	                    float minValue = numeric_limits<float>::min(),
 	                    float maxValue = numeric_limits<float>::max()) noexcept;
 
 private:
+	// Private types
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** A substring of mText */
+	struct Range final {
+		uint32_t begin, length;
+	};
+
+	struct Item final {
+		Range section, key, value;
+	};
+
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	Item* findItem(const char* section, const char* key) noexcept;
+	const Item* findItem(const char* section, const char* key) const noexcept;
+	bool equals(Range range, const char* str) const noexcept;
+	bool equals(Range lhs, Range rhs) const noexcept;
+	Range appendText(const char* str) noexcept;
+
+	bool parseBool(Range range, bool& valueOut) const noexcept;
+	bool parseInt(Range range, int32_t& valueOut) const noexcept;
+	bool parseFloat(Range range, float& valueOut) const noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
 	string mPath;
-	map<string,map<string,string>> mIniTree;
+	string mText;
+	vector<Item> mItems;
+	bool mDirty = false;
 };
 
 } // namespace sfz
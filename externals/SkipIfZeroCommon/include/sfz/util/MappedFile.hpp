@@ -0,0 +1,61 @@
+#pragma once
+#ifndef SFZ_UTIL_MAPPED_FILE_HPP
+#define SFZ_UTIL_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sfz {
+
+using std::size_t;
+using std::uint8_t;
+
+// MappedFile class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief A read-only view of an entire file, memory mapped if the platform supports it
+ * Nothing is copied when mapping succeeds, pages are read in by the OS as they are accessed. If the
+ * file can't be mapped it is read into an owned buffer instead. The contents are not null
+ * terminated. The file must not be truncated or rewritten while it is mapped.
+ */
+class MappedFile final {
+public:
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator= (const MappedFile&) = delete;
+
+	MappedFile() noexcept = default;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator= (MappedFile&& other) noexcept;
+	~MappedFile() noexcept;
+
+	/** @brief Maps the file at the specified path, isValid() returns false if it couldn't be opened */
+	explicit MappedFile(const char* path) noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Unmaps the file, called automatically by the destructor */
+	void destroy() noexcept;
+
+	inline bool isValid() const noexcept { return mValid; }
+	inline bool isMemoryMapped() const noexcept { return mMapped; }
+	inline const uint8_t* data() const noexcept { return mData; }
+	inline const char* str() const noexcept { return reinterpret_cast<const char*>(mData); }
+	inline size_t size() const noexcept { return mSize; }
+
+private:
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	const uint8_t* mData = nullptr;
+	size_t mSize = 0;
+	bool mValid = false;
+	bool mMapped = false; // Otherwise mData was allocated with new[], or is nullptr for empty files
+};
+
+} // namespace sfz
+#endif
\ No newline at end of file
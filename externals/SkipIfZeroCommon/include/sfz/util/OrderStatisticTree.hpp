@@ -0,0 +1,94 @@
+#pragma once
+#ifndef SFZ_UTIL_ORDER_STATISTIC_TREE_HPP
+#define SFZ_UTIL_ORDER_STATISTIC_TREE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sfz {
+
+using std::size_t;
+using std::uint32_t;
+
+/**
+ * @brief A sorted multiset which can answer rank queries in O(log n)
+ * Implemented as a treap stored in a single vector, so inserting never allocates unless the
+ * vector needs to grow. Elements comparing equal are kept in insertion order. Removing elements
+ * is not supported.
+ */
+template<typename T, typename Compare = std::less<T>>
+class OrderStatisticTree final {
+public:
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	OrderStatisticTree() noexcept = default;
+	OrderStatisticTree(const OrderStatisticTree&) = default;
+	OrderStatisticTree& operator= (const OrderStatisticTree&) = default;
+	OrderStatisticTree(OrderStatisticTree&&) noexcept = default;
+	OrderStatisticTree& operator= (OrderStatisticTree&&) noexcept = default;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Inserts an element after all elements comparing equal to it, O(log n) */
+	void insert(const T& value) noexcept;
+
+	/**
+	 * @brief Replaces the contents with the specified (already sorted) values in O(n)
+	 * Much faster than inserting the elements one by one when building a large tree from scratch.
+	 */
+	void assignSorted(const T* values, size_t count) noexcept;
+
+	/** @brief Returns the number of elements ordered strictly before value, O(log n) */
+	size_t countLess(const T& value) const noexcept;
+
+	/** @brief Returns the element at the specified position in sorted order, O(log n) */
+	const T& at(size_t index) const noexcept;
+
+	void reserve(size_t capacity) noexcept { mNodes.reserve(capacity); }
+	void clear() noexcept;
+	inline size_t size() const noexcept { return mNodes.size(); }
+	inline bool empty() const noexcept { return mNodes.empty(); }
+
+private:
+	// Private constants & types
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const uint32_t NIL = ~uint32_t(0);
+
+	struct Node final {
+		T value;
+		uint32_t left, right;
+		uint32_t size; // Number of nodes in the subtree rooted at this node
+		uint32_t priority; // Max heap ordered, randomized to keep the tree balanced
+	};
+
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	uint32_t nextPriority() noexcept;
+	inline uint32_t sizeOf(uint32_t node) const noexcept { return node == NIL ? 0 : mNodes[node].size; }
+	inline void updateSize(uint32_t node) noexcept;
+
+	/** Splits the subtree into one with all elements ordered before or equal to value and the rest */
+	void split(uint32_t node, const T& value, uint32_t& lowerOut, uint32_t& upperOut) noexcept;
+
+	/** Joins two subtrees, all elements in lower must be ordered before or equal to those in upper */
+	uint32_t merge(uint32_t lower, uint32_t upper) noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	std::vector<Node> mNodes;
+	uint32_t mRoot = NIL;
+	uint32_t mRngState = 0x9E3779B9u;
+	Compare mCompare;
+};
+
+} // namespace sfz
+
+#include "sfz/util/OrderStatisticTree.inl"
+#endif
\ No newline at end of file
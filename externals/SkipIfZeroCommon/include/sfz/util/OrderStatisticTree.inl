@@ -0,0 +1,147 @@
+namespace sfz {
+
+// OrderStatisticTree: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+template<typename T, typename Compare>
+void OrderStatisticTree<T,Compare>::insert(const T& value) noexcept
+{
+	const uint32_t newNode = (uint32_t)mNodes.size();
+	mNodes.push_back(Node{value, NIL, NIL, 1, nextPriority()});
+
+	uint32_t lower, upper;
+	split(mRoot, value, lower, upper);
+	mRoot = merge(merge(lower, newNode), upper);
+}
+
+template<typename T, typename Compare>
+void OrderStatisticTree<T,Compare>::assignSorted(const T* values, size_t count) noexcept
+{
+	clear();
+	mNodes.reserve(count);
+
+	// Builds the treap left to right, the stack holds its current right spine. Nodes popped off
+	// the spine will never get new children, so their sizes are final and can be computed then.
+	std::vector<uint32_t> spine;
+	for (size_t i = 0; i < count; ++i) {
+		const uint32_t node = (uint32_t)i;
+		mNodes.push_back(Node{values[i], NIL, NIL, 1, nextPriority()});
+
+		uint32_t lastPopped = NIL;
+		while (!spine.empty() && mNodes[spine.back()].priority < mNodes[node].priority) {
+			lastPopped = spine.back();
+			spine.pop_back();
+			updateSize(lastPopped);
+		}
+		mNodes[node].left = lastPopped;
+		if (!spine.empty()) mNodes[spine.back()].right = node;
+		spine.push_back(node);
+	}
+	mRoot = spine.empty() ? NIL : spine.front();
+	while (!spine.empty()) {
+		updateSize(spine.back());
+		spine.pop_back();
+	}
+}
+
+template<typename T, typename Compare>
+size_t OrderStatisticTree<T,Compare>::countLess(const T& value) const noexcept
+{
+	size_t count = 0;
+	uint32_t node = mRoot;
+	while (node != NIL) {
+		const Node& n = mNodes[node];
+		if (mCompare(n.value, value)) {
+			count += sizeOf(n.left) + 1;
+			node = n.right;
+		} else {
+			node = n.left;
+		}
+	}
+	return count;
+}
+
+template<typename T, typename Compare>
+const T& OrderStatisticTree<T,Compare>::at(size_t index) const noexcept
+{
+	uint32_t node = mRoot;
+	while (true) {
+		const Node& n = mNodes[node];
+		const size_t leftSize = sizeOf(n.left);
+		if (index < leftSize) {
+			node = n.left;
+		} else if (index == leftSize) {
+			return n.value;
+		} else {
+			index -= (leftSize + 1);
+			node = n.right;
+		}
+	}
+}
+
+template<typename T, typename Compare>
+void OrderStatisticTree<T,Compare>::clear() noexcept
+{
+	mNodes.clear();
+	mRoot = NIL;
+}
+
+// OrderStatisticTree: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+template<typename T, typename Compare>
+uint32_t OrderStatisticTree<T,Compare>::nextPriority() noexcept
+{
+	// xorshift32
+	mRngState ^= mRngState << 13;
+	mRngState ^= mRngState >> 17;
+	mRngState ^= mRngState << 5;
+	return mRngState;
+}
+
+template<typename T, typename Compare>
+void OrderStatisticTree<T,Compare>::updateSize(uint32_t node) noexcept
+{
+	Node& n = mNodes[node];
+	n.size = sizeOf(n.left) + sizeOf(n.right) + 1;
+}
+
+template<typename T, typename Compare>
+void OrderStatisticTree<T,Compare>::split(uint32_t node, const T& value,
+                                          uint32_t& lowerOut, uint32_t& upperOut) noexcept
+{
+	if (node == NIL) {
+		lowerOut = NIL;
+		upperOut = NIL;
+		return;
+	}
+
+	Node& n = mNodes[node];
+	if (mCompare(value, n.value)) {
+		split(n.left, value, lowerOut, mNodes[node].left);
+		upperOut = node;
+	} else {
+		split(n.right, value, mNodes[node].right, upperOut);
+		lowerOut = node;
+	}
+	updateSize(node);
+}
+
+template<typename T, typename Compare>
+uint32_t OrderStatisticTree<T,Compare>::merge(uint32_t lower, uint32_t upper) noexcept
+{
+	if (lower == NIL) return upper;
+	if (upper == NIL) return lower;
+
+	if (mNodes[lower].priority > mNodes[upper].priority) {
+		mNodes[lower].right = merge(mNodes[lower].right, upper);
+		updateSize(lower);
+		return lower;
+	} else {
+		mNodes[upper].left = merge(lower, mNodes[upper].left);
+		updateSize(upper);
+		return upper;
+	}
+}
+
+} // namespace sfz
\ No newline at end of file
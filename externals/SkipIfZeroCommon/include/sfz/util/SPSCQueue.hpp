@@ -0,0 +1,56 @@
+#pragma once
+#ifndef SFZ_UTIL_SPSC_QUEUE_HPP
+#define SFZ_UTIL_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace sfz {
+
+using std::size_t;
+
+/**
+ * @brief A fixed size lock-free single producer single consumer queue
+ * Exactly one thread may call tryPush() and exactly one (other) thread may call tryPop(), the
+ * queue does not block and never allocates memory. Holds at most CAPACITY - 1 elements.
+ */
+template<typename T, size_t CAPACITY>
+class SPSCQueue final {
+public:
+	static_assert(CAPACITY >= 2, "SPSCQueue needs a capacity of at least 2");
+
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	SPSCQueue(const SPSCQueue&) = delete;
+	SPSCQueue& operator= (const SPSCQueue&) = delete;
+
+	SPSCQueue() noexcept = default;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Called by the producer, returns false (and does nothing) if the queue is full */
+	inline bool tryPush(const T& element) noexcept;
+
+	/** @brief Called by the consumer, returns false (and does nothing) if the queue is empty */
+	inline bool tryPop(T& elementOut) noexcept;
+
+	/** @brief Approximate number of elements, exact if neither thread is modifying the queue */
+	inline size_t size() const noexcept;
+	inline bool empty() const noexcept { return size() == 0; }
+	inline size_t capacity() const noexcept { return CAPACITY - 1; }
+
+private:
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	T mElements[CAPACITY];
+	std::atomic<size_t> mHead{0}; // Next index to pop, only written by consumer
+	std::atomic<size_t> mTail{0}; // Next index to push, only written by producer
+};
+
+} // namespace sfz
+
+#include "sfz/util/SPSCQueue.inl"
+#endif
\ No newline at end of file
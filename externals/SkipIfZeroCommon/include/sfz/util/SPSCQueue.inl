@@ -0,0 +1,37 @@
+namespace sfz {
+
+// SPSCQueue: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+template<typename T, size_t CAPACITY>
+inline bool SPSCQueue<T,CAPACITY>::tryPush(const T& element) noexcept
+{
+	const size_t tail = mTail.load(std::memory_order_relaxed);
+	const size_t nextTail = (tail + 1) % CAPACITY;
+	if (nextTail == mHead.load(std::memory_order_acquire)) return false;
+
+	mElements[tail] = element;
+	mTail.store(nextTail, std::memory_order_release);
+	return true;
+}
+
+template<typename T, size_t CAPACITY>
+inline bool SPSCQueue<T,CAPACITY>::tryPop(T& elementOut) noexcept
+{
+	const size_t head = mHead.load(std::memory_order_relaxed);
+	if (head == mTail.load(std::memory_order_acquire)) return false;
+
+	elementOut = mElements[head];
+	mHead.store((head + 1) % CAPACITY, std::memory_order_release);
+	return true;
+}
+
+template<typename T, size_t CAPACITY>
+inline size_t SPSCQueue<T,CAPACITY>::size() const noexcept
+{
+	const size_t head = mHead.load(std::memory_order_acquire);
+	const size_t tail = mTail.load(std::memory_order_acquire);
+	return (tail + CAPACITY - head) % CAPACITY;
+}
+
+} // namespace sfz
\ No newline at end of file
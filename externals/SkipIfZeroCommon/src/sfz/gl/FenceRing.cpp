@@ -0,0 +1,90 @@
+#include "sfz/gl/FenceRing.hpp"
+
+#include <algorithm> // std::swap
+
+#include "sfz/Assert.hpp"
+#include "sfz/gl/OpenGL.hpp"
+
+namespace gl {
+
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static const GLuint64 WAIT_TIMEOUT_NS = 100000000; // 100ms, waiting is retried until signaled
+
+// FenceRing: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+FenceRing::FenceRing(uint32_t capacity) noexcept
+:
+	mFences(capacity, nullptr)
+{
+	sfz_assert_debug(capacity > 0);
+}
+
+FenceRing::FenceRing(FenceRing&& other) noexcept
+{
+	std::swap(this->mFences, other.mFences);
+	std::swap(this->mOldest, other.mOldest);
+	std::swap(this->mSize, other.mSize);
+}
+
+FenceRing& FenceRing::operator= (FenceRing&& other) noexcept
+{
+	std::swap(this->mFences, other.mFences);
+	std::swap(this->mOldest, other.mOldest);
+	std::swap(this->mSize, other.mSize);
+	return *this;
+}
+
+FenceRing::~FenceRing() noexcept
+{
+	for (uint32_t i = 0; i < mSize; ++i) {
+		glDeleteSync(static_cast<GLsync>(mFences[(mOldest + i) % capacity()]));
+	}
+}
+
+// FenceRing: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+uint32_t FenceRing::insert() noexcept
+{
+	sfz_assert_debug(!isFull());
+	const uint32_t slot = nextSlot();
+	mFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	mSize += 1;
+	return slot;
+}
+
+bool FenceRing::retireOldest() noexcept
+{
+	if (mSize == 0) return true;
+	GLsync fence = static_cast<GLsync>(mFences[mOldest]);
+
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NS);
+	while (result == GL_TIMEOUT_EXPIRED) {
+		result = glClientWaitSync(fence, 0, WAIT_TIMEOUT_NS);
+	}
+
+	glDeleteSync(fence);
+	mFences[mOldest] = nullptr;
+	mOldest = (mOldest + 1) % capacity();
+	mSize -= 1;
+	return result != GL_WAIT_FAILED;
+}
+
+bool FenceRing::isOldestSignaled() const noexcept
+{
+	if (mSize == 0) return false;
+	GLsync fence = static_cast<GLsync>(mFences[mOldest]);
+	return glClientWaitSync(fence, 0, 0) != GL_TIMEOUT_EXPIRED;
+}
+
+void FenceRing::retireSignaled() noexcept
+{
+	while (isOldestSignaled()) {
+		retireOldest();
+	}
+}
+
+} // namespace gl
@@ -10,19 +10,39 @@
 
 #include "sfz/gl/OpenGL.hpp"
 #include "sfz/gl/GLUtils.hpp"
+#include "sfz/gl/GpuMemoryTracker.hpp"
+#include "sfz/gl/StateCache.hpp"
 
+#include "sfz/util/ByteIO.hpp"
 #include "sfz/util/IO.hpp"
+#include "sfz/util/MappedFile.hpp"
 
 #include <cstdio>
 #include <cstdlib> // malloc
 #include <cstring> // std::memcpy
 #include <iostream> // std::cerr
 #include <exception> // std::terminate
+#include <iterator> // std::prev
 #include <new> // std::nothrow
+#include <string>
 #include <vector>
 
 namespace gl {
 
+using std::uint16_t;
+using std::uint64_t;
+using std::vector;
+
+using sfz::fnv1a64;
+using sfz::readF32;
+using sfz::readU16;
+using sfz::readU32;
+using sfz::readU64;
+using sfz::writeF32;
+using sfz::writeU16;
+using sfz::writeU32;
+using sfz::writeU64;
+
 // Static functions
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -119,82 +139,127 @@ static void calculateCharInfo(CharInfo& info, void* chardata, vec2 pixelToUV, ui
 	pos[0] += c.xadvance * scale;
 }
 
-// FontRenderer: Constructors & destructors
+// Anonymous: Atlas cache
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-FontRenderer::FontRenderer(const char* fontPath, uint32_t texWidth, uint32_t texHeight,
-	                       float fontSize, size_t numCharsPerBatch, TextureFiltering filtering) noexcept
-:
-	mFontSize{fontSize},
-	mPackedChars{new (std::nothrow) stbtt_packedchar[CHAR_COUNT]},
-	mSpriteBatch{numCharsPerBatch, FONT_RENDERER_FRAGMENT_SHADER_SRC}
-{
-	// This should be const, but MSVC12 doesn't support ini lists in constructor's ini list
-	mPixelToUV = vec2{1.0f/static_cast<float>(texWidth), 1.0f/static_cast<float>(texHeight)};
-
-	uint8_t* tempBitmap = new uint8_t[texWidth*texHeight];
-
-	stbtt_pack_context packContext;
-	if(stbtt_PackBegin(&packContext, tempBitmap, texWidth, texHeight, 0, 1, NULL) == 0) {
-		std::cerr << "FontRenderer: Couldn't stbtt_PackBegin()" << std::endl;
-		std::terminate();
-	}
+// Layout, all integers little endian:
+// Header: 8 byte magic, u32 version, u64 font hash, u32 font size (float bits), u32 first char,
+//         u32 char count, u32 oversampling, u32 atlas width, u32 atlas height, u32 reserved
+// Chars: u16 x0, y0, x1, y1, f32 xoff, yoff, xadvance, xoff2, yoff2 for each char
+// Atlas: width * height bytes, one channel
+static const char ATLAS_CACHE_MAGIC[8] = {'S', 'F', 'Z', 'F', 'O', 'N', 'T', '\0'};
+static const uint32_t ATLAS_CACHE_VERSION = 1;
+static const size_t ATLAS_CACHE_HEADER_SIZE = 48;
+static const size_t ATLAS_CACHE_CHAR_SIZE = 28;
+static const uint32_t OVERSAMPLING = 2;
+
+struct AtlasCacheKey final {
+	uint64_t fontHash;
+	float fontSize;
+	uint32_t firstChar, charCount;
+	uint32_t width, height;
+};
 
-	stbtt_PackSetOversampling(&packContext, 2, 2);
+static size_t atlasCacheSize(const AtlasCacheKey& key) noexcept
+{
+	return ATLAS_CACHE_HEADER_SIZE + key.charCount * ATLAS_CACHE_CHAR_SIZE + size_t(key.width) * key.height;
+}
 
-	std::vector<uint8_t> ttfBuffer = sfz::readBinaryFile(fontPath);
-	if (ttfBuffer.size() == 0) {
-		std::cerr << "Couldn't open TTF file at: " << fontPath << std::endl;
-		std::terminate();
+/** Returns a pointer to the cached atlas and reads the chars, or nullptr if the cache is stale. */
+static const uint8_t* readAtlasCache(const sfz::MappedFile& file, const AtlasCacheKey& key,
+                                     stbtt_packedchar* charsOut) noexcept
+{
+	const uint8_t* data = file.data();
+	if (!file.isValid() || file.size() != atlasCacheSize(key)) return nullptr;
+	if (std::memcmp(data, ATLAS_CACHE_MAGIC, sizeof(ATLAS_CACHE_MAGIC)) != 0) return nullptr;
+	if (readU32(data + 8) != ATLAS_CACHE_VERSION) return nullptr;
+	const uint64_t fontHash = readU64(data + 12);
+	if (fontHash != key.fontHash) return nullptr;
+	if (readF32(data + 20) != key.fontSize) return nullptr;
+	if (readU32(data + 24) != key.firstChar || readU32(data + 28) != key.charCount) return nullptr;
+	if (readU32(data + 32) != OVERSAMPLING) return nullptr;
+	if (readU32(data + 36) != key.width || readU32(data + 40) != key.height) return nullptr;
+
+	const uint8_t* ptr = data + ATLAS_CACHE_HEADER_SIZE;
+	for (uint32_t i = 0; i < key.charCount; ++i, ptr += ATLAS_CACHE_CHAR_SIZE) {
+		stbtt_packedchar& c = charsOut[i];
+		c.x0 = readU16(ptr);
+		c.y0 = readU16(ptr + 2);
+		c.x1 = readU16(ptr + 4);
+		c.y1 = readU16(ptr + 6);
+		c.xoff = readF32(ptr + 8);
+		c.yoff = readF32(ptr + 12);
+		c.xadvance = readF32(ptr + 16);
+		c.xoff2 = readF32(ptr + 20);
+		c.yoff2 = readF32(ptr + 24);
 	}
+	return ptr;
+}
 
-	if (stbtt_PackFontRange(&packContext, ttfBuffer.data(), 0, mFontSize, FIRST_CHAR, CHAR_COUNT,
-	                    reinterpret_cast<stbtt_packedchar*>(mPackedChars)) == 0) {
-		std::cerr << "FontRenderer: Couldn't pack font, texture likely too small." << std::endl;
-		std::terminate();
+static bool writeAtlasCache(const char* path, const AtlasCacheKey& key, const stbtt_packedchar* chars,
+                            const uint8_t* atlas) noexcept
+{
+	vector<uint8_t> file(atlasCacheSize(key), 0);
+	uint8_t* data = file.data();
+	std::memcpy(data, ATLAS_CACHE_MAGIC, sizeof(ATLAS_CACHE_MAGIC));
+	writeU32(data + 8, ATLAS_CACHE_VERSION);
+	writeU64(data + 12, key.fontHash);
+	writeF32(data + 20, key.fontSize);
+	writeU32(data + 24, key.firstChar);
+	writeU32(data + 28, key.charCount);
+	writeU32(data + 32, OVERSAMPLING);
+	writeU32(data + 36, key.width);
+	writeU32(data + 40, key.height);
+
+	uint8_t* ptr = data + ATLAS_CACHE_HEADER_SIZE;
+	for (uint32_t i = 0; i < key.charCount; ++i, ptr += ATLAS_CACHE_CHAR_SIZE) {
+		const stbtt_packedchar& c = chars[i];
+		writeU16(ptr, c.x0);
+		writeU16(ptr + 2, c.y0);
+		writeU16(ptr + 4, c.x1);
+		writeU16(ptr + 6, c.y1);
+		writeF32(ptr + 8, c.xoff);
+		writeF32(ptr + 12, c.yoff);
+		writeF32(ptr + 16, c.xadvance);
+		writeF32(ptr + 20, c.xoff2);
+		writeF32(ptr + 24, c.yoff2);
 	}
+	std::memcpy(ptr, atlas, size_t(key.width) * key.height);
 
-	stbtt_PackEnd(&packContext);
+	return sfz::writeBinaryFile(path, file.data(), file.size());
+}
 
-	glGenTextures(1, &mFontTexture);
-	glBindTexture(GL_TEXTURE_2D, mFontTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, texWidth, texHeight, 0, GL_RED, GL_UNSIGNED_BYTE,
-	             tempBitmap);
+// FontRenderer: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	// Sets specified texture filtering, generating mipmaps if needed.
-	switch (filtering) {
-	case TextureFiltering::NEAREST:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		break;
-	case TextureFiltering::BILINEAR:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		break;
-	case TextureFiltering::TRILINEAR:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		break;
-	case TextureFiltering::ANISOTROPIC_1:
-	case TextureFiltering::ANISOTROPIC_2:
-	case TextureFiltering::ANISOTROPIC_4:
-	case TextureFiltering::ANISOTROPIC_8:
-	case TextureFiltering::ANISOTROPIC_16:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicFactor(filtering));
-		break;
-	}
+FontRenderer::FontRenderer(const char* fontPath, uint32_t texWidth, uint32_t texHeight,
+	                       float fontSize, size_t numCharsPerBatch, TextureFiltering filtering,
+	                       const char* atlasCachePath) noexcept
+:
+	mFontSize{fontSize},
+	mPackedChars{new (std::nothrow) stbtt_packedchar[CHAR_COUNT]},
+	mSpriteBatch{numCharsPerBatch, FONT_RENDERER_FRAGMENT_SHADER_SRC}
+{
+	const sfz::MappedFile ttfFile{fontPath};
+	createFontTexture(ttfFile.data(), ttfFile.size(), fontPath, texWidth, texHeight, filtering, atlasCachePath);
+}
 
-	delete[] tempBitmap;
+FontRenderer::FontRenderer(const AssetView& ttfFile, const char* name, uint32_t texWidth,
+                           uint32_t texHeight, float fontSize, size_t numCharsPerBatch,
+                           TextureFiltering filtering, const char* atlasCachePath) noexcept
+:
+	mFontSize{fontSize},
+	mPackedChars{new (std::nothrow) stbtt_packedchar[CHAR_COUNT]},
+	mSpriteBatch{numCharsPerBatch, FONT_RENDERER_FRAGMENT_SHADER_SRC}
+{
+	createFontTexture(ttfFile.data, ttfFile.size, name, texWidth, texHeight, filtering, atlasCachePath);
 }
 
 FontRenderer::~FontRenderer() noexcept
 {
+	StateCache::INSTANCE().onTextureDeleted(mFontTexture);
 	glDeleteTextures(1, &mFontTexture);
+	GpuMemoryTracker::INSTANCE().remove(mMemoryId);
 	delete[] reinterpret_cast<stbtt_packedchar* const>(mPackedChars);
 }
 
@@ -214,31 +279,21 @@ void FontRenderer::begin(vec2 cameraPosition, vec2 cameraDimensions) noexcept
 float FontRenderer::write(vec2 position, float size, const char* text) noexcept
 {
 	const float scale = size / mFontSize;
+	const CachedTextRun& run = textRun(text);
 
-	vec2 currPos = position;
+	vec2 origin = position;
 	const float vertOffsetScale = distance(VerticalAlign::BOTTOM, mVertAlign) / 2.0f;
-	currPos[1] -= size * vertOffsetScale;
+	origin[1] -= size * vertOffsetScale;
 	if (mHorizAlign != HorizontalAlign::LEFT) {
-		const float strWidth = measureStringWidth(size, text);
 		const float horizOffsetScale = distance(HorizontalAlign::LEFT, mHorizAlign) / 2.0f;
-		currPos[0] -= strWidth * horizOffsetScale;
+		origin[0] -= run.width * scale * horizOffsetScale;
 	}
 
-	CharInfo info;
-	uint32_t codepoint;
-	uint32_t state = 0;
-	const char* textItr = text;
-	uint8_t c;
-	while ((c = *textItr++)) {
-		if (decode(&state, &codepoint, c)) continue;
-		codepoint -= FIRST_CHAR;
-		if (LAST_CHAR < codepoint) codepoint = UNKNOWN_CHAR - FIRST_CHAR;
-
-		calculateCharInfo(info, mPackedChars, mPixelToUV, codepoint, currPos, scale);
-		mSpriteBatch.draw(info.pos, info.dim, info.texRegion);
+	for (const CachedGlyph& glyph : run.glyphs) {
+		mSpriteBatch.draw(origin + glyph.pos * scale, glyph.dim * scale, glyph.texRegion);
 	}
 
-	return currPos[0];
+	return origin[0] + run.width * scale;
 }
 
 void FontRenderer::writeBitmapFont(vec2 position, vec2 dimensions) noexcept
@@ -253,27 +308,167 @@ void FontRenderer::end(uint32_t fbo, vec2 viewportDimensions, vec4 textColor) no
 
 void FontRenderer::end(uint32_t fbo, const AABB2D& viewport, vec4 textColor) noexcept
 {
-	glUseProgram(mSpriteBatch.shaderProgram().handle());
+	StateCache::INSTANCE().useProgram(mSpriteBatch.shaderProgram().handle());
 	gl::setUniform(mSpriteBatch.shaderProgram(), "uTextColor", textColor);
 	mSpriteBatch.end(fbo, viewport, mFontTexture);
 }
 
 float FontRenderer::measureStringWidth(float size, const char* text) const noexcept
 {
-	const float scale = size / mFontSize;
+	return textRun(text).width * (size / mFontSize);
+}
+
+// FontRenderer: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+const FontRenderer::CachedTextRun& FontRenderer::textRun(const char* text) const noexcept
+{
+	const size_t length = std::strlen(text);
+	const uint64_t hash = fnv1a64(reinterpret_cast<const uint8_t*>(text), length);
+
+	auto mapItr = mTextRunMap.find(hash);
+	if (mapItr != mTextRunMap.end()) {
+		auto runItr = mapItr->second;
+		mTextRuns.splice(mTextRuns.begin(), mTextRuns, runItr);
+		if (runItr->text.size() != length || std::memcmp(runItr->text.data(), text, length) != 0) {
+			layoutTextRun(*runItr, text, length); // Hash collision, replaces the other text
+		}
+		return *runItr;
+	}
+
+	// Reuses the least recently used run when the cache is full, keeping its allocations
+	if (mTextRuns.size() >= TEXT_RUN_CACHE_CAPACITY) {
+		mTextRunMap.erase(mTextRuns.back().hash);
+		mTextRuns.splice(mTextRuns.begin(), mTextRuns, std::prev(mTextRuns.end()));
+	} else {
+		mTextRuns.emplace_front();
+	}
+
+	CachedTextRun& run = mTextRuns.front();
+	run.hash = hash;
+	layoutTextRun(run, text, length);
+	mTextRunMap[hash] = mTextRuns.begin();
+	return run;
+}
+
+void FontRenderer::layoutTextRun(CachedTextRun& run, const char* text, size_t length) const noexcept
+{
+	run.text.assign(text, length);
+	run.glyphs.clear();
+
 	CharInfo info;
 	vec2 currPos = vec2{0.0f};
 	uint32_t codepoint;
 	uint32_t state = 0;
-	const char* textItr = text;
-	uint8_t c;
-	while ((c = *textItr++)) {
-		if (decode(&state, &codepoint, c)) continue;
+	for (size_t i = 0; i < length; ++i) {
+		if (decode(&state, &codepoint, uint8_t(text[i]))) continue;
 		codepoint -= FIRST_CHAR;
 		if (LAST_CHAR < codepoint) codepoint = UNKNOWN_CHAR - FIRST_CHAR;
-		calculateCharInfo(info, mPackedChars, mPixelToUV, codepoint, currPos, scale);
+
+		calculateCharInfo(info, mPackedChars, mPixelToUV, codepoint, currPos, 1.0f);
+		CachedGlyph glyph;
+		glyph.pos = info.pos;
+		glyph.dim = info.dim;
+		glyph.texRegion = info.texRegion;
+		run.glyphs.push_back(glyph);
+	}
+	run.width = currPos[0];
+}
+
+void FontRenderer::createFontTexture(const uint8_t* ttfData, size_t ttfSize, const char* name,
+                                     uint32_t texWidth, uint32_t texHeight, TextureFiltering filtering,
+                                     const char* atlasCachePath) noexcept
+{
+	if (ttfSize == 0) {
+		std::cerr << "Couldn't open TTF file at: " << name << std::endl;
+		std::terminate();
+	}
+
+	// This should be const, but MSVC12 doesn't support ini lists in constructor's ini list
+	mPixelToUV = vec2{1.0f/static_cast<float>(texWidth), 1.0f/static_cast<float>(texHeight)};
+
+	stbtt_packedchar* packedChars = reinterpret_cast<stbtt_packedchar*>(mPackedChars);
+	AtlasCacheKey cacheKey;
+	cacheKey.fontHash = fnv1a64(ttfData, ttfSize);
+	cacheKey.fontSize = mFontSize;
+	cacheKey.firstChar = FIRST_CHAR;
+	cacheKey.charCount = CHAR_COUNT;
+	cacheKey.width = texWidth;
+	cacheKey.height = texHeight;
+
+	// Uses the cached atlas if it was baked from the same font with the same parameters, it's
+	// mapped so the atlas can be uploaded directly from it
+	sfz::MappedFile cacheFile;
+	const uint8_t* atlas = nullptr;
+	if (atlasCachePath != nullptr && sfz::fileExists(atlasCachePath)) {
+		cacheFile = sfz::MappedFile{atlasCachePath};
+		atlas = readAtlasCache(cacheFile, cacheKey, packedChars);
+	}
+
+	vector<uint8_t> tempBitmap;
+	if (atlas == nullptr) {
+		tempBitmap.resize(size_t(texWidth) * texHeight);
+
+		stbtt_pack_context packContext;
+		if(stbtt_PackBegin(&packContext, tempBitmap.data(), texWidth, texHeight, 0, 1, NULL) == 0) {
+			std::cerr << "FontRenderer: Couldn't stbtt_PackBegin()" << std::endl;
+			std::terminate();
+		}
+
+		stbtt_PackSetOversampling(&packContext, OVERSAMPLING, OVERSAMPLING);
+
+		// stbtt only reads from the font data even though it takes a non-const pointer
+		if (stbtt_PackFontRange(&packContext, const_cast<uint8_t*>(ttfData), 0, mFontSize, FIRST_CHAR, CHAR_COUNT,
+		                        packedChars) == 0) {
+			std::cerr << "FontRenderer: Couldn't pack font, texture likely too small." << std::endl;
+			std::terminate();
+		}
+
+		stbtt_PackEnd(&packContext);
+		atlas = tempBitmap.data();
+
+		if (atlasCachePath != nullptr) {
+			cacheFile = sfz::MappedFile{}; // Unmapped before it's overwritten
+			if (!writeAtlasCache(atlasCachePath, cacheKey, packedChars, atlas)) {
+				std::cerr << "FontRenderer: Couldn't write font atlas cache to: " << atlasCachePath << std::endl;
+			}
+		}
+	}
+
+	glGenTextures(1, &mFontTexture);
+	glBindTexture(GL_TEXTURE_2D, mFontTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, texWidth, texHeight, 0, GL_RED, GL_UNSIGNED_BYTE, atlas);
+	mMemoryId = GpuMemoryTracker::INSTANCE().add(GpuMemoryCategory::TEXTURE,
+	             (std::string(name) + " (font atlas)").c_str(), estimatedTextureSizeBytes((int)texWidth,
+	             (int)texHeight, 1, 1, filtering != TextureFiltering::NEAREST));
+
+	// Sets specified texture filtering, generating mipmaps if needed.
+	switch (filtering) {
+	case TextureFiltering::NEAREST:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		break;
+	case TextureFiltering::BILINEAR:
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		break;
+	case TextureFiltering::TRILINEAR:
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		break;
+	case TextureFiltering::ANISOTROPIC_1:
+	case TextureFiltering::ANISOTROPIC_2:
+	case TextureFiltering::ANISOTROPIC_4:
+	case TextureFiltering::ANISOTROPIC_8:
+	case TextureFiltering::ANISOTROPIC_16:
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicFactor(filtering));
+		break;
 	}
-	return currPos[0];
 }
 
 } // namespace sfz
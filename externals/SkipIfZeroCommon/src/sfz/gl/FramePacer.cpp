@@ -0,0 +1,97 @@
+#include "sfz/gl/FramePacer.hpp"
+
+#include <algorithm>
+
+#include "sfz/gl/OpenGL.hpp"
+
+namespace gl {
+
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static float secondsBetween(std::chrono::high_resolution_clock::time_point before,
+                            std::chrono::high_resolution_clock::time_point after) noexcept
+{
+	using FloatSecond = std::chrono::duration<float>;
+	return std::chrono::duration_cast<FloatSecond>(after - before).count();
+}
+
+// FramePacer: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+FramePacer::FramePacer(uint32_t maxFramesInFlight, size_t numStatsSamples) noexcept
+:
+	mFences{MAX_FRAMES_IN_FLIGHT},
+	mCpuWaitStats{numStatsSamples},
+	mGpuLatencyStats{numStatsSamples}
+{
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+		mSubmitGpuTimes[i] = 0;
+	}
+	glGenQueries(MAX_FRAMES_IN_FLIGHT, mTimestampQueries);
+	this->maxFramesInFlight(maxFramesInFlight);
+}
+
+FramePacer::~FramePacer() noexcept
+{
+	glDeleteQueries(MAX_FRAMES_IN_FLIGHT, mTimestampQueries);
+}
+
+// FramePacer: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void FramePacer::waitForFrameSlot() noexcept
+{
+	retireSignaled();
+
+	auto before = std::chrono::high_resolution_clock::now();
+	while (mFences.size() >= mMaxFramesInFlight) {
+		retireOldest();
+	}
+	mCpuWaitStats.addSample(secondsBetween(before, std::chrono::high_resolution_clock::now()));
+}
+
+void FramePacer::frameSubmitted() noexcept
+{
+	if (mFences.isFull()) retireOldest();
+
+	// The timestamp is written when the GPU has finished all previous commands, and is available
+	// once the fence inserted after it is signaled
+	const uint32_t slot = mFences.nextSlot();
+	GLint64 submitTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &submitTime);
+	mSubmitGpuTimes[slot] = submitTime;
+	glQueryCounter(mTimestampQueries[slot], GL_TIMESTAMP);
+	mFences.insert();
+}
+
+void FramePacer::maxFramesInFlight(uint32_t maxFramesInFlight) noexcept
+{
+	mMaxFramesInFlight = std::min(std::max(maxFramesInFlight, 1u), MAX_FRAMES_IN_FLIGHT);
+}
+
+// FramePacer: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void FramePacer::retireOldest() noexcept
+{
+	if (mFences.isEmpty()) return;
+	const uint32_t slot = mFences.oldestSlot();
+
+	// The timestamp is only read if the wait succeeded, a lost context still retires the fence
+	if (mFences.retireOldest()) {
+		GLuint64 finishedTime = 0;
+		glGetQueryObjectui64v(mTimestampQueries[slot], GL_QUERY_RESULT, &finishedTime);
+		const int64_t latencyNs = int64_t(finishedTime) - mSubmitGpuTimes[slot];
+		mGpuLatencyStats.addSample(float(std::max(latencyNs, int64_t(0))) / 1000000000.0f);
+	}
+}
+
+void FramePacer::retireSignaled() noexcept
+{
+	while (mFences.isOldestSignaled()) {
+		retireOldest();
+	}
+}
+
+} // namespace gl
\ No newline at end of file
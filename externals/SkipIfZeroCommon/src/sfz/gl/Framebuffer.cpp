@@ -1,9 +1,53 @@
 #include "sfz/gl/Framebuffer.hpp"
 
+#include <cstdio>
+
+#include "sfz/gl/GpuMemoryTracker.hpp"
 #include "sfz/gl/OpenGL.hpp"
+#include "sfz/gl/StateCache.hpp"
 
 namespace gl {
 
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static size_t bytesPerPixel(FBTextureFormat format) noexcept
+{
+	const uint32_t formatIndex = static_cast<uint32_t>(format);
+	const uint32_t numComponents = (formatIndex % 4) + 1;
+	const size_t paddedComponents = (numComponents == 3) ? 4 : numComponents;
+
+	// The formats are grouped four at a time (R, RG, RGB, RGBA) in the same order as the enum
+	switch (formatIndex / 4) {
+	case 0: // U8
+	case 2: // S8
+	case 4: // INT_U8
+	case 5: // INT_S8
+		return paddedComponents;
+	case 1: // U16
+	case 3: // S16
+	case 7: // F16
+		return paddedComponents * 2;
+	case 6: // F32
+		return paddedComponents * 4;
+	default:
+		sfz_assert_debug(false);
+		return 0;
+	}
+}
+
+static size_t bytesPerPixel(FBDepthFormat format) noexcept
+{
+	switch (format) {
+	case FBDepthFormat::F16: return 2;
+	case FBDepthFormat::F24: return 4;
+	case FBDepthFormat::F32: return 4;
+	default:
+		sfz_assert_debug(false);
+		return 0;
+	}
+}
+
 // FramebufferBuilder: Constructors & destructors
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -101,6 +145,41 @@ FramebufferBuilder& FramebufferBuilder::removeStencilTexture() noexcept
 	return *this;
 }
 
+// FramebufferBuilder: Comparison & size estimation
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool FramebufferBuilder::operator== (const FramebufferBuilder& other) const noexcept
+{
+	if (mDim != other.mDim) return false;
+	for (uint32_t i = 0; i < 8; ++i) {
+		if (mCreateTexture[i] != other.mCreateTexture[i]) return false;
+		if (!mCreateTexture[i]) continue;
+		if (mTextureFormat[i] != other.mTextureFormat[i]) return false;
+		if (mTextureFiltering[i] != other.mTextureFiltering[i]) return false;
+	}
+	if (mCreateDepthBuffer != other.mCreateDepthBuffer) return false;
+	if (mCreateDepthTexture != other.mCreateDepthTexture) return false;
+	if ((mCreateDepthBuffer || mCreateDepthTexture) && mDepthFormat != other.mDepthFormat) return false;
+	return mCreateStencilBuffer == other.mCreateStencilBuffer &&
+	       mCreateStencilTexture == other.mCreateStencilTexture;
+}
+
+bool FramebufferBuilder::operator!= (const FramebufferBuilder& other) const noexcept
+{
+	return !(*this == other);
+}
+
+size_t FramebufferBuilder::estimatedSizeBytes() const noexcept
+{
+	size_t bytes = 0;
+	for (uint32_t i = 0; i < 8; ++i) {
+		if (mCreateTexture[i]) bytes += bytesPerPixel(mTextureFormat[i]);
+	}
+	if (mCreateDepthBuffer || mCreateDepthTexture) bytes += bytesPerPixel(mDepthFormat);
+	if (mCreateStencilBuffer || mCreateStencilTexture) bytes += 1;
+	return bytes * size_t(mDim.x) * size_t(mDim.y);
+}
+
 // FramebufferBuilder: Framebuffer building method
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -127,7 +206,7 @@ Framebuffer FramebufferBuilder::build() const noexcept
 	glActiveTexture(GL_TEXTURE0); // TODO: Not sure if necessary
 	uint32_t numTextures = 0;
 	for (uint32_t i = 0; i < 8; ++i) {
-		if (!mCreateTexture[i]) break;
+		if (!mCreateTexture[i]) continue;
 		numTextures = i + 1;
 
 		glGenTextures(1, &tmp.mTextures[i]);
@@ -307,10 +386,10 @@ Framebuffer FramebufferBuilder::build() const noexcept
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, tmp.mStencilTexture, 0);
 	}
 
-	// Sets up the textures to draw to
+	// Sets up the textures to draw to, fragment outputs without a texture are discarded
 	GLenum drawBuffers[8];
 	for (uint32_t i = 0; i < 8; ++i) {
-		drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+		drawBuffers[i] = mCreateTexture[i] ? (GL_COLOR_ATTACHMENT0 + i) : GL_NONE;
 	}
 	glDrawBuffers(numTextures, drawBuffers);
 
@@ -323,6 +402,10 @@ Framebuffer FramebufferBuilder::build() const noexcept
 	glBindTexture(GL_TEXTURE_2D, 0);
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
+	char label[64];
+	std::snprintf(label, sizeof(label), "Framebuffer %ix%i", mDim.x, mDim.y);
+	tmp.mMemoryId = GpuMemoryTracker::INSTANCE().add(GpuMemoryCategory::FRAMEBUFFER, label, estimatedSizeBytes());
+
 	return std::move(tmp);
 }
 
@@ -382,6 +465,10 @@ Framebuffer createShadowMap(vec2i dimensions, FBDepthFormat depthFormat, bool pc
 	glBindTexture(GL_TEXTURE_2D, 0);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+	char label[64];
+	std::snprintf(label, sizeof(label), "Shadow map %ix%i", dimensions.x, dimensions.y);
+	const size_t sizeBytes = bytesPerPixel(depthFormat) * size_t(dimensions.x) * size_t(dimensions.y);
+	tmp.mMemoryId = GpuMemoryTracker::INSTANCE().add(GpuMemoryCategory::FRAMEBUFFER, label, sizeBytes);
 
 	return std::move(tmp);
 }
@@ -400,6 +487,7 @@ Framebuffer::Framebuffer(Framebuffer&& other) noexcept
 	std::swap(this->mStencilTexture, other.mStencilTexture);
 	std::swap(this->mFBO, other.mFBO);
 	std::swap(this->mDim, other.mDim);
+	std::swap(this->mMemoryId, other.mMemoryId);
 }
 
 Framebuffer& Framebuffer::operator= (Framebuffer&& other) noexcept
@@ -413,17 +501,27 @@ Framebuffer& Framebuffer::operator= (Framebuffer&& other) noexcept
 	std::swap(this->mStencilTexture, other.mStencilTexture);
 	std::swap(this->mFBO, other.mFBO);
 	std::swap(this->mDim, other.mDim);
+	std::swap(this->mMemoryId, other.mMemoryId);
 	return *this;
 }
 
 Framebuffer::~Framebuffer() noexcept
 {
+	StateCache& glState = StateCache::INSTANCE();
+	for (uint32_t i = 0; i < 8; ++i) {
+		glState.onTextureDeleted(mTextures[i]);
+	}
+	glState.onTextureDeleted(mDepthTexture);
+	glState.onTextureDeleted(mStencilTexture);
+	glState.onFramebufferDeleted(mFBO);
+
 	glDeleteTextures(8, mTextures);
 	glDeleteRenderbuffers(1, &mDepthBuffer);
 	glDeleteTextures(1, &mDepthTexture);
 	glDeleteRenderbuffers(1, &mStencilBuffer);
 	glDeleteTextures(1, &mStencilTexture);
 	glDeleteFramebuffers(1, &mFBO);
+	GpuMemoryTracker::INSTANCE().remove(mMemoryId);
 }
 
 // Framebuffer: Getters
@@ -473,7 +571,7 @@ void Framebuffer::attachExternalDepthBuffer(uint32_t buffer) noexcept
 {
 	sfz_assert_debug(mDepthBuffer == 0);
 	sfz_assert_debug(mDepthTexture == 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+	StateCache::INSTANCE().bindFramebuffer(mFBO);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, buffer);
 	bool status = checkCurrentFramebufferStatus();
 	sfz_assert_debug(status);
@@ -483,7 +581,7 @@ void Framebuffer::attachExternalDepthTexture(uint32_t texture) noexcept
 {
 	sfz_assert_debug(mDepthBuffer == 0);
 	sfz_assert_debug(mDepthTexture == 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+	StateCache::INSTANCE().bindFramebuffer(mFBO);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
 	bool status = checkCurrentFramebufferStatus();
 	sfz_assert_debug(status);
@@ -493,7 +591,7 @@ void Framebuffer::attachExternalStencilBuffer(uint32_t buffer) noexcept
 {
 	sfz_assert_debug(mStencilBuffer == 0);
 	sfz_assert_debug(mStencilTexture == 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+	StateCache::INSTANCE().bindFramebuffer(mFBO);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, buffer);
 	bool status = checkCurrentFramebufferStatus();
 	sfz_assert_debug(status);
@@ -503,7 +601,7 @@ void Framebuffer::attachExternalStencilTexture(uint32_t texture) noexcept
 {
 	sfz_assert_debug(mStencilBuffer == 0);
 	sfz_assert_debug(mStencilTexture == 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+	StateCache::INSTANCE().bindFramebuffer(mFBO);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
 	bool status = checkCurrentFramebufferStatus();
 	sfz_assert_debug(status);
@@ -0,0 +1,119 @@
+#include "sfz/gl/GpuMemoryTracker.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "sfz/Assert.hpp"
+
+namespace gl {
+
+// GpuMemoryCategory enum
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+const char* to_string(GpuMemoryCategory category) noexcept
+{
+	switch (category) {
+	case GpuMemoryCategory::TEXTURE: return "Textures";
+	case GpuMemoryCategory::FRAMEBUFFER: return "Framebuffers";
+	case GpuMemoryCategory::MESH: return "Meshes";
+	case GpuMemoryCategory::SPRITE_BATCH: return "Sprite batches";
+	}
+	return "";
+}
+
+// GpuMemoryTracker: Singleton instance
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+GpuMemoryTracker& GpuMemoryTracker::INSTANCE() noexcept
+{
+	static GpuMemoryTracker tracker;
+	return tracker;
+}
+
+// GpuMemoryTracker: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+uint32_t GpuMemoryTracker::add(GpuMemoryCategory category, const char* label, size_t bytes) noexcept
+{
+	GpuAllocation allocation;
+	allocation.id = mNextId;
+	allocation.category = category;
+	allocation.bytes = bytes;
+
+	// Keeps the end of long labels, usually the interesting part of a path
+	if (label == nullptr) label = "";
+	size_t labelLen = std::strlen(label);
+	if (labelLen >= sizeof(allocation.label)) label += (labelLen - sizeof(allocation.label) + 1);
+	std::strncpy(allocation.label, label, sizeof(allocation.label));
+	allocation.label[sizeof(allocation.label) - 1] = '\0';
+
+	mAllocations.push_back(allocation);
+	mNextId += 1;
+	if (mNextId == 0) mNextId = 1;
+
+	const uint32_t categoryIndex = static_cast<uint32_t>(category);
+	mStats.bytes[categoryIndex] += bytes;
+	mStats.numAllocations[categoryIndex] += 1;
+	mStats.totalBytes += bytes;
+	mStats.peakTotalBytes = std::max(mStats.peakTotalBytes, mStats.totalBytes);
+
+	return allocation.id;
+}
+
+void GpuMemoryTracker::remove(uint32_t id) noexcept
+{
+	if (id == 0) return;
+	for (size_t i = 0; i < mAllocations.size(); ++i) {
+		if (mAllocations[i].id != id) continue;
+
+		const GpuAllocation& allocation = mAllocations[i];
+		const uint32_t categoryIndex = static_cast<uint32_t>(allocation.category);
+		mStats.bytes[categoryIndex] -= allocation.bytes;
+		mStats.numAllocations[categoryIndex] -= 1;
+		mStats.totalBytes -= allocation.bytes;
+
+		// Order doesn't matter, the report sorts a copy
+		mAllocations[i] = mAllocations.back();
+		mAllocations.pop_back();
+		return;
+	}
+	sfz_assert_debug_m(false, "Allocation was not added to this tracker");
+}
+
+void GpuMemoryTracker::printReport() const noexcept
+{
+	const float MIB = 1024.0f * 1024.0f;
+
+	vector<GpuAllocation> sorted = mAllocations;
+	std::sort(sorted.begin(), sorted.end(), [](const GpuAllocation& lhs, const GpuAllocation& rhs) {
+		return lhs.bytes > rhs.bytes;
+	});
+
+	std::printf("GPU memory report (estimated)\n");
+	for (const GpuAllocation& allocation : sorted) {
+		std::printf("%9.2f MiB  %-15s %s\n", allocation.bytes / MIB, to_string(allocation.category),
+		            allocation.label);
+	}
+	std::printf("\n");
+	for (uint32_t i = 0; i < NUM_GPU_MEMORY_CATEGORIES; ++i) {
+		std::printf("%-15s %4u allocations, %9.2f MiB\n", to_string(static_cast<GpuMemoryCategory>(i)),
+		            mStats.numAllocations[i], mStats.bytes[i] / MIB);
+	}
+	std::printf("Total: %.2f MiB, peak: %.2f MiB\n\n", mStats.totalBytes / MIB, mStats.peakTotalBytes / MIB);
+	std::fflush(stdout);
+}
+
+// Size estimation functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+size_t estimatedTextureSizeBytes(int width, int height, int numChannels, size_t bytesPerChannel,
+                                 bool mipmapped) noexcept
+{
+	if (width <= 0 || height <= 0) return 0;
+	const size_t paddedChannels = (numChannels == 3) ? 4 : size_t(numChannels);
+	const size_t baseBytes = size_t(width) * size_t(height) * paddedChannels * bytesPerChannel;
+	return mipmapped ? (baseBytes + baseBytes / 3) : baseBytes;
+}
+
+} // namespace gl
\ No newline at end of file
@@ -5,7 +5,8 @@
 #include <new>
 
 #include "sfz/gl/OpenGL.hpp"
-#include "sfz/util/IO.hpp"
+#include "sfz/gl/StateCache.hpp"
+#include "sfz/util/MappedFile.hpp"
 
 namespace gl {
 
@@ -23,6 +24,7 @@ static const char* POST_PROCESS_VERTEX_SHADER_SOURCE = R"(
 
 	// Uniforms
 	uniform mat4 uInvProjMatrix = mat4(1);
+	uniform vec2 uUVScale = vec2(1); // Scales uvCoord, used when rendering to a sub-rect of a texture
 
 	// Output
 	out vec2 uvCoord;
@@ -31,7 +33,7 @@ static const char* POST_PROCESS_VERTEX_SHADER_SOURCE = R"(
 	void main()
 	{
 		gl_Position = vec4(inPosition, 1.0);
-		uvCoord = inUV;
+		uvCoord = inUV * uUVScale;
 
 		vec4 nonNormRayDirTmp = (uInvProjMatrix * vec4(inPosition.xy, 0.0, 1.0));
 		nonNormRayDirTmp /= nonNormRayDirTmp.w; // Not sure if necessary
@@ -39,115 +41,35 @@ static const char* POST_PROCESS_VERTEX_SHADER_SOURCE = R"(
 	}
 )";
 
+static void bindPostProcessAttribs(uint32_t shaderProgram) noexcept
+{
+	glBindAttribLocation(shaderProgram, 0, "inPosition");
+	glBindAttribLocation(shaderProgram, 1, "inNormal");
+	glBindAttribLocation(shaderProgram, 2, "inUV");
+	glBindAttribLocation(shaderProgram, 3, "inMaterialID");
+}
+
 // Program: Constructor functions
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 Program Program::fromSource(const char* vertexSrc, const char* geometrySrc, const char* fragmentSrc,
                             void(*bindAttribFragFunc)(uint32_t shaderProgram)) noexcept
 {
-	GLuint vertexShader = compileShader(vertexSrc, GL_VERTEX_SHADER);
-	if (vertexShader == 0) {
-		std::cerr << "Couldn't compile vertex shader." << std::endl;
-		return Program{};
-	}
-
-	GLuint geometryShader = compileShader(geometrySrc, GL_GEOMETRY_SHADER);
-	if (geometryShader == 0) {
-		std::cerr << "Couldn't compile geometry shader." << std::endl;
-		return Program{};
-	}
-	
-	GLuint fragmentShader = compileShader(fragmentSrc, GL_FRAGMENT_SHADER);
-	if (fragmentShader == 0) {
-		std::cerr << "Couldn't compile fragment shader." << std::endl;
-		return Program{};
-	}
-
-	GLuint shaderProgram = glCreateProgram();
-	
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, geometryShader);
-	glAttachShader(shaderProgram, fragmentShader);
-
-	// glBindAttribLocation() & glBindFragDataLocation()
-	if (bindAttribFragFunc != nullptr) bindAttribFragFunc(shaderProgram);
-
-	bool linkSuccess = linkProgram(shaderProgram);
-
-	glDetachShader(shaderProgram, vertexShader);
-	glDetachShader(shaderProgram, geometryShader);
-	glDetachShader(shaderProgram, fragmentShader);
-
-	glDeleteShader(vertexShader);
-	glDeleteShader(geometryShader);
-	glDeleteShader(fragmentShader);
-
-	if (!linkSuccess) {
-		glDeleteProgram(shaderProgram);
-		std::cerr << "Couldn't link shader program." << std::endl;
-		return Program{};
-	}
-	
-	Program temp;
-	temp.mHandle = shaderProgram;
-	temp.mBindAttribFragFunc = bindAttribFragFunc;
-	return std::move(temp);
+	return fromSourceWithLengths(vertexSrc, -1, geometrySrc, -1, fragmentSrc, -1, bindAttribFragFunc);
 }
 
 Program Program::fromSource(const char* vertexSrc, const char* fragmentSrc,
                             void(*bindAttribFragFunc)(uint32_t shaderProgram)) noexcept
 {
-	GLuint vertexShader = compileShader(vertexSrc, GL_VERTEX_SHADER);
-	if (vertexShader == 0) {
-		std::cerr << "Couldn't compile vertex shader." << std::endl;
-		return Program{};
-	}
-	
-	GLuint fragmentShader = compileShader(fragmentSrc, GL_FRAGMENT_SHADER);
-	if (fragmentShader == 0) {
-		std::cerr << "Couldn't compile fragment shader." << std::endl;
-		return Program{};
-	}
-
-	GLuint shaderProgram = glCreateProgram();
-	
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-
-	// glBindAttribLocation() & glBindFragDataLocation()
-	if (bindAttribFragFunc != nullptr) bindAttribFragFunc(shaderProgram);
-
-	bool linkSuccess = linkProgram(shaderProgram);
-
-	glDetachShader(shaderProgram, vertexShader);
-	glDetachShader(shaderProgram, fragmentShader);
-
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	if (!linkSuccess) {
-		glDeleteProgram(shaderProgram);
-		std::cerr << "Couldn't link shader program." << std::endl;
-		return Program{};
-	}
-	
-	Program temp;
-	temp.mHandle = shaderProgram;
-	temp.mBindAttribFragFunc = bindAttribFragFunc;
-	return temp;
+	return fromSourceWithLengths(vertexSrc, -1, nullptr, 0, fragmentSrc, -1, bindAttribFragFunc);
 }
 
 Program Program::postProcessFromSource(const char* postProcessSource) noexcept
 {
-	Program tmp;
-	tmp = Program::fromSource(POST_PROCESS_VERTEX_SHADER_SOURCE, postProcessSource, [](uint32_t shaderProgram) {
-		glBindAttribLocation(shaderProgram, 0, "inPosition");
-		glBindAttribLocation(shaderProgram, 1, "inNormal");
-		glBindAttribLocation(shaderProgram, 2, "inUV");
-		glBindAttribLocation(shaderProgram, 3, "inMaterialID");
-	});
+	Program tmp = fromSourceWithLengths(POST_PROCESS_VERTEX_SHADER_SOURCE, -1, nullptr, 0,
+	                                    postProcessSource, -1, bindPostProcessAttribs);
 	tmp.mIsPostProcess = true;
-	return std::move(tmp);
+	return tmp;
 }
 
 
@@ -186,17 +108,42 @@ Program Program::postProcessFromFile(const char* postProcessPath) noexcept
 	return tmp;
 }
 
+Program Program::fromMemory(const char* vertexSrc, size_t vertexLength, const char* vertexPath,
+                            const char* fragmentSrc, size_t fragmentLength, const char* fragmentPath,
+                            void(*bindAttribFragFunc)(uint32_t shaderProgram)) noexcept
+{
+	Program tmp = fromSourceWithLengths(vertexSrc, (int32_t)vertexLength, nullptr, 0,
+	                                    fragmentSrc, (int32_t)fragmentLength, bindAttribFragFunc);
+	tmp.mVertexPath = vertexPath;
+	tmp.mFragmentPath = fragmentPath;
+	tmp.mBindAttribFragFunc = bindAttribFragFunc;
+	return tmp;
+}
+
+Program Program::postProcessFromMemory(const char* postProcessSrc, size_t postProcessLength,
+                                       const char* postProcessPath) noexcept
+{
+	Program tmp = fromSourceWithLengths(POST_PROCESS_VERTEX_SHADER_SOURCE, -1, nullptr, 0,
+	                                    postProcessSrc, (int32_t)postProcessLength, bindPostProcessAttribs);
+	tmp.mFragmentPath = postProcessPath;
+	tmp.mIsPostProcess = true;
+	return tmp;
+}
+
 // Program: Public methods
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 bool Program::reload() noexcept
 {
-	const string vertexSrc = sfz::readTextFile(mVertexPath.c_str());
-	const string geometrySrc = sfz::readTextFile(mGeometryPath.c_str());
-	const string fragmentSrc = sfz::readTextFile(mFragmentPath.c_str());
+	// The sources are compiled straight from the mapped files, without copying them
+	const sfz::MappedFile vertexSrc{mVertexPath.c_str()};
+	const sfz::MappedFile geometrySrc{mGeometryPath.c_str()};
+	const sfz::MappedFile fragmentSrc{mFragmentPath.c_str()};
 
 	if (mIsPostProcess && (fragmentSrc.size() > 0)) {
-		Program tmp = Program::postProcessFromSource(fragmentSrc.c_str());
+		Program tmp = fromSourceWithLengths(POST_PROCESS_VERTEX_SHADER_SOURCE, -1, nullptr, 0,
+		                                    fragmentSrc.str(), (int32_t)fragmentSrc.size(),
+		                                    bindPostProcessAttribs);
 		if (!tmp.isValid()) return false;
 
 		tmp.mFragmentPath = this->mFragmentPath;
@@ -206,8 +153,10 @@ bool Program::reload() noexcept
 		return true;
 	}
 	else if ((vertexSrc.size() > 0) && (geometrySrc.size() > 0) && (fragmentSrc.size() > 0)) {
-		Program tmp = Program::fromSource(vertexSrc.c_str(), geometrySrc.c_str(), fragmentSrc.c_str(),
-		                                  mBindAttribFragFunc);
+		Program tmp = fromSourceWithLengths(vertexSrc.str(), (int32_t)vertexSrc.size(),
+		                                    geometrySrc.str(), (int32_t)geometrySrc.size(),
+		                                    fragmentSrc.str(), (int32_t)fragmentSrc.size(),
+		                                    mBindAttribFragFunc);
 		if (!tmp.isValid()) return false;
 
 		tmp.mVertexPath = this->mVertexPath;
@@ -219,7 +168,9 @@ bool Program::reload() noexcept
 		return true;
 	}
 	else if ((vertexSrc.size() > 0) && (fragmentSrc.size() > 0)) {
-		Program tmp = Program::fromSource(vertexSrc.c_str(), fragmentSrc.c_str(), mBindAttribFragFunc);
+		Program tmp = fromSourceWithLengths(vertexSrc.str(), (int32_t)vertexSrc.size(), nullptr, 0,
+		                                    fragmentSrc.str(), (int32_t)fragmentSrc.size(),
+		                                    mBindAttribFragFunc);
 		if (!tmp.isValid()) return false;
 
 		tmp.mVertexPath = this->mVertexPath;
@@ -233,6 +184,68 @@ bool Program::reload() noexcept
 	return false;
 }
 
+// Program: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+Program Program::fromSourceWithLengths(const char* vertexSrc, int32_t vertexLength,
+                                      const char* geometrySrc, int32_t geometryLength,
+                                      const char* fragmentSrc, int32_t fragmentLength,
+                                      void(*bindAttribFragFunc)(uint32_t shaderProgram)) noexcept
+{
+	GLuint vertexShader = compileShader(vertexSrc, vertexLength, GL_VERTEX_SHADER);
+	if (vertexShader == 0) {
+		std::cerr << "Couldn't compile vertex shader." << std::endl;
+		return Program{};
+	}
+
+	GLuint geometryShader = 0;
+	if (geometrySrc != nullptr) {
+		geometryShader = compileShader(geometrySrc, geometryLength, GL_GEOMETRY_SHADER);
+		if (geometryShader == 0) {
+			std::cerr << "Couldn't compile geometry shader." << std::endl;
+			glDeleteShader(vertexShader);
+			return Program{};
+		}
+	}
+	
+	GLuint fragmentShader = compileShader(fragmentSrc, fragmentLength, GL_FRAGMENT_SHADER);
+	if (fragmentShader == 0) {
+		std::cerr << "Couldn't compile fragment shader." << std::endl;
+		glDeleteShader(vertexShader);
+		glDeleteShader(geometryShader); // Silently ignored if 0
+		return Program{};
+	}
+
+	GLuint shaderProgram = glCreateProgram();
+	
+	glAttachShader(shaderProgram, vertexShader);
+	if (geometryShader != 0) glAttachShader(shaderProgram, geometryShader);
+	glAttachShader(shaderProgram, fragmentShader);
+
+	// glBindAttribLocation() & glBindFragDataLocation()
+	if (bindAttribFragFunc != nullptr) bindAttribFragFunc(shaderProgram);
+
+	bool linkSuccess = linkProgram(shaderProgram);
+
+	glDetachShader(shaderProgram, vertexShader);
+	if (geometryShader != 0) glDetachShader(shaderProgram, geometryShader);
+	glDetachShader(shaderProgram, fragmentShader);
+
+	glDeleteShader(vertexShader);
+	glDeleteShader(geometryShader);
+	glDeleteShader(fragmentShader);
+
+	if (!linkSuccess) {
+		glDeleteProgram(shaderProgram);
+		std::cerr << "Couldn't link shader program." << std::endl;
+		return Program{};
+	}
+	
+	Program temp;
+	temp.mHandle = shaderProgram;
+	temp.mBindAttribFragFunc = bindAttribFragFunc;
+	return temp;
+}
 
 // Program: Constructors & destructors
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -262,6 +275,7 @@ Program& Program::operator= (Program&& other) noexcept
 
 Program::~Program() noexcept
 {
+	StateCache::INSTANCE().onProgramDeleted(mHandle);
 	glDeleteProgram(mHandle); // Silently ignored if mHandle == 0.
 }
 
@@ -269,9 +283,15 @@ Program::~Program() noexcept
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 uint32_t compileShader(const char* source, uint32_t shaderType) noexcept
+{
+	return compileShader(source, -1, shaderType);
+}
+
+uint32_t compileShader(const char* source, int32_t length, uint32_t shaderType) noexcept
 {
 	GLuint shader = glCreateShader(shaderType);
-	glShaderSource(shader, 1, &source, NULL);
+	const GLint glLength = length;
+	glShaderSource(shader, 1, &source, length < 0 ? NULL : &glLength);
 	glCompileShader(shader);
 
 	int compileSuccess;
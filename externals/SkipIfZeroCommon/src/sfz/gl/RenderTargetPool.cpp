@@ -0,0 +1,95 @@
+#include "sfz/gl/RenderTargetPool.hpp"
+
+#include <algorithm>
+
+#include "sfz/Assert.hpp"
+#include "sfz/gl/StateCache.hpp"
+
+namespace gl {
+
+// RenderTargetPool: Singleton instance
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+RenderTargetPool& RenderTargetPool::INSTANCE() noexcept
+{
+	static RenderTargetPool pool;
+	return pool;
+}
+
+// RenderTargetPool: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+Framebuffer& RenderTargetPool::acquire(const FramebufferBuilder& builder) noexcept
+{
+	Entry* entryPtr = nullptr;
+	for (auto& entry : mEntries) {
+		if (!entry->inUse && entry->builder == builder) {
+			entryPtr = entry.get();
+			break;
+		}
+	}
+
+	if (entryPtr == nullptr) {
+		mEntries.emplace_back(new Entry);
+		entryPtr = mEntries.back().get();
+		entryPtr->builder = builder;
+		entryPtr->framebuffer = builder.build();
+		entryPtr->sizeBytes = builder.estimatedSizeBytes();
+
+		// Building binds the framebuffer and textures behind the state cache's back
+		StateCache::INSTANCE().invalidate();
+
+		mStats.bytesAllocated += entryPtr->sizeBytes;
+		mStats.numTargets += 1;
+		mStats.numCreatedThisFrame += 1;
+	}
+
+	entryPtr->inUse = true;
+	entryPtr->framesUnused = 0;
+	mStats.bytesInUse += entryPtr->sizeBytes;
+	mStats.peakBytesInUse = std::max(mStats.peakBytesInUse, mStats.bytesInUse);
+	return entryPtr->framebuffer;
+}
+
+void RenderTargetPool::release(const Framebuffer& framebuffer) noexcept
+{
+	for (auto& entry : mEntries) {
+		if (&entry->framebuffer != &framebuffer) continue;
+		sfz_assert_debug(entry->inUse);
+		entry->inUse = false;
+		mStats.bytesInUse -= entry->sizeBytes;
+		return;
+	}
+	sfz_assert_debug_m(false, "Framebuffer was not acquired from this pool");
+}
+
+void RenderTargetPool::newFrame() noexcept
+{
+	for (size_t i = mEntries.size(); i > 0; --i) {
+		Entry& entry = *mEntries[i-1];
+		if (entry.inUse) continue;
+		entry.framesUnused += 1;
+		if (entry.framesUnused > MAX_UNUSED_FRAMES) destroyEntry(i-1);
+	}
+	mStats.peakBytesInUse = mStats.bytesInUse;
+	mStats.numCreatedThisFrame = 0;
+}
+
+void RenderTargetPool::clear() noexcept
+{
+	for (size_t i = mEntries.size(); i > 0; --i) {
+		if (!mEntries[i-1]->inUse) destroyEntry(i-1);
+	}
+}
+
+// RenderTargetPool: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void RenderTargetPool::destroyEntry(size_t index) noexcept
+{
+	mStats.bytesAllocated -= mEntries[index]->sizeBytes;
+	mStats.numTargets -= 1;
+	mEntries.erase(mEntries.begin() + index);
+}
+
+} // namespace gl
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include <sfz/Assert.hpp>
 #include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/StateCache.hpp>
 #include <sfz/math/MathHelpers.hpp>
 
 namespace gl {
@@ -209,20 +210,20 @@ SSAO::SSAO(vec2i dimensions, size_t numSamples, float radius, float minDepthBias
 uint32_t SSAO::calculate(uint32_t linearDepthTex, uint32_t normalTex, const mat4& projMatrix,
                          float farPlaneDist) noexcept
 {
+	StateCache& glState = StateCache::INSTANCE();
+
 	// Occlusion pass
-	glUseProgram(mSSAOProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, mOcclusionFBO.fbo());
-	glViewport(0, 0, mOcclusionFBO.width(), mOcclusionFBO.height());
+	glState.useProgram(mSSAOProgram.handle());
+	glState.bindFramebuffer(mOcclusionFBO.fbo());
+	glState.viewport(mOcclusionFBO.dimensions());
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Texture buffer uniforms
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, linearDepthTex);
+	glState.bindTexture(0, linearDepthTex);
 	gl::setUniform(mSSAOProgram, "uLinearDepthTexture", 0);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, normalTex);
+	glState.bindTexture(1, normalTex);
 	gl::setUniform(mSSAOProgram, "uNormalTexture", 1);
 
 	// Other uniforms
@@ -243,30 +244,28 @@ uint32_t SSAO::calculate(uint32_t linearDepthTex, uint32_t normalTex, const mat4
 
 	if (mBlurOcclusion) {
 		// Horizontal blur pass
-		glUseProgram(mHorizontalBlurProgram.handle());
-		glBindFramebuffer(GL_FRAMEBUFFER, mTempFBO.fbo());
-		glViewport(0, 0, mTempFBO.width(), mTempFBO.height());
+		glState.useProgram(mHorizontalBlurProgram.handle());
+		glState.bindFramebuffer(mTempFBO.fbo());
+		glState.viewport(mTempFBO.dimensions());
 		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 		glClearDepth(1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, mOcclusionFBO.texture(0));
+		glState.bindTexture(0, mOcclusionFBO.texture(0));
 		gl::setUniform(mHorizontalBlurProgram, "uTexture", 0);
 		gl::setUniform(mHorizontalBlurProgram, "uTexelWidth", 1.0f / mDimensions.x);
 
 		mPostProcessQuad.render();
 
 		// Vertical blur pass
-		glUseProgram(mVerticalBlurProgram.handle());
-		glBindFramebuffer(GL_FRAMEBUFFER, mOcclusionFBO.fbo());
-		glViewport(0, 0, mOcclusionFBO.width(), mOcclusionFBO.height());
+		glState.useProgram(mVerticalBlurProgram.handle());
+		glState.bindFramebuffer(mOcclusionFBO.fbo());
+		glState.viewport(mOcclusionFBO.dimensions());
 		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 		glClearDepth(1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, mTempFBO.texture(0));
+		glState.bindTexture(0, mTempFBO.texture(0));
 		gl::setUniform(mVerticalBlurProgram, "uTexture", 0);
 		gl::setUniform(mVerticalBlurProgram, "uTexelHeight", 1.0f / mDimensions.y);
 
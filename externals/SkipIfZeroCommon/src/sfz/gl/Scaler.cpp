@@ -1,10 +1,14 @@
 #include "sfz/gl/Scaler.hpp"
 
 #include <algorithm>
+#include <cmath>
 
+#include "sfz/gl/Framebuffer.hpp"
 #include "sfz/gl/OpenGL.hpp"
 #include "sfz/gl/PostProcessQuad.hpp"
 #include "sfz/gl/Program.hpp"
+#include "sfz/gl/RenderTargetPool.hpp"
+#include "sfz/gl/StateCache.hpp"
 
 namespace gl {
 
@@ -21,13 +25,14 @@ static const char* SINGLE_SAMPLE_SHADER_SRC = R"(
 	uniform sampler2D uSrcTex;
 	uniform vec2 uDstDimensions;
 	uniform vec2 uSrcDimensions;
+	uniform vec2 uUVMax; // Taps are clamped to the source rect
 
 	// Output
 	out vec4 outFragColor;
 
 	void main()
 	{
-		outFragColor = texture(uSrcTex, uvCoord);
+		outFragColor = texture(uSrcTex, min(uvCoord, uUVMax));
 	}
 )";
 
@@ -41,13 +46,14 @@ static const char* GRID_2X2_SHADER_SRC = R"(
 	uniform sampler2D uSrcTex;
 	uniform vec2 uDstDimensions;
 	uniform vec2 uSrcDimensions;
+	uniform vec2 uUVMax; // Taps are clamped to the source rect
 
 	// Output
 	out vec4 outFragColor;
 
 	void main()
 	{
-		vec2 fragSize = vec2(1.0) / uDstDimensions;
+		vec2 fragSize = vec2(dFdx(uvCoord).x, dFdy(uvCoord).y); // Size of a dst pixel in uv space
 		vec2 quartFragSize = fragSize / 4.0;
 
 		vec2 bottomLeftUV = uvCoord - quartFragSize;
@@ -55,8 +61,10 @@ static const char* GRID_2X2_SHADER_SRC = R"(
 		vec2 topLeftUV = uvCoord + vec2(-quartFragSize.x, quartFragSize.y);
 		vec2 topRightUV = uvCoord + quartFragSize;
 
-		outFragColor = (texture(uSrcTex, bottomLeftUV) + texture(uSrcTex, bottomRightUV)
-		             + texture(uSrcTex, topLeftUV) + texture(uSrcTex, topRightUV))/4.0f;
+		outFragColor = (texture(uSrcTex, min(bottomLeftUV, uUVMax))
+		             + texture(uSrcTex, min(bottomRightUV, uUVMax))
+		             + texture(uSrcTex, min(topLeftUV, uUVMax))
+		             + texture(uSrcTex, min(topRightUV, uUVMax)))/4.0f;
 	}
 )";
 
@@ -70,13 +78,14 @@ static const char* GRID_4X4_SHADER_SRC = R"(
 	uniform sampler2D uSrcTex;
 	uniform vec2 uDstDimensions;
 	uniform vec2 uSrcDimensions;
+	uniform vec2 uUVMax; // Taps are clamped to the source rect
 
 	// Output
 	out vec4 outFragColor;
 
 	void main()
 	{
-		vec2 fragSize = vec2(1.0) / uDstDimensions;
+		vec2 fragSize = vec2(dFdx(uvCoord).x, dFdy(uvCoord).y); // Size of a dst pixel in uv space
 		vec2 fragSizeDiv4 = fragSize / 4.0;
 		vec2 fragSizeDiv8 = fragSize / 8.0;
 
@@ -102,25 +111,25 @@ static const char* GRID_4X4_SHADER_SRC = R"(
 		vec2 coord33 = coord32 + vec2(0, fragSizeDiv4.y);
 
 		outFragColor = vec4((
-		             texture(uSrcTex, coord00).rgb
-		             + texture(uSrcTex, coord10).rgb
-		             + texture(uSrcTex, coord20).rgb
-		             + texture(uSrcTex, coord30).rgb
-
-		             + texture(uSrcTex, coord01).rgb
-		             + texture(uSrcTex, coord11).rgb
-		             + texture(uSrcTex, coord21).rgb
-		             + texture(uSrcTex, coord31).rgb
-
-		             + texture(uSrcTex, coord02).rgb
-		             + texture(uSrcTex, coord12).rgb
-		             + texture(uSrcTex, coord22).rgb
-		             + texture(uSrcTex, coord32).rgb
-
-		             + texture(uSrcTex, coord03).rgb
-		             + texture(uSrcTex, coord13).rgb
-		             + texture(uSrcTex, coord23).rgb
-		             + texture(uSrcTex, coord33).rgb) / 16.0, 1.0);
+		             texture(uSrcTex, min(coord00, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord10, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord20, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord30, uUVMax)).rgb
+
+		             + texture(uSrcTex, min(coord01, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord11, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord21, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord31, uUVMax)).rgb
+
+		             + texture(uSrcTex, min(coord02, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord12, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord22, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord32, uUVMax)).rgb
+
+		             + texture(uSrcTex, min(coord03, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord13, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord23, uUVMax)).rgb
+		             + texture(uSrcTex, min(coord33, uUVMax)).rgb) / 16.0, 1.0);
 	}
 )";
 
@@ -134,6 +143,7 @@ static const char* BICUBIC_BSPLINE_SHADER_SRC = R"(
 	uniform sampler2D uSrcTex;
 	uniform vec2 uDstDimensions;
 	uniform vec2 uSrcDimensions;
+	uniform vec2 uUVMax; // Taps are clamped to the source rect
 
 	// Output
 	out vec4 outFragColor;
@@ -210,10 +220,10 @@ static const char* BICUBIC_BSPLINE_SHADER_SRC = R"(
 		vec2 coord11 = cornerCoord1;
 
 		// Take samples
-		vec4 sample00 = texture(uSrcTex, coord00);
-		vec4 sample10 = texture(uSrcTex, coord10);
-		vec4 sample01 = texture(uSrcTex, coord01);
-		vec4 sample11 = texture(uSrcTex, coord11);
+		vec4 sample00 = texture(uSrcTex, min(coord00, uUVMax));
+		vec4 sample10 = texture(uSrcTex, min(coord10, uUVMax));
+		vec4 sample01 = texture(uSrcTex, min(coord01, uUVMax));
+		vec4 sample11 = texture(uSrcTex, min(coord11, uUVMax));
 
 		// Calculate scale used to scale samples
 		vec2 scale0 = w0 + w1;
@@ -234,6 +244,7 @@ static const char* LANCZOS_2_SHADER_SRC = R"(
 	uniform sampler2D uSrcTex;
 	uniform vec2 uDstDimensions;
 	uniform vec2 uSrcDimensions;
+	uniform vec2 uUVMax; // Taps are clamped to the source rect
 
 	// Output
 	out vec4 outFragColor;
@@ -295,25 +306,25 @@ static const char* LANCZOS_2_SHADER_SRC = R"(
 		// Sample source texture
 		vec3 sum = vec3(0.0);
 
-		sum += (xWeights[0] * yWeights[0] * texture(uSrcTex, coord00).rgb);
-		sum += (xWeights[0] * yWeights[1] * texture(uSrcTex, coord01).rgb);
-		sum += (xWeights[0] * yWeights[2] * texture(uSrcTex, coord02).rgb);
-		sum += (xWeights[0] * yWeights[3] * texture(uSrcTex, coord03).rgb);
-
-		sum += (xWeights[1] * yWeights[0] * texture(uSrcTex, coord10).rgb);
-		sum += (xWeights[1] * yWeights[1] * texture(uSrcTex, coord11).rgb);
-		sum += (xWeights[1] * yWeights[2] * texture(uSrcTex, coord12).rgb);
-		sum += (xWeights[1] * yWeights[3] * texture(uSrcTex, coord13).rgb);
-
-		sum += (xWeights[2] * yWeights[0] * texture(uSrcTex, coord20).rgb);
-		sum += (xWeights[2] * yWeights[1] * texture(uSrcTex, coord21).rgb);
-		sum += (xWeights[2] * yWeights[2] * texture(uSrcTex, coord22).rgb);
-		sum += (xWeights[2] * yWeights[3] * texture(uSrcTex, coord23).rgb);
-
-		sum += (xWeights[3] * yWeights[0] * texture(uSrcTex, coord30).rgb);
-		sum += (xWeights[3] * yWeights[1] * texture(uSrcTex, coord31).rgb);
-		sum += (xWeights[3] * yWeights[2] * texture(uSrcTex, coord32).rgb);
-		sum += (xWeights[3] * yWeights[3] * texture(uSrcTex, coord33).rgb);
+		sum += (xWeights[0] * yWeights[0] * texture(uSrcTex, min(coord00, uUVMax)).rgb);
+		sum += (xWeights[0] * yWeights[1] * texture(uSrcTex, min(coord01, uUVMax)).rgb);
+		sum += (xWeights[0] * yWeights[2] * texture(uSrcTex, min(coord02, uUVMax)).rgb);
+		sum += (xWeights[0] * yWeights[3] * texture(uSrcTex, min(coord03, uUVMax)).rgb);
+
+		sum += (xWeights[1] * yWeights[0] * texture(uSrcTex, min(coord10, uUVMax)).rgb);
+		sum += (xWeights[1] * yWeights[1] * texture(uSrcTex, min(coord11, uUVMax)).rgb);
+		sum += (xWeights[1] * yWeights[2] * texture(uSrcTex, min(coord12, uUVMax)).rgb);
+		sum += (xWeights[1] * yWeights[3] * texture(uSrcTex, min(coord13, uUVMax)).rgb);
+
+		sum += (xWeights[2] * yWeights[0] * texture(uSrcTex, min(coord20, uUVMax)).rgb);
+		sum += (xWeights[2] * yWeights[1] * texture(uSrcTex, min(coord21, uUVMax)).rgb);
+		sum += (xWeights[2] * yWeights[2] * texture(uSrcTex, min(coord22, uUVMax)).rgb);
+		sum += (xWeights[2] * yWeights[3] * texture(uSrcTex, min(coord23, uUVMax)).rgb);
+
+		sum += (xWeights[3] * yWeights[0] * texture(uSrcTex, min(coord30, uUVMax)).rgb);
+		sum += (xWeights[3] * yWeights[1] * texture(uSrcTex, min(coord31, uUVMax)).rgb);
+		sum += (xWeights[3] * yWeights[2] * texture(uSrcTex, min(coord32, uUVMax)).rgb);
+		sum += (xWeights[3] * yWeights[3] * texture(uSrcTex, min(coord33, uUVMax)).rgb);
 		
 		outFragColor = vec4(sum / totalWeight, 1.0);
 	}
@@ -329,6 +340,7 @@ static const char* LANCZOS_3_SHADER_SRC = R"(
 	uniform sampler2D uSrcTex;
 	uniform vec2 uDstDimensions;
 	uniform vec2 uSrcDimensions;
+	uniform vec2 uUVMax; // Taps are clamped to the source rect
 
 	// Output
 	out vec4 outFragColor;
@@ -364,7 +376,7 @@ static const char* LANCZOS_3_SHADER_SRC = R"(
 				float yf = float(y);
 				float yWeight = L(yf - texCenterOffs.y);
 				vec2 coord = (texCenter + vec2(xf, yf)) * texelSize;
-				sum += (xWeight * yWeight * texture(uSrcTex, coord).rgb);
+				sum += (xWeight * yWeight * texture(uSrcTex, min(coord, uUVMax)).rgb);
 
 				totalWeight += (xWeight * yWeight);
 			}
@@ -374,6 +386,112 @@ static const char* LANCZOS_3_SHADER_SRC = R"(
 	}
 )";
 
+// Used for both passes of the separable algorithms. The weights are normalized when the table is
+// built, so unlike above the sum doesn't need to be divided by the total weight.
+static const char* LANCZOS_SEPARABLE_SHADER_SRC = R"(
+	#version 330
+
+	// Input
+	in vec2 uvCoord;
+
+	// Uniforms
+	uniform sampler2D uSrcTex;
+	uniform sampler2D uWeightsTex; // Two RGBA texels of tap weights per phase
+	uniform vec2 uDstDimensions;
+	uniform vec2 uSrcDimensions;
+	uniform vec2 uDirection; // (1, 0) for the horizontal pass, (0, 1) for the vertical pass
+	uniform vec2 uSrcRectDimensions; // Taps are clamped to the texels inside the source rect
+	uniform int uNumTaps;
+	uniform int uNumPhases;
+
+	// Output
+	out vec4 outFragColor;
+
+	void main()
+	{
+		vec2 texelSize = vec2(1.0 / uSrcDimensions);
+		vec2 pixCoord = uvCoord * uSrcDimensions;
+		vec2 texCenter = floor(pixCoord - vec2(0.5)) + vec2(0.5); // Nearest texel center below
+		float phase = dot(pixCoord - texCenter, uDirection); // [0, 1)
+
+		int row = int(floor(phase * float(uNumPhases) + 0.5));
+		vec4 w0 = texelFetch(uWeightsTex, ivec2(0, row), 0);
+		vec4 w1 = texelFetch(uWeightsTex, ivec2(1, row), 0);
+		float weights[8] = float[8](w0.x, w0.y, w0.z, w0.w, w1.x, w1.y, w1.z, w1.w);
+
+		// The other axis is already at a texel center, since the intermediate target has the
+		// same number of pixels along it as the source
+		vec2 firstCoord = mix(pixCoord, texCenter, uDirection) - float(uNumTaps / 2 - 1) * uDirection;
+		vec2 minCoord = vec2(0.5);
+		vec2 maxCoord = uSrcRectDimensions - vec2(0.5);
+		vec3 sum = vec3(0.0);
+		for (int i = 0; i < uNumTaps; ++i) {
+			vec2 coord = clamp(firstCoord + float(i) * uDirection, minCoord, maxCoord);
+			sum += weights[i] * texture(uSrcTex, coord * texelSize).rgb;
+		}
+
+		outFragColor = vec4(sum, 1.0);
+	}
+)";
+
+// Phases are exact if the destination has at most half this many pixels per repetition of the
+// sampling pattern (e.g. 2 for 1080p -> 4K, 4 for 1080p -> 1440p), otherwise rounded.
+static const int32_t MAX_WEIGHT_PHASES = 256;
+
+static float lanczos(float x, float a) noexcept
+{
+	if (x == 0.0f) return 1.0f;
+	if (std::abs(x) >= a) return 0.0f;
+	const float PI = 3.14159265358979323846f;
+	const float PIx = PI * x;
+	return (a * std::sin(PIx) * std::sin(PIx / a)) / (PI * PI * x * x);
+}
+
+static int32_t greatestCommonDivisor(int32_t a, int32_t b) noexcept
+{
+	while (b != 0) {
+		int32_t tmp = a % b;
+		a = b;
+		b = tmp;
+	}
+	return a;
+}
+
+// Row k of the table holds the weights of the taps [-N/2+1, N/2] relative to the nearest texel
+// center below the sampling position, when the sampling position is k/numPhases texels past it.
+static void updateWeightTable(int32_t& numPhases, uint32_t& texture, int32_t srcSize, int32_t dstSize,
+                              int32_t numTaps) noexcept
+{
+	sfz_assert_debug(numTaps <= 8);
+
+	// Output pixel x samples at (x + 0.5) * src/dst, which gives phases that are multiples of
+	// 1/(2*period) where period is the number of output pixels before the pattern repeats
+	const int32_t period = dstSize / greatestCommonDivisor(dstSize, srcSize);
+	numPhases = std::min(2 * period, MAX_WEIGHT_PHASES);
+
+	const int32_t halfNumTaps = numTaps / 2;
+	float weights[(MAX_WEIGHT_PHASES + 1) * 8];
+	for (int32_t k = 0; k <= numPhases; ++k) {
+		const float phase = float(k) / float(numPhases);
+		float* row = weights + k * 8;
+
+		float totalWeight = 0.0f;
+		for (int32_t i = 0; i < 8; ++i) {
+			row[i] = (i < numTaps) ? lanczos(float(i - halfNumTaps + 1) - phase, float(halfNumTaps)) : 0.0f;
+			totalWeight += row[i];
+		}
+		for (int32_t i = 0; i < numTaps; ++i) {
+			row[i] /= totalWeight;
+		}
+	}
+
+	if (texture == 0) glGenTextures(1, &texture);
+	StateCache::INSTANCE().bindTexture(1, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, 2, numPhases + 1, 0, GL_RGBA, GL_FLOAT, weights);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
 // Scaling algorithm enum
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -389,6 +507,8 @@ const char* to_string(ScalingAlgorithm algorithm) noexcept
 	case ScalingAlgorithm::BICUBIC_BSPLINE: return "BICUBIC_BSPLINE";
 	case ScalingAlgorithm::LANCZOS_2: return "LANCZOS_2";
 	case ScalingAlgorithm::LANCZOS_3: return "LANCZOS_3";
+	case ScalingAlgorithm::LANCZOS_2_SEPARABLE: return "LANCZOS_2_SEPARABLE";
+	case ScalingAlgorithm::LANCZOS_3_SEPARABLE: return "LANCZOS_3_SEPARABLE";
 	default:
 		sfz_assert_release_m(false, "Invalid or unhandled enum type.");
 	}
@@ -407,18 +527,29 @@ Scaler::Scaler(Scaler&& other) noexcept
 {
 	std::swap(this->mScalingAlgorithm, other.mScalingAlgorithm);
 	std::swap(this->mProgram, other.mProgram);
+	std::swap(this->mSamplerObject, other.mSamplerObject);
+	std::swap(this->mNumTaps, other.mNumTaps);
+	std::swap(this->mWeights, other.mWeights);
 }
 
 Scaler& Scaler::operator= (Scaler&& other) noexcept
 {
 	std::swap(this->mScalingAlgorithm, other.mScalingAlgorithm);
 	std::swap(this->mProgram, other.mProgram);
+	std::swap(this->mSamplerObject, other.mSamplerObject);
+	std::swap(this->mNumTaps, other.mNumTaps);
+	std::swap(this->mWeights, other.mWeights);
 	return *this;
 }
 
 Scaler::~Scaler() noexcept
 {
 	glDeleteSamplers(1, &mSamplerObject);
+	for (WeightTable& table : mWeights) {
+		if (table.texture == 0) continue;
+		StateCache::INSTANCE().onTextureDeleted(table.texture);
+		glDeleteTextures(1, &table.texture);
+	}
 }
 
 // Scaler: Public methods
@@ -431,26 +562,37 @@ void Scaler::scale(uint32_t dstFBO, vec2 dstDimensions, uint32_t srcTex, vec2 sr
 
 void Scaler::scale(uint32_t dstFBO, const AABB2D& dstViewport, uint32_t srcTex, vec2 srcDimensions) noexcept
 {
+	scale(dstFBO, dstViewport, srcTex, srcDimensions, srcDimensions);
+}
+
+void Scaler::scale(uint32_t dstFBO, const AABB2D& dstViewport, uint32_t srcTex, vec2 srcDimensions,
+                   vec2 srcRectDimensions) noexcept
+{
+	if (mNumTaps != 0) {
+		scaleSeparable(dstFBO, dstViewport, srcTex, srcDimensions, srcRectDimensions);
+		return;
+	}
+
+	StateCache& glState = StateCache::INSTANCE();
+
 	// Bind shader, framebuffer and viewport
-	glUseProgram(mProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, dstFBO);
-	glViewport(dstViewport.min.x, dstViewport.min.y, dstViewport.width(), dstViewport.height());
+	glState.useProgram(mProgram.handle());
+	glState.bindFramebuffer(dstFBO);
+	glState.viewport(dstViewport);
 
 	// Bind src texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, srcTex);
+	glState.bindTexture(0, srcTex);
 	gl::setUniform(mProgram, "uSrcTex", 0);
 	glBindSampler(0, mSamplerObject);
 
 	gl::setUniform(mProgram, "uDstDimensions", dstViewport.dimensions());
 	gl::setUniform(mProgram, "uSrcDimensions", srcDimensions);
+	gl::setUniform(mProgram, "uUVScale", srcRectDimensions / srcDimensions);
+	gl::setUniform(mProgram, "uUVMax", (srcRectDimensions - vec2{0.5f}) / srcDimensions); // Last texel center
 
 	mQuad.render();
 
 	// Cleanup
-	glUseProgram(0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glBindTexture(GL_TEXTURE_2D, 0);
 	glBindSampler(0, 0);
 }
 
@@ -461,6 +603,11 @@ void Scaler::changeScalingAlgorithm(ScalingAlgorithm newAlgo) noexcept
 	mScalingAlgorithm = newAlgo;
 	glDeleteSamplers(1, &mSamplerObject);
 	glGenSamplers(1, &mSamplerObject);
+	mNumTaps = 0;
+	for (WeightTable& table : mWeights) {
+		table.srcSize = -1;
+		table.dstSize = -1;
+	}
 
 	switch (mScalingAlgorithm) {
 	case ScalingAlgorithm::NEAREST:
@@ -526,9 +673,94 @@ void Scaler::changeScalingAlgorithm(ScalingAlgorithm newAlgo) noexcept
 		glSamplerParameteri(mSamplerObject, GL_TEXTURE_WRAP_S, GL_CLAMP);
 		glSamplerParameteri(mSamplerObject, GL_TEXTURE_WRAP_T, GL_CLAMP);
 		break;
+	case ScalingAlgorithm::LANCZOS_2_SEPARABLE:
+		mProgram = gl::Program::postProcessFromSource(LANCZOS_SEPARABLE_SHADER_SRC);
+		mNumTaps = 4;
+		glSamplerParameteri(mSamplerObject, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glSamplerParameteri(mSamplerObject, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glSamplerParameteri(mSamplerObject, GL_TEXTURE_WRAP_S, GL_CLAMP);
+		glSamplerParameteri(mSamplerObject, GL_TEXTURE_WRAP_T, GL_CLAMP);
+		break;
+	case ScalingAlgorithm::LANCZOS_3_SEPARABLE:
+		mProgram = gl::Program::postProcessFromSource(LANCZOS_SEPARABLE_SHADER_SRC);
+		mNumTaps = 6;
+		glSamplerParameteri(mSamplerObject, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glSamplerParameteri(mSamplerObject, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glSamplerParameteri(mSamplerObject, GL_TEXTURE_WRAP_S, GL_CLAMP);
+		glSamplerParameteri(mSamplerObject, GL_TEXTURE_WRAP_T, GL_CLAMP);
+		break;
 	default:
 		sfz_assert_release_m(false, "Invalid scaling algorithm.");
 	}
 }
 
+// Scaler: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void Scaler::scaleSeparable(uint32_t dstFBO, const AABB2D& dstViewport, uint32_t srcTex, vec2 srcDimensions,
+                            vec2 srcRectDimensions) noexcept
+{
+	StateCache& glState = StateCache::INSTANCE();
+	RenderTargetPool& pool = RenderTargetPool::INSTANCE();
+
+	const vec2 dstDim = dstViewport.dimensions();
+	const int32_t dstWidth = (int32_t)std::round(dstDim.x);
+	const int32_t dstHeight = (int32_t)std::round(dstDim.y);
+	const int32_t srcRectWidth = (int32_t)std::round(srcRectDimensions.x);
+	const int32_t srcRectHeight = (int32_t)std::round(srcRectDimensions.y);
+
+	for (int32_t axis = 0; axis < 2; ++axis) {
+		WeightTable& table = mWeights[axis];
+		const int32_t srcSize = (axis == 0) ? srcRectWidth : srcRectHeight;
+		const int32_t dstSize = (axis == 0) ? dstWidth : dstHeight;
+		if (table.srcSize == srcSize && table.dstSize == dstSize) continue;
+		updateWeightTable(table.numPhases, table.texture, srcSize, dstSize, mNumTaps);
+		table.srcSize = srcSize;
+		table.dstSize = dstSize;
+	}
+
+	// The intermediate target is as tall as the whole source, so that the pooled framebuffer can
+	// be reused when only the size of the source rect changes (e.g. with dynamic resolution). Only
+	// the rows of the source rect are written, the vertical pass never samples the others.
+	const vec2i tempDim{dstWidth, (int32_t)srcDimensions.y};
+	const Framebuffer& tempFB = pool.acquire(FramebufferBuilder{tempDim}
+	                            .addTexture(0, FBTextureFormat::RGB_F16, FBTextureFiltering::NEAREST));
+
+	glState.useProgram(mProgram.handle());
+	gl::setUniform(mProgram, "uSrcTex", 0);
+	gl::setUniform(mProgram, "uWeightsTex", 1);
+	gl::setUniform(mProgram, "uNumTaps", mNumTaps);
+	glBindSampler(0, mSamplerObject);
+
+	// Horizontal pass, from the source rect to dst width x source rect height
+	glState.bindFramebuffer(tempFB.fbo());
+	glState.viewport(0, 0, dstWidth, srcRectHeight);
+	glState.bindTexture(0, srcTex);
+	glState.bindTexture(1, mWeights[0].texture);
+	gl::setUniform(mProgram, "uNumPhases", mWeights[0].numPhases);
+	gl::setUniform(mProgram, "uDirection", vec2{1.0f, 0.0f});
+	gl::setUniform(mProgram, "uSrcDimensions", srcDimensions);
+	gl::setUniform(mProgram, "uSrcRectDimensions", srcRectDimensions);
+	gl::setUniform(mProgram, "uUVScale", srcRectDimensions / srcDimensions);
+
+	mQuad.render();
+
+	// Vertical pass, from the intermediate target to the destination viewport
+	glState.bindFramebuffer(dstFBO);
+	glState.viewport(dstViewport);
+	glState.bindTexture(0, tempFB.texture(0));
+	glState.bindTexture(1, mWeights[1].texture);
+	gl::setUniform(mProgram, "uNumPhases", mWeights[1].numPhases);
+	gl::setUniform(mProgram, "uDirection", vec2{0.0f, 1.0f});
+	gl::setUniform(mProgram, "uSrcDimensions", vec2{(float)tempDim.x, (float)tempDim.y});
+	gl::setUniform(mProgram, "uSrcRectDimensions", vec2{(float)dstWidth, (float)srcRectHeight});
+	gl::setUniform(mProgram, "uUVScale", vec2{1.0f, srcRectDimensions.y / srcDimensions.y});
+
+	mQuad.render();
+
+	// Cleanup
+	glBindSampler(0, 0);
+	pool.release(tempFB);
+}
+
 } // namespace sfz
\ No newline at end of file
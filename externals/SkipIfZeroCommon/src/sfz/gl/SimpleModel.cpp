@@ -3,13 +3,18 @@
 #include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <istream>
+#include <map>
 #include <new>
+#include <streambuf>
 #include <string>
 #include <vector>
 
 #include "tiny_obj_loader.h"
 
+#include "sfz/gl/GpuMemoryTracker.hpp"
 #include "sfz/gl/OpenGL.hpp"
+#include "sfz/util/MappedFile.hpp"
 
 namespace gl {
 
@@ -19,15 +24,57 @@ using std::vector;
 using tinyobj::shape_t;
 using tinyobj::material_t;
 
+// Static functions & classes
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** A stream reading directly from memory, so that tinyobjloader doesn't need a copy of the file. */
+class MemoryStreamBuf final : public std::streambuf {
+public:
+	MemoryStreamBuf(const uint8_t* data, size_t size) noexcept
+	{
+		// The get area is only read from, std::streambuf just lacks a const variant
+		char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+		this->setg(begin, begin, begin + size);
+	}
+};
+
+/** Used when there is no directory to look for .mtl files in, leaves the material list empty. */
+class NoMaterialReader final : public tinyobj::MaterialReader {
+public:
+	virtual std::string operator()(const std::string&, std::vector<material_t>&,
+	                               std::map<std::string, int>&) override
+	{
+		return "";
+	}
+};
+
 // SimpleModel: Constructors & destructors
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 SimpleModel::SimpleModel(const char* basePath, const char* filename) noexcept
+{
+	const string path = string(basePath) + filename;
+	const sfz::MappedFile file{path.c_str()};
+	if (!file.isValid()) {
+		std::cerr << "Cannot open model file [" << path << "]" << std::endl;
+		return;
+	}
+	*this = SimpleModel{filename, file.data(), file.size(), basePath};
+}
+
+SimpleModel::SimpleModel(const char* name, const uint8_t* data, size_t size, const char* mtlBasePath) noexcept
 {
 	vector<shape_t> shapes;
 	vector<material_t> materials;
 
-	string error = tinyobj::LoadObj(shapes, materials, (string(basePath) + filename).c_str(), basePath);
+	MemoryStreamBuf buffer{data, size};
+	std::istream stream{&buffer};
+	tinyobj::MaterialFileReader fileMaterialReader{mtlBasePath != nullptr ? mtlBasePath : ""};
+	NoMaterialReader noMaterialReader;
+	tinyobj::MaterialReader& materialReader = (mtlBasePath != nullptr) ?
+	    static_cast<tinyobj::MaterialReader&>(fileMaterialReader) : noMaterialReader;
+
+	string error = tinyobj::LoadObj(shapes, materials, stream, materialReader);
 
 	if (!error.empty()) {
 		std::cerr << error << std::endl;
@@ -36,12 +83,12 @@ SimpleModel::SimpleModel(const char* basePath, const char* filename) noexcept
 
 	// Make sure shapes has required properties
 	if (shapes.size() == 0) {
-		std::cerr << "Model \"" << filename << "\" has no shapes\n";
+		std::cerr << "Model \"" << name << "\" has no shapes\n";
 		return;
 	}
 	for (size_t i = 0; i < shapes.size(); ++i) {
 		if (shapes[i].mesh.normals.size() == 0) {
-			std::cerr << "Model \"" << filename << "\" shape " << i << " has no normals\n";
+			std::cerr << "Model \"" << name << "\" shape " << i << " has no normals\n";
 			return;
 		}
 	}
@@ -62,6 +109,7 @@ SimpleModel::SimpleModel(const char* basePath, const char* filename) noexcept
 
 	mVAORenderingInfos = unique_ptr<VAORenderingInfo[]>{new (std::nothrow) VAORenderingInfo[shapes.size()]};
 	mVAOBufferInfos = unique_ptr<VAOBufferInfo[]>{new (std::nothrow) VAOBufferInfo[shapes.size()]};
+	size_t sizeBytes = 0;
 
 	for (size_t i = 0; i < shapes.size(); ++i) {
 		auto& shape = shapes[i];
@@ -99,6 +147,12 @@ SimpleModel::SimpleModel(const char* basePath, const char* filename) noexcept
 		glGenBuffers(1, &bufferInfo.materialIDBuffer);
 		glBindBuffer(GL_ARRAY_BUFFER, bufferInfo.materialIDBuffer);
 		glBufferData(GL_ARRAY_BUFFER, shape.mesh.material_ids.size()*sizeof(int), shape.mesh.material_ids.data(), GL_STATIC_DRAW);
+
+		sizeBytes += shape.mesh.positions.size()*sizeof(float);
+		sizeBytes += shape.mesh.normals.size()*sizeof(float);
+		sizeBytes += (2*shape.mesh.positions.size()/3)*sizeof(float);
+		sizeBytes += shape.mesh.indices.size()*sizeof(unsigned int);
+		sizeBytes += shape.mesh.material_ids.size()*sizeof(int);
 		
 		// Bind buffers to VAO
 		glBindVertexArray(renderingInfo.vao);
@@ -122,21 +176,32 @@ SimpleModel::SimpleModel(const char* basePath, const char* filename) noexcept
 
 	mNumVAOs = shapes.size();
 	delete[] defaultUVArray;
+
+	mMemoryId = GpuMemoryTracker::INSTANCE().add(GpuMemoryCategory::MESH, name, sizeBytes);
 }
 
 SimpleModel::SimpleModel(SimpleModel&& other) noexcept
 {
 	std::swap(this->mVAORenderingInfos, other.mVAORenderingInfos);
 	std::swap(this->mVAOBufferInfos, other.mVAOBufferInfos);
+	std::swap(this->mNumVAOs, other.mNumVAOs);
+	std::swap(this->mMemoryId, other.mMemoryId);
 }
 
 SimpleModel& SimpleModel::operator= (SimpleModel&& other) noexcept
 {
 	std::swap(this->mVAORenderingInfos, other.mVAORenderingInfos);
 	std::swap(this->mVAOBufferInfos, other.mVAOBufferInfos);
+	std::swap(this->mNumVAOs, other.mNumVAOs);
+	std::swap(this->mMemoryId, other.mMemoryId);
 	return *this;
 }
 
+SimpleModel::~SimpleModel() noexcept
+{
+	GpuMemoryTracker::INSTANCE().remove(mMemoryId);
+}
+
 // SimpleModel: Public methods
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -150,6 +215,16 @@ void SimpleModel::render() noexcept
 	}
 }
 
+void SimpleModel::renderInstanced(uint32_t numInstances) noexcept
+{
+	for (size_t i = 0; i < mNumVAOs; ++i) {
+		const VAORenderingInfo& info = mVAORenderingInfos[i];
+		glBindVertexArray(info.vao);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, info.indexBuffer);
+		glDrawElementsInstanced(GL_TRIANGLES, info.numIndices, GL_UNSIGNED_INT, 0, numInstances);
+	}
+}
+
 // SimpleModel: Private classes
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -1,11 +1,15 @@
 #include "sfz/gl/SpriteBatch.hpp"
 
 #include "sfz/Assert.hpp"
+#include "sfz/gl/GpuMemoryTracker.hpp"
 #include "sfz/gl/OpenGL.hpp"
+#include "sfz/gl/StateCache.hpp"
 
-#include <new> // std::nothrow
 #include <algorithm> // std::swap
 #include <cmath>
+#include <cstddef> // offsetof
+#include <cstdint>
+#include <cstdio>
 
 namespace gl {
 
@@ -71,6 +75,11 @@ gl::Program compileSpriteBatchShaderProgram(const char* vertexSrc, const char* f
 	});
 }
 
+bool rangesOverlap(size_t begin1, size_t end1, size_t begin2, size_t end2) noexcept
+{
+	return begin1 < end2 && begin2 < end1;
+}
+
 } // anonymous namespace
 
 // SpriteBatch: Constructors & destructors
@@ -84,11 +93,12 @@ SpriteBatch::SpriteBatch(size_t capacity, const char* fragmentShaderSrc) noexcep
 :
 	mCapacity{capacity},
 	mCurrentDrawCount{0},
-	mTransformArray{new (std::nothrow) mat3[mCapacity]},
-	mUVArray{new (std::nothrow) vec4[mCapacity]}
+	mRingSize{sizeof(Sprite) * capacity * RING_SIZE_IN_BATCHES},
+	mFences{MAX_PENDING_BATCHES}
 {
 	static_assert(sizeof(vec2) == sizeof(float)*2, "vec2 is padded");
 	static_assert(sizeof(mat3) == sizeof(float)*9, "mat3 is padded");
+	static_assert(sizeof(Sprite) == sizeof(float)*13, "Sprite is padded");
 
 	// Vertex buffer
 	const float vertices[] = {
@@ -101,15 +111,18 @@ SpriteBatch::SpriteBatch(size_t capacity, const char* fragmentShaderSrc) noexcep
 	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-	// Transform buffer (null now, to be updated when rendering batch)
-	glGenBuffers(1, &mTransformBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, mTransformBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(mat3)*mCapacity, NULL, GL_STREAM_DRAW);
-
-	// UV buffer (null now, to be updated when rendering batch)
-	glGenBuffers(1, &mUVBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, mUVBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vec4)*mCapacity, NULL, GL_STREAM_DRAW);
+	// Stream buffer with the transform and uv of each sprite, written to when drawing
+	glGenBuffers(1, &mStreamBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, mStreamBuffer);
+	mPersistent = GLEW_ARB_buffer_storage && mRingSize != 0;
+	if (mPersistent) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, mRingSize, NULL, flags);
+		mPersistentPtr = glMapBufferRange(GL_ARRAY_BUFFER, 0, mRingSize, flags | GL_MAP_FLUSH_EXPLICIT_BIT);
+		if (mPersistentPtr == nullptr) sfz_error("SpriteBatch: Couldn't map stream buffer.");
+	} else {
+		glBufferData(GL_ARRAY_BUFFER, mRingSize, NULL, GL_STREAM_DRAW);
+	}
 
 	// Index buffer
 	const unsigned int indices[] = {
@@ -120,7 +133,7 @@ SpriteBatch::SpriteBatch(size_t capacity, const char* fragmentShaderSrc) noexcep
 	glBindBuffer(GL_ARRAY_BUFFER, mIndexBuffer);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
-	// Vertex Array Object
+	// Vertex Array Object, the stream attributes are pointed at the current batch in end()
 	glGenVertexArrays(1, &mVAO);
 	glBindVertexArray(mVAO);
 
@@ -128,21 +141,20 @@ SpriteBatch::SpriteBatch(size_t capacity, const char* fragmentShaderSrc) noexcep
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
 	glEnableVertexAttribArray(0);
 
-	glBindBuffer(GL_ARRAY_BUFFER, mTransformBuffer);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(mat3), (void*)(sizeof(float)*3*0));
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(mat3), (void*)(sizeof(float)*3*1));
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(mat3), (void*)(sizeof(float)*3*2));
+	glBindBuffer(GL_ARRAY_BUFFER, mStreamBuffer);
 	glEnableVertexAttribArray(1);
 	glEnableVertexAttribArray(2);
 	glEnableVertexAttribArray(3);
-
-	glBindBuffer(GL_ARRAY_BUFFER, mUVBuffer);
-	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 0, NULL);
 	glEnableVertexAttribArray(4);
 
 	// Create shader program and bind uniform
 	mShader = compileSpriteBatchShaderProgram(VERTEX_SHADER_SRC, fragmentShaderSrc);
 	mTextureUniformLoc = glGetUniformLocation(mShader.handle(), "uTexture");
+
+	char label[64];
+	std::snprintf(label, sizeof(label), "SpriteBatch (capacity %u)", (uint32_t)mCapacity);
+	const size_t sizeBytes = sizeof(vertices) + sizeof(indices) + mRingSize;
+	mMemoryId = GpuMemoryTracker::INSTANCE().add(GpuMemoryCategory::SPRITE_BATCH, label, sizeBytes);
 }
 
 SpriteBatch::SpriteBatch(SpriteBatch&& other) noexcept
@@ -159,25 +171,38 @@ SpriteBatch& SpriteBatch::operator= (SpriteBatch&& other) noexcept
 	std::swap(mCamProj, other.mCamProj);
 
 	std::swap(mShader, other.mShader);
+	std::swap(mTextureUniformLoc, other.mTextureUniformLoc);
 	std::swap(mVAO, other.mVAO);
 	std::swap(mVertexBuffer, other.mVertexBuffer);
 	std::swap(mIndexBuffer, other.mIndexBuffer);
-	std::swap(mTransformBuffer, other.mTransformBuffer);
-	std::swap(mUVBuffer, other.mUVBuffer);
+	std::swap(mStreamBuffer, other.mStreamBuffer);
+	std::swap(mMemoryId, other.mMemoryId);
 
-	std::swap(mTransformArray, other.mTransformArray);
-	std::swap(mUVArray, other.mUVArray);
+	std::swap(mPersistent, other.mPersistent);
+	std::swap(mPersistentPtr, other.mPersistentPtr);
+	std::swap(mSprites, other.mSprites);
+	std::swap(mRingSize, other.mRingSize);
+	std::swap(mBatchOffset, other.mBatchOffset);
+
+	std::swap(mFences, other.mFences);
+	std::swap(mFenceBegins, other.mFenceBegins);
+	std::swap(mFenceEnds, other.mFenceEnds);
 
 	return *this;
 }
 
 SpriteBatch::~SpriteBatch() noexcept
 {
+	if (mSprites != nullptr && !mPersistent) {
+		glBindBuffer(GL_ARRAY_BUFFER, mStreamBuffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+
 	glDeleteBuffers(1, &mVertexBuffer);
 	glDeleteBuffers(1, &mIndexBuffer);
-	glDeleteBuffers(1, &mTransformBuffer);
-	glDeleteBuffers(1, &mUVBuffer);
+	glDeleteBuffers(1, &mStreamBuffer); // Also unmaps the persistent mapping
 	glDeleteVertexArrays(1, &mVAO);
+	GpuMemoryTracker::INSTANCE().remove(mMemoryId);
 }
 
 // SpriteBatch: Public interface
@@ -192,6 +217,7 @@ void SpriteBatch::begin(vec2 cameraPosition, vec2 cameraDimensions) noexcept
 {
 	mCamProj = sfz::glOrthogonalProjectionMatrix2D(cameraPosition, cameraDimensions);
 	mCurrentDrawCount = 0;
+	if (mSprites == nullptr) reserveBatch(); // Otherwise begin() was called again without end()
 }
 
 void SpriteBatch::draw(const AABB2D& rect, const TextureRegion& texRegion) noexcept
@@ -205,14 +231,15 @@ void SpriteBatch::draw(vec2 position, vec2 dimensions, const TextureRegion& texR
 					{0.0f, dimensions[1], position[1]},
 	                {0.0f, 0.0f, 1.0f}};
 
-	// Setting transform & uv arrays
-	mTransformArray[mCurrentDrawCount] = mCamProj * transform;
-	mUVArray[mCurrentDrawCount] = vec4{texRegion.mUVMin[0], texRegion.mUVMin[1],
-	                                    texRegion.mUVMax[0], texRegion.mUVMax[1]};
+	// Writing the sprite straight to the mapped stream buffer
+	sfz_assert_debug(mSprites != nullptr);
+	sfz_assert_debug(mCurrentDrawCount < mCapacity);
+	Sprite& sprite = mSprites[mCurrentDrawCount];
+	sprite.transform = mCamProj * transform;
+	sprite.uv = vec4{texRegion.mUVMin[0], texRegion.mUVMin[1], texRegion.mUVMax[0], texRegion.mUVMax[1]};
 
 	// Incrementing current draw count
 	mCurrentDrawCount++;
-	sfz_assert_debug(mCurrentDrawCount <= mCapacity);
 }
 
 void SpriteBatch::draw(vec2 position, vec2 dimensions, float angleRads,
@@ -225,14 +252,15 @@ void SpriteBatch::draw(vec2 position, vec2 dimensions, float angleRads,
 	mat3 transform = rotMat * scaling;
 	transform.setColumn(2, vec3{position[0], position[1], 1.0f});
 
-	// Setting transform & uv arrays
-	mTransformArray[mCurrentDrawCount] = mCamProj * transform;
-	mUVArray[mCurrentDrawCount] = vec4{texRegion.mUVMin[0], texRegion.mUVMin[1],
-	                                    texRegion.mUVMax[0], texRegion.mUVMax[1]};
+	// Writing the sprite straight to the mapped stream buffer
+	sfz_assert_debug(mSprites != nullptr);
+	sfz_assert_debug(mCurrentDrawCount < mCapacity);
+	Sprite& sprite = mSprites[mCurrentDrawCount];
+	sprite.transform = mCamProj * transform;
+	sprite.uv = vec4{texRegion.mUVMin[0], texRegion.mUVMin[1], texRegion.mUVMax[0], texRegion.mUVMax[1]};
 
 	// Incrementing current draw count
 	mCurrentDrawCount++;
-	sfz_assert_debug(mCurrentDrawCount <= mCapacity);
 }
 
 void SpriteBatch::end(uint32_t fbo, vec2 viewportDimensions, uint32_t texture) noexcept
@@ -243,15 +271,22 @@ void SpriteBatch::end(uint32_t fbo, vec2 viewportDimensions, uint32_t texture) n
 void SpriteBatch::end(uint32_t fbo, const AABB2D& viewport, uint32_t texture) noexcept
 {
 	sfz_assert_debug(mCurrentDrawCount <= mCapacity);
+	StateCache& glState = StateCache::INSTANCE();
+
+	// Hands the written sprites over to the GL, the rest of the reserved range is left for the
+	// next batch
+	const size_t batchSize = sizeof(Sprite) * mCurrentDrawCount;
+	glBindBuffer(GL_ARRAY_BUFFER, mStreamBuffer);
+	if (mSprites != nullptr) {
+		if (mPersistent) {
+			if (batchSize != 0) glFlushMappedBufferRange(GL_ARRAY_BUFFER, mBatchOffset, batchSize);
+		} else {
+			if (batchSize != 0) glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, batchSize);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+		mSprites = nullptr;
+	}
 
-	// Get old values
-	float oldViewport[4];
-	glGetFloatv(GL_VIEWPORT, oldViewport);
-	int oldShader;
-	glGetIntegerv(GL_CURRENT_PROGRAM, &oldShader);
-
-	// Setting up buffers and transferring data.
-	// Uses orpahning, see: https://www.opengl.org/wiki/Buffer_Object_Streaming
 	glBindVertexArray(mVAO);
 
 	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
@@ -259,12 +294,12 @@ void SpriteBatch::end(uint32_t fbo, const AABB2D& viewport, uint32_t texture) no
 	glEnableVertexAttribArray(0);
 	glVertexAttribDivisor(0, 0); // Same quad for each draw instance
 
-	glBindBuffer(GL_ARRAY_BUFFER, mTransformBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(mat3)*mCapacity, NULL, GL_STREAM_DRAW); // Orphaning.
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(mat3)*mCurrentDrawCount, mTransformArray[0].data());
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(mat3), (void*)(sizeof(float)*3*0));
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(mat3), (void*)(sizeof(float)*3*1));
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(mat3), (void*)(sizeof(float)*3*2));
+	const size_t transformOffset = mBatchOffset + offsetof(Sprite, transform);
+	const size_t uvOffset = mBatchOffset + offsetof(Sprite, uv);
+	glBindBuffer(GL_ARRAY_BUFFER, mStreamBuffer);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Sprite), (void*)(transformOffset + sizeof(float)*3*0));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Sprite), (void*)(transformOffset + sizeof(float)*3*1));
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Sprite), (void*)(transformOffset + sizeof(float)*3*2));
 	glEnableVertexAttribArray(1);
 	glEnableVertexAttribArray(2);
 	glEnableVertexAttribArray(3);
@@ -272,26 +307,20 @@ void SpriteBatch::end(uint32_t fbo, const AABB2D& viewport, uint32_t texture) no
 	glVertexAttribDivisor(2, 1);
 	glVertexAttribDivisor(3, 1);
 
-	glBindBuffer(GL_ARRAY_BUFFER, mUVBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vec4)*mCapacity, NULL, GL_STREAM_DRAW); // Orphaning.
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vec4)*mCurrentDrawCount, mUVArray[0].elements);
-	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 0, 0);
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Sprite), (void*)uvOffset);
 	glEnableVertexAttribArray(4);
 	glVertexAttribDivisor(4, 1); // One UV coordinate per vertex
 
-	// Save previous depth test state and then disable it
-	GLboolean depthTestWasEnabled;
-	glGetBooleanv(GL_DEPTH_TEST, &depthTestWasEnabled);
-	glDisable(GL_DEPTH_TEST);
+	// Disable depth test, state is not restored afterwards as it is tracked by the StateCache
+	glState.disable(GL_DEPTH_TEST);
 
 	// Enabling shader
-	glUseProgram(mShader.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-	glViewport(viewport.min.x, viewport.min.y, viewport.width(), viewport.height());
+	glState.useProgram(mShader.handle());
+	glState.bindFramebuffer(fbo);
+	glState.viewport(viewport);
 
 	// Uniforms
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	glState.bindTexture(0, texture);
 	gl::setUniform(mTextureUniformLoc, 0);
 
 	// Drawing instances
@@ -299,15 +328,58 @@ void SpriteBatch::end(uint32_t fbo, const AABB2D& viewport, uint32_t texture) no
 	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, mCurrentDrawCount);
 
 	// Cleanup
-	if (depthTestWasEnabled) glEnable(GL_DEPTH_TEST);
-	glUseProgram(oldShader);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0); // TODO: Store previous framebuffer
-	glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
 	glVertexAttribDivisor(0, 0);
 	glVertexAttribDivisor(1, 0);
 	glVertexAttribDivisor(2, 0);
 	glVertexAttribDivisor(3, 0);
 	glVertexAttribDivisor(4, 0);
+
+	// Fences the range read by this batch, it can't be written to again until the GPU is done
+	if (batchSize != 0) {
+		if (mFences.isFull()) mFences.retireOldest();
+		const uint32_t slot = mFences.insert();
+		mFenceBegins[slot] = mBatchOffset;
+		mFenceEnds[slot] = mBatchOffset + batchSize;
+		mBatchOffset += batchSize;
+	}
+}
+
+// SpriteBatch: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void SpriteBatch::reserveBatch() noexcept
+{
+	const size_t reservedSize = sizeof(Sprite) * mCapacity;
+	if (reservedSize == 0) return;
+	mFences.retireSignaled();
+
+	// The batch must be contiguous, wraps around to the start if it doesn't fit at the end
+	if (mBatchOffset + reservedSize > mRingSize) {
+		waitForRange(mBatchOffset, mRingSize);
+		mBatchOffset = 0;
+	}
+	waitForRange(mBatchOffset, mBatchOffset + reservedSize);
+
+	if (mPersistent) {
+		mSprites = reinterpret_cast<Sprite*>(static_cast<uint8_t*>(mPersistentPtr) + mBatchOffset);
+	} else {
+		// Unsynchronized, the fences already guarantee the GPU is done with the range
+		glBindBuffer(GL_ARRAY_BUFFER, mStreamBuffer);
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT |
+		                         GL_MAP_UNSYNCHRONIZED_BIT;
+		mSprites = static_cast<Sprite*>(glMapBufferRange(GL_ARRAY_BUFFER, mBatchOffset, reservedSize, flags));
+		if (mSprites == nullptr) sfz_error("SpriteBatch: Couldn't map stream buffer.");
+	}
+}
+
+void SpriteBatch::waitForRange(size_t begin, size_t end) noexcept
+{
+	// Batches are reserved in ring order, so the oldest pending batch is always the first one
+	// after the current offset and the ones overlapping the range are retired first
+	while (!mFences.isEmpty() && rangesOverlap(mFenceBegins[mFences.oldestSlot()],
+	                                           mFenceEnds[mFences.oldestSlot()], begin, end)) {
+		mFences.retireOldest();
+	}
 }
 
 } // namespace sfz
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "sfz/gl/StateCache.hpp"
+
+#include "sfz/gl/OpenGL.hpp"
+
+namespace gl {
+
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static uint32_t capabilityIndex(uint32_t capability) noexcept
+{
+	switch (capability) {
+	case GL_DEPTH_TEST: return 0;
+	case GL_BLEND: return 1;
+	case GL_CULL_FACE: return 2;
+	case GL_STENCIL_TEST: return 3;
+	default: return ~0u;
+	}
+}
+
+// StateCache: Singleton instance
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+StateCache& StateCache::INSTANCE() noexcept
+{
+	static StateCache cache;
+	return cache;
+}
+
+// StateCache: State changing methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void StateCache::enable(uint32_t capability) noexcept
+{
+	setCapability(capability, true);
+}
+
+void StateCache::disable(uint32_t capability) noexcept
+{
+	setCapability(capability, false);
+}
+
+void StateCache::useProgram(uint32_t program) noexcept
+{
+	if (mProgram == program) {
+		mStats.numSkipped += 1;
+		return;
+	}
+	glUseProgram(program);
+	mProgram = program;
+	mStats.numIssued += 1;
+}
+
+void StateCache::bindFramebuffer(uint32_t fbo) noexcept
+{
+	if (mFramebuffer == fbo) {
+		mStats.numSkipped += 1;
+		return;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	mFramebuffer = fbo;
+	mStats.numIssued += 1;
+}
+
+void StateCache::viewport(int32_t x, int32_t y, int32_t width, int32_t height) noexcept
+{
+	if (mViewportKnown && mViewport[0] == x && mViewport[1] == y &&
+	    mViewport[2] == width && mViewport[3] == height) {
+		mStats.numSkipped += 1;
+		return;
+	}
+	glViewport(x, y, width, height);
+	mViewport[0] = x;
+	mViewport[1] = y;
+	mViewport[2] = width;
+	mViewport[3] = height;
+	mViewportKnown = true;
+	mStats.numIssued += 1;
+}
+
+void StateCache::viewport(vec2i dimensions) noexcept
+{
+	this->viewport(0, 0, dimensions.x, dimensions.y);
+}
+
+void StateCache::viewport(vec2 dimensions) noexcept
+{
+	this->viewport(0, 0, (int32_t)dimensions.x, (int32_t)dimensions.y);
+}
+
+void StateCache::viewport(const AABB2D& viewport) noexcept
+{
+	this->viewport((int32_t)viewport.min.x, (int32_t)viewport.min.y,
+	               (int32_t)viewport.width(), (int32_t)viewport.height());
+}
+
+void StateCache::bindTexture(uint32_t unit, uint32_t texture) noexcept
+{
+	if (unit < MAX_TEXTURE_UNITS && mTextures[unit] == texture) {
+		mStats.numSkipped += 1;
+		return;
+	}
+	activeTexture(unit);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	if (unit < MAX_TEXTURE_UNITS) mTextures[unit] = texture;
+	mStats.numIssued += 1;
+}
+
+// StateCache: Invalidation & statistics
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void StateCache::invalidate() noexcept
+{
+	for (uint32_t i = 0; i < NUM_CAPABILITIES; ++i) {
+		mCapabilities[i] = UNKNOWN;
+	}
+	mProgram = UNKNOWN;
+	mFramebuffer = UNKNOWN;
+	mViewportKnown = false;
+	mActiveTextureUnit = UNKNOWN;
+	for (uint32_t i = 0; i < MAX_TEXTURE_UNITS; ++i) {
+		mTextures[i] = UNKNOWN;
+	}
+}
+
+void StateCache::newFrame() noexcept
+{
+	this->invalidate();
+	this->resetStats();
+}
+
+void StateCache::onProgramDeleted(uint32_t program) noexcept
+{
+	if (program != 0 && mProgram == program) mProgram = UNKNOWN;
+}
+
+void StateCache::onFramebufferDeleted(uint32_t fbo) noexcept
+{
+	if (fbo != 0 && mFramebuffer == fbo) mFramebuffer = UNKNOWN;
+}
+
+void StateCache::onTextureDeleted(uint32_t texture) noexcept
+{
+	if (texture == 0) return;
+	for (uint32_t i = 0; i < MAX_TEXTURE_UNITS; ++i) {
+		if (mTextures[i] == texture) mTextures[i] = UNKNOWN;
+	}
+}
+
+// StateCache: Private constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+StateCache::StateCache() noexcept
+{
+	this->invalidate();
+}
+
+// StateCache: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void StateCache::setCapability(uint32_t capability, bool enabled) noexcept
+{
+	const uint32_t index = capabilityIndex(capability);
+	const uint32_t value = enabled ? 1u : 0u;
+	if (index < NUM_CAPABILITIES) {
+		if (mCapabilities[index] == value) {
+			mStats.numSkipped += 1;
+			return;
+		}
+		mCapabilities[index] = value;
+	}
+	if (enabled) glEnable(capability);
+	else glDisable(capability);
+	mStats.numIssued += 1;
+}
+
+void StateCache::activeTexture(uint32_t unit) noexcept
+{
+	if (mActiveTextureUnit == unit) return;
+	glActiveTexture(GL_TEXTURE0 + unit);
+	mActiveTextureUnit = unit;
+	mStats.numIssued += 1;
+}
+
+} // namespace gl
\ No newline at end of file
@@ -7,36 +7,20 @@
 #include <sfz/PopWarnings.hpp>
 
 #include "sfz/Assert.hpp"
+#include "sfz/gl/GpuMemoryTracker.hpp"
 #include "sfz/gl/OpenGL.hpp"
+#include "sfz/gl/StateCache.hpp"
+#include "sfz/gl/TextureContainer.hpp"
+#include "sfz/util/MappedFile.hpp"
 
-#include <algorithm> // std::swap
-#include <cstring> // std::memcpy
+#include <algorithm> // std::min, std::swap
 #include <iostream>
-#include <new>
 
 namespace gl {
 
 // Static functions
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-static void flipImage(uint8_t* const pixels, int w, int h, int pitch, int numChannels) noexcept
-{
-	const int bytesPerRow = w*numChannels;
-	const int bytePitch = pitch*numChannels;
-	uint8_t* const buffer = new (std::nothrow) uint8_t[bytesPerRow];
-
-	for (int i = 0; i < (h/2); ++i) {
-		uint8_t* begin = pixels + i*bytePitch;
-		uint8_t* end = pixels + (h-i-1)*bytePitch;
-
-		std::memcpy(buffer, begin, bytesPerRow);
-		std::memcpy(begin, end, bytesPerRow);
-		std::memcpy(end, buffer, bytesPerRow);
-	}
-
-	delete[] buffer;
-}
-
 static float anisotropicFactor(TextureFiltering filtering) noexcept
 {
 	switch (filtering) {
@@ -50,21 +34,53 @@ static float anisotropicFactor(TextureFiltering filtering) noexcept
 	}
 }
 
-static GLuint loadTexture(const char* path, int numChannelsWanted, TextureFiltering filtering, AABB2D& dims) noexcept
+static void setFiltering(TextureFiltering filtering, bool generateMipmaps) noexcept
+{
+	// Sets specified texture filtering, generating mipmaps if needed.
+	switch (filtering) {
+	case TextureFiltering::NEAREST:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		break;
+	case TextureFiltering::BILINEAR:
+		if (generateMipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		break;
+	case TextureFiltering::TRILINEAR:
+		if (generateMipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		break;
+	case TextureFiltering::ANISOTROPIC_1:
+	case TextureFiltering::ANISOTROPIC_2:
+	case TextureFiltering::ANISOTROPIC_4:
+	case TextureFiltering::ANISOTROPIC_8:
+	case TextureFiltering::ANISOTROPIC_16:
+		if (generateMipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicFactor(filtering));
+		break;
+	}
+}
+
+static GLuint loadTexture(const uint8_t* data, size_t size, const char* name, int numChannelsWanted,
+                          TextureFiltering filtering, AABB2D& dims, size_t& sizeBytes) noexcept
 {
-	// Loading image
-	int width, height, numChannels;
-	uint8_t* img = stbi_load(path, &width, &height, &numChannels, numChannelsWanted);
+	// Flips image so UV coordinates will be in a right-handed system in OpenGL.
+	stbi_set_flip_vertically_on_load(1);
+
+	int width, height, numChannelsInFile;
+	uint8_t* img = stbi_load_from_memory(data, (int)size, &width, &height, &numChannelsInFile, numChannelsWanted);
 
 	// Some error checking
 	if (img == NULL) {		
-		std::cerr << "Unable to load image at: " << path << ", reason: "
+		std::cerr << "Unable to load image at: " << name << ", reason: "
 		          << stbi_failure_reason() << std::endl;
 		return 0;
 	}
-
-	// Flips image so UV coordinates will be in a right-handed system in OpenGL.
-	flipImage(img, width, height, width, numChannels);
+	const int numChannels = (numChannelsWanted != 0) ? numChannelsWanted : numChannelsInFile;
 
 	// Creating OpenGL Texture from surface.
 	GLuint texture;
@@ -87,37 +103,74 @@ static GLuint loadTexture(const char* path, int numChannelsWanted, TextureFilter
 	}
 	stbi_image_free(img);
 
-	// Sets specified texture filtering, generating mipmaps if needed.
-	switch (filtering) {
-	case TextureFiltering::NEAREST:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		break;
-	case TextureFiltering::BILINEAR:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		break;
-	case TextureFiltering::TRILINEAR:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		break;
-	case TextureFiltering::ANISOTROPIC_1:
-	case TextureFiltering::ANISOTROPIC_2:
-	case TextureFiltering::ANISOTROPIC_4:
-	case TextureFiltering::ANISOTROPIC_8:
-	case TextureFiltering::ANISOTROPIC_16:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicFactor(filtering));
-		break;
-	}
+	setFiltering(filtering, true);
 
 	float wf = (float)width;
 	float hf = (float)height;
 	dims = AABB2D(wf/2.0f, hf/2.0f, wf, hf);
+	sizeBytes = estimatedTextureSizeBytes(width, height, numChannels, 1, filtering != TextureFiltering::NEAREST);
+
+	return texture;
+}
+
+static GLuint loadContainer(const uint8_t* data, size_t size, const char* name, TextureFiltering filtering,
+                            uint32_t maxLevel, AABB2D& dims, size_t& sizeBytes) noexcept
+{
+	TextureContainerInfo info;
+	if (!parseTextureContainer(data, size, info)) {
+		std::cerr << "Unable to load texture container at: " << name << ", damaged or unknown version" << std::endl;
+		return 0;
+	}
+	if (isCompressed(info.format) && !GLEW_EXT_texture_compression_s3tc) {
+		std::cerr << "Unable to load texture container at: " << name << ", S3TC is not supported" << std::endl;
+		return 0;
+	}
+
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// Levels are tightly packed, only level 0 is needed without mipmaps
+	size_t numLevels = std::min(info.levels.size() - 1, size_t(maxLevel)) + 1;
+	if (filtering == TextureFiltering::NEAREST) numLevels = 1;
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	sizeBytes = 0;
+	for (size_t i = 0; i < numLevels; ++i) {
+		const TextureContainerLevel& level = info.levels[i];
+		const GLint lvl = GLint(i);
+		switch (info.format) {
+		case TextureContainerFormat::R8:
+			glTexImage2D(GL_TEXTURE_2D, lvl, GL_R8, level.width, level.height, 0, GL_RED, GL_UNSIGNED_BYTE, level.data);
+			break;
+		case TextureContainerFormat::RG8:
+			glTexImage2D(GL_TEXTURE_2D, lvl, GL_RG8, level.width, level.height, 0, GL_RG, GL_UNSIGNED_BYTE, level.data);
+			break;
+		case TextureContainerFormat::RGB8:
+			glTexImage2D(GL_TEXTURE_2D, lvl, GL_RGB8, level.width, level.height, 0, GL_RGB, GL_UNSIGNED_BYTE, level.data);
+			break;
+		case TextureContainerFormat::RGBA8:
+			glTexImage2D(GL_TEXTURE_2D, lvl, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+			break;
+		case TextureContainerFormat::BC1_RGB:
+			glCompressedTexImage2D(GL_TEXTURE_2D, lvl, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, level.width, level.height,
+			                       0, GLsizei(level.size), level.data);
+			break;
+		case TextureContainerFormat::BC3_RGBA:
+			glCompressedTexImage2D(GL_TEXTURE_2D, lvl, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, level.width, level.height,
+			                       0, GLsizei(level.size), level.data);
+			break;
+		}
+		// Three channel textures are assumed to be padded to four channels, like estimatedTextureSizeBytes()
+		sizeBytes += (info.format == TextureContainerFormat::RGB8) ? level.size / 3 * 4 : level.size;
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(numLevels - 1));
+
+	setFiltering(filtering, false);
+
+	float wf = (float)info.width;
+	float hf = (float)info.height;
+	dims = AABB2D(wf/2.0f, hf/2.0f, wf, hf);
 
 	return texture;
 }
@@ -126,9 +179,37 @@ static GLuint loadTexture(const char* path, int numChannelsWanted, TextureFilter
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 Texture Texture::fromFile(const char* path, TextureFormat format, TextureFiltering filtering) noexcept
+{
+	// Decoded straight from the mapped file
+	const sfz::MappedFile file{path};
+	if (!file.isValid()) {
+		std::cerr << "Unable to open image at: " << path << std::endl;
+		return Texture{};
+	}
+	return fromMemory(file.data(), file.size(), path, format, filtering);
+}
+
+Texture Texture::fromMemory(const uint8_t* data, size_t size, const char* name, TextureFormat format,
+                            TextureFiltering filtering) noexcept
 {
 	Texture tmp;
-	tmp.mHandle = loadTexture(path, static_cast<uint8_t>(format), filtering, tmp.mDim);
+	size_t sizeBytes = 0;
+	tmp.mHandle = loadTexture(data, size, name, static_cast<uint8_t>(format), filtering, tmp.mDim, sizeBytes);
+	if (tmp.mHandle != 0) {
+		tmp.mMemoryId = GpuMemoryTracker::INSTANCE().add(GpuMemoryCategory::TEXTURE, name, sizeBytes);
+	}
+	return std::move(tmp);
+}
+
+Texture Texture::fromContainer(const uint8_t* data, size_t size, const char* name,
+                               TextureFiltering filtering, uint32_t maxLevel) noexcept
+{
+	Texture tmp;
+	size_t sizeBytes = 0;
+	tmp.mHandle = loadContainer(data, size, name, filtering, maxLevel, tmp.mDim, sizeBytes);
+	if (tmp.mHandle != 0) {
+		tmp.mMemoryId = GpuMemoryTracker::INSTANCE().add(GpuMemoryCategory::TEXTURE, name, sizeBytes);
+	}
 	return std::move(tmp);
 }
 
@@ -139,18 +220,22 @@ Texture::Texture(Texture&& other) noexcept
 {
 	std::swap(this->mHandle, other.mHandle);
 	std::swap(this->mDim, other.mDim);
+	std::swap(this->mMemoryId, other.mMemoryId);
 }
 
 Texture& Texture::operator= (Texture&& other) noexcept
 {
 	std::swap(this->mHandle, other.mHandle);
 	std::swap(this->mDim, other.mDim);
+	std::swap(this->mMemoryId, other.mMemoryId);
 	return *this;
 }
 
 Texture::~Texture() noexcept
 {
+	StateCache::INSTANCE().onTextureDeleted(mHandle);
 	glDeleteTextures(1, &mHandle); // Silently ignores mHandle == 0
+	GpuMemoryTracker::INSTANCE().remove(mMemoryId);
 }
 	
 } // namespace gl
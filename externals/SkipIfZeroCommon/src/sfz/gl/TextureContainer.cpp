@@ -0,0 +1,378 @@
+#include "sfz/gl/TextureContainer.hpp"
+
+#include <sfz/PushWarnings.hpp>
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <sfz/PopWarnings.hpp>
+
+#include "sfz/util/ByteIO.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace gl {
+
+using std::uint16_t;
+using std::uint64_t;
+
+using sfz::readU32;
+using sfz::writeU32;
+
+// Static constants
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Layout, all integers little endian:
+// Header: 8 byte magic, u32 version, u32 format, u32 width, u32 height, u32 numLevels, u32 reserved
+// Levels: level 0 first, each level starts at a multiple of LEVEL_ALIGNMENT
+static const char MAGIC[8] = {'S', 'F', 'Z', 'T', 'E', 'X', '\0', '\0'};
+static const uint32_t VERSION = 1;
+static const size_t HEADER_SIZE = 32;
+static const size_t LEVEL_ALIGNMENT = 4;
+
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static size_t alignLevel(size_t offset) noexcept
+{
+	return (offset + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+}
+
+static uint32_t numMipLevels(int width, int height) noexcept
+{
+	uint32_t numLevels = 1;
+	int dim = std::max(width, height);
+	while (dim > 1) {
+		dim /= 2;
+		numLevels += 1;
+	}
+	return numLevels;
+}
+
+/** Box filters the level down to half its size (rounded down, at least 1). */
+static vector<uint8_t> nextMipLevel(const vector<uint8_t>& level, int width, int height, int numChannels) noexcept
+{
+	const int nextWidth = std::max(1, width / 2);
+	const int nextHeight = std::max(1, height / 2);
+	vector<uint8_t> next(size_t(nextWidth) * size_t(nextHeight) * size_t(numChannels));
+
+	for (int y = 0; y < nextHeight; ++y) {
+		const int y0 = std::min(2 * y, height - 1);
+		const int y1 = std::min(2 * y + 1, height - 1);
+		for (int x = 0; x < nextWidth; ++x) {
+			const int x0 = std::min(2 * x, width - 1);
+			const int x1 = std::min(2 * x + 1, width - 1);
+			for (int c = 0; c < numChannels; ++c) {
+				const int sum = level[(y0 * width + x0) * numChannels + c] + level[(y0 * width + x1) * numChannels + c]
+				              + level[(y1 * width + x0) * numChannels + c] + level[(y1 * width + x1) * numChannels + c];
+				next[(y * nextWidth + x) * numChannels + c] = uint8_t((sum + 2) / 4);
+			}
+		}
+	}
+	return next;
+}
+
+static uint16_t toRGB565(const int color[3]) noexcept
+{
+	const int r = (color[0] * 31 + 127) / 255;
+	const int g = (color[1] * 63 + 127) / 255;
+	const int b = (color[2] * 31 + 127) / 255;
+	return uint16_t((r << 11) | (g << 5) | b);
+}
+
+static void fromRGB565(uint16_t value, int colorOut[3]) noexcept
+{
+	const int r = value >> 11;
+	const int g = (value >> 5) & 63;
+	const int b = value & 31;
+	colorOut[0] = (r << 3) | (r >> 2);
+	colorOut[1] = (g << 2) | (g >> 4);
+	colorOut[2] = (b << 3) | (b >> 2);
+}
+
+/** Encodes the colors of a 4x4 RGBA block into an 8 byte BC1 block (always in 4 color mode). */
+static void encodeColorBlock(const uint8_t block[64], uint8_t* out) noexcept
+{
+	// Bounding box of the colors
+	int minColor[3] = {255, 255, 255};
+	int maxColor[3] = {0, 0, 0};
+	int mean[3] = {0, 0, 0};
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < 3; ++c) {
+			minColor[c] = std::min(minColor[c], int(block[i * 4 + c]));
+			maxColor[c] = std::max(maxColor[c], int(block[i * 4 + c]));
+			mean[c] += block[i * 4 + c];
+		}
+	}
+	for (int c = 0; c < 3; ++c) mean[c] = (mean[c] + 8) / 16;
+
+	// Uses the diagonal of the box the colors are spread along, channels which are negatively
+	// correlated with the channel with the largest range are swapped
+	int axis = 0;
+	for (int c = 1; c < 3; ++c) {
+		if ((maxColor[c] - minColor[c]) > (maxColor[axis] - minColor[axis])) axis = c;
+	}
+	for (int c = 0; c < 3; ++c) {
+		if (c == axis) continue;
+		int covariance = 0;
+		for (int i = 0; i < 16; ++i) {
+			covariance += (block[i * 4 + c] - mean[c]) * (block[i * 4 + axis] - mean[axis]);
+		}
+		if (covariance < 0) std::swap(minColor[c], maxColor[c]);
+	}
+
+	// Insets the endpoints, reduces the error of the colors in the middle of the range
+	for (int c = 0; c < 3; ++c) {
+		const int inset = (maxColor[c] - minColor[c]) / 16;
+		maxColor[c] -= inset;
+		minColor[c] += inset;
+	}
+
+	uint16_t color0 = toRGB565(maxColor);
+	uint16_t color1 = toRGB565(minColor);
+	if (color0 < color1) std::swap(color0, color1);
+
+	int palette[4][3];
+	fromRGB565(color0, palette[0]);
+	fromRGB565(color1, palette[1]);
+	for (int c = 0; c < 3; ++c) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	uint32_t indices = 0;
+	if (color0 != color1) {
+		for (int i = 0; i < 16; ++i) {
+			int bestIndex = 0, bestDist = 0x7FFFFFFF;
+			for (int p = 0; p < 4; ++p) {
+				int dist = 0;
+				for (int c = 0; c < 3; ++c) {
+					const int diff = block[i * 4 + c] - palette[p][c];
+					dist += diff * diff;
+				}
+				if (dist < bestDist) {
+					bestDist = dist;
+					bestIndex = p;
+				}
+			}
+			indices |= uint32_t(bestIndex) << (2 * i);
+		}
+	}
+
+	out[0] = uint8_t(color0);
+	out[1] = uint8_t(color0 >> 8);
+	out[2] = uint8_t(color1);
+	out[3] = uint8_t(color1 >> 8);
+	writeU32(out + 4, indices);
+}
+
+/** Encodes the alpha of a 4x4 RGBA block into the 8 byte alpha part of a BC3 block. */
+static void encodeAlphaBlock(const uint8_t block[64], uint8_t* out) noexcept
+{
+	int alpha0 = 0, alpha1 = 255;
+	for (int i = 0; i < 16; ++i) {
+		alpha0 = std::max(alpha0, int(block[i * 4 + 3]));
+		alpha1 = std::min(alpha1, int(block[i * 4 + 3]));
+	}
+
+	// 8 value mode, alpha0 > alpha1
+	int palette[8];
+	palette[0] = alpha0;
+	palette[1] = alpha1;
+	for (int p = 2; p < 8; ++p) {
+		palette[p] = ((8 - p) * alpha0 + (p - 1) * alpha1) / 7;
+	}
+
+	uint64_t indices = 0;
+	if (alpha0 != alpha1) {
+		for (int i = 0; i < 16; ++i) {
+			int bestIndex = 0, bestDist = 256;
+			for (int p = 0; p < 8; ++p) {
+				const int dist = std::abs(int(block[i * 4 + 3]) - palette[p]);
+				if (dist < bestDist) {
+					bestDist = dist;
+					bestIndex = p;
+				}
+			}
+			indices |= uint64_t(bestIndex) << (3 * i);
+		}
+	}
+
+	out[0] = uint8_t(alpha0);
+	out[1] = uint8_t(alpha1);
+	for (int i = 0; i < 6; ++i) out[2 + i] = uint8_t(indices >> (8 * i));
+}
+
+/** Block compresses an RGBA level, blocks on the edges are padded by repeating the last pixels. */
+static void compressLevel(const vector<uint8_t>& rgba, int width, int height, TextureContainerFormat format,
+                          uint8_t* out) noexcept
+{
+	const bool hasAlpha = format == TextureContainerFormat::BC3_RGBA;
+	uint8_t block[64];
+	for (int by = 0; by < (height + 3) / 4; ++by) {
+		for (int bx = 0; bx < (width + 3) / 4; ++bx) {
+			for (int y = 0; y < 4; ++y) {
+				const int srcY = std::min(by * 4 + y, height - 1);
+				for (int x = 0; x < 4; ++x) {
+					const int srcX = std::min(bx * 4 + x, width - 1);
+					std::memcpy(block + (y * 4 + x) * 4, rgba.data() + (srcY * width + srcX) * 4, 4);
+				}
+			}
+			if (hasAlpha) {
+				encodeAlphaBlock(block, out);
+				out += 8;
+			}
+			encodeColorBlock(block, out);
+			out += 8;
+		}
+	}
+}
+
+// Texture container functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+size_t textureContainerLevelSize(TextureContainerFormat format, int width, int height) noexcept
+{
+	const size_t numBlocks = size_t((width + 3) / 4) * size_t((height + 3) / 4);
+	switch (format) {
+	case TextureContainerFormat::R8: return size_t(width) * size_t(height);
+	case TextureContainerFormat::RG8: return size_t(width) * size_t(height) * 2;
+	case TextureContainerFormat::RGB8: return size_t(width) * size_t(height) * 3;
+	case TextureContainerFormat::RGBA8: return size_t(width) * size_t(height) * 4;
+	case TextureContainerFormat::BC1_RGB: return numBlocks * 8;
+	case TextureContainerFormat::BC3_RGBA: return numBlocks * 16;
+	}
+	return 0;
+}
+
+bool parseTextureContainer(const uint8_t* data, size_t size, TextureContainerInfo& infoOut) noexcept
+{
+	if (data == nullptr || size < HEADER_SIZE) return false;
+	if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) return false;
+	if (readU32(data + 8) != VERSION) return false;
+
+	const uint32_t format = readU32(data + 12);
+	const uint32_t width = readU32(data + 16);
+	const uint32_t height = readU32(data + 20);
+	const uint32_t numLevels = readU32(data + 24);
+	if (format < uint32_t(TextureContainerFormat::R8) || format > uint32_t(TextureContainerFormat::BC3_RGBA)) return false;
+	if (width == 0 || height == 0 || width > 65536 || height > 65536) return false;
+	if (numLevels != numMipLevels(int(width), int(height))) return false;
+
+	TextureContainerInfo info;
+	info.format = TextureContainerFormat(format);
+	info.width = int(width);
+	info.height = int(height);
+	info.levels.reserve(numLevels);
+
+	size_t offset = HEADER_SIZE;
+	int levelWidth = info.width, levelHeight = info.height;
+	for (uint32_t i = 0; i < numLevels; ++i) {
+		TextureContainerLevel level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.size = textureContainerLevelSize(info.format, levelWidth, levelHeight);
+		offset = alignLevel(offset);
+		if (offset > size || level.size > size - offset) return false;
+		level.data = data + offset;
+		info.levels.push_back(level);
+
+		offset += level.size;
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+
+	infoOut = std::move(info);
+	return true;
+}
+
+vector<uint8_t> bakeTextureContainer(const uint8_t* pixels, int width, int height, int numChannels,
+                                     bool compress) noexcept
+{
+	if (pixels == nullptr || width <= 0 || height <= 0 || numChannels < 1 || numChannels > 4) {
+		return vector<uint8_t>();
+	}
+
+	// Flips the image so UV coordinates will be in a right-handed system in OpenGL
+	const size_t bytesPerRow = size_t(width) * size_t(numChannels);
+	vector<uint8_t> level(bytesPerRow * size_t(height));
+	for (int y = 0; y < height; ++y) {
+		std::memcpy(level.data() + y * bytesPerRow, pixels + (height - y - 1) * bytesPerRow, bytesPerRow);
+	}
+
+	TextureContainerFormat format = TextureContainerFormat(numChannels);
+	if (compress && numChannels >= 3) {
+		// Compressed levels are encoded from RGBA, images with only opaque pixels use BC1
+		bool opaque = true;
+		if (numChannels == 3) {
+			vector<uint8_t> rgba(size_t(width) * size_t(height) * 4, 255);
+			for (size_t i = 0; i < size_t(width) * size_t(height); ++i) {
+				std::memcpy(rgba.data() + i * 4, level.data() + i * 3, 3);
+			}
+			level.swap(rgba);
+			numChannels = 4;
+		} else {
+			for (size_t i = 3; i < level.size() && opaque; i += 4) opaque = level[i] == 255;
+		}
+		format = opaque ? TextureContainerFormat::BC1_RGB : TextureContainerFormat::BC3_RGBA;
+	}
+
+	const uint32_t numLevels = numMipLevels(width, height);
+	vector<uint8_t> container(HEADER_SIZE, 0);
+	std::memcpy(container.data(), MAGIC, sizeof(MAGIC));
+	writeU32(container.data() + 8, VERSION);
+	writeU32(container.data() + 12, uint32_t(format));
+	writeU32(container.data() + 16, uint32_t(width));
+	writeU32(container.data() + 20, uint32_t(height));
+	writeU32(container.data() + 24, numLevels);
+
+	int levelWidth = width, levelHeight = height;
+	for (uint32_t i = 0; i < numLevels; ++i) {
+		if (i != 0) {
+			level = nextMipLevel(level, levelWidth, levelHeight, numChannels);
+			levelWidth = std::max(1, levelWidth / 2);
+			levelHeight = std::max(1, levelHeight / 2);
+		}
+
+		const size_t offset = alignLevel(container.size());
+		const size_t levelSize = textureContainerLevelSize(format, levelWidth, levelHeight);
+		container.resize(offset + levelSize, 0);
+		if (isCompressed(format)) {
+			compressLevel(level, levelWidth, levelHeight, format, container.data() + offset);
+		} else {
+			std::memcpy(container.data() + offset, level.data(), levelSize);
+		}
+	}
+	return container;
+}
+
+vector<uint8_t> bakeTextureContainerFromImage(const uint8_t* data, size_t size, const char* name,
+                                              TextureFormat format, bool compress) noexcept
+{
+	const int numChannels = static_cast<int>(format);
+	int width, height, numChannelsInFile;
+	uint8_t* img = stbi_load_from_memory(data, (int)size, &width, &height, &numChannelsInFile, numChannels);
+	if (img == NULL) {
+		std::cerr << "Unable to load image at: " << name << ", reason: "
+		          << stbi_failure_reason() << std::endl;
+		return vector<uint8_t>();
+	}
+
+	vector<uint8_t> container = bakeTextureContainer(img, width, height, numChannels, compress);
+	stbi_image_free(img);
+	return container;
+}
+
+string bakedTextureName(const string& imageName) noexcept
+{
+	const size_t dot = imageName.find_last_of('.');
+	const size_t separator = imageName.find_last_of("/\\");
+	if (dot == string::npos || (separator != string::npos && dot < separator)) {
+		return imageName + ".sfztex";
+	}
+	return imageName.substr(0, dot) + ".sfztex";
+}
+
+} // namespace gl
\ No newline at end of file
@@ -6,8 +6,6 @@
 #include <exception> // std::terminate
 #include <algorithm> // std::swap
 
-#include <SDL.h>
-
 #include "sfz/PushWarnings.hpp"
 //#define STB_RECT_PACK_IMPLEMENTATION
 #include <stb_rect_pack.h>
@@ -17,94 +15,37 @@
 #include "sfz/PopWarnings.hpp"
 
 #include "sfz/Assert.hpp"
-#include "sfz/gl/GLUtils.hpp"
-#include "sfz/gl/OpenGL.hpp"
+#include "sfz/gl/TextureContainer.hpp"
 #include "sfz/math/vector.hpp"
+#include "sfz/util/ByteIO.hpp"
+#include "sfz/util/MappedFile.hpp"
 
 namespace gl {
 
 using sfz::vec2;
-
-// Static functions
+using sfz::readF32;
+using sfz::readU32;
+using sfz::readU64;
+using sfz::writeF32;
+using sfz::writeU32;
+using sfz::writeU64;
+
+// Static constants
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-static void flipImage(uint8_t* const pixels, int w, int h, int pitch, int numChannels) noexcept
-{
-	const int bytesPerRow = w*numChannels;
-	const int bytePitch = pitch*numChannels;
-	uint8_t* const buffer = new (std::nothrow) uint8_t[bytesPerRow];
-
-	for (int i = 0; i < (h/2); ++i) {
-		uint8_t* begin = pixels + i*bytePitch;
-		uint8_t* end = pixels + (h-i-1)*bytePitch;
-
-		std::memcpy(buffer, begin, bytesPerRow);
-		std::memcpy(begin, end, bytesPerRow);
-		std::memcpy(end, buffer, bytesPerRow);
-	}
-
-	delete[] buffer;
-}
-
-static float anisotropicFactor(TextureFiltering filtering) noexcept
-{
-	switch (filtering) {
-	case TextureFiltering::ANISOTROPIC_1: return 1.0f;
-	case TextureFiltering::ANISOTROPIC_2: return 2.0f;
-	case TextureFiltering::ANISOTROPIC_4: return 4.0f;
-	case TextureFiltering::ANISOTROPIC_8: return 8.0f;
-	case TextureFiltering::ANISOTROPIC_16: return 16.0f;
-	default:
-		sfz_error("Can't extract anisotropic factor.");
-	}
-}
-
-static SDL_Surface* loadTexture(const string& path) noexcept
-{
-	// Loading image
-	int width, height, numChannels;
-	uint8_t* data = stbi_load(path.c_str(), &width, &height, &numChannels, 4);
-
-	// Some error checking
-	if (data == NULL) {		
-		std::cerr << "Unable to load image at: " << path << ", reason: "
-		          << stbi_failure_reason() << std::endl;
-		std::terminate();
-	}
-	if (numChannels != 4)
-	{
-		std::cerr << "Number of channels in image not equal to 4 at: " << path << std::endl;
-		std::terminate();
-	}
-
-	// Flips image so UV coordinates will be in a right-handed system in OpenGL.
-	flipImage(data, width, height, width, numChannels);
-
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-	const uint32_t rmask = 0xff000000;
-	const uint32_t gmask = 0x00ff0000;
-	const uint32_t bmask = 0x0000ff00;
-	const uint32_t amask = 0x000000ff;
-#else
-	const uint32_t rmask = 0x000000ff;
-	const uint32_t gmask = 0x0000ff00;
-	const uint32_t bmask = 0x00ff0000;
-	const uint32_t amask = 0xff000000;
-#endif
-
-	SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(data, width, height, 32, width*numChannels,
-	                                                rmask, gmask, bmask, amask);
-
-	if (surface == NULL) {
-		std::cerr << "SDL_CreateRGBSurfaceFrom() failed for image at: " << path << ", SDL error: "
-		          << SDL_GetError() << std::endl;
-		std::terminate();
-	}
-
-	SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+// Baked atlas layout, all integers little endian:
+// Header: 8 byte magic, u32 version, u32 numRegions, u64 namesOffset, u64 textureOffset,
+//         u32 padding, u32 reserved
+// Regions: u32 nameOffset, f32 uvMin.x, f32 uvMin.y, f32 uvMax.x, f32 uvMax.y
+// Names: null terminated, referred to by offset into this block
+// Texture: a texture container, at a multiple of 4 and until the end of the atlas
+static const char ATLAS_MAGIC[8] = {'S', 'F', 'Z', 'A', 'T', 'L', 'A', 'S'};
+static const uint32_t ATLAS_VERSION = 2;
+static const size_t ATLAS_HEADER_SIZE = 40;
+static const size_t ATLAS_REGION_SIZE = 20;
 
-	return surface;
-}
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 static bool packRects(vector<stbrp_rect>& rects, int width, int height) noexcept
 {
@@ -113,7 +54,7 @@ static bool packRects(vector<stbrp_rect>& rects, int width, int height) noexcept
 	stbrp_init_target(&packContext, width, height, nodes, width);
 	stbrp_pack_rects(&packContext, rects.data(), rects.size());
 	delete[] nodes;
-	
+
 	// Check if all rects were packed
 	for (auto& rect : rects) {
 		if (!rect.was_packed) return false;
@@ -121,136 +62,156 @@ static bool packRects(vector<stbrp_rect>& rects, int width, int height) noexcept
 	return true;
 }
 
-// TexturePacker: Constructors & destructors
-// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
-
-TexturePacker::TexturePacker(const string& dirPath, const vector<string>& filenames, int padding,
-                             size_t suggestedWidth, size_t suggestedHeight,
-                             TextureFiltering filtering) noexcept
-:
-	mWidth{suggestedWidth},
-	mHeight{suggestedHeight},
-	mFilenames(filenames)
+/**
+ * Decodes and packs the images into a single RGBA image with the first row at the top, like in an
+ * image file. The regions are in OpenGL's UV coordinates (v = 0 at the bottom), i.e. for the image
+ * after it has been flipped by bakeTextureContainer().
+ */
+static bool packImages(const string& name, const vector<string>& filenames, const vector<AssetView>& files,
+                       int padding, size_t& width, size_t& height, vector<uint8_t>& pixelsOut,
+                       unordered_map<string, TextureRegion>& regionsOut) noexcept
 {
-	size_t size = filenames.size();
+	struct Image {
+		uint8_t* pixels;
+		int w, h;
+	};
 
-	// Loads surfaces and creates rects for packing
-	vector<SDL_Surface*> surfaces;
+	// Decodes images and creates rects for packing
+	vector<Image> images;
 	vector<stbrp_rect> rects;
-	for (auto& filename : filenames) {
-		surfaces.emplace_back(loadTexture(dirPath + filename));
+	bool success = true;
+	for (size_t i = 0; i < files.size(); ++i) {
+		Image image;
+		int numChannels;
+		image.pixels = stbi_load_from_memory(files[i].data, (int)files[i].size, &image.w, &image.h,
+		                                     &numChannels, 4);
+		if (image.pixels == NULL) {
+			std::cerr << "Unable to load image at: " << name << filenames[i] << ", reason: "
+			          << stbi_failure_reason() << std::endl;
+			success = false;
+			break;
+		}
+		images.push_back(image);
+
 		struct stbrp_rect r;
-		r.id = surfaces.size()-1;
-		r.w = surfaces.back()->w + 2*padding;
-		r.h = surfaces.back()->h + 2*padding;
+		r.id = int(i);
+		r.w = image.w + 2*padding;
+		r.h = image.h + 2*padding;
 		rects.push_back(r);
 	}
 
-	// Increases size until packing succeeds
-	bool widthIncTurn = true;
-	while (!packRects(rects, (int)mWidth, (int)mHeight)) {
-		if (widthIncTurn) mWidth *= 2;
-		else mHeight *= 2;
-		widthIncTurn = !widthIncTurn;
+	if (success) {
+		// Increases size until packing succeeds
+		bool widthIncTurn = true;
+		while (!packRects(rects, (int)width, (int)height)) {
+			if (widthIncTurn) width *= 2;
+			else height *= 2;
+			widthIncTurn = !widthIncTurn;
+		}
+
+		// Copies the images into the atlas (with empty padding) and calculates their regions. The
+		// rects are placed bottom-up, so the image rows are copied from the bottom of the atlas.
+		pixelsOut.assign(width * height * 4, 0);
+		const vec2 texDimInv{1.0f/(float)width, 1.0f/(float)height};
+		for (size_t i = 0; i < images.size(); ++i) {
+			const Image& image = images[i];
+			const int x = rects[i].x + padding;
+			const int y = rects[i].y + padding;
+			for (int row = 0; row < image.h; ++row) {
+				const size_t dstRow = height - size_t(y) - size_t(image.h) + size_t(row);
+				std::memcpy(pixelsOut.data() + (dstRow * width + size_t(x)) * 4,
+				            image.pixels + size_t(row) * size_t(image.w) * 4, size_t(image.w) * 4);
+			}
+
+			vec2 min = vec2{(float)x, (float)y} * texDimInv;
+			vec2 max = vec2{(float)(x + image.w), (float)(y + image.h)} * texDimInv;
+			regionsOut[filenames[i]] = TextureRegion{min, max};
+		}
 	}
 
-	// Creates surface and makes sure it's empty.
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-	const uint32_t rmask = 0xff000000;
-	const uint32_t gmask = 0x00ff0000;
-	const uint32_t bmask = 0x0000ff00;
-	const uint32_t amask = 0x000000ff;
-#else
-	const uint32_t rmask = 0x000000ff;
-	const uint32_t gmask = 0x0000ff00;
-	const uint32_t bmask = 0x00ff0000;
-	const uint32_t amask = 0xff000000;
-#endif
-	SDL_Surface* surface = SDL_CreateRGBSurface(0, mWidth, mHeight, 32, rmask, gmask, bmask, amask);
-	SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
-	SDL_FillRect(surface, NULL, 0);
-
-	// Blitting individual surfaces to common surface and calculating TextureRegions
-	vec2 texDimInv{1.0f/(float)mWidth, 1.0f/(float)mHeight};
-	for (size_t i = 0; i < size; ++i) {
-		SDL_Rect dstRect;
-		dstRect.w = surfaces[i]->w - 2*padding;
-		dstRect.h = surfaces[i]->h - 2*padding;
-		dstRect.x = rects[i].x + padding;
-		dstRect.y = rects[i].y + padding;
-
-		SDL_BlitSurface(surfaces[i], NULL, surface, &dstRect);
-
-		// Calculate TextureRegion
-		const vec2 offset{0.35f, 0.35f}; // Small hack to fix pixel imprecision
-		vec2 min = (vec2{(float)(dstRect.x + padding), (float)(dstRect.y + padding)} - offset) * texDimInv;
-		vec2 max = (vec2{(float)(dstRect.x + dstRect.w - padding), (float)(dstRect.y + dstRect.h - padding)} + offset) * texDimInv;
-		mTextureRegionMap[filenames[i]] = TextureRegion{min, max};
+	for (const Image& image : images) {
+		stbi_image_free(image.pixels);
 	}
+	return success;
+}
 
-	// Cleaning up surfaces
-	for (SDL_Surface* surface : surfaces) {
-		uint8_t* data = (uint8_t*)surface->pixels;
-		SDL_FreeSurface(surface);
-		stbi_image_free(data);
-	}
+// TexturePacker: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	// Generating texture
-	glGenTextures(1, &mTexture);
-	glBindTexture(GL_TEXTURE_2D, mTexture);
-
-	int numChannels = 4;
-	int width = surface->w;
-	int height = surface->h;
-
-	switch (numChannels) {
-	case 1:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, surface->pixels);
-		break;
-	case 2:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, width, height, 0, GL_RG, GL_UNSIGNED_BYTE, surface->pixels);
-		break;
-	case 3:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, surface->pixels);
-		break;
-	case 4:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, surface->pixels);
-		break;
+TexturePacker::TexturePacker(TexturePacker&& other) noexcept
+{
+	std::swap(this->mTexture, other.mTexture);
+	std::swap(this->mWidth, other.mWidth);
+	std::swap(this->mHeight, other.mHeight);
+	std::swap(this->mFilenames, other.mFilenames);
+	std::swap(this->mTextureRegionMap, other.mTextureRegionMap);
+}
+
+TexturePacker& TexturePacker::operator= (TexturePacker&& other) noexcept
+{
+	std::swap(this->mTexture, other.mTexture);
+	std::swap(this->mWidth, other.mWidth);
+	std::swap(this->mHeight, other.mHeight);
+	std::swap(this->mFilenames, other.mFilenames);
+	std::swap(this->mTextureRegionMap, other.mTextureRegionMap);
+	return *this;
+}
+
+TexturePacker::TexturePacker(const string& dirPath, const vector<string>& filenames, int padding,
+                             size_t suggestedWidth, size_t suggestedHeight,
+                             TextureFiltering filtering) noexcept
+{
+	// The images are decoded straight from the mapped files
+	vector<sfz::MappedFile> mappedFiles;
+	vector<AssetView> files;
+	mappedFiles.reserve(filenames.size());
+	for (auto& filename : filenames) {
+		mappedFiles.emplace_back((dirPath + filename).c_str());
+		AssetView view;
+		view.data = mappedFiles.back().data();
+		view.size = mappedFiles.back().size();
+		files.push_back(view);
 	}
-	SDL_FreeSurface(surface);
-
-	// Sets specified texture filtering, generating mipmaps if needed.
-	switch (filtering) {
-	case TextureFiltering::NEAREST:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		break;
-	case TextureFiltering::BILINEAR:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		break;
-	case TextureFiltering::TRILINEAR:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		break;
-	case TextureFiltering::ANISOTROPIC_1:
-	case TextureFiltering::ANISOTROPIC_2:
-	case TextureFiltering::ANISOTROPIC_4:
-	case TextureFiltering::ANISOTROPIC_8:
-	case TextureFiltering::ANISOTROPIC_16:
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicFactor(filtering));
-		break;
+	*this = TexturePacker{dirPath, filenames, files, padding, suggestedWidth, suggestedHeight, filtering};
+}
+
+TexturePacker::TexturePacker(const string& name, const vector<string>& filenames,
+                             const vector<AssetView>& files, int padding, size_t suggestedWidth,
+                             size_t suggestedHeight, TextureFiltering filtering) noexcept
+:
+	mWidth{suggestedWidth},
+	mHeight{suggestedHeight},
+	mFilenames(filenames)
+{
+	sfz_assert_debug(files.size() == filenames.size());
+	vector<uint8_t> pixels;
+	if (!packImages(name, filenames, files, padding, mWidth, mHeight, pixels, mTextureRegionMap)) {
+		std::terminate();
 	}
+
+	// Mipmaps are generated and uploaded the same way as for baked atlases
+	const vector<uint8_t> container = bakeTextureContainer(pixels.data(), int(mWidth), int(mHeight), 4, false);
+	mTexture = Texture::fromContainer(container.data(), container.size(), (name + " (atlas)").c_str(),
+	                                  filtering, atlasMaxMipLevel(padding));
 }
 
-TexturePacker::~TexturePacker() noexcept
+TexturePacker::TexturePacker(const AssetView& bakedAtlas, const string& name,
+                             TextureFiltering filtering) noexcept
 {
-	glDeleteTextures(1, &mTexture);
+	// Validates the whole region table before touching the texture
+	TextureAtlasInfo info;
+	if (!parseTextureAtlas(bakedAtlas.data, bakedAtlas.size, info)) {
+		std::cerr << "Unable to load baked atlas at: " << name << ", damaged or unknown version" << std::endl;
+		return;
+	}
+	mTexture = Texture::fromContainer(info.container, info.containerSize, (name + " (atlas)").c_str(),
+	                                  filtering, atlasMaxMipLevel(info.padding));
+	if (!mTexture.isValid()) return;
+
+	mWidth = size_t(info.width);
+	mHeight = size_t(info.height);
+	mFilenames = std::move(info.filenames);
+	mTextureRegionMap = std::move(info.regions);
 }
 
 // TexturePacker: Public methods
@@ -263,4 +224,103 @@ const TextureRegion* TexturePacker::textureRegion(const string& filename) const
 	return &it->second;
 }
 
+// Baked atlases
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+uint32_t atlasMaxMipLevel(int padding) noexcept
+{
+	uint32_t level = 0;
+	while ((2 << level) <= padding) level += 1;
+	return level;
+}
+
+bool parseTextureAtlas(const uint8_t* data, size_t size, TextureAtlasInfo& infoOut) noexcept
+{
+	if (data == nullptr || size < ATLAS_HEADER_SIZE) return false;
+	if (std::memcmp(data, ATLAS_MAGIC, sizeof(ATLAS_MAGIC)) != 0) return false;
+	if (readU32(data + 8) != ATLAS_VERSION) return false;
+
+	const uint32_t numRegions = readU32(data + 12);
+	const uint64_t namesOffset = readU64(data + 16);
+	const uint64_t textureOffset = readU64(data + 24);
+	const uint32_t padding = readU32(data + 32);
+	if (namesOffset != ATLAS_HEADER_SIZE + uint64_t(numRegions) * ATLAS_REGION_SIZE) return false;
+	if (textureOffset < namesOffset || textureOffset > size) return false;
+	if (padding > 1024) return false;
+
+	TextureAtlasInfo info;
+	info.padding = int(padding);
+	info.filenames.reserve(numRegions);
+	for (uint32_t i = 0; i < numRegions; ++i) {
+		const uint8_t* region = data + ATLAS_HEADER_SIZE + size_t(i) * ATLAS_REGION_SIZE;
+		const uint64_t nameOffset = namesOffset + readU32(region);
+		if (nameOffset >= textureOffset) return false;
+		if (std::memchr(data + nameOffset, '\0', size_t(textureOffset - nameOffset)) == nullptr) return false;
+		info.filenames.emplace_back(reinterpret_cast<const char*>(data + nameOffset));
+		info.regions[info.filenames.back()] = TextureRegion{vec2{readF32(region + 4), readF32(region + 8)},
+		                                                    vec2{readF32(region + 12), readF32(region + 16)}};
+	}
+
+	info.container = data + textureOffset;
+	info.containerSize = size - size_t(textureOffset);
+	TextureContainerInfo containerInfo;
+	if (!parseTextureContainer(info.container, info.containerSize, containerInfo)) return false;
+	info.width = containerInfo.width;
+	info.height = containerInfo.height;
+
+	infoOut = std::move(info);
+	return true;
+}
+
+vector<uint8_t> bakeTextureAtlas(const vector<string>& filenames, const vector<AssetView>& files,
+                                 int padding, size_t suggestedWidth, size_t suggestedHeight,
+                                 bool compress) noexcept
+{
+	sfz_assert_debug(files.size() == filenames.size());
+	size_t width = suggestedWidth, height = suggestedHeight;
+	vector<uint8_t> pixels;
+	unordered_map<string, TextureRegion> regions;
+	if (!packImages("", filenames, files, padding, width, height, pixels, regions)) {
+		return vector<uint8_t>();
+	}
+
+	vector<uint8_t> names;
+	vector<uint8_t> atlas(ATLAS_HEADER_SIZE + filenames.size() * ATLAS_REGION_SIZE, 0);
+	for (size_t i = 0; i < filenames.size(); ++i) {
+		const TextureRegion& region = regions[filenames[i]];
+		uint8_t* ptr = atlas.data() + ATLAS_HEADER_SIZE + i * ATLAS_REGION_SIZE;
+		writeU32(ptr, uint32_t(names.size()));
+		writeF32(ptr + 4, region.mUVMin.x);
+		writeF32(ptr + 8, region.mUVMin.y);
+		writeF32(ptr + 12, region.mUVMax.x);
+		writeF32(ptr + 16, region.mUVMax.y);
+		names.insert(names.end(), filenames[i].begin(), filenames[i].end());
+		names.push_back('\0');
+	}
+
+	const size_t namesOffset = atlas.size();
+	atlas.insert(atlas.end(), names.begin(), names.end());
+	atlas.resize((atlas.size() + 3) / 4 * 4, 0);
+	const size_t textureOffset = atlas.size();
+
+	std::memcpy(atlas.data(), ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+	writeU32(atlas.data() + 8, ATLAS_VERSION);
+	writeU32(atlas.data() + 12, uint32_t(filenames.size()));
+	writeU64(atlas.data() + 16, namesOffset);
+	writeU64(atlas.data() + 24, textureOffset);
+	writeU32(atlas.data() + 32, uint32_t(padding));
+	writeU32(atlas.data() + 36, 0);
+
+	const vector<uint8_t> container = bakeTextureContainer(pixels.data(), int(width), int(height), 4, compress);
+	atlas.insert(atlas.end(), container.begin(), container.end());
+	return atlas;
+}
+
+string bakedAtlasName(const string& dirPath) noexcept
+{
+	string name = dirPath;
+	while (!name.empty() && (name.back() == '/' || name.back() == '\\')) name.pop_back();
+	return name + ".sfzatlas";
+}
+
 } // namespace sfz
\ No newline at end of file
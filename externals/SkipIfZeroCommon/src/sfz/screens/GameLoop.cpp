@@ -7,6 +7,9 @@
 #include <unordered_map>
 #include <vector>
 
+#include "sfz/gl/FramePacer.hpp"
+#include "sfz/gl/RenderTargetPool.hpp"
+#include "sfz/gl/StateCache.hpp"
 #include "sfz/math/Vector.hpp"
 #include "sfz/sdl/GameController.hpp"
 
@@ -53,10 +56,14 @@ static void initControllers(unordered_map<int32_t, sdl::GameController>& control
 // GameLoop function
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-void runGameLoop(sdl::Window& window, shared_ptr<BaseScreen> currentScreen)
+void runGameLoop(sdl::Window& window, shared_ptr<BaseScreen> currentScreen, uint32_t maxFramesInFlight)
 {
 	UpdateState state{window};
 
+	// Initialize frame pacing
+	gl::FramePacer framePacer{maxFramesInFlight};
+	state.framePacer = &framePacer;
+
 	// Initialize controllers
 	initControllers(state.controllers);
 
@@ -69,6 +76,10 @@ void runGameLoop(sdl::Window& window, shared_ptr<BaseScreen> currentScreen)
 	SDL_Event event;
 
 	while (true) {
+		// Wait for the GPU before sampling input, so that input latency isn't increased by frames
+		// queued up beyond the frames in flight limit
+		framePacer.waitForFrameSlot();
+
 		// Calculate delta
 		state.delta = std::min(calculateDelta(previousTime), 0.2f);
 
@@ -150,9 +161,12 @@ void runGameLoop(sdl::Window& window, shared_ptr<BaseScreen> currentScreen)
 		}
 
 		// Render current screen
+		gl::StateCache::INSTANCE().newFrame();
+		gl::RenderTargetPool::INSTANCE().newFrame();
 		currentScreen->render(state);
 
 		SDL_GL_SwapWindow(window.ptr);
+		framePacer.frameSubmitted();
 	}
 }
 
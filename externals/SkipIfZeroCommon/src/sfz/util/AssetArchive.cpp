@@ -0,0 +1,257 @@
+#include "sfz/util/AssetArchive.hpp"
+
+#include "sfz/util/ByteIO.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace sfz {
+
+// Static constants
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Layout, all integers little endian:
+// Header: 8 byte magic, u32 version, u32 numEntries, u64 namesOffset, u64 namesSize
+// Entries (sorted by hash): u64 nameHash, u64 dataOffset, u64 dataSize, u32 nameOffset, u32 compression
+// Names: null terminated, referred to by offset into this block
+// Data: each asset starts at a multiple of DATA_ALIGNMENT
+static const char MAGIC[8] = {'S', 'F', 'Z', 'A', 'S', 'S', 'E', 'T'};
+static const uint32_t VERSION = 1;
+static const size_t HEADER_SIZE = 32;
+static const size_t ENTRY_SIZE = 32;
+static const size_t DATA_ALIGNMENT = 16;
+
+// Only uncompressed entries are written for now, other values make the archive invalid.
+static const uint32_t COMPRESSION_NONE = 0;
+
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static const uint8_t* entryPtr(const MappedFile& file, uint32_t index) noexcept
+{
+	return file.data() + HEADER_SIZE + size_t(index) * ENTRY_SIZE;
+}
+
+/** Checks that everything the index refers to is inside the file, so lookups don't have to. */
+static bool validateArchive(const MappedFile& file, uint32_t& numEntriesOut) noexcept
+{
+	const uint8_t* data = file.data();
+	const uint64_t fileSize = file.size();
+	if (fileSize < HEADER_SIZE) return false;
+	if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) return false;
+	if (readU32(data + 8) != VERSION) return false;
+
+	const uint32_t numEntries = readU32(data + 12);
+	const uint64_t namesOffset = readU64(data + 16);
+	const uint64_t namesSize = readU64(data + 24);
+	if (namesOffset != HEADER_SIZE + uint64_t(numEntries) * ENTRY_SIZE) return false;
+	if (namesOffset > fileSize || namesSize > fileSize - namesOffset) return false;
+	if (namesSize == 0 || data[namesOffset + namesSize - 1] != '\0') return false;
+
+	uint64_t prevHash = 0;
+	for (uint32_t i = 0; i < numEntries; ++i) {
+		const uint8_t* entry = entryPtr(file, i);
+		const uint64_t hash = readU64(entry);
+		const uint64_t offset = readU64(entry + 8);
+		const uint64_t size = readU64(entry + 16);
+		if (i != 0 && hash < prevHash) return false;
+		if (offset > fileSize || size > fileSize - offset) return false;
+		if (readU32(entry + 24) >= namesSize) return false;
+		if (readU32(entry + 28) != COMPRESSION_NONE) return false;
+		prevHash = hash;
+	}
+
+	numEntriesOut = numEntries;
+	return true;
+}
+
+// AssetArchive: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+AssetArchive::AssetArchive(AssetArchive&& other) noexcept
+{
+	std::swap(this->mFile, other.mFile);
+	std::swap(this->mNumEntries, other.mNumEntries);
+}
+
+AssetArchive& AssetArchive::operator= (AssetArchive&& other) noexcept
+{
+	std::swap(this->mFile, other.mFile);
+	std::swap(this->mNumEntries, other.mNumEntries);
+	return *this;
+}
+
+AssetArchive::AssetArchive(const char* path) noexcept
+:
+	mFile{path}
+{
+	if (!mFile.isValid()) return;
+	if (!validateArchive(mFile, mNumEntries)) {
+		std::cerr << "Asset archive at \"" << path << "\" is damaged or of an unknown version" << std::endl;
+		mFile.destroy();
+		mNumEntries = 0;
+	}
+}
+
+// AssetArchive: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+AssetView AssetArchive::find(const char* name) const noexcept
+{
+	const uint64_t hash = assetNameHash(name);
+
+	// Binary search for the first entry with the hash
+	uint32_t first = 0;
+	uint32_t count = mNumEntries;
+	while (count > 0) {
+		uint32_t step = count / 2;
+		if (readU64(entryPtr(mFile, first + step)) < hash) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+
+	// Names are compared as well, in the unlikely case that two of them share the same hash
+	for (uint32_t i = first; i < mNumEntries; ++i) {
+		const uint8_t* entry = entryPtr(mFile, i);
+		if (readU64(entry) != hash) break;
+		if (std::strcmp(entryName(i), name) != 0) continue;
+
+		AssetView view;
+		view.data = mFile.data() + readU64(entry + 8);
+		view.size = size_t(readU64(entry + 16));
+		return view;
+	}
+	return AssetView{};
+}
+
+const char* AssetArchive::entryName(uint32_t index) const noexcept
+{
+	if (index >= mNumEntries) return nullptr;
+	const uint64_t namesOffset = readU64(mFile.data() + 16);
+	return mFile.str() + namesOffset + readU32(entryPtr(mFile, index) + 24);
+}
+
+// Asset archive functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+uint64_t assetNameHash(const char* name) noexcept
+{
+	return fnv1a64(reinterpret_cast<const uint8_t*>(name), std::strlen(name));
+}
+
+bool writeAssetArchive(const char* archivePath, const char* rootPath, const vector<string>& names) noexcept
+{
+	// Maps all files first, so that nothing is written if one of them is missing
+	vector<MappedFile> files;
+	vector<AssetView> contents;
+	files.reserve(names.size());
+	contents.reserve(names.size());
+	for (const string& name : names) {
+		files.emplace_back((string(rootPath) + name).c_str());
+		if (!files.back().isValid()) {
+			std::cerr << "Couldn't read asset \"" << name << "\"" << std::endl;
+			return false;
+		}
+		AssetView view;
+		view.data = files.back().data();
+		view.size = files.back().size();
+		contents.push_back(view);
+	}
+	return writeAssetArchive(archivePath, names, contents);
+}
+
+bool writeAssetArchive(const char* archivePath, const vector<string>& names,
+                       const vector<AssetView>& contents) noexcept
+{
+	struct PackEntry {
+		string name;
+		uint64_t hash;
+		AssetView contents;
+		uint64_t dataOffset, nameOffset;
+	};
+
+	if (names.size() != contents.size()) return false;
+	vector<PackEntry> entries;
+	entries.reserve(names.size());
+	for (size_t i = 0; i < names.size(); ++i) {
+		PackEntry entry;
+		entry.name = names[i];
+		std::replace(entry.name.begin(), entry.name.end(), '\\', '/');
+		entry.hash = assetNameHash(entry.name.c_str());
+		entry.contents = contents[i];
+		entries.push_back(std::move(entry));
+	}
+	std::sort(entries.begin(), entries.end(), [](const PackEntry& lhs, const PackEntry& rhs) {
+		return lhs.hash < rhs.hash || (lhs.hash == rhs.hash && lhs.name < rhs.name);
+	});
+
+	// Header, index and names
+	vector<uint8_t> nameBlock;
+	nameBlock.push_back('\0'); // Never empty, simplifies validation
+	for (PackEntry& entry : entries) {
+		entry.nameOffset = nameBlock.size();
+		nameBlock.insert(nameBlock.end(), entry.name.begin(), entry.name.end());
+		nameBlock.push_back('\0');
+	}
+
+	const uint64_t namesOffset = HEADER_SIZE + entries.size() * ENTRY_SIZE;
+	uint64_t offset = namesOffset + nameBlock.size();
+	for (PackEntry& entry : entries) {
+		offset = (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+		entry.dataOffset = offset;
+		offset += entry.contents.size;
+	}
+
+	vector<uint8_t> index(size_t(namesOffset), 0);
+	std::memcpy(index.data(), MAGIC, sizeof(MAGIC));
+	writeU32(index.data() + 8, VERSION);
+	writeU32(index.data() + 12, uint32_t(entries.size()));
+	writeU64(index.data() + 16, namesOffset);
+	writeU64(index.data() + 24, nameBlock.size());
+	for (size_t i = 0; i < entries.size(); ++i) {
+		uint8_t* ptr = index.data() + HEADER_SIZE + i * ENTRY_SIZE;
+		writeU64(ptr, entries[i].hash);
+		writeU64(ptr + 8, entries[i].dataOffset);
+		writeU64(ptr + 16, entries[i].contents.size);
+		writeU32(ptr + 24, uint32_t(entries[i].nameOffset));
+		writeU32(ptr + 28, COMPRESSION_NONE);
+	}
+
+	// Written to a temporary file first, so a failed write doesn't leave a damaged archive behind
+	const string tmpPath = string(archivePath) + ".tmp";
+	std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+	if (file == NULL) {
+		std::cerr << "Couldn't create asset archive at \"" << archivePath << "\"" << std::endl;
+		return false;
+	}
+
+	bool success = std::fwrite(index.data(), 1, index.size(), file) == index.size();
+	success = success && std::fwrite(nameBlock.data(), 1, nameBlock.size(), file) == nameBlock.size();
+	uint64_t written = namesOffset + nameBlock.size();
+	const uint8_t padding[DATA_ALIGNMENT] = {};
+	for (const PackEntry& entry : entries) {
+		if (!success) break;
+		const size_t paddingSize = size_t(entry.dataOffset - written);
+		success = std::fwrite(padding, 1, paddingSize, file) == paddingSize;
+		success = success && std::fwrite(entry.contents.data, 1, entry.contents.size, file) == entry.contents.size;
+		written = entry.dataOffset + entry.contents.size;
+	}
+	success = (std::fclose(file) == 0) && success;
+
+	if (success) {
+		std::remove(archivePath); // rename() doesn't replace existing files on Windows
+		success = std::rename(tmpPath.c_str(), archivePath) == 0;
+	}
+	if (!success) {
+		std::cerr << "Couldn't write asset archive at \"" << archivePath << "\"" << std::endl;
+		std::remove(tmpPath.c_str());
+	}
+	return success;
+}
+
+} // namespace sfz
\ No newline at end of file
@@ -61,29 +61,27 @@ const string& gameBaseFolderPath() noexcept
 
 bool fileExists(const char* path) noexcept
 {
-	std::FILE* file = std::fopen(path, "r");
-	if (file == NULL) return false;
-	std::fclose(file);
-	return true;
+#ifdef _WIN32
+	DWORD ftyp = GetFileAttributesA(path);
+	if (ftyp == INVALID_FILE_ATTRIBUTES) return false;
+	return (ftyp & FILE_ATTRIBUTE_DIRECTORY) == 0;
+#else
+	struct stat pathStat;
+	if (stat(path, &pathStat) != 0) return false;
+	return !S_ISDIR(pathStat.st_mode);
+#endif
 }
 
 bool directoryExists(const char* path) noexcept
 {
 #ifdef _WIN32
-	std::FILE* file = std::fopen(path, "r");
-	if (file == NULL) {
-		DWORD ftyp = GetFileAttributesA(path);
-		if (ftyp == INVALID_FILE_ATTRIBUTES) return false;
-		if (ftyp & FILE_ATTRIBUTE_DIRECTORY) return true;
-		return false;
-	}
-	std::fclose(file);
-	return true;
+	DWORD ftyp = GetFileAttributesA(path);
+	if (ftyp == INVALID_FILE_ATTRIBUTES) return false;
+	return (ftyp & FILE_ATTRIBUTE_DIRECTORY) != 0;
 #else
-	std::FILE* file = std::fopen(path, "r");
-	if (file == NULL) return false;
-	std::fclose(file);
-	return true;
+	struct stat pathStat;
+	if (stat(path, &pathStat) != 0) return false;
+	return S_ISDIR(pathStat.st_mode);
 #endif
 }
 
@@ -198,27 +196,13 @@ vector<uint8_t> readBinaryFile(const char* path) noexcept
 		return vector<uint8_t>{};
 	}
 
-	// Create vector with enough capacity to fit file
+	// Read the file directly into the vector
 	vector<uint8_t> temp(static_cast<size_t>(size));
-
-	// Read the file into the vector
-	uint8_t buffer[BUFSIZ];
-	size_t readSize;
-	size_t currOffs = 0;
-	while ((readSize = std::fread(buffer, 1, BUFSIZ, file)) > 0) {
-
-		// Ensure vector has space.
-		if ((temp.data() + currOffs + readSize) > (temp.data() + temp.size())) {
-			size_t diff = (temp.data() + currOffs + readSize) - (temp.data() + temp.size());
-			temp.resize(temp.size() + diff, 0);
-		}
-
-		std::memcpy(temp.data() + currOffs, buffer, readSize);
-		currOffs += readSize;
-	}
+	size_t numRead = std::fread(temp.data(), 1, temp.size(), file);
+	temp.resize(numRead);
 
 	std::fclose(file);
-	return std::move(temp);
+	return temp;
 }
 
 string readTextFile(const char* path) noexcept
@@ -236,26 +220,13 @@ string readTextFile(const char* path) noexcept
 		return "";
 	}
 
-	// Create string with enough capacity to fit file
-	string str = "";
-	str.reserve(static_cast<size_t>(size + 1));
-
-	// Read the file into the vector
-	uint8_t buffer[BUFSIZ+1];
-	buffer[BUFSIZ] = '\0';
-	size_t readSize;
-	while ((readSize = std::fread(buffer, 1, BUFSIZ, file)) > 0) {
-
-		if (readSize < BUFSIZ) {
-			buffer[readSize] = '\0';
-			str += (char*)buffer;
-		} else {
-			str += (char*)buffer;
-		}
-	}
+	// Read the file directly into the string, text mode may make it shorter than its size on disk
+	string str(static_cast<size_t>(size), '\0');
+	size_t numRead = std::fread(&str[0], 1, str.size(), file);
+	str.resize(numRead);
 
 	std::fclose(file);
-	return std::move(str);
+	return str;
 }
 
 bool writeBinaryFile(const char* path, const uint8_t* data, size_t numBytes) noexcept
@@ -1,21 +1,31 @@
 #include "sfz/util/IniParser.hpp"
 
 #include "sfz/Assert.hpp"
+#include "sfz/util/IO.hpp"
 
-#include <algorithm>
 #include <cctype> // std::tolower()
-#include <fstream>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 namespace sfz {
 
 // Static functions
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-static void toLowerCase(string& str) noexcept
+static bool isWhitespace(char c) noexcept
 {
-	for (size_t i = 0; i < str.size(); ++i) {
-		str[i] = std::tolower(str[i]);
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool equalsIgnoreCase(const char* str, size_t length, const char* lowerCase) noexcept
+{
+	if (std::strlen(lowerCase) != length) return false;
+	for (size_t i = 0; i < length; ++i) {
+		if (std::tolower(str[i]) != lowerCase[i]) return false;
 	}
+	return true;
 }
 
 // IniParser: Constructors & destructors
@@ -31,34 +41,59 @@ IniParser::IniParser(const string& path) noexcept
 
 bool IniParser::load() noexcept
 {
-	std::ifstream file{mPath};
-	if (!file.is_open()) return false;
+	if (!fileExists(mPath.c_str())) return false;
+
+	mText = readTextFile(mPath.c_str());
+	mItems.clear();
+	mDirty = false;
+
+	const char* text = mText.data();
+	const uint32_t textSize = (uint32_t)mText.size();
+	Range section{0, 0};
+	uint32_t pos = 0;
+	while (pos < textSize) {
+		// Find the line and trim whitespace at both ends
+		uint32_t lineBegin = pos;
+		uint32_t lineEnd = pos;
+		while (lineEnd < textSize && text[lineEnd] != '\n') lineEnd += 1;
+		pos = lineEnd + 1;
+		while (lineBegin < lineEnd && isWhitespace(text[lineBegin])) lineBegin += 1;
+		while (lineEnd > lineBegin && isWhitespace(text[lineEnd - 1])) lineEnd -= 1;
+
+		if (lineBegin == lineEnd) continue;
+		if (text[lineBegin] == ';') continue; // Skip comments
 
-	mIniTree.clear();
-
-	std::string str;
-	std::string currentSection = "";
-	while (std::getline(file, str)) {
-		if (str == "") continue;
-		if (str[0] == ';') continue; // Remove comments
-		
 		// Check if new section
-		size_t sectLoc = str.find_first_of("[");
-		if (sectLoc != str.npos) {
-			size_t endLoc = str.find_first_of("]");
-			if (endLoc == str.npos) return false;
-			if (sectLoc >= endLoc) return false;
-			currentSection = str.substr(sectLoc+1, endLoc-sectLoc-1);
-			mIniTree.emplace(std::make_pair(currentSection, map<string,string>{}));
+		if (text[lineBegin] == '[') {
+			const char* endPtr = (const char*)std::memchr(text + lineBegin, ']', lineEnd - lineBegin);
+			if (endPtr == nullptr) return false;
+			section = Range{lineBegin + 1, (uint32_t)(endPtr - text) - lineBegin - 1};
 			continue;
 		}
 
-		// Add item to tree
-		size_t delimLoc = str.find_first_of("=");
-		if (delimLoc == str.npos) return false;
-		if (delimLoc == 0) return false;
-		if (delimLoc+1 == str.size()) return false;
-		mIniTree[currentSection][str.substr(0, delimLoc)] = str.substr(delimLoc+1, str.size()-delimLoc+1);
+		// Add item, a key appearing twice in a section keeps the last value
+		const char* delimPtr = (const char*)std::memchr(text + lineBegin, '=', lineEnd - lineBegin);
+		if (delimPtr == nullptr) return false;
+		const uint32_t delimLoc = (uint32_t)(delimPtr - text);
+
+		// Whitespace around the delimiter is allowed, i.e. "key = value"
+		uint32_t keyEnd = delimLoc;
+		uint32_t valueBegin = delimLoc + 1;
+		while (keyEnd > lineBegin && isWhitespace(text[keyEnd - 1])) keyEnd -= 1;
+		while (valueBegin < lineEnd && isWhitespace(text[valueBegin])) valueBegin += 1;
+		if (keyEnd == lineBegin) return false;
+		if (valueBegin == lineEnd) return false;
+
+		Item item{section, Range{lineBegin, keyEnd - lineBegin}, Range{valueBegin, lineEnd - valueBegin}};
+		bool replaced = false;
+		for (Item& existing : mItems) {
+			if (equals(existing.section, item.section) && equals(existing.key, item.key)) {
+				existing.value = item.value;
+				replaced = true;
+				break;
+			}
+		}
+		if (!replaced) mItems.push_back(item);
 	}
 
 	return true;
@@ -66,186 +101,203 @@ bool IniParser::load() noexcept
 
 bool IniParser::save() noexcept
 {
-	// Check if current file is correct
-	IniParser oldFileParser = *this;
-	oldFileParser.load();
-	if (mIniTree == oldFileParser.mIniTree) return true;
-
-	// Opens the file and clears it
-	std::ofstream file{mPath, std::ofstream::out | std::ofstream::trunc};
-	if (!file.is_open()) return false;
-
-	// Adds the global items first
-	auto globalItr = mIniTree.find("");
-	if (globalItr != mIniTree.end()) {
-		for (auto& keyPair : globalItr->second) {
-			file << keyPair.first << "=" << keyPair.second << "\n";
+	if (!mDirty) return true;
+
+	string out;
+	out.reserve(mText.size());
+	auto appendRange = [&](Range range) {
+		out.append(mText, range.begin, range.length);
+	};
+
+	auto appendSection = [&](Range section) {
+		for (const Item& item : mItems) {
+			if (!equals(item.section, section)) continue;
+			appendRange(item.key);
+			out += '=';
+			appendRange(item.value);
+			out += '\n';
 		}
-		file << "\n";
-	}
+		out += '\n';
+	};
 
-	// Adds the rest of the sections and items
-	for (auto& sectionPair : mIniTree) {
-		if (sectionPair.first == "") continue;
-		file << "[" << sectionPair.first << "]" << "\n";
-		
-		for (auto& keyPair : sectionPair.second) {
-			file << keyPair.first << "=" << keyPair.second << "\n";
+	// Global items first, then the sections in the order they first appear
+	bool hasGlobalItems = false;
+	for (const Item& item : mItems) {
+		if (item.section.length == 0) hasGlobalItems = true;
+	}
+	if (hasGlobalItems) appendSection(Range{0, 0});
+
+	for (size_t i = 0; i < mItems.size(); ++i) {
+		const Range section = mItems[i].section;
+		if (section.length == 0) continue;
+		bool firstInSection = true;
+		for (size_t j = 0; j < i; ++j) {
+			if (equals(mItems[j].section, section)) {
+				firstInSection = false;
+				break;
+			}
 		}
-		file << "\n";
+		if (!firstInSection) continue;
+
+		out += '[';
+		appendRange(section);
+		out += "]\n";
+		appendSection(section);
 	}
 
-	file.flush();
+	if (!writeBinaryFile(mPath.c_str(), (const uint8_t*)out.data(), out.size())) return false;
+	mDirty = false;
 	return true;
 }
 
 // IniParser: Info about a specific item
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-bool IniParser::itemExists(const string& section, const string& key) const noexcept
+bool IniParser::itemExists(const char* section, const char* key) const noexcept
 {
-	auto sectionItr = mIniTree.find(section);
-	if (sectionItr == mIniTree.end()) return false;
-	auto keyItr = sectionItr->second.find(key);
-	if (keyItr == sectionItr->second.end()) return false;
-	return true;
+	return findItem(section, key) != nullptr;
 }
 
-bool IniParser::itemIsBool(const string& section, const string& key) const noexcept
+bool IniParser::itemIsBool(const char* section, const char* key) const noexcept
 {
-	auto sectionItr = mIniTree.find(section);
-	if (sectionItr == mIniTree.end()) return false;
-	auto keyItr = sectionItr->second.find(key);
-	if (keyItr == sectionItr->second.end()) return false;
-
-	string val = keyItr->second;
-	toLowerCase(val);
-	return val == "true" || val == "false"
-	    || val == "on" || val == "off"
-	    || val == "1" || val == "0";
+	const Item* item = findItem(section, key);
+	bool tmp;
+	return item != nullptr && parseBool(item->value, tmp);
 }
 
-bool IniParser::itemIsInt(const string& section, const string& key) const noexcept
+bool IniParser::itemIsInt(const char* section, const char* key) const noexcept
 {
-	auto sectionItr = mIniTree.find(section);
-	if (sectionItr == mIniTree.end()) return false;
-	auto keyItr = sectionItr->second.find(key);
-	if (keyItr == sectionItr->second.end()) return false;
-
-	string val = keyItr->second;
-	try {
-		std::stoi(val);
-		return true;
-	} catch (...) {
-		return false;
-	}
+	const Item* item = findItem(section, key);
+	int32_t tmp;
+	return item != nullptr && parseInt(item->value, tmp);
 }
 
-bool IniParser::itemIsFloat(const string& section, const string& key) const noexcept
+bool IniParser::itemIsFloat(const char* section, const char* key) const noexcept
 {
-	auto sectionItr = mIniTree.find(section);
-	if (sectionItr == mIniTree.end()) return false;
-	auto keyItr = sectionItr->second.find(key);
-	if (keyItr == sectionItr->second.end()) return false;
-
-	string val = keyItr->second;
-	try {
-		std::stof(val);
-		return true;
-	} catch (...) {
-		return false;
-	}
+	const Item* item = findItem(section, key);
+	float tmp;
+	return item != nullptr && parseFloat(item->value, tmp);
 }
 
 // IniParser: Getters
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-string IniParser::getString(const string& section, const string& key,
+string IniParser::getString(const char* section, const char* key,
                             const string& defaultValue) const noexcept
 {
-	auto sectionItr = mIniTree.find(section);
-	if (sectionItr == mIniTree.end()) return defaultValue;
-	auto keyItr = sectionItr->second.find(key);
-	if (keyItr == sectionItr->second.end()) return defaultValue;
-	return keyItr->second;
+	const Item* item = findItem(section, key);
+	if (item == nullptr) return defaultValue;
+	return mText.substr(item->value.begin, item->value.length);
 }
 
-bool IniParser::getBool(const string& section, const string& key,
+bool IniParser::getBool(const char* section, const char* key,
                         bool defaultValue) const noexcept
 {
-	string val = this->getString(section, key, defaultValue ? "true" : "false");
-	toLowerCase(val);
-	if (val == "true") return true;
-	if (val == "on") return true;
-	if (val == "1") return true;
-	return false;
-
+	const Item* item = findItem(section, key);
+	bool value;
+	if (item == nullptr || !parseBool(item->value, value)) return defaultValue;
+	return value;
 }
 
-int32_t IniParser::getInt(const string& section, const string& key,
+int32_t IniParser::getInt(const char* section, const char* key,
                           int32_t defaultValue) const noexcept
 {
-	string val = this->getString(section, key, std::to_string(defaultValue));
+	const Item* item = findItem(section, key);
 	int32_t value;
-	try {
-		value = std::stoi(val);
-	} catch (...) {
-		value = defaultValue;
-	}
+	if (item == nullptr || !parseInt(item->value, value)) return defaultValue;
 	return value;
 }
 
-float IniParser::getFloat(const string& section, const string& key,
+float IniParser::getFloat(const char* section, const char* key,
                           float defaultValue) const noexcept
 {
-	string val = this->getString(section, key, std::to_string(defaultValue));
+	const Item* item = findItem(section, key);
 	float value;
-	try {
-		value = std::stof(val);
-	}
-	catch (...) {
-		value = defaultValue;
-	}
+	if (item == nullptr || !parseFloat(item->value, value)) return defaultValue;
 	return value;
 }
 
 // IniParser: Setters
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-void IniParser::setString(const string& section, const string& key, const string& value) noexcept
+void IniParser::setString(const char* section, const char* key, const char* value) noexcept
 {
-	mIniTree[section][key] = value;
+	Item* item = findItem(section, key);
+	if (item != nullptr) {
+		if (equals(item->value, value)) return;
+		item->value = appendText(value);
+		mDirty = true;
+		return;
+	}
+
+	// Reuse the text of the section name if it already exists
+	Range sectionRange{0, 0};
+	bool sectionFound = false;
+	for (const Item& existing : mItems) {
+		if (equals(existing.section, section)) {
+			sectionRange = existing.section;
+			sectionFound = true;
+			break;
+		}
+	}
+	if (!sectionFound) sectionRange = appendText(section);
+
+	Item newItem;
+	newItem.section = sectionRange;
+	newItem.key = appendText(key);
+	newItem.value = appendText(value);
+	mItems.push_back(newItem);
+	mDirty = true;
 }
 
-void IniParser::setBool(const string& section, const string& key, bool value) noexcept
+void IniParser::setBool(const char* section, const char* key, bool value) noexcept
 {
+	const Item* item = findItem(section, key);
+	bool current;
+	if (item != nullptr && parseBool(item->value, current) && current == value) return;
 	this->setString(section, key, value ? "true" : "false");
 }
 
-void IniParser::setInt(const string& section, const string& key, int32_t value) noexcept
+void IniParser::setInt(const char* section, const char* key, int32_t value) noexcept
 {
-	this->setString(section, key, std::to_string(value));
+	const Item* item = findItem(section, key);
+	int32_t current;
+	if (item != nullptr && parseInt(item->value, current) && current == value) return;
+
+	char buffer[16];
+	std::snprintf(buffer, sizeof(buffer), "%i", value);
+	this->setString(section, key, buffer);
 }
 
-void IniParser::setFloat(const string& section, const string& key, float value) noexcept
+void IniParser::setFloat(const char* section, const char* key, float value) noexcept
 {
-	this->setString(section, key, std::to_string(value));
+	const Item* item = findItem(section, key);
+	float current;
+	if (item != nullptr && parseFloat(item->value, current) && current == value) return;
+
+	// Short representation if it reads back as the same value, otherwise all digits needed
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%g", value);
+	if (std::strtof(buffer, nullptr) != value) {
+		std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+	}
+	this->setString(section, key, buffer);
 }
 
 // Sanitizers
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-string IniParser::sanitizeString(const string& section, const string& key,
+string IniParser::sanitizeString(const char* section, const char* key,
                                  const string& defaultValue) noexcept
 {
 	if (!this->itemExists(section, key)) {
-		this->setString(section, key, defaultValue);
+		this->setString(section, key, defaultValue.c_str());
 		return defaultValue;
 	}
 	return this->getString(section, key);
 }
 
-bool IniParser::sanitizeBool(const string& section, const string& key,
+bool IniParser::sanitizeBool(const char* section, const char* key,
                              bool defaultValue) noexcept
 {
 	if (!this->itemIsBool(section, key)) {
@@ -255,7 +307,7 @@ bool IniParser::sanitizeBool(const string& section, const string& key,
 	return this->getBool(section, key);
 }
 
-int32_t IniParser::sanitizeInt(const string& section, const string& key,
+int32_t IniParser::sanitizeInt(const char* section, const char* key,
                                int32_t defaultValue, int32_t minValue, int32_t maxValue) noexcept
 {
 	sfz_assert_debug(minValue <= maxValue);
@@ -264,12 +316,13 @@ int32_t IniParser::sanitizeInt(const string& section, const string& key,
 		return defaultValue;
 	}
 	int32_t value = this->getInt(section, key);
-	if (value > maxValue) this->setInt(section, key, maxValue);
-	else if (value < minValue) this->setInt(section, key, minValue);
-	return this->getInt(section, key);
+	if (value > maxValue) value = maxValue;
+	else if (value < minValue) value = minValue;
+	this->setInt(section, key, value);
+	return value;
 }
 
-float IniParser::sanitizeFloat(const string& section, const string& key,
+float IniParser::sanitizeFloat(const char* section, const char* key,
                                float defaultValue, float minValue, float maxValue) noexcept
 {
 	sfz_assert_debug(minValue <= maxValue);
@@ -278,9 +331,99 @@ float IniParser::sanitizeFloat(const string& section, const string& key,
 		return defaultValue;
 	}
 	float value = this->getFloat(section, key);
-	if (value > maxValue) this->setFloat(section, key, maxValue);
-	else if (value < minValue) this->setFloat(section, key, minValue);
-	return this->getFloat(section, key);
+	if (value > maxValue) value = maxValue;
+	else if (value < minValue) value = minValue;
+	this->setFloat(section, key, value);
+	return value;
+}
+
+// IniParser: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+IniParser::Item* IniParser::findItem(const char* section, const char* key) noexcept
+{
+	for (Item& item : mItems) {
+		if (equals(item.key, key) && equals(item.section, section)) return &item;
+	}
+	return nullptr;
+}
+
+const IniParser::Item* IniParser::findItem(const char* section, const char* key) const noexcept
+{
+	for (const Item& item : mItems) {
+		if (equals(item.key, key) && equals(item.section, section)) return &item;
+	}
+	return nullptr;
+}
+
+bool IniParser::equals(Range range, const char* str) const noexcept
+{
+	return std::strncmp(mText.data() + range.begin, str, range.length) == 0
+	    && str[range.length] == '\0';
+}
+
+bool IniParser::equals(Range lhs, Range rhs) const noexcept
+{
+	return lhs.length == rhs.length
+	    && std::memcmp(mText.data() + lhs.begin, mText.data() + rhs.begin, lhs.length) == 0;
+}
+
+IniParser::Range IniParser::appendText(const char* str) noexcept
+{
+	Range range{(uint32_t)mText.size(), (uint32_t)std::strlen(str)};
+	mText.append(str, range.length);
+	return range;
+}
+
+bool IniParser::parseBool(Range range, bool& valueOut) const noexcept
+{
+	const char* str = mText.data() + range.begin;
+	if (equalsIgnoreCase(str, range.length, "true") || equalsIgnoreCase(str, range.length, "on")
+	 || equalsIgnoreCase(str, range.length, "1")) {
+		valueOut = true;
+		return true;
+	}
+	if (equalsIgnoreCase(str, range.length, "false") || equalsIgnoreCase(str, range.length, "off")
+	 || equalsIgnoreCase(str, range.length, "0")) {
+		valueOut = false;
+		return true;
+	}
+	return false;
+}
+
+bool IniParser::parseInt(Range range, int32_t& valueOut) const noexcept
+{
+	// Values aren't null terminated in mText, copy to a small stack buffer first
+	char buffer[32];
+	if (range.length == 0 || range.length >= sizeof(buffer)) return false;
+	std::memcpy(buffer, mText.data() + range.begin, range.length);
+	buffer[range.length] = '\0';
+
+	char* end = nullptr;
+	errno = 0;
+	long value = std::strtol(buffer, &end, 10);
+	if (errno != 0 || end != buffer + range.length) return false;
+	if (value < (long)numeric_limits<int32_t>::min() || value > (long)numeric_limits<int32_t>::max()) return false;
+	valueOut = (int32_t)value;
+	return true;
+}
+
+bool IniParser::parseFloat(Range range, float& valueOut) const noexcept
+{
+	char buffer[32];
+	if (range.length == 0 || range.length >= sizeof(buffer)) return false;
+	std::memcpy(buffer, mText.data() + range.begin, range.length);
+	buffer[range.length] = '\0';
+
+	char* end = nullptr;
+	errno = 0;
+	float value = std::strtof(buffer, &end);
+	if (errno != 0 || end == buffer) return false;
+	// Older config files may contain C style float literals, e.g. "2.25f"
+	if (*end == 'f' || *end == 'F') end += 1;
+	if (end != buffer + range.length) return false;
+	valueOut = value;
+	return true;
 }
 
 } // namespace sfz
\ No newline at end of file
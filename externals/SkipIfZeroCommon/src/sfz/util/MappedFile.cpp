@@ -0,0 +1,160 @@
+#include "sfz/util/MappedFile.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <new>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#elif defined(__APPLE__) || defined(__unix)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SFZ_MAPPED_FILE_POSIX
+#endif
+
+namespace sfz {
+
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** Fallback when mapping isn't available, returns nullptr on failure. */
+static uint8_t* readWholeFile(const char* path, size_t& sizeOut) noexcept
+{
+	std::FILE* file = std::fopen(path, "rb");
+	if (file == NULL) return nullptr;
+
+	std::fseek(file, 0, SEEK_END);
+	long size = std::ftell(file);
+	std::rewind(file);
+	if (size <= 0) {
+		std::fclose(file);
+		return nullptr;
+	}
+
+	uint8_t* data = new (std::nothrow) uint8_t[size_t(size)];
+	if (data == nullptr) {
+		std::fclose(file);
+		return nullptr;
+	}
+	sizeOut = std::fread(data, 1, size_t(size), file);
+	std::fclose(file);
+	return data;
+}
+
+// MappedFile: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	std::swap(this->mData, other.mData);
+	std::swap(this->mSize, other.mSize);
+	std::swap(this->mValid, other.mValid);
+	std::swap(this->mMapped, other.mMapped);
+}
+
+MappedFile& MappedFile::operator= (MappedFile&& other) noexcept
+{
+	std::swap(this->mData, other.mData);
+	std::swap(this->mSize, other.mSize);
+	std::swap(this->mValid, other.mValid);
+	std::swap(this->mMapped, other.mMapped);
+	return *this;
+}
+
+MappedFile::~MappedFile() noexcept
+{
+	this->destroy();
+}
+
+MappedFile::MappedFile(const char* path) noexcept
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+	                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return;
+	}
+	mValid = true;
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		return;
+	}
+
+	// The view keeps the file open by itself, the handles aren't needed after mapping it
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping != NULL) {
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (view != NULL) {
+			CloseHandle(file);
+			mData = static_cast<const uint8_t*>(view);
+			mSize = size_t(size.QuadPart);
+			mMapped = true;
+			return;
+		}
+	}
+	CloseHandle(file);
+
+#elif defined(SFZ_MAPPED_FILE_POSIX)
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return;
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || S_ISDIR(fileStat.st_mode)) {
+		close(fd);
+		return;
+	}
+	mValid = true;
+	if (fileStat.st_size == 0) {
+		close(fd);
+		return;
+	}
+
+	void* map = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map != MAP_FAILED) {
+		mData = static_cast<const uint8_t*>(map);
+		mSize = size_t(fileStat.st_size);
+		mMapped = true;
+		return;
+	}
+#endif
+
+	// Couldn't map the file, read it instead
+	size_t size = 0;
+	mData = readWholeFile(path, size);
+	mSize = size;
+	mValid = mData != nullptr;
+}
+
+// MappedFile: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void MappedFile::destroy() noexcept
+{
+	if (mMapped) {
+#if defined(_WIN32)
+		UnmapViewOfFile(mData);
+#elif defined(SFZ_MAPPED_FILE_POSIX)
+		munmap(const_cast<uint8_t*>(mData), mSize);
+#endif
+	} else {
+		delete[] mData;
+	}
+
+	mData = nullptr;
+	mSize = 0;
+	mValid = false;
+	mMapped = false;
+}
+
+} // namespace sfz
\ No newline at end of file
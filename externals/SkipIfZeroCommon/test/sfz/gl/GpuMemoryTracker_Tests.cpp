@@ -0,0 +1,99 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstring>
+#include <string>
+
+#include "sfz/gl/GpuMemoryTracker.hpp"
+
+using namespace gl;
+
+static const GpuAllocation* findAllocation(uint32_t id) noexcept
+{
+	for (const GpuAllocation& allocation : GpuMemoryTracker::INSTANCE().allocations()) {
+		if (allocation.id == id) return &allocation;
+	}
+	return nullptr;
+}
+
+TEST_CASE("Adding and removing allocations", "[gl::GpuMemoryTracker]")
+{
+	GpuMemoryTracker& tracker = GpuMemoryTracker::INSTANCE();
+	const GpuMemoryStats before = tracker.stats();
+	const uint32_t texIndex = static_cast<uint32_t>(GpuMemoryCategory::TEXTURE);
+	const uint32_t meshIndex = static_cast<uint32_t>(GpuMemoryCategory::MESH);
+
+	uint32_t tex = tracker.add(GpuMemoryCategory::TEXTURE, "tex.png", 1000);
+	uint32_t mesh = tracker.add(GpuMemoryCategory::MESH, "mesh", 300);
+	REQUIRE(tex != 0);
+	REQUIRE(mesh != 0);
+	REQUIRE(tex != mesh);
+	REQUIRE(tracker.stats().bytes[texIndex] == before.bytes[texIndex] + 1000);
+	REQUIRE(tracker.stats().bytes[meshIndex] == before.bytes[meshIndex] + 300);
+	REQUIRE(tracker.stats().numAllocations[texIndex] == before.numAllocations[texIndex] + 1);
+	REQUIRE(tracker.stats().totalBytes == before.totalBytes + 1300);
+	REQUIRE(tracker.stats().peakTotalBytes >= before.totalBytes + 1300);
+	REQUIRE(findAllocation(tex) != nullptr);
+	REQUIRE(std::strcmp(findAllocation(tex)->label, "tex.png") == 0);
+
+	tracker.remove(tex);
+	REQUIRE(findAllocation(tex) == nullptr);
+	REQUIRE(findAllocation(mesh) != nullptr);
+	REQUIRE(tracker.stats().bytes[texIndex] == before.bytes[texIndex]);
+	REQUIRE(tracker.stats().numAllocations[texIndex] == before.numAllocations[texIndex]);
+	REQUIRE(tracker.stats().totalBytes == before.totalBytes + 300);
+
+	// The peak is kept after removing
+	REQUIRE(tracker.stats().peakTotalBytes >= before.totalBytes + 1300);
+
+	tracker.remove(0); // Ignored
+	tracker.remove(mesh);
+	REQUIRE(tracker.stats().totalBytes == before.totalBytes);
+	size_t numAllocationsBefore = 0;
+	for (uint32_t i = 0; i < NUM_GPU_MEMORY_CATEGORIES; ++i) {
+		numAllocationsBefore += before.numAllocations[i];
+	}
+	REQUIRE(tracker.allocations().size() == numAllocationsBefore);
+}
+
+TEST_CASE("Labels", "[gl::GpuMemoryTracker]")
+{
+	GpuMemoryTracker& tracker = GpuMemoryTracker::INSTANCE();
+
+	SECTION("Long labels keep their end") {
+		std::string label = std::string(100, 'a') + "/textures/logo.png";
+		uint32_t id = tracker.add(GpuMemoryCategory::TEXTURE, label.c_str(), 1);
+		const GpuAllocation* allocation = findAllocation(id);
+		REQUIRE(allocation != nullptr);
+		REQUIRE(std::strlen(allocation->label) == sizeof(allocation->label) - 1);
+		REQUIRE(label.compare(label.size() - 63, 63, allocation->label) == 0);
+		tracker.remove(id);
+	}
+	SECTION("Labels exactly fitting are not truncated") {
+		std::string label(63, 'b');
+		uint32_t id = tracker.add(GpuMemoryCategory::TEXTURE, label.c_str(), 1);
+		REQUIRE(label == findAllocation(id)->label);
+		tracker.remove(id);
+	}
+	SECTION("Null labels are empty") {
+		uint32_t id = tracker.add(GpuMemoryCategory::FRAMEBUFFER, nullptr, 1);
+		REQUIRE(findAllocation(id)->label[0] == '\0');
+		tracker.remove(id);
+	}
+}
+
+TEST_CASE("Texture size estimates", "[gl::GpuMemoryTracker]")
+{
+	REQUIRE(estimatedTextureSizeBytes(16, 8, 4, 1, false) == 16 * 8 * 4);
+	REQUIRE(estimatedTextureSizeBytes(16, 8, 1, 2, false) == 16 * 8 * 2);
+
+	// Three channels are padded to four
+	REQUIRE(estimatedTextureSizeBytes(16, 8, 3, 1, false) == 16 * 8 * 4);
+	REQUIRE(estimatedTextureSizeBytes(16, 8, 3, 4, false) == 16 * 8 * 16);
+
+	// The mip chain adds a third of the base level
+	REQUIRE(estimatedTextureSizeBytes(16, 16, 4, 1, true) == 1024 + 1024 / 3);
+
+	REQUIRE(estimatedTextureSizeBytes(0, 16, 4, 1, true) == 0);
+	REQUIRE(estimatedTextureSizeBytes(16, -1, 4, 1, false) == 0);
+}
@@ -0,0 +1,122 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "sfz/gl/TextureContainer.hpp"
+
+using namespace gl;
+using std::uint8_t;
+using std::vector;
+
+TEST_CASE("Uncompressed containers", "[gl::TextureContainer]")
+{
+	// 5x3 RGBA, every row a single color
+	vector<uint8_t> pixels;
+	for (int y = 0; y < 3; ++y) {
+		for (int x = 0; x < 5; ++x) {
+			pixels.push_back(uint8_t(y * 100));
+			pixels.push_back(uint8_t(x * 10));
+			pixels.push_back(0);
+			pixels.push_back(255);
+		}
+	}
+
+	vector<uint8_t> container = bakeTextureContainer(pixels.data(), 5, 3, 4, false);
+	TextureContainerInfo info;
+	REQUIRE(parseTextureContainer(container.data(), container.size(), info));
+	REQUIRE(info.format == TextureContainerFormat::RGBA8);
+	REQUIRE(info.width == 5);
+	REQUIRE(info.height == 3);
+	REQUIRE(info.levels.size() == 3);
+	REQUIRE(info.levels[0].width == 5);
+	REQUIRE(info.levels[0].height == 3);
+	REQUIRE(info.levels[0].size == 5 * 3 * 4);
+	REQUIRE(info.levels[1].width == 2);
+	REQUIRE(info.levels[1].height == 1);
+	REQUIRE(info.levels[2].width == 1);
+	REQUIRE(info.levels[2].height == 1);
+
+	// Flipped, the first row in the container is the last one in the image
+	REQUIRE(info.levels[0].data[0] == 200);
+	REQUIRE(info.levels[0].data[5 * 4 * 2] == 0);
+	REQUIRE(info.levels[0].data[4 + 1] == 10);
+
+	// Box filtered from the two first rows of the flipped image
+	REQUIRE(info.levels[1].data[0] == 150);
+	REQUIRE(info.levels[1].data[1] == 5);
+	REQUIRE(info.levels[1].data[4 + 1] == 25);
+	REQUIRE(info.levels[1].data[3] == 255);
+
+	SECTION("Damaged containers") {
+		REQUIRE(!parseTextureContainer(container.data(), container.size() - 1, info));
+		REQUIRE(!parseTextureContainer(container.data(), 16, info));
+		REQUIRE(!parseTextureContainer(nullptr, 0, info));
+		container[8] = 2; // Version
+		REQUIRE(!parseTextureContainer(container.data(), container.size(), info));
+	}
+}
+
+TEST_CASE("Compressed containers", "[gl::TextureContainer]")
+{
+	SECTION("Opaque images use BC1") {
+		vector<uint8_t> pixels(8 * 8 * 4, 255);
+		for (size_t i = 0; i < pixels.size(); i += 4) {
+			pixels[i] = 255;
+			pixels[i + 1] = 0;
+			pixels[i + 2] = 0;
+		}
+		vector<uint8_t> container = bakeTextureContainer(pixels.data(), 8, 8, 4, true);
+		TextureContainerInfo info;
+		REQUIRE(parseTextureContainer(container.data(), container.size(), info));
+		REQUIRE(info.format == TextureContainerFormat::BC1_RGB);
+		REQUIRE(info.levels.size() == 4);
+		REQUIRE(info.levels[0].size == 4 * 8);
+		REQUIRE(info.levels[3].size == 8);
+
+		// Pure red is exactly representable, both endpoints are red and all indices 0
+		const uint8_t* block = info.levels[0].data;
+		REQUIRE(block[0] == 0x00);
+		REQUIRE(block[1] == 0xF8);
+		REQUIRE(block[2] == 0x00);
+		REQUIRE(block[3] == 0xF8);
+		REQUIRE(block[4] == 0);
+	}
+	SECTION("Translucent images use BC3") {
+		vector<uint8_t> pixels(4 * 4 * 4, 0);
+		for (int i = 0; i < 16; ++i) {
+			pixels[i * 4 + 3] = (i < 8) ? 255 : 0;
+		}
+		vector<uint8_t> container = bakeTextureContainer(pixels.data(), 4, 4, 4, true);
+		TextureContainerInfo info;
+		REQUIRE(parseTextureContainer(container.data(), container.size(), info));
+		REQUIRE(info.format == TextureContainerFormat::BC3_RGBA);
+		REQUIRE(info.levels.size() == 3);
+		REQUIRE(info.levels[0].size == 16);
+		REQUIRE(info.levels[2].size == 16);
+
+		// Alpha endpoints, flipped so the transparent half comes first (index 1 == alpha 0)
+		const uint8_t* block = info.levels[0].data;
+		REQUIRE(block[0] == 255);
+		REQUIRE(block[1] == 0);
+		REQUIRE(block[2] == 0x49);
+		REQUIRE(block[3] == 0x92);
+		REQUIRE(block[4] == 0x24);
+		REQUIRE(block[5] == 0x00);
+	}
+	SECTION("Gray images are never compressed") {
+		vector<uint8_t> pixels(4 * 4, 128);
+		vector<uint8_t> container = bakeTextureContainer(pixels.data(), 4, 4, 1, true);
+		TextureContainerInfo info;
+		REQUIRE(parseTextureContainer(container.data(), container.size(), info));
+		REQUIRE(info.format == TextureContainerFormat::R8);
+	}
+}
+
+TEST_CASE("Baked texture names", "[gl::TextureContainer]")
+{
+	REQUIRE(bakedTextureName("textures/logo.png") == "textures/logo.sfztex");
+	REQUIRE(bakedTextureName("a.b/logo") == "a.b/logo.sfztex");
+	REQUIRE(bakedTextureName("logo.png") == "logo.sfztex");
+}
\ No newline at end of file
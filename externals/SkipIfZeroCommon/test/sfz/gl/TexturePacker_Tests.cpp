@@ -0,0 +1,127 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "sfz/gl/TextureContainer.hpp"
+#include "sfz/gl/TexturePacker.hpp"
+
+using namespace gl;
+using std::string;
+using std::uint8_t;
+using std::vector;
+
+/** Binary PPM (P6) of a single color, decoded by stb_image like any other image file. */
+static vector<uint8_t> solidPPM(int width, int height, uint8_t r, uint8_t g, uint8_t b)
+{
+	char header[32];
+	const int headerSize = std::snprintf(header, sizeof(header), "P6\n%i %i\n255\n", width, height);
+	vector<uint8_t> file(header, header + headerSize);
+	for (int i = 0; i < width * height; ++i) {
+		file.push_back(r);
+		file.push_back(g);
+		file.push_back(b);
+	}
+	return file;
+}
+
+static AssetView viewOf(const vector<uint8_t>& file)
+{
+	AssetView view;
+	view.data = file.data();
+	view.size = file.size();
+	return view;
+}
+
+TEST_CASE("Max mip level of atlases", "[gl::TexturePacker]")
+{
+	REQUIRE(atlasMaxMipLevel(0) == 0);
+	REQUIRE(atlasMaxMipLevel(1) == 0);
+	REQUIRE(atlasMaxMipLevel(2) == 1);
+	REQUIRE(atlasMaxMipLevel(3) == 1);
+	REQUIRE(atlasMaxMipLevel(8) == 3);
+	REQUIRE(atlasMaxMipLevel(9) == 3);
+	REQUIRE(atlasMaxMipLevel(16) == 4);
+}
+
+TEST_CASE("Baking and parsing atlases", "[gl::TexturePacker]")
+{
+	const vector<uint8_t> red = solidPPM(16, 8, 255, 0, 0);
+	const vector<uint8_t> blue = solidPPM(4, 4, 0, 0, 255);
+	const vector<string> filenames = {"red.ppm", "sub/blue.ppm"};
+	const vector<AssetView> files = {viewOf(red), viewOf(blue)};
+
+	vector<uint8_t> atlas = bakeTextureAtlas(filenames, files, 8, 32, 32, false);
+	REQUIRE(!atlas.empty());
+
+	TextureAtlasInfo info;
+	REQUIRE(parseTextureAtlas(atlas.data(), atlas.size(), info));
+	REQUIRE(info.padding == 8);
+	REQUIRE(info.filenames == filenames);
+	REQUIRE(info.regions.size() == 2);
+
+	// The suggested size is doubled until the padded images fit
+	const int paddedArea = (16 + 16) * (8 + 16) + (4 + 16) * (4 + 16);
+	const int atlasArea = info.width * info.height;
+	REQUIRE(info.width >= 32);
+	REQUIRE(info.height >= 32);
+	REQUIRE(atlasArea >= paddedArea);
+
+	// Regions are the exact image bounds, with at least the padding to the atlas edges
+	const float w = float(info.width), h = float(info.height);
+	const TextureRegion& redRegion = info.regions["red.ppm"];
+	const float redMinX = redRegion.mUVMin.x * w, redMinY = redRegion.mUVMin.y * h;
+	const float redWidth = redRegion.mUVMax.x * w - redMinX;
+	const float redHeight = redRegion.mUVMax.y * h - redMinY;
+	REQUIRE(redWidth == Approx(16.0f));
+	REQUIRE(redHeight == Approx(8.0f));
+	REQUIRE(redMinX >= 8.0f);
+	REQUIRE(redMinY >= 8.0f);
+	const TextureRegion& blueRegion = info.regions["sub/blue.ppm"];
+	const float blueWidth = (blueRegion.mUVMax.x - blueRegion.mUVMin.x) * w;
+	const float blueHeight = (blueRegion.mUVMax.y - blueRegion.mUVMin.y) * h;
+	REQUIRE(blueWidth == Approx(4.0f));
+	REQUIRE(blueHeight == Approx(4.0f));
+
+	// The texture is a regular container with the full mip chain
+	TextureContainerInfo container;
+	REQUIRE(parseTextureContainer(info.container, info.containerSize, container));
+	REQUIRE(container.format == TextureContainerFormat::RGBA8);
+	REQUIRE(container.width == info.width);
+	REQUIRE(container.height == info.height);
+	const uint8_t* containerEnd = info.container + info.containerSize;
+	REQUIRE(containerEnd == atlas.data() + atlas.size());
+
+	// Center texel of the red image, UV v = 0 is the first row of the container
+	const int x = int(redMinX + 0.5f) + 8;
+	const int y = int(redMinY + 0.5f) + 4;
+	const uint8_t* texel = container.levels[0].data + (size_t(y) * size_t(info.width) + size_t(x)) * 4;
+	REQUIRE(texel[0] == 255);
+	REQUIRE(texel[1] == 0);
+	REQUIRE(texel[2] == 0);
+	REQUIRE(texel[3] == 255);
+
+	SECTION("Damaged atlases") {
+		REQUIRE(!parseTextureAtlas(atlas.data(), atlas.size() - 1, info));
+		REQUIRE(!parseTextureAtlas(atlas.data(), 32, info));
+		REQUIRE(!parseTextureAtlas(nullptr, 0, info));
+
+		vector<uint8_t> badName = atlas;
+		badName[40] = 0xFF; // Name offset of the first region
+		REQUIRE(!parseTextureAtlas(badName.data(), badName.size(), info));
+
+		atlas[8] = 1; // Version
+		REQUIRE(!parseTextureAtlas(atlas.data(), atlas.size(), info));
+	}
+}
+
+TEST_CASE("Images that can't be decoded", "[gl::TexturePacker]")
+{
+	const vector<uint8_t> garbage = {1, 2, 3, 4};
+	const vector<string> filenames = {"garbage.png"};
+	const vector<AssetView> files = {viewOf(garbage)};
+	REQUIRE(bakeTextureAtlas(filenames, files, 1, 32, 32, false).empty());
+}
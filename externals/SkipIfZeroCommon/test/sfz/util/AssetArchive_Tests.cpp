@@ -0,0 +1,127 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sfz/util/AssetArchive.hpp"
+#include "sfz/util/IO.hpp"
+
+using std::string;
+using std::vector;
+
+static const string& testDirPath()
+{
+	static const string path{sfz::basePath() + "sfz_asset_archive_test/"};
+	return path;
+}
+
+static const string& archivePath()
+{
+	static const string path{sfz::basePath() + "sfz_asset_archive_test.pak"};
+	return path;
+}
+
+TEST_CASE("Writing and reading archives", "[sfz::AssetArchive]")
+{
+	const char* first = "first file";
+	const char* second = "the second file is a bit longer than the first one";
+	REQUIRE(sfz::createDirectory(testDirPath().c_str()));
+	REQUIRE(sfz::createDirectory((testDirPath() + "sub").c_str()));
+	REQUIRE(sfz::writeBinaryFile((testDirPath() + "first.txt").c_str(), (const uint8_t*)first, std::strlen(first)));
+	REQUIRE(sfz::writeBinaryFile((testDirPath() + "sub/second.txt").c_str(), (const uint8_t*)second, std::strlen(second)));
+	REQUIRE(sfz::createFile((testDirPath() + "empty.txt").c_str()));
+
+	SECTION("Missing files") {
+		vector<string> names{"first.txt", "missing.txt"};
+		REQUIRE(!sfz::writeAssetArchive(archivePath().c_str(), testDirPath().c_str(), names));
+		REQUIRE(!sfz::fileExists(archivePath().c_str()));
+	}
+	SECTION("Lookups") {
+		vector<string> names{"first.txt", "sub/second.txt", "empty.txt"};
+		REQUIRE(sfz::writeAssetArchive(archivePath().c_str(), testDirPath().c_str(), names));
+
+		sfz::AssetArchive archive{archivePath().c_str()};
+		REQUIRE(archive.isValid());
+		REQUIRE(archive.numEntries() == 3);
+
+		sfz::AssetView firstView = archive.find("first.txt");
+		REQUIRE(firstView.isValid());
+		REQUIRE(firstView.size == std::strlen(first));
+		REQUIRE(std::memcmp(firstView.data, first, firstView.size) == 0);
+		REQUIRE(((uintptr_t)firstView.data % 16) == 0);
+
+		sfz::AssetView secondView = archive.find("sub/second.txt");
+		REQUIRE(secondView.isValid());
+		REQUIRE(secondView.size == std::strlen(second));
+		REQUIRE(std::memcmp(secondView.data, second, secondView.size) == 0);
+
+		sfz::AssetView emptyView = archive.find("empty.txt");
+		REQUIRE(emptyView.isValid());
+		REQUIRE(emptyView.size == 0);
+
+		REQUIRE(!archive.find("missing.txt").isValid());
+		REQUIRE(!archive.find("sub").isValid());
+		REQUIRE(!archive.find("").isValid());
+
+		for (uint32_t i = 0; i < archive.numEntries(); ++i) {
+			REQUIRE(archive.find(archive.entryName(i)).isValid());
+		}
+		REQUIRE(archive.entryName(3) == nullptr);
+
+		sfz::AssetArchive moved = std::move(archive);
+		REQUIRE(!archive.isValid());
+		REQUIRE(!archive.find("first.txt").isValid());
+		REQUIRE(moved.find("first.txt").data == firstView.data);
+	}
+	SECTION("Assets in memory") {
+		const char* generated = "generated by the packer";
+		vector<string> names{"first.txt", "generated.txt"};
+		vector<sfz::AssetView> contents(2);
+		contents[0].data = (const uint8_t*)first;
+		contents[0].size = std::strlen(first);
+		contents[1].data = (const uint8_t*)generated;
+		contents[1].size = std::strlen(generated);
+		REQUIRE(sfz::writeAssetArchive(archivePath().c_str(), names, contents));
+
+		sfz::AssetArchive archive{archivePath().c_str()};
+		REQUIRE(archive.numEntries() == 2);
+		sfz::AssetView generatedView = archive.find("generated.txt");
+		REQUIRE(generatedView.size == std::strlen(generated));
+		REQUIRE(std::memcmp(generatedView.data, generated, generatedView.size) == 0);
+
+		names.pop_back();
+		REQUIRE(!sfz::writeAssetArchive(archivePath().c_str(), names, contents));
+	}
+	SECTION("Damaged archives") {
+		vector<string> names{"first.txt", "sub/second.txt"};
+		REQUIRE(sfz::writeAssetArchive(archivePath().c_str(), testDirPath().c_str(), names));
+		vector<uint8_t> contents = sfz::readBinaryFile(archivePath().c_str());
+		REQUIRE(contents.size() > 64);
+
+		// Truncated in the middle of the data
+		REQUIRE(sfz::writeBinaryFile(archivePath().c_str(), contents.data(), contents.size() - 8));
+		REQUIRE(!sfz::AssetArchive{archivePath().c_str()}.isValid());
+
+		// Unknown version
+		contents[8] = 2;
+		REQUIRE(sfz::writeBinaryFile(archivePath().c_str(), contents.data(), contents.size()));
+		REQUIRE(!sfz::AssetArchive{archivePath().c_str()}.isValid());
+	}
+
+	sfz::deleteFile(archivePath().c_str());
+	REQUIRE(sfz::deleteFile((testDirPath() + "first.txt").c_str()));
+	REQUIRE(sfz::deleteFile((testDirPath() + "sub/second.txt").c_str()));
+	REQUIRE(sfz::deleteFile((testDirPath() + "empty.txt").c_str()));
+	REQUIRE(sfz::deleteDirectory((testDirPath() + "sub").c_str()));
+	REQUIRE(sfz::deleteDirectory(testDirPath().c_str()));
+}
+
+TEST_CASE("Missing archives", "[sfz::AssetArchive]")
+{
+	sfz::AssetArchive archive{(sfz::basePath() + "sfz_no_such_archive.pak").c_str()};
+	REQUIRE(!archive.isValid());
+	REQUIRE(archive.numEntries() == 0);
+	REQUIRE(!archive.find("first.txt").isValid());
+}
\ No newline at end of file
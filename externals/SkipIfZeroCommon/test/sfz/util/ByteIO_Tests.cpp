@@ -0,0 +1,48 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#include "sfz/util/ByteIO.hpp"
+
+TEST_CASE("Little-endian reading and writing", "[sfz::ByteIO]")
+{
+	uint8_t buffer[16] = {};
+
+	sfz::writeU32(buffer, 0x04030201u);
+	REQUIRE(buffer[0] == 0x01);
+	REQUIRE(buffer[1] == 0x02);
+	REQUIRE(buffer[2] == 0x03);
+	REQUIRE(buffer[3] == 0x04);
+	REQUIRE(sfz::readU32(buffer) == 0x04030201u);
+	REQUIRE(sfz::readU16(buffer) == 0x0201u);
+
+	// Unaligned
+	sfz::writeU64(buffer + 3, 0x0807060504030201ull);
+	REQUIRE(buffer[3] == 0x01);
+	REQUIRE(buffer[10] == 0x08);
+	REQUIRE(sfz::readU64(buffer + 3) == 0x0807060504030201ull);
+
+	sfz::writeU16(buffer + 1, 0xBEEFu);
+	REQUIRE(buffer[1] == 0xEF);
+	REQUIRE(buffer[2] == 0xBE);
+	REQUIRE(sfz::readU16(buffer + 1) == 0xBEEFu);
+
+	sfz::writeF32(buffer + 5, -2.25f);
+	REQUIRE(sfz::readF32(buffer + 5) == -2.25f);
+	REQUIRE(sfz::readU32(buffer + 5) == 0xC0100000u);
+}
+
+TEST_CASE("FNV-1a hashing", "[sfz::ByteIO]")
+{
+	// Reference values from the FNV specification
+	REQUIRE(sfz::fnv1a32(nullptr, 0) == 2166136261u);
+	REQUIRE(sfz::fnv1a64(nullptr, 0) == 14695981039346656037ull);
+	const uint8_t a[] = {'a'};
+	REQUIRE(sfz::fnv1a32(a, 1) == 0xE40C292Cu);
+	REQUIRE(sfz::fnv1a64(a, 1) == 0xAF63DC4C8601EC8Cull);
+	const char* foobar = "foobar";
+	REQUIRE(sfz::fnv1a32((const uint8_t*)foobar, std::strlen(foobar)) == 0xBF9CF968u);
+	REQUIRE(sfz::fnv1a64((const uint8_t*)foobar, std::strlen(foobar)) == 0x85944171F73967E8ull);
+}
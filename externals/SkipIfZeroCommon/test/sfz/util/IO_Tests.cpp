@@ -4,6 +4,7 @@
 #include <string>
 
 #include "sfz/util/IO.hpp"
+#include "sfz/util/MappedFile.hpp"
 
 using std::string;
 
@@ -101,4 +102,42 @@ TEST_CASE("readTextFile()", "[sfz::IO]")
 	}
 
 	REQUIRE(sfz::deleteFile(fpath));
+}
+
+TEST_CASE("MappedFile", "[sfz::IO]")
+{
+	const string filePath = sfz::basePath() + stupidFileName();
+	const char* fpath = filePath.c_str();
+	const uint8_t data[] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+	REQUIRE(sfz::writeBinaryFile(fpath, data, sizeof(data)));
+	{
+		sfz::MappedFile file{fpath};
+		REQUIRE(file.isValid());
+		REQUIRE(file.size() == sizeof(data));
+		for (size_t i = 0; i < sizeof(data); ++i) {
+			REQUIRE(file.data()[i] == data[i]);
+		}
+
+		sfz::MappedFile moved = std::move(file);
+		REQUIRE(!file.isValid());
+		REQUIRE(moved.isValid());
+		REQUIRE(moved.data()[7] == 8);
+
+		moved.destroy();
+		REQUIRE(!moved.isValid());
+		REQUIRE(moved.size() == 0);
+	}
+	REQUIRE(sfz::deleteFile(fpath));
+
+	REQUIRE(sfz::createFile(fpath));
+	{
+		sfz::MappedFile empty{fpath};
+		REQUIRE(empty.isValid());
+		REQUIRE(empty.size() == 0);
+	}
+	REQUIRE(sfz::deleteFile(fpath));
+
+	sfz::MappedFile missing{fpath};
+	REQUIRE(!missing.isValid());
 }
\ No newline at end of file
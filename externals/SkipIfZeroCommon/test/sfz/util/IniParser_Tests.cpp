@@ -0,0 +1,122 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "sfz/util/IniParser.hpp"
+#include "sfz/util/IO.hpp"
+
+using std::string;
+
+static string writeTestIni(const char* contents)
+{
+	const string path = sfz::basePath() + "ini_parser_test_file.ini";
+	sfz::writeBinaryFile(path.c_str(), (const uint8_t*)contents, std::strlen(contents));
+	return path;
+}
+
+TEST_CASE("Loading and reading items", "[sfz::IniParser]")
+{
+	const string path = writeTestIni(
+		"globalItem=14\r\n"
+		"; comment\n"
+		"\n"
+		"[Section1]\n"
+		"bBool=TRUE\n"
+		"iInt= -3\n"
+		"fFloat=2.5\n"
+		"sString=hello world\n"
+		"[Section2]\n"
+		"iInt=7\n"
+		"iInt=8");
+
+	sfz::IniParser ini{path};
+	REQUIRE(ini.load());
+	REQUIRE(!ini.isDirty());
+
+	REQUIRE(ini.itemExists("", "globalItem"));
+	REQUIRE(ini.getInt("", "globalItem") == 14);
+	REQUIRE(!ini.itemExists("Section1", "globalItem"));
+
+	REQUIRE(ini.itemIsBool("Section1", "bBool"));
+	REQUIRE(ini.getBool("Section1", "bBool"));
+	REQUIRE(ini.itemIsInt("Section1", "iInt"));
+	REQUIRE(ini.getInt("Section1", "iInt") == -3);
+	REQUIRE(ini.itemIsFloat("Section1", "fFloat"));
+	REQUIRE(ini.getFloat("Section1", "fFloat") == 2.5f);
+	REQUIRE(!ini.itemIsInt("Section1", "fFloat"));
+	REQUIRE(!ini.itemIsInt("Section1", "sString"));
+	REQUIRE(ini.getString("Section1", "sString") == "hello world");
+	REQUIRE(ini.getInt("Section1", "sString", 42) == 42);
+
+	REQUIRE(ini.getInt("Section2", "iInt") == 8);
+	REQUIRE(ini.getInt("Section3", "iInt", 5) == 5);
+
+	sfz::deleteFile(path.c_str());
+}
+
+TEST_CASE("Only changed values mark the parser as dirty", "[sfz::IniParser]")
+{
+	const string path = writeTestIni(
+		"[Graphics]\n"
+		"bLightShafts=true\n"
+		"fScale=0.250000\n"
+		"iVSync=1\n");
+
+	sfz::IniParser ini{path};
+	REQUIRE(ini.load());
+
+	ini.setBool("Graphics", "bLightShafts", true);
+	ini.setFloat("Graphics", "fScale", 0.25f);
+	ini.setInt("Graphics", "iVSync", 1);
+	REQUIRE(ini.sanitizeInt("Graphics", "iVSync", 0, 0, 2) == 1);
+	REQUIRE(!ini.isDirty());
+
+	REQUIRE(ini.sanitizeInt("Graphics", "iVSync", 0, 2, 2) == 2);
+	REQUIRE(ini.isDirty());
+	REQUIRE(ini.getInt("Graphics", "iVSync") == 2);
+
+	REQUIRE(ini.sanitizeFloat("Audio", "fVolume", 0.5f, 0.0f, 1.0f) == 0.5f);
+	REQUIRE(ini.save());
+	REQUIRE(!ini.isDirty());
+
+	sfz::IniParser reloaded{path};
+	REQUIRE(reloaded.load());
+	REQUIRE(reloaded.getBool("Graphics", "bLightShafts"));
+	REQUIRE(reloaded.getFloat("Graphics", "fScale") == 0.25f);
+	REQUIRE(reloaded.getInt("Graphics", "iVSync") == 2);
+	REQUIRE(reloaded.getFloat("Audio", "fVolume") == 0.5f);
+
+	sfz::deleteFile(path.c_str());
+}
+
+TEST_CASE("Files written by older versions still load", "[sfz::IniParser]")
+{
+	const string path = writeTestIni(
+		"[Graphics]\n"
+		"fScale = 2.25f\n"
+		"iVSync =1\n"
+		"bFullscreen= false\n"
+		"fGamma=1.5F\n"
+		"fBroken=1.5ff\n");
+
+	sfz::IniParser ini{path};
+	REQUIRE(ini.load());
+
+	REQUIRE(ini.itemIsFloat("Graphics", "fScale"));
+	REQUIRE(ini.getFloat("Graphics", "fScale") == 2.25f);
+	REQUIRE(ini.getInt("Graphics", "iVSync") == 1);
+	REQUIRE(ini.itemIsBool("Graphics", "bFullscreen"));
+	REQUIRE(!ini.getBool("Graphics", "bFullscreen", true));
+	REQUIRE(ini.getFloat("Graphics", "fGamma") == 1.5f);
+	REQUIRE(!ini.itemIsFloat("Graphics", "fBroken"));
+	REQUIRE(!ini.itemIsInt("Graphics", "fScale"));
+
+	// Values that are already correct are left as is
+	REQUIRE(ini.sanitizeFloat("Graphics", "fScale", 1.0f, 0.0f, 4.0f) == 2.25f);
+	REQUIRE(!ini.isDirty());
+
+	sfz::deleteFile(path.c_str());
+}
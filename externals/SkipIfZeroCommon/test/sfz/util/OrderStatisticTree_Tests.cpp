@@ -0,0 +1,101 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "sfz/util/OrderStatisticTree.hpp"
+
+TEST_CASE("Insert & query", "[sfz::OrderStatisticTree]")
+{
+	sfz::OrderStatisticTree<int> tree;
+	REQUIRE(tree.empty());
+	REQUIRE(tree.countLess(5) == 0);
+
+	tree.insert(5);
+	tree.insert(1);
+	tree.insert(3);
+	tree.insert(3);
+	tree.insert(9);
+	REQUIRE(tree.size() == 5);
+
+	REQUIRE(tree.at(0) == 1);
+	REQUIRE(tree.at(1) == 3);
+	REQUIRE(tree.at(2) == 3);
+	REQUIRE(tree.at(3) == 5);
+	REQUIRE(tree.at(4) == 9);
+
+	REQUIRE(tree.countLess(0) == 0);
+	REQUIRE(tree.countLess(1) == 0);
+	REQUIRE(tree.countLess(3) == 1);
+	REQUIRE(tree.countLess(4) == 3);
+	REQUIRE(tree.countLess(9) == 4);
+	REQUIRE(tree.countLess(10) == 5);
+
+	tree.clear();
+	REQUIRE(tree.empty());
+	REQUIRE(tree.countLess(10) == 0);
+}
+
+TEST_CASE("Equal elements keep insertion order", "[sfz::OrderStatisticTree]")
+{
+	struct Pair { int key, id; };
+	struct CompareKey {
+		bool operator() (const Pair& lhs, const Pair& rhs) const { return lhs.key > rhs.key; }
+	};
+
+	sfz::OrderStatisticTree<Pair, CompareKey> tree;
+	tree.insert(Pair{2, 0});
+	tree.insert(Pair{7, 1});
+	tree.insert(Pair{2, 2});
+	tree.insert(Pair{7, 3});
+	tree.insert(Pair{2, 4});
+
+	REQUIRE(tree.at(0).id == 1);
+	REQUIRE(tree.at(1).id == 3);
+	REQUIRE(tree.at(2).id == 0);
+	REQUIRE(tree.at(3).id == 2);
+	REQUIRE(tree.at(4).id == 4);
+}
+
+TEST_CASE("Matches sorted vector", "[sfz::OrderStatisticTree]")
+{
+	std::mt19937 rng{1337};
+	std::uniform_int_distribution<int32_t> dist{-1000, 1000};
+
+	std::vector<int32_t> values;
+	for (int i = 0; i < 20000; ++i) values.push_back(dist(rng));
+
+	std::vector<int32_t> sorted = values;
+	std::sort(sorted.begin(), sorted.end(), std::greater<int32_t>());
+
+	sfz::OrderStatisticTree<int32_t, std::greater<int32_t>> inserted, assigned;
+	for (int32_t v : values) inserted.insert(v);
+	assigned.assignSorted(sorted.data(), sorted.size());
+	REQUIRE(inserted.size() == sorted.size());
+	REQUIRE(assigned.size() == sorted.size());
+
+	for (size_t i = 0; i < sorted.size(); i += 7) {
+		REQUIRE(inserted.at(i) == sorted[i]);
+		REQUIRE(assigned.at(i) == sorted[i]);
+	}
+	for (int32_t v = -1001; v <= 1001; v += 3) {
+		size_t expected = std::lower_bound(sorted.begin(), sorted.end(), v, std::greater<int32_t>()) - sorted.begin();
+		REQUIRE(inserted.countLess(v) == expected);
+		REQUIRE(assigned.countLess(v) == expected);
+	}
+
+	// Inserting into a tree built from sorted values
+	assigned.insert(0);
+	sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), 0, std::greater<int32_t>()), 0);
+	for (size_t i = 0; i < sorted.size(); i += 5) {
+		REQUIRE(assigned.at(i) == sorted[i]);
+	}
+
+	sfz::OrderStatisticTree<int32_t> empty;
+	empty.assignSorted(nullptr, 0);
+	REQUIRE(empty.empty());
+}
\ No newline at end of file
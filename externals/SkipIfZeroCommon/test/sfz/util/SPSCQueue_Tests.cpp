@@ -0,0 +1,63 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdint>
+#include <thread>
+
+#include "sfz/util/SPSCQueue.hpp"
+
+TEST_CASE("Push & pop on single thread", "[sfz::SPSCQueue]")
+{
+	sfz::SPSCQueue<int, 4> queue;
+	REQUIRE(queue.capacity() == 3);
+	REQUIRE(queue.empty());
+
+	int out = 0;
+	REQUIRE(!queue.tryPop(out));
+
+	REQUIRE(queue.tryPush(1));
+	REQUIRE(queue.tryPush(2));
+	REQUIRE(queue.tryPush(3));
+	REQUIRE(queue.size() == 3);
+	REQUIRE(!queue.tryPush(4));
+
+	REQUIRE(queue.tryPop(out));
+	REQUIRE(out == 1);
+	REQUIRE(queue.tryPush(4));
+	REQUIRE(queue.tryPop(out));
+	REQUIRE(out == 2);
+	REQUIRE(queue.tryPop(out));
+	REQUIRE(out == 3);
+	REQUIRE(queue.tryPop(out));
+	REQUIRE(out == 4);
+	REQUIRE(!queue.tryPop(out));
+	REQUIRE(queue.empty());
+}
+
+TEST_CASE("Elements arrive in order across threads", "[sfz::SPSCQueue]")
+{
+	sfz::SPSCQueue<uint32_t, 16> queue;
+	const uint32_t NUM_ELEMENTS = 100000;
+
+	std::thread producer{[&queue, NUM_ELEMENTS]() {
+		for (uint32_t i = 0; i < NUM_ELEMENTS; ++i) {
+			while (!queue.tryPush(i)) std::this_thread::yield();
+		}
+	}};
+
+	bool inOrder = true;
+	uint32_t expected = 0;
+	while (expected < NUM_ELEMENTS) {
+		uint32_t value;
+		if (!queue.tryPop(value)) {
+			std::this_thread::yield();
+			continue;
+		}
+		if (value != expected) inOrder = false;
+		expected += 1;
+	}
+	producer.join();
+
+	REQUIRE(inOrder);
+	REQUIRE(queue.empty());
+}
\ No newline at end of file
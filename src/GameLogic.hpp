@@ -8,6 +8,7 @@
 #include "gamelogic/ModelConfig.hpp"
 #include "gamelogic/Object.hpp"
 #include "gamelogic/Position.hpp"
+#include "gamelogic/Simulation.hpp"
 #include "gamelogic/SnakeTile.hpp"
 #include "gamelogic/Stats.hpp"
 
@@ -1,5 +1,7 @@
 #include "GlobalConfig.hpp"
 
+#include <cstddef> // offsetof
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <exception> // std::terminate()
@@ -9,7 +11,9 @@
 
 namespace s3 {
 
+using std::size_t;
 using std::string;
+using std::uint8_t;
 
 // Static functions
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -26,6 +30,91 @@ static const string& userIniPath() noexcept
 	return USER_INI_PATH;
 }
 
+// Config schema
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+enum class FieldType : uint8_t {
+	BOOL,
+	INT,
+	FLOAT
+};
+
+/** A single item in config.ini and the ConfigData member it is stored in */
+struct ConfigField final {
+	const char* section;
+	const char* key;
+	FieldType type;
+	size_t offset; // Offset of the member in ConfigData
+	double defaultValue, minValue, maxValue;
+};
+
+#define S3_BOOL_FIELD(section, key, member, defaultValue) \
+	ConfigField{section, key, FieldType::BOOL, offsetof(ConfigData, member), (defaultValue) ? 1.0 : 0.0, 0.0, 1.0}
+#define S3_INT_FIELD(section, key, member, defaultValue, minValue, maxValue) \
+	ConfigField{section, key, FieldType::INT, offsetof(ConfigData, member), defaultValue, minValue, maxValue}
+#define S3_FLOAT_FIELD(section, key, member, defaultValue, minValue, maxValue) \
+	ConfigField{section, key, FieldType::FLOAT, offsetof(ConfigData, member), defaultValue, minValue, maxValue}
+
+// Every item in config.ini, with its default value and valid range. Loading, validation and saving
+// are all driven by this table, in this order.
+static const ConfigField CONFIG_SCHEMA[] = {
+	// [Audio]
+	S3_INT_FIELD("Audio", "iMusicVolume", musicVolume, 10, 0, 10),
+	S3_INT_FIELD("Audio", "iSfxVolume", sfxVolume, 10, 0, 10),
+
+	// [CustomModel]
+	S3_INT_FIELD("CustomModel", "iGridWidth", modelConfig.gridWidth, 3, 2, 128),
+	S3_FLOAT_FIELD("CustomModel", "fTilesPerSecond", modelConfig.tilesPerSecond, 2.25f, 0.05f, 60.0f),
+	S3_FLOAT_FIELD("CustomModel", "fSpeedIncreasePerObject", modelConfig.speedIncreasePerObject, 0.025f, 0.001f, 60.0f),
+	S3_INT_FIELD("CustomModel", "iBonusFrequency", modelConfig.bonusFrequency, 8, 1, 1024),
+	S3_INT_FIELD("CustomModel", "iBonusDuration", modelConfig.bonusDuration, 32, 0, 4096),
+	S3_INT_FIELD("CustomModel", "iNumberOfBonusObjects", modelConfig.numberOfBonusObjects, 1, 0, 32),
+	S3_INT_FIELD("CustomModel", "iEarlyDuration", modelConfig.earlyDuration, 8, 0, 1024),
+	S3_INT_FIELD("CustomModel", "iShiftBonusDuration", modelConfig.shiftBonusDuration, 8, 0, 1024),
+	S3_INT_FIELD("CustomModel", "iObjectValue", modelConfig.objectValue, 8, 0, 4096),
+	S3_INT_FIELD("CustomModel", "iObjectEarlyBonus", modelConfig.objectEarlyBonus, 8, 0, 4096),
+	S3_INT_FIELD("CustomModel", "iObjectShiftBonus", modelConfig.objectShiftBonus, 8, 0, 4096),
+	S3_INT_FIELD("CustomModel", "iBonusObjectValue", modelConfig.bonusObjectValue, 32, 0, 4096),
+	S3_INT_FIELD("CustomModel", "iBonusObjectShiftBonus", modelConfig.bonusObjectShiftBonus, 16, 0, 4096),
+
+	// [Debug]
+	S3_BOOL_FIELD("Debug", "bContinuousShaderReload", continuousShaderReload, false),
+	S3_BOOL_FIELD("Debug", "bPrintFrametimes", printFrametimes, false),
+
+	// [GameSettings]
+	S3_INT_FIELD("GameSettings", "iInputBufferSize", inputBufferSize, 2, 1, 5),
+
+	// [Graphics]
+	S3_BOOL_FIELD("Graphics", "bNativeInternalRes", gc.nativeInternalRes, false),
+	S3_BOOL_FIELD("Graphics", "bDynamicResolution", dynamicResolution, false),
+	S3_FLOAT_FIELD("Graphics", "fDynamicResMinScale", dynamicResMinScale, 0.5f, 0.25f, 1.0f),
+	S3_FLOAT_FIELD("Graphics", "fDynamicResTargetMs", dynamicResTargetMs, 16.0f, 2.0f, 100.0f),
+	S3_BOOL_FIELD("Graphics", "bFusedEmissive", fusedEmissive, true),
+	S3_INT_FIELD("Graphics", "iBlurAlgorithm", gc.blurAlgorithm, 0, 0, 1),
+	S3_FLOAT_FIELD("Graphics", "fBlurResScaling", gc.blurResScaling, 0.4f, 0.01f, 2.0f),
+	S3_INT_FIELD("Graphics", "iInternalResolutionY", gc.internalResolutionY, 1080, 120, 8192),
+	S3_BOOL_FIELD("Graphics", "bLightShafts", gc.lightShafts, true),
+	S3_FLOAT_FIELD("Graphics", "fLightShaftsResScaling", gc.lightShaftsResScaling, 0.5f, 0.01f, 10.0f),
+	S3_BOOL_FIELD("Graphics", "bOrderIndependentTransparency", orderIndependentTransparency, false),
+	S3_FLOAT_FIELD("Graphics", "fSpotlightResScaling", gc.spotlightResScaling, 1.0f, 0.01f, 10.0f),
+	S3_BOOL_FIELD("Graphics", "bTemporalUpsampling", gc.temporalUpsampling, false),
+	S3_INT_FIELD("Graphics", "iDisplayIndex", displayIndex, -1, -1, 8),
+	S3_INT_FIELD("Graphics", "iFullscreenMode", fullscreenMode, 1, 0, 2),
+	S3_INT_FIELD("Graphics", "iMaxFramesInFlight", maxFramesInFlight, 2, 1, 3),
+	S3_INT_FIELD("Graphics", "iScalingAlgorithm", gc.scalingAlgorithm, 3, 0, 10),
+	S3_INT_FIELD("Graphics", "iVSync", gc.vsync, 1, 0, 2)
+};
+
+#undef S3_BOOL_FIELD
+#undef S3_INT_FIELD
+#undef S3_FLOAT_FIELD
+
+template<typename T>
+static T& fieldRef(ConfigData& data, const ConfigField& field) noexcept
+{
+	return *reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(&data) + field.offset);
+}
+
 // ConfigData struct
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -36,7 +125,10 @@ const GraphicsConfig TOASTER_GRAPHICS_CONFIG = {
 	0.15f, // float blurResScaling;
 	1.0f, // float spotlightResScaling;
 	0.15f, // float lightShaftsResScaling;
-	1 // int32_t scalingAlgorithm;
+	false, // bool lightShafts;
+	1, // int32_t scalingAlgorithm;
+	0, // int32_t blurAlgorithm; // 0 = gaussian, 1 = dual filter
+	false // bool temporalUpsampling; // Replaces scalingAlgorithm
 };
 
 const GraphicsConfig LAPTOP_W_INTEL_GRAPHICS_CONFIG = {
@@ -46,7 +138,10 @@ const GraphicsConfig LAPTOP_W_INTEL_GRAPHICS_CONFIG = {
 	0.15f, // float blurResScaling;
 	1.0f, // float spotlightResScaling;
 	0.3f, // float lightShaftsResScaling;
-	1 // int32_t scalingAlgorithm;
+	false, // bool lightShafts;
+	1, // int32_t scalingAlgorithm;
+	0, // int32_t blurAlgorithm; // 0 = gaussian, 1 = dual filter
+	false // bool temporalUpsampling; // Replaces scalingAlgorithm
 };
 
 const GraphicsConfig LAPTOP_W_NVIDIA_GRAPHICS_CONFIG = {
@@ -56,7 +151,10 @@ const GraphicsConfig LAPTOP_W_NVIDIA_GRAPHICS_CONFIG = {
 	0.2f, // float blurResScaling;
 	1.0f, // float spotlightResScaling;
 	0.4f, // float lightShaftsResScaling;
-	1 // int32_t scalingAlgorithm;
+	true, // bool lightShafts;
+	1, // int32_t scalingAlgorithm;
+	0, // int32_t blurAlgorithm; // 0 = gaussian, 1 = dual filter
+	true // bool temporalUpsampling; // Replaces scalingAlgorithm
 };
 
 const GraphicsConfig GAMING_COMPUTER_GRAPHICS_CONFIG = {
@@ -66,7 +164,10 @@ const GraphicsConfig GAMING_COMPUTER_GRAPHICS_CONFIG = {
 	0.25f, // float blurResScaling;
 	1.0f, // float spotlightResScaling;
 	0.5f, // float lightShaftsResScaling;
-	3 // int32_t scalingAlgorithm;
+	true, // bool lightShafts;
+	3, // int32_t scalingAlgorithm;
+	1, // int32_t blurAlgorithm; // 0 = gaussian, 1 = dual filter
+	true // bool temporalUpsampling; // Replaces scalingAlgorithm
 };
 
 const GraphicsConfig FUTURE_SUPERCOMPUTER_GRAPHICS_CONFIG = {
@@ -76,7 +177,10 @@ const GraphicsConfig FUTURE_SUPERCOMPUTER_GRAPHICS_CONFIG = {
 	0.4f, // float blurResScaling;
 	1.0f, // float spotlightResScaling;
 	0.5f, // float lightShaftsResScaling;
-	3 // int32_t scalingAlgorithm;
+	true, // bool lightShafts;
+	3, // int32_t scalingAlgorithm;
+	1, // int32_t blurAlgorithm; // 0 = gaussian, 1 = dual filter
+	true // bool temporalUpsampling; // Replaces scalingAlgorithm
 };
 
 bool operator== (const GraphicsConfig& lhs, const GraphicsConfig& rhs) noexcept
@@ -87,7 +191,10 @@ bool operator== (const GraphicsConfig& lhs, const GraphicsConfig& rhs) noexcept
 	       lhs.blurResScaling == rhs.blurResScaling &&
 	       lhs.spotlightResScaling == rhs.spotlightResScaling &&
 	       lhs.lightShaftsResScaling == rhs.lightShaftsResScaling &&
-	       lhs.scalingAlgorithm == rhs.scalingAlgorithm;
+	       lhs.lightShafts == rhs.lightShafts &&
+	       lhs.scalingAlgorithm == rhs.scalingAlgorithm &&
+	       lhs.blurAlgorithm == rhs.blurAlgorithm &&
+	       lhs.temporalUpsampling == rhs.temporalUpsampling;
 }
 
 bool operator!= (const GraphicsConfig& lhs, const GraphicsConfig& rhs) noexcept
@@ -106,6 +213,12 @@ bool operator== (const ConfigData& lhs, const ConfigData& rhs) noexcept
 	// Graphics
 	lhs.displayIndex == rhs.displayIndex &&
 	lhs.fullscreenMode == rhs.fullscreenMode &&
+	lhs.maxFramesInFlight == rhs.maxFramesInFlight &&
+	lhs.dynamicResolution == rhs.dynamicResolution &&
+	lhs.dynamicResTargetMs == rhs.dynamicResTargetMs &&
+	lhs.dynamicResMinScale == rhs.dynamicResMinScale &&
+	lhs.fusedEmissive == rhs.fusedEmissive &&
+	lhs.orderIndependentTransparency == rhs.orderIndependentTransparency &&
 	lhs.gc == rhs.gc &&
 
 	// Audio
@@ -157,102 +270,50 @@ void GlobalConfig::load() noexcept
 		std::terminate();
 	}
 
-	sfz::IniParser& ip = mIniParser;
-	
-	// [Audio]
-	static const string aStr = "Audio";
-	musicVolume = ip.sanitizeInt(aStr, "iMusicVolume", 10, 0, 10);
-	sfxVolume =   ip.sanitizeInt(aStr, "iSfxVolume", 10, 0, 10);
-
-	// [CustomModel]
-	static const string cmStr = "CustomModel";
-	ModelConfig& mc = modelConfig;
-	mc.gridWidth =              ip.sanitizeInt(cmStr, "iGridWidth", 3, 2, 128);
-
-	mc.tilesPerSecond =         ip.sanitizeFloat(cmStr, "fTilesPerSecond", 2.25f, 0.05f, 60.0f);
-	mc.speedIncreasePerObject = ip.sanitizeFloat(cmStr, "fSpeedIncreasePerObject", 0.025f, 0.001f, 60.0f);
-	
-	mc.bonusFrequency =         ip.sanitizeInt(cmStr, "iBonusFrequency", 8, 1, 1024);
-	mc.bonusDuration =          ip.sanitizeInt(cmStr, "iBonusDuration", 32, 0, 4096);
-	mc.numberOfBonusObjects =   ip.sanitizeInt(cmStr, "iNumberOfBonusObjects", 1, 0, 32);
-	mc.earlyDuration =          ip.sanitizeInt(cmStr, "iEarlyDuration", 8, 0, 1024);
-	mc.shiftBonusDuration =     ip.sanitizeInt(cmStr, "iShiftBonusDuration", 8, 0, 1024);
-
-	mc.objectValue =            ip.sanitizeInt(cmStr, "iObjectValue", 8, 0, 4096);
-	mc.objectEarlyBonus =       ip.sanitizeInt(cmStr, "iObjectEarlyBonus", 8, 0, 4096);
-	mc.objectShiftBonus =       ip.sanitizeInt(cmStr, "iObjectShiftBonus", 8, 0, 4096);
-	mc.bonusObjectValue =       ip.sanitizeInt(cmStr, "iBonusObjectValue", 32, 0, 4096);
-	mc.bonusObjectShiftBonus =  ip.sanitizeInt(cmStr, "iBonusObjectShiftBonus", 16, 0, 4096);
-
-	// [Debug]
-	static const string dStr = "Debug";
-	continuousShaderReload = ip.sanitizeBool(dStr, "bContinuousShaderReload", false);
-	printFrametimes =        ip.sanitizeBool(dStr, "bPrintFrametimes", false);
+	ConfigData& data = *this;
+	for (const ConfigField& field : CONFIG_SCHEMA) {
+		switch (field.type) {
+		case FieldType::BOOL:
+			fieldRef<bool>(data, field) =
+			    mIniParser.sanitizeBool(field.section, field.key, field.defaultValue != 0.0);
+			break;
+		case FieldType::INT:
+			fieldRef<int32_t>(data, field) =
+			    mIniParser.sanitizeInt(field.section, field.key, (int32_t)field.defaultValue,
+			                           (int32_t)field.minValue, (int32_t)field.maxValue);
+			break;
+		case FieldType::FLOAT:
+			fieldRef<float>(data, field) =
+			    mIniParser.sanitizeFloat(field.section, field.key, (float)field.defaultValue,
+			                             (float)field.minValue, (float)field.maxValue);
+			break;
+		}
+	}
 
-	// [GameSettings]
-	static const string gsStr = "GameSettings";
-	inputBufferSize = ip.sanitizeInt(gsStr, "iInputBufferSize", 2, 1, 5);
-	
-	// [Graphics]
-	static const string grStr = "Graphics";
-	gc.nativeInternalRes =     ip.sanitizeBool(grStr, "bNativeInternalRes", false);
-	gc.blurResScaling =        ip.sanitizeFloat(grStr, "fBlurResScaling", 0.4f, 0.01f, 2.0f);
-	gc.internalResolutionY =   ip.sanitizeInt(grStr, "iInternalResolutionY", 1080, 120, 8192);
-	gc.lightShaftsResScaling = ip.sanitizeFloat(grStr, "fLightShaftsResScaling", 0.5f, 0.01f, 10.0f);
-	gc.spotlightResScaling =   ip.sanitizeFloat(grStr, "fSpotlightResScaling", 1.0f, 0.01f, 10.0f);
-	displayIndex =          ip.sanitizeInt(grStr, "iDisplayIndex", -1, -1, 8);
-	fullscreenMode =        ip.sanitizeInt(grStr, "iFullscreenMode", 1, 0, 2);
-	gc.scalingAlgorithm =      ip.sanitizeInt(grStr, "iScalingAlgorithm", 3, 0, 8);
-	gc.vsync =                 ip.sanitizeInt(grStr, "iVSync", 1, 0, 2);
+	// Only rewrites the file if items were missing or invalid
+	if (!mIniParser.save()) {
+		std::cerr << "Couldn't save config.ini at: " << userIniPath() << std::endl;
+	}
 }
 
 void GlobalConfig::save() noexcept
 {
-	// [Audio]
-	static const string aStr = "Audio";
-	mIniParser.setInt(aStr, "iMusicVolume", musicVolume);
-	mIniParser.setInt(aStr, "iSfxVolume", sfxVolume);
-
-	// [CustomModel]
-	static const string cmStr = "CustomModel";
-	mIniParser.setInt(cmStr, "iGridWidth", modelConfig.gridWidth);
-
-	mIniParser.setFloat(cmStr, "fTilesPerSecond", modelConfig.tilesPerSecond);
-	mIniParser.setFloat(cmStr, "fSpeedIncreasePerObject", modelConfig.speedIncreasePerObject);
-	
-	mIniParser.setInt(cmStr, "iBonusFrequency", modelConfig.bonusFrequency);
-	mIniParser.setInt(cmStr, "iBonusDuration", modelConfig.bonusDuration);
-	mIniParser.setInt(cmStr, "iNumberOfBonusObjects", modelConfig.numberOfBonusObjects);
-	mIniParser.setInt(cmStr, "iEarlyDuration", modelConfig.earlyDuration);
-	mIniParser.setInt(cmStr, "iShiftBonusDuration", modelConfig.shiftBonusDuration);
-
-	mIniParser.setInt(cmStr, "iObjectValue", modelConfig.objectValue);
-	mIniParser.setInt(cmStr, "iObjectEarlyBonus", modelConfig.objectEarlyBonus);
-	mIniParser.setInt(cmStr, "iObjectShiftBonus", modelConfig.objectShiftBonus);
-	mIniParser.setInt(cmStr, "iBonusObjectValue", modelConfig.bonusObjectValue);
-	mIniParser.setInt(cmStr, "iBonusObjectShiftBonus", modelConfig.bonusObjectShiftBonus);
-
-	// [Debug]
-	static const string dStr = "Debug";
-	mIniParser.setBool(dStr, "bContinuousShaderReload", continuousShaderReload);
-	mIniParser.setBool(dStr, "bPrintFrametimes", printFrametimes);
-
-	// [GameSettings]
-	static const string gsStr = "GameSettings";
-	mIniParser.setInt(gsStr, "iInputBufferSize", inputBufferSize);
-
-	// [Graphics]
-	static const string grStr = "Graphics";
-	mIniParser.setBool(grStr, "bNativeInternalRes", gc.nativeInternalRes);
-	mIniParser.setFloat(grStr, "fBlurResScaling", gc.blurResScaling);
-	mIniParser.setInt(grStr, "iInternalResolutionY", gc.internalResolutionY);
-	mIniParser.setFloat(grStr, "fLightShaftsResScaling", gc.lightShaftsResScaling);
-	mIniParser.setFloat(grStr, "fSpotlightResScaling", gc.spotlightResScaling);
-	mIniParser.setInt(grStr, "iDisplayIndex", displayIndex);
-	mIniParser.setInt(grStr, "iFullscreenMode", fullscreenMode);
-	mIniParser.setInt(grStr, "iScalingAlgorithm", gc.scalingAlgorithm);
-	mIniParser.setInt(grStr, "iVSync", gc.vsync);
+	ConfigData& data = *this;
+	for (const ConfigField& field : CONFIG_SCHEMA) {
+		switch (field.type) {
+		case FieldType::BOOL:
+			mIniParser.setBool(field.section, field.key, fieldRef<bool>(data, field));
+			break;
+		case FieldType::INT:
+			mIniParser.setInt(field.section, field.key, fieldRef<int32_t>(data, field));
+			break;
+		case FieldType::FLOAT:
+			mIniParser.setFloat(field.section, field.key, fieldRef<float>(data, field));
+			break;
+		}
+	}
 
+	// Does nothing unless a value actually changed
 	if (!mIniParser.save()) {
 		std::cerr << "Couldn't save config.ini at: " << userIniPath() << std::endl;
 	}
@@ -270,6 +331,12 @@ void GlobalConfig::data(const ConfigData& configData) noexcept
 	// Graphics
 	this->displayIndex = configData.displayIndex;
 	this->fullscreenMode = configData.fullscreenMode;
+	this->maxFramesInFlight = configData.maxFramesInFlight;
+	this->dynamicResolution = configData.dynamicResolution;
+	this->dynamicResTargetMs = configData.dynamicResTargetMs;
+	this->dynamicResMinScale = configData.dynamicResMinScale;
+	this->fusedEmissive = configData.fusedEmissive;
+	this->orderIndependentTransparency = configData.orderIndependentTransparency;
 	this->gc = configData.gc;
 
 	// Audio
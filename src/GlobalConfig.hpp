@@ -22,7 +22,10 @@ struct GraphicsConfig {
 	float blurResScaling;
 	float spotlightResScaling;
 	float lightShaftsResScaling;
+	bool lightShafts;
 	int32_t scalingAlgorithm;
+	int32_t blurAlgorithm; // 0 = gaussian, 1 = dual filter
+	bool temporalUpsampling; // Replaces scalingAlgorithm
 };
 
 extern const GraphicsConfig TOASTER_GRAPHICS_CONFIG;
@@ -42,6 +45,12 @@ struct ConfigData {
 	// Graphics
 	int32_t displayIndex;
 	int32_t fullscreenMode; // 0 = off, 1 = windowed, 2 = exclusive
+	int32_t maxFramesInFlight; // [1, 3]
+	bool dynamicResolution;
+	float dynamicResTargetMs; // Frametime to aim for when dynamic resolution is enabled
+	float dynamicResMinScale; // Lowest fraction of the internal resolution to render at
+	bool fusedEmissive; // Write emissive in the GBuffer pass instead of a separate pass
+	bool orderIndependentTransparency; // Weighted blended OIT instead of back to front rendering
 	GraphicsConfig gc;
 
 	// Audio
@@ -4,6 +4,8 @@
 
 #include <sfz/Assert.hpp>
 #include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/BoxBlur.hpp>
+#include <sfz/gl/RenderTargetPool.hpp>
 #include <sfz/Math.hpp>
 #include <sfz/Screens.hpp>
 #include <sfz/SDL.hpp>
@@ -30,7 +32,6 @@ int main(int argc, char* argv[])
 #endif
 
 	s3::GlobalConfig& cfg = s3::GlobalConfig::INSTANCE();
-	cfg.save();
 
 	Session2 sdlSession{{InitFlags::EVENTS, InitFlags::VIDEO, InitFlags::AUDIO, InitFlags::GAMECONTROLLER}};
 
@@ -82,6 +83,13 @@ int main(int argc, char* argv[])
 	gl::setupDebugMessages(gl::Severity::MEDIUM, gl::Severity::MEDIUM);
 #endif
 
+	// GPU benchmarks, run instead of the game
+	if (argc > 1 && std::string{argv[1]} == "--benchmark-box-blur") {
+		gl::benchmarkBoxBlur(std::cout);
+		gl::RenderTargetPool::INSTANCE().clear();
+		return 0;
+	}
+
 	// Load assets
 	s3::Assets::load();
 
@@ -116,8 +124,10 @@ int main(int argc, char* argv[])
 		gui::Button::rendererFactory = s3::snakiumButtonRendererFactory();
 	}
 
-	sfz::runGameLoop(window, std::shared_ptr<sfz::BaseScreen>{new s3::MainMenuScreen{}});
+	sfz::runGameLoop(window, std::shared_ptr<sfz::BaseScreen>{new s3::MainMenuScreen{}},
+	                 (uint32_t)cfg.maxFramesInFlight);
 
-	// Destroy assets
+	// Destroy assets and pooled render targets while the GL context is still alive
 	s3::Assets::destroy();
+	gl::RenderTargetPool::INSTANCE().clear();
 }
\ No newline at end of file
@@ -5,8 +5,11 @@
 #include "rendering/Assets.hpp"
 #include "rendering/Camera.hpp"
 #include "rendering/ClassicRenderer.hpp"
+#include "rendering/DynamicResolution.hpp"
+#include "rendering/TemporalUpsampler.hpp"
 #include "rendering/Materials.hpp"
 #include "rendering/ModernRenderer.hpp"
+#include "rendering/RenderCommands.hpp"
 #include "rendering/TileObject.hpp"
 
 #endif
\ No newline at end of file
@@ -1,168 +1,436 @@
 #include "ScoreManagement.hpp"
 
 #include <algorithm>
-#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <string>
 
+#include <sfz/util/ByteIO.hpp>
 #include <sfz/util/IO.hpp>
+#include <sfz/util/MappedFile.hpp>
 
 namespace s3 {
 
+using std::int64_t;
 using std::string;
-using std::uint8_t;
 
-// statics
+// Statics: File format
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-static const char* scoresPath() noexcept
+// Header: 8 byte magic, u32 version, u32 record size. Followed by records, all little-endian:
+// 13 x 4 byte config fields, 8 x i64 + f32 stats, 24 byte name (null padded), u32 checksum of the
+// preceding bytes of the record.
+static const char LOG_MAGIC[8] = {'S', '3', 'S', 'C', 'O', 'R', 'E', 'S'};
+static const uint32_t LOG_VERSION = 1;
+static const size_t HEADER_SIZE = 16;
+static const size_t CONFIG_SIZE = 13 * 4;
+static const size_t NAME_FIELD_SIZE = 24;
+static const size_t RECORD_SIZE = CONFIG_SIZE + 8 * 8 + 4 + NAME_FIELD_SIZE + 4;
+
+static_assert(SCORE_NAME_LENGTH < NAME_FIELD_SIZE, "Name doesn't fit in record");
+
+static const char* logPath() noexcept
+{
+	static const string PATH = sfz::gameBaseFolderPath() + "/snakium-cubed/scores.log";
+	return PATH.c_str();
+}
+
+static const char* legacyScoresPath() noexcept
 {
 	static const string PATH = sfz::gameBaseFolderPath() + "/snakium-cubed/highscores.bin";
 	return PATH.c_str();
 }
 
+// Cursor style wrappers around the sfz little-endian helpers, each call advances the pointer
+
+static void writeU32(uint8_t*& ptr, uint32_t value) noexcept
+{
+	sfz::writeU32(ptr, value);
+	ptr += 4;
+}
+
+static void writeI64(uint8_t*& ptr, int64_t value) noexcept
+{
+	sfz::writeU64(ptr, uint64_t(value));
+	ptr += 8;
+}
+
+static void writeF32(uint8_t*& ptr, float value) noexcept
+{
+	sfz::writeF32(ptr, value);
+	ptr += 4;
+}
+
+static uint32_t readU32(const uint8_t*& ptr) noexcept
+{
+	const uint32_t value = sfz::readU32(ptr);
+	ptr += 4;
+	return value;
+}
+
+static int64_t readI64(const uint8_t*& ptr) noexcept
+{
+	const int64_t value = int64_t(sfz::readU64(ptr));
+	ptr += 8;
+	return value;
+}
+
+static float readF32(const uint8_t*& ptr) noexcept
+{
+	const float value = sfz::readF32(ptr);
+	ptr += 4;
+	return value;
+}
+
+static void writeHeader(uint8_t* ptr) noexcept
+{
+	std::memcpy(ptr, LOG_MAGIC, sizeof(LOG_MAGIC));
+	ptr += sizeof(LOG_MAGIC);
+	writeU32(ptr, LOG_VERSION);
+	writeU32(ptr, uint32_t(RECORD_SIZE));
+}
+
+static void writeConfig(uint8_t*& ptr, const ModelConfig& cfg) noexcept
+{
+	writeU32(ptr, uint32_t(cfg.gridWidth));
+	writeF32(ptr, cfg.tilesPerSecond);
+	writeF32(ptr, cfg.speedIncreasePerObject);
+	writeU32(ptr, uint32_t(cfg.bonusFrequency));
+	writeU32(ptr, uint32_t(cfg.bonusDuration));
+	writeU32(ptr, uint32_t(cfg.numberOfBonusObjects));
+	writeU32(ptr, uint32_t(cfg.earlyDuration));
+	writeU32(ptr, uint32_t(cfg.shiftBonusDuration));
+	writeU32(ptr, uint32_t(cfg.objectValue));
+	writeU32(ptr, uint32_t(cfg.objectEarlyBonus));
+	writeU32(ptr, uint32_t(cfg.objectShiftBonus));
+	writeU32(ptr, uint32_t(cfg.bonusObjectValue));
+	writeU32(ptr, uint32_t(cfg.bonusObjectShiftBonus));
+}
+
+static ModelConfig readConfig(const uint8_t*& ptr) noexcept
+{
+	ModelConfig cfg;
+	cfg.gridWidth = int32_t(readU32(ptr));
+	cfg.tilesPerSecond = readF32(ptr);
+	cfg.speedIncreasePerObject = readF32(ptr);
+	cfg.bonusFrequency = int32_t(readU32(ptr));
+	cfg.bonusDuration = int32_t(readU32(ptr));
+	cfg.numberOfBonusObjects = int32_t(readU32(ptr));
+	cfg.earlyDuration = int32_t(readU32(ptr));
+	cfg.shiftBonusDuration = int32_t(readU32(ptr));
+	cfg.objectValue = int32_t(readU32(ptr));
+	cfg.objectEarlyBonus = int32_t(readU32(ptr));
+	cfg.objectShiftBonus = int32_t(readU32(ptr));
+	cfg.bonusObjectValue = int32_t(readU32(ptr));
+	cfg.bonusObjectShiftBonus = int32_t(readU32(ptr));
+	return cfg;
+}
+
+static void writeRecord(uint8_t* record, const ModelConfig& cfg, const ScoreEntry& entry) noexcept
+{
+	uint8_t* ptr = record;
+	writeConfig(ptr, cfg);
+
+	const Stats& s = entry.stats;
+	writeI64(ptr, s.objectsEaten);
+	writeI64(ptr, s.objectsEarly);
+	writeI64(ptr, s.objectsShift);
+	writeI64(ptr, s.bonusObjectsEaten);
+	writeI64(ptr, s.bonusObjectsShift);
+	writeI64(ptr, s.bonusObjectsMissed);
+	writeI64(ptr, s.tilesTraversed);
+	writeI64(ptr, s.numberOfShifts);
+	writeF32(ptr, s.maxSpeed);
+
+	std::memset(ptr, 0, NAME_FIELD_SIZE);
+	std::memcpy(ptr, entry.name, std::strlen(entry.name));
+	ptr += NAME_FIELD_SIZE;
+
+	writeU32(ptr, sfz::fnv1a32(record, RECORD_SIZE - 4));
+}
+
+/** Returns false if the checksum doesn't match, i.e. the record is damaged or incomplete. */
+static bool readRecord(const uint8_t* record, ScoreEntry& entryOut) noexcept
+{
+	const uint8_t* checksumPtr = record + RECORD_SIZE - 4;
+	if (readU32(checksumPtr) != sfz::fnv1a32(record, RECORD_SIZE - 4)) return false;
+
+	const uint8_t* ptr = record;
+	ModelConfig cfg = readConfig(ptr);
+
+	Stats& s = entryOut.stats;
+	s.objectsEaten = readI64(ptr);
+	s.objectsEarly = readI64(ptr);
+	s.objectsShift = readI64(ptr);
+	s.bonusObjectsEaten = readI64(ptr);
+	s.bonusObjectsShift = readI64(ptr);
+	s.bonusObjectsMissed = readI64(ptr);
+	s.tilesTraversed = readI64(ptr);
+	s.numberOfShifts = readI64(ptr);
+	s.maxSpeed = readF32(ptr);
+
+	std::memcpy(entryOut.name, ptr, SCORE_NAME_LENGTH);
+	entryOut.name[SCORE_NAME_LENGTH] = '\0';
+
+	entryOut.configHash = configHash(cfg);
+	entryOut.score = totalScore(s, cfg);
+	return true;
+}
+
+// Statics: Legacy score bundle
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// The raw struct written by older versions, only the 3 best games of each standard config.
+struct LegacyScoreBundle final {
+	Stats standardResults[3];
+	char standardNames[3][SCORE_NAME_LENGTH + 1];
+	size_t numStandardResults;
+
+	Stats largeResults[3];
+	char largeNames[3][SCORE_NAME_LENGTH + 1];
+	size_t numLargeResults;
+
+	Stats giantResults[3];
+	char giantNames[3][SCORE_NAME_LENGTH + 1];
+	size_t numGiantResults;
+};
+
 // General functions
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-ScoreBundle createEmptyScoreBundle() noexcept
+uint64_t configHash(const ModelConfig& config) noexcept
 {
-	ScoreBundle tmp;
-	for (size_t i = 0; i < NUM_SCORES_SAVED; ++i) {
-		for (size_t n = 0; n < SCORE_NAME_LENGTH + 1; ++n) {
-			tmp.standardNames[i][n] = '\0';
-			tmp.largeNames[i][n] = '\0';
-			tmp.giantNames[i][n] = '\0';
-		}
-	}
-	return tmp;
-}
-
-int tryAddScoreToBundle(ScoreBundle& currentHighScores, ScoreConfigType configType,
-                        Stats newScore, const char* scoreName) noexcept
-{
-	int32_t score = 0;
-	Stats* scores = nullptr;
-	char (*names)[SCORE_NAME_LENGTH + 1] = nullptr;
-	size_t* numScores = nullptr;
-	const ModelConfig* mc = nullptr;
-	switch (configType) {
-	case ScoreConfigType::STANDARD:
-		score = totalScore(newScore, STANDARD_CONFIG);
-		scores = currentHighScores.standardResults;
-		names = currentHighScores.standardNames;
-		numScores = &currentHighScores.numStandardResults;
-		mc = &STANDARD_CONFIG;
-		break;
-	case ScoreConfigType::LARGE:
-		score = totalScore(newScore, LARGE_CONFIG);
-		scores = currentHighScores.largeResults;
-		names = currentHighScores.largeNames;
-		numScores = &currentHighScores.numLargeResults;
-		mc = &LARGE_CONFIG;
-		break;
-	case ScoreConfigType::GIANT:
-		score = totalScore(newScore, GIANT_CONFIG);
-		scores = currentHighScores.giantResults;
-		names = currentHighScores.giantNames;
-		numScores = &currentHighScores.numGiantResults;
-		mc = &GIANT_CONFIG;
-		break;
+	uint8_t bytes[CONFIG_SIZE];
+	uint8_t* ptr = bytes;
+	writeConfig(ptr, config);
+
+	return sfz::fnv1a64(bytes, CONFIG_SIZE);
+}
+
+// ScoreLog: Singleton instance
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+ScoreLog& ScoreLog::INSTANCE() noexcept
+{
+	static ScoreLog log;
+	static bool loaded = log.load();
+	(void)loaded;
+	return log;
+}
+
+// ScoreLog: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool ScoreLog::load() noexcept
+{
+	mEntries.clear();
+	mIndices.clear();
+	mWritable = true;
+
+	if (!sfz::fileExists(logPath())) {
+		importLegacyScores();
+		return !mEntries.empty();
 	}
 
-	// Insert score
-	for (size_t i = 0; i < *numScores; ++i) {
-		int32_t ithScore = totalScore(scores[i], *mc);
-		if (ithScore < score) {
-			for (size_t j = NUM_SCORES_SAVED - 1; j > i; --j) {
-				scores[j] = scores[j-1];
-				std::memcpy(names[j], names[j-1], SCORE_NAME_LENGTH+1);
-			}
-			scores[i] = newScore;
-			std::memcpy(names[i], scoreName, SCORE_NAME_LENGTH+1);
-			*numScores = std::min(*numScores + 1, NUM_SCORES_SAVED);
-			return (int)i+1;
-		}
+	// Records are parsed straight from the mapped file
+	sfz::MappedFile file{logPath()};
+	if (!file.isValid()) {
+		// Exists but can't be read (permissions, locked, ...), never overwrite the history then
+		std::cerr << "Couldn't open score log: " << logPath() << ", scores will not be saved." << std::endl;
+		mWritable = false;
+		return false;
 	}
+	const uint8_t* data = file.data();
 
-	// Just add score if list is not filled
-	if (*numScores < NUM_SCORES_SAVED) {
-		scores[*numScores] = newScore;
-		std::memcpy(names[*numScores], scoreName, SCORE_NAME_LENGTH+1);
-		*numScores += 1;
-		return (int)*numScores;
+	// Crashed before even the header was written, start over with an empty log
+	if (file.size() < HEADER_SIZE) {
+		file.destroy();
+		uint8_t header[HEADER_SIZE];
+		writeHeader(header);
+		rewriteFile(header, HEADER_SIZE);
+		return false;
 	}
 
-	return -1;
-}
-
-int checkScoreRank(const ScoreBundle& currentHighScores, ScoreConfigType configType, Stats newScore) noexcept
-{
-	int32_t score = 0;
-	const Stats* scores = nullptr;
-	const size_t* numScores = nullptr;
-	const ModelConfig* mc = nullptr;
-	switch (configType) {
-	case ScoreConfigType::STANDARD:
-		score = totalScore(newScore, STANDARD_CONFIG);
-		scores = currentHighScores.standardResults;
-		numScores = &currentHighScores.numStandardResults;
-		mc = &STANDARD_CONFIG;
-		break;
-	case ScoreConfigType::LARGE:
-		score = totalScore(newScore, LARGE_CONFIG);
-		scores = currentHighScores.largeResults;
-		numScores = &currentHighScores.numLargeResults;
-		mc = &LARGE_CONFIG;
-		break;
-	case ScoreConfigType::GIANT:
-		score = totalScore(newScore, GIANT_CONFIG);
-		scores = currentHighScores.giantResults;
-		numScores = &currentHighScores.numGiantResults;
-		mc = &GIANT_CONFIG;
-		break;
+	const uint8_t* ptr = data + sizeof(LOG_MAGIC);
+	const uint32_t version = readU32(ptr);
+	const uint32_t recordSize = readU32(ptr);
+	if (std::memcmp(data, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0
+	 || version != LOG_VERSION || recordSize != RECORD_SIZE) {
+		// Might have been written by a newer version, don't touch it
+		std::cerr << "Unsupported score log: " << logPath() << ", scores will not be saved." << std::endl;
+		mWritable = false;
+		return false;
 	}
 
-	for (size_t i = 0; i < *numScores; ++i) {
-		int32_t ithScore = totalScore(scores[i], *mc);
-		if (ithScore < score) {
-			return (int)i+1;
+	// Damaged records are skipped, the following ones are still found as records have fixed size
+	const size_t numRecords = (file.size() - HEADER_SIZE) / RECORD_SIZE;
+	size_t numDamagedRecords = 0;
+	mEntries.reserve(numRecords);
+	for (size_t i = 0; i < numRecords; ++i) {
+		ScoreEntry entry;
+		if (!readRecord(data + HEADER_SIZE + i * RECORD_SIZE, entry)) {
+			numDamagedRecords += 1;
+			continue;
 		}
+		mEntries.push_back(entry);
+	}
+	if (numDamagedRecords != 0) {
+		std::cerr << "Skipped " << numDamagedRecords << " damaged scores in: " << logPath() << std::endl;
+	}
+
+	// Cut off an incomplete record at the end, most likely a game being written on crash. The
+	// file can't be replaced while it is mapped, so the complete records are copied out first.
+	const size_t numCompleteBytes = HEADER_SIZE + numRecords * RECORD_SIZE;
+	if (numCompleteBytes != file.size()) {
+		std::cerr << "Discarding " << (file.size() - numCompleteBytes) << " bytes of incomplete score in: "
+		          << logPath() << std::endl;
+		vector<uint8_t> completeBytes(data, data + numCompleteBytes);
+		file.destroy();
+		rewriteFile(completeBytes.data(), completeBytes.size());
 	}
 
-	if (*numScores < NUM_SCORES_SAVED) {
-		return (int)*numScores + 1;
+	rebuildIndices();
+	return true;
+}
+
+int32_t ScoreLog::add(const ModelConfig& config, const Stats& stats, const char* name) noexcept
+{
+	ScoreEntry entry;
+	entry.configHash = configHash(config);
+	entry.score = totalScore(stats, config);
+	entry.stats = stats;
+	std::memset(entry.name, 0, sizeof(entry.name));
+	if (name != nullptr) std::strncpy(entry.name, name, SCORE_NAME_LENGTH);
+
+	const uint32_t entryIndex = uint32_t(mEntries.size());
+	mEntries.push_back(entry);
+	addToIndex(entryIndex);
+
+	if (mWritable && !appendRecord(config, entry)) {
+		std::cerr << "Couldn't write score to: " << logPath() << std::endl;
 	}
 
-	return -1;
+	const ScoreIndex& index = mIndices[entry.configHash];
+	return int32_t(index.countLess(ScoreKey{entry.score, entryIndex})) + 1;
+}
+
+int32_t ScoreLog::rank(const ModelConfig& config, const Stats& stats) const noexcept
+{
+	auto itr = mIndices.find(configHash(config));
+	if (itr == mIndices.end()) return 1;
+
+	// A new game would be placed after all games with the same score
+	ScoreKey key{totalScore(stats, config), ~uint32_t(0)};
+	return int32_t(itr->second.countLess(key)) + 1;
 }
 
-// IO functions
+size_t ScoreLog::numScores(const ModelConfig& config) const noexcept
+{
+	auto itr = mIndices.find(configHash(config));
+	if (itr == mIndices.end()) return 0;
+	return itr->second.size();
+}
+
+const ScoreEntry& ScoreLog::entry(const ModelConfig& config, size_t rankIndex) const noexcept
+{
+	const ScoreIndex& index = mIndices.find(configHash(config))->second;
+	return mEntries[index.at(rankIndex).entryIndex];
+}
+
+bool ScoreLog::clear() noexcept
+{
+	mEntries.clear();
+	mIndices.clear();
+	mWritable = true;
+
+	// Old scores would otherwise be imported again the next time the log is loaded
+	if (sfz::fileExists(legacyScoresPath())) sfz::deleteFile(legacyScoresPath());
+	if (!sfz::fileExists(logPath())) return true;
+	return sfz::deleteFile(logPath());
+}
+
+// ScoreLog: Private methods
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-bool writeScores(const ScoreBundle& scores) noexcept
+void ScoreLog::addToIndex(uint32_t entryIndex) noexcept
 {
-	return sfz::writeBinaryFile(scoresPath(), (const uint8_t*)&scores, sizeof(ScoreBundle));
+	const ScoreEntry& entry = mEntries[entryIndex];
+	mIndices[entry.configHash].insert(ScoreKey{entry.score, entryIndex});
 }
 
-bool loadScores(ScoreBundle& scoresOut) noexcept
+void ScoreLog::rebuildIndices() noexcept
 {
-	ScoreBundle tmp;
-	int32_t res = sfz::readBinaryFile(scoresPath(), (uint8_t*)&tmp, sizeof(ScoreBundle));
-	if (res == -2) {
-		std::cerr << "Corrupt score file." << std::endl;
-		return false;
+	// Sorting each config's keys and building the trees in linear time is a lot faster than
+	// inserting millions of entries one at a time.
+	unordered_map<uint64_t, vector<ScoreKey>> keys;
+	for (size_t i = 0; i < mEntries.size(); ++i) {
+		keys[mEntries[i].configHash].push_back(ScoreKey{mEntries[i].score, uint32_t(i)});
 	}
-	if (res == -1) {
-		return false;
+
+	mIndices.clear();
+	for (auto& pair : keys) {
+		vector<ScoreKey>& configKeys = pair.second;
+		std::sort(configKeys.begin(), configKeys.end(), CompareScoreKey());
+		mIndices[pair.first].assignSorted(configKeys.data(), configKeys.size());
 	}
-	scoresOut = tmp;
-	return true;
 }
 
-bool deleteScores() noexcept
-{ 
-	return sfz::deleteFile(scoresPath());
+bool ScoreLog::appendRecord(const ModelConfig& config, const ScoreEntry& entry) noexcept
+{
+	uint8_t buffer[HEADER_SIZE + RECORD_SIZE];
+	size_t numBytes = 0;
+	if (!sfz::fileExists(logPath())) {
+		writeHeader(buffer);
+		numBytes += HEADER_SIZE;
+	}
+	writeRecord(buffer + numBytes, config, entry);
+	numBytes += RECORD_SIZE;
+
+	// A single write followed by a flush, if this is interrupted load() will discard the record
+	std::FILE* file = std::fopen(logPath(), "ab");
+	if (file == NULL) return false;
+	bool success = std::fwrite(buffer, 1, numBytes, file) == numBytes;
+	success = (std::fflush(file) == 0) && success;
+	success = (std::fclose(file) == 0) && success;
+	return success;
+}
+
+bool ScoreLog::rewriteFile(const uint8_t* data, size_t numBytes) noexcept
+{
+	// Written to a temporary file first so that the log is never left half written
+	const string tmpPath = string(logPath()) + ".tmp";
+	if (!sfz::writeBinaryFile(tmpPath.c_str(), data, numBytes)) return false;
+	if (std::rename(tmpPath.c_str(), logPath()) == 0) return true;
+
+	// Renaming over an existing file fails on Windows
+	std::remove(logPath());
+	return std::rename(tmpPath.c_str(), logPath()) == 0;
+}
+
+void ScoreLog::importLegacyScores() noexcept
+{
+	if (!sfz::fileExists(legacyScoresPath())) return;
+
+	LegacyScoreBundle legacy;
+	if (sfz::readBinaryFile(legacyScoresPath(), (uint8_t*)&legacy, sizeof(LegacyScoreBundle)) < 0) {
+		std::cerr << "Corrupt score file: " << legacyScoresPath() << std::endl;
+		return;
+	}
+
+	auto importScores = [this](const ModelConfig& cfg, const Stats* results,
+	                           const char (*names)[SCORE_NAME_LENGTH + 1], size_t numResults) {
+		for (size_t i = 0; i < std::min(numResults, size_t(3)); ++i) {
+			char name[SCORE_NAME_LENGTH + 1];
+			std::memcpy(name, names[i], SCORE_NAME_LENGTH);
+			name[SCORE_NAME_LENGTH] = '\0';
+			this->add(cfg, results[i], name);
+		}
+	};
+	importScores(STANDARD_CONFIG, legacy.standardResults, legacy.standardNames, legacy.numStandardResults);
+	importScores(LARGE_CONFIG, legacy.largeResults, legacy.largeNames, legacy.numLargeResults);
+	importScores(GIANT_CONFIG, legacy.giantResults, legacy.giantNames, legacy.numGiantResults);
+	std::cout << "Imported " << mEntries.size() << " scores from: " << legacyScoresPath() << std::endl;
 }
 
 } // namespace s3
\ No newline at end of file
@@ -3,68 +3,136 @@
 #define S3_SCORE_MANAGEMENT_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
+#include <sfz/util/OrderStatisticTree.hpp>
+
+#include "gamelogic/ModelConfig.hpp"
 #include "gamelogic/Stats.hpp"
 
 namespace s3 {
 
+using std::int32_t;
 using std::size_t;
+using std::uint8_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::unordered_map;
+using std::vector;
 
 // Constants
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-constexpr size_t NUM_SCORES_SAVED = 3;
+constexpr size_t NUM_SCORES_PER_PAGE = 3; // Games ranked on the first page count as high scores
 constexpr size_t SCORE_NAME_LENGTH = 20;
 
-enum class ScoreConfigType {
-	STANDARD,
-	LARGE,
-	GIANT
-};
-
-// Bundle struct
+// ScoreEntry struct
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-struct ScoreBundle final {
-	Stats standardResults[NUM_SCORES_SAVED];
-	char standardNames[NUM_SCORES_SAVED][SCORE_NAME_LENGTH + 1];
-	size_t numStandardResults = 0;
-	
-	Stats largeResults[NUM_SCORES_SAVED];
-	char largeNames[NUM_SCORES_SAVED][SCORE_NAME_LENGTH + 1];
-	size_t numLargeResults = 0;
-
-	Stats giantResults[NUM_SCORES_SAVED];
-	char giantNames[NUM_SCORES_SAVED][SCORE_NAME_LENGTH + 1];
-	size_t numGiantResults = 0;
+struct ScoreEntry final {
+	uint64_t configHash;
+	int32_t score;
+	Stats stats;
+	char name[SCORE_NAME_LENGTH + 1]; // Empty for anonymous games
 };
 
-// General functions
-// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+/** @brief Hash of all fields in the config, scores are only ranked against games with the same hash */
+uint64_t configHash(const ModelConfig& config) noexcept;
 
-ScoreBundle createEmptyScoreBundle() noexcept;
+// ScoreLog class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 /**
- * @brief Attempts to add new high score to the current ones
- * @param currentHighScores the current scores bundle
- * @param configType the config the new score belongs to
- * @param newScore the new score
- * @param scoreName the name of the new score (must be at least SCORE_NAME_LENGTH large buffer)
- * @return the ranking of the new score, -1 if not ranked
+ * @brief The history of all finished games, for every config played
+ * Backed by an append-only file (scores.log) of fixed size checksummed records, each new game is
+ * appended and flushed directly. The file is memory mapped when loaded and parsed in place. A
+ * record left incomplete by a crash is cut off the next time the log is loaded, and records with
+ * a bad checksum are skipped. In memory every config has an order statistic tree of its scores,
+ * so both the rank of a score and the n:th best score can be found in O(log n).
+ *
+ * A highscores.bin file from older versions is imported the first time the log is created.
  */
-int tryAddScoreToBundle(ScoreBundle& currentHighScores, ScoreConfigType configType,
-                        Stats newScore, const char* scoreName) noexcept;
+class ScoreLog final {
+public:
+	// Singleton instance
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-int checkScoreRank(const ScoreBundle& currentHighScores, ScoreConfigType configType, Stats newScore) noexcept;
+	/** @brief Returns the log, loading it from file the first time this is called */
+	static ScoreLog& INSTANCE() noexcept;
 
-// IO functions
-// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief (Re)loads the log from file, returns false if no valid log could be read */
+	bool load() noexcept;
+
+	/**
+	 * @brief Adds a finished game to the log and returns its rank (starting at 1)
+	 * The game is kept in memory even if it could not be written to file.
+	 * @param name the name of the player, nullptr or empty for anonymous games
+	 */
+	int32_t add(const ModelConfig& config, const Stats& stats, const char* name) noexcept;
+
+	/** @brief Returns the rank a game with these stats would get if it was added now */
+	int32_t rank(const ModelConfig& config, const Stats& stats) const noexcept;
+
+	/** @brief Returns the number of games logged with the specified config */
+	size_t numScores(const ModelConfig& config) const noexcept;
+
+	/** @brief Returns the game with the specified rank (starting at 0), must be less than numScores() */
+	const ScoreEntry& entry(const ModelConfig& config, size_t rankIndex) const noexcept;
 
-bool writeScores(const ScoreBundle& scores) noexcept;
+	inline size_t numEntries() const noexcept { return mEntries.size(); }
 
-bool loadScores(ScoreBundle& scoresOut) noexcept;
+	/** @brief Removes all scores, both in memory and on file */
+	bool clear() noexcept;
 
-bool deleteScores() noexcept;
+private:
+	// Private types
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** Ordered by score (highest first), ties are ranked by which game was played first. */
+	struct ScoreKey final {
+		int32_t score;
+		uint32_t entryIndex;
+	};
+
+	struct CompareScoreKey final {
+		inline bool operator() (const ScoreKey& lhs, const ScoreKey& rhs) const noexcept
+		{
+			if (lhs.score != rhs.score) return lhs.score > rhs.score;
+			return lhs.entryIndex < rhs.entryIndex;
+		}
+	};
+
+	typedef sfz::OrderStatisticTree<ScoreKey, CompareScoreKey> ScoreIndex;
+
+	// Private constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	ScoreLog(const ScoreLog&) = delete;
+	ScoreLog& operator= (const ScoreLog&) = delete;
+
+	ScoreLog() noexcept = default;
+
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void addToIndex(uint32_t entryIndex) noexcept;
+	void rebuildIndices() noexcept;
+	bool appendRecord(const ModelConfig& config, const ScoreEntry& entry) noexcept;
+	bool rewriteFile(const uint8_t* data, size_t numBytes) noexcept;
+	void importLegacyScores() noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	vector<ScoreEntry> mEntries;
+	unordered_map<uint64_t, ScoreIndex> mIndices;
+	bool mWritable = true;
+};
 
 } // namespace s3
 #endif
\ No newline at end of file
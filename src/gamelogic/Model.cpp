@@ -1,5 +1,6 @@
 #include "gamelogic/Model.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <new>
 #include <random> // std::mt19937_64, std::random_device
@@ -280,6 +281,30 @@ bool Model::isChangingDirection(Direction upDir, DirectionInput direction) noexc
 	return isChange;
 }
 
+void Model::copyStateFrom(const Model& other) noexcept
+{
+	sfz_assert_debug(mTileCount == other.mTileCount);
+
+	// +1 to include the dead head tile
+	std::copy(&other.mTiles[0], &other.mTiles[0] + other.mTileCount + 1, &mTiles[0]);
+	mHeadPtr = &mTiles[0] + (other.mHeadPtr - &other.mTiles[0]);
+	mPreHeadPtr = &mTiles[0] + (other.mPreHeadPtr - &other.mTiles[0]);
+	mTailPtr = &mTiles[0] + (other.mTailPtr - &other.mTiles[0]);
+	mDeadHeadPtr = &mTiles[0] + (other.mDeadHeadPtr - &other.mTiles[0]);
+	mDeadHeadPos = other.mDeadHeadPos;
+
+	mObjects = other.mObjects;
+	mEventQueue.clear();
+
+	mProgress = other.mProgress;
+	mGameOver = other.mGameOver;
+	mCurrentSpeed = other.mCurrentSpeed;
+	mTimeSinceBonus = other.mTimeSinceBonus;
+	mShiftTimeLeft = other.mShiftTimeLeft;
+
+	mStats = other.mStats;
+}
+
 // Model: Access methods
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -43,6 +43,14 @@ public:
 	void updateSetProgress(float progress) noexcept;
 	bool isChangingDirection(Direction upDir, DirectionInput direction) noexcept;
 
+	/**
+	 * @brief Copies the entire game state (except pending events) from another model
+	 * Used to create snapshots of a model owned by another thread. Both models must have been
+	 * created with the same grid width. Does not allocate memory unless other has more objects
+	 * than this model has ever had.
+	 */
+	void copyStateFrom(const Model& other) noexcept;
+
 	// Access methods
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
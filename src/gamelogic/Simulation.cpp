@@ -0,0 +1,232 @@
+#include "gamelogic/Simulation.hpp"
+
+#include <chrono>
+
+#include <sfz/Assert.hpp>
+
+namespace s3 {
+
+// Statics
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static const uint32_t FRESH_SNAPSHOT_BIT = 0x4u;
+static const uint32_t SNAPSHOT_INDEX_MASK = 0x3u;
+
+// Never run more than this many ticks in one go to catch up, e.g. if the thread was starved
+static const uint32_t MAX_CATCH_UP_TICKS = 8;
+
+// Simulation: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+Simulation::Simulation(const ModelConfig& cfg, size_t inputBufferSize) noexcept
+:
+	mModel{cfg},
+	mInputBufferSize{inputBufferSize <= MAX_INPUT_BUFFER_SIZE ? inputBufferSize : MAX_INPUT_BUFFER_SIZE},
+	mMiddleIndex{2}
+{
+	for (auto& snapshot : mSnapshots) {
+		snapshot = unique_ptr<Model>{new Model{cfg}};
+		snapshot->copyStateFrom(mModel);
+	}
+	mThread = std::thread{&Simulation::threadLoop, this};
+}
+
+Simulation::~Simulation() noexcept
+{
+	mQuit.store(true, std::memory_order_release);
+	mThread.join();
+}
+
+// Simulation: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void Simulation::pushInput(Direction upDir, DirectionInput input) noexcept
+{
+	SimulationCommand cmd;
+	cmd.type = SimulationCommandType::DIRECTION_INPUT;
+	cmd.input = input;
+	cmd.upDir = upDir;
+	pushCommand(cmd);
+	mSentUpDir = upDir;
+}
+
+void Simulation::setUpDir(Direction upDir) noexcept
+{
+	if (upDir == mSentUpDir) return;
+	SimulationCommand cmd;
+	cmd.type = SimulationCommandType::SET_UP_DIR;
+	cmd.upDir = upDir;
+	pushCommand(cmd);
+	mSentUpDir = upDir;
+}
+
+void Simulation::clearInputBuffer() noexcept
+{
+	SimulationCommand cmd;
+	cmd.type = SimulationCommandType::CLEAR_INPUT_BUFFER;
+	pushCommand(cmd);
+}
+
+void Simulation::finishDive() noexcept
+{
+	SimulationCommand cmd;
+	cmd.type = SimulationCommandType::FINISH_DIVE;
+	pushCommand(cmd);
+}
+
+void Simulation::setPaused(bool paused) noexcept
+{
+	mPaused.store(paused, std::memory_order_release);
+}
+
+bool Simulation::tryPopEvent(Event& eventOut) noexcept
+{
+	return mEvents.tryPop(eventOut);
+}
+
+void Simulation::acquireLatestSnapshot() noexcept
+{
+	if ((mMiddleIndex.load(std::memory_order_acquire) & FRESH_SNAPSHOT_BIT) == 0) return;
+	mFrontIndex = mMiddleIndex.exchange(mFrontIndex, std::memory_order_acq_rel) & SNAPSHOT_INDEX_MASK;
+}
+
+// Simulation: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void Simulation::pushCommand(const SimulationCommand& command) noexcept
+{
+	// The simulation thread empties the queue every tick, so it is only full for a very short time
+	while (!mCommands.tryPush(command)) std::this_thread::yield();
+}
+
+bool Simulation::pushEvent(Event event) noexcept
+{
+	// Blocks until the owning thread has made room, events such as GAME_OVER must never be lost.
+	// Gives up if the simulation is being destroyed as the owner might have stopped receiving.
+	while (!mEvents.tryPush(event)) {
+		if (mQuit.load(std::memory_order_acquire)) return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+void Simulation::threadLoop() noexcept
+{
+	using std::chrono::steady_clock;
+	const steady_clock::duration tickDuration = std::chrono::duration_cast<steady_clock::duration>(
+	                                            std::chrono::nanoseconds{1000000000 / TICKS_PER_SECOND});
+	const float tickDelta = 1.0f / float(TICKS_PER_SECOND);
+
+	steady_clock::time_point nextTick = steady_clock::now();
+	while (!mQuit.load(std::memory_order_acquire)) {
+		bool modelChanged = false;
+
+		SimulationCommand cmd;
+		while (mCommands.tryPop(cmd)) {
+			processCommand(cmd);
+			modelChanged = true;
+		}
+
+		const steady_clock::time_point now = steady_clock::now();
+		if (mPaused.load(std::memory_order_acquire)) {
+			nextTick = now + tickDuration;
+		} else {
+			if ((now - nextTick) > (tickDuration * MAX_CATCH_UP_TICKS)) nextTick = now;
+			while (nextTick <= now) {
+				step(tickDelta);
+				modelChanged = true;
+				nextTick += tickDuration;
+			}
+		}
+
+		if (modelChanged) publishSnapshot();
+		std::this_thread::sleep_until(nextTick);
+	}
+}
+
+void Simulation::processCommand(const SimulationCommand& command) noexcept
+{
+	switch (command.type) {
+	case SimulationCommandType::DIRECTION_INPUT:
+		mUpDir = command.upDir;
+		updateInputBuffer(command.upDir, command.input);
+		break;
+	case SimulationCommandType::SET_UP_DIR:
+		mUpDir = command.upDir;
+		break;
+	case SimulationCommandType::CLEAR_INPUT_BUFFER:
+		mInputBufferIndex = 0;
+		break;
+	case SimulationCommandType::FINISH_DIVE:
+		if (mWaitingForDive) {
+			mWaitingForDive = false;
+			mModel.updateSetProgress(0.75f); // TODO: Ugly hack.
+		}
+		break;
+	}
+}
+
+void Simulation::updateInputBuffer(Direction upDir, DirectionInput input) noexcept
+{
+	sfz_assert_debug(mInputBufferIndex <= mInputBufferSize);
+
+	if (mInputBufferIndex == 0) {
+		if (!mModel.isChangingDirection(upDir, input)) {
+			return;
+		}
+		mInputBuffer[mInputBufferIndex] = input;
+		mInputBufferIndex += 1;
+	}
+	else if (mInputBufferIndex < mInputBufferSize) {
+		if (mInputBuffer[mInputBufferIndex-1] == input ||
+		    mInputBuffer[mInputBufferIndex-1] == opposite(input)) {
+			return;
+		}
+		mInputBuffer[mInputBufferIndex] = input;
+		mInputBufferIndex += 1;
+	}
+	else {
+		mInputBuffer[mInputBufferSize-1] = input;
+		mInputBufferIndex = mInputBufferSize;
+	}
+}
+
+void Simulation::step(float delta) noexcept
+{
+	if (mWaitingForDive) return;
+
+	if (mInputBufferIndex > 0) mModel.changeDirection(mUpDir, mInputBuffer[0]);
+	mModel.update(delta);
+
+	bool stateChanged = false;
+	Event event = mModel.popEvent();
+	while (event != Event::NONE) {
+		if (event == Event::STATE_CHANGE) {
+			stateChanged = true;
+			if (mInputBufferIndex > 0) {
+				mInputBufferIndex -= 1;
+				for (size_t i = 0; i < (mInputBufferSize-1); ++i) {
+					mInputBuffer[i] = mInputBuffer[i+1];
+				}
+			}
+		}
+		if (!pushEvent(event)) return;
+		event = mModel.popEvent();
+	}
+
+	// Wait for the camera to turn around if the snake just dived to the opposite side
+	if (stateChanged && !mModel.isGameOver()) {
+		Direction headSide = mModel.tilePosition(mModel.headPtr()).side;
+		Direction preHeadSide = mModel.tilePosition(mModel.preHeadPtr()).side;
+		if (headSide == opposite(preHeadSide)) mWaitingForDive = true;
+	}
+}
+
+void Simulation::publishSnapshot() noexcept
+{
+	mSnapshots[mBackIndex]->copyStateFrom(mModel);
+	mBackIndex = mMiddleIndex.exchange(mBackIndex | FRESH_SNAPSHOT_BIT, std::memory_order_acq_rel)
+	           & SNAPSHOT_INDEX_MASK;
+}
+
+} // namespace s3
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+#ifndef S3_GAMELOGIC_SIMULATION_HPP
+#define S3_GAMELOGIC_SIMULATION_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include <sfz/util/SPSCQueue.hpp>
+
+#include "gamelogic/Direction.hpp"
+#include "gamelogic/Event.hpp"
+#include "gamelogic/Model.hpp"
+#include "gamelogic/ModelConfig.hpp"
+
+namespace s3 {
+
+using std::size_t;
+using std::uint32_t;
+using std::unique_ptr;
+
+// SimulationCommand struct
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+enum class SimulationCommandType : uint8_t {
+	DIRECTION_INPUT,
+	SET_UP_DIR,
+	CLEAR_INPUT_BUFFER,
+	FINISH_DIVE
+};
+
+struct SimulationCommand final {
+	SimulationCommandType type;
+	DirectionInput input;
+	Direction upDir;
+};
+
+// Simulation class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Steps a Model at a fixed rate on a dedicated thread
+ *
+ * Commands (direction input etc) are sent to the simulation thread and Events are received from
+ * it through lock-free single producer single consumer queues. The model itself is never accessed
+ * by the owning thread, instead the simulation publishes a snapshot after each step into a triple
+ * buffer. acquireLatestSnapshot() makes the most recent snapshot available through snapshot(),
+ * which then stays unmodified until the next call to acquireLatestSnapshot().
+ *
+ * Buffered input is interpreted relative to the camera's current up direction, which has to be
+ * kept up to date with setUpDir() as it changes when the snake moves to another side of the cube.
+ *
+ * After a dive the simulation waits until finishDive() is called, giving the camera time to
+ * rotate to the opposite side of the cube.
+ *
+ * All public methods must be called from the same (owning) thread.
+ */
+class Simulation final {
+public:
+	// Constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const uint32_t TICKS_PER_SECOND = 240;
+	static const size_t QUEUE_CAPACITY = 256;
+	static const size_t MAX_INPUT_BUFFER_SIZE = 5;
+
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	Simulation() = delete;
+	Simulation(const Simulation&) = delete;
+	Simulation& operator= (const Simulation&) = delete;
+
+	Simulation(const ModelConfig& cfg, size_t inputBufferSize) noexcept;
+	~Simulation() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void pushInput(Direction upDir, DirectionInput input) noexcept;
+	void setUpDir(Direction upDir) noexcept;
+	void clearInputBuffer() noexcept;
+	void finishDive() noexcept;
+	void setPaused(bool paused) noexcept;
+
+	bool tryPopEvent(Event& eventOut) noexcept;
+
+	void acquireLatestSnapshot() noexcept;
+	inline const Model& snapshot() const noexcept { return *mSnapshots[mFrontIndex]; }
+
+private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void pushCommand(const SimulationCommand& command) noexcept;
+	bool pushEvent(Event event) noexcept;
+	void threadLoop() noexcept;
+	void processCommand(const SimulationCommand& command) noexcept;
+	void updateInputBuffer(Direction upDir, DirectionInput input) noexcept;
+	void step(float delta) noexcept;
+	void publishSnapshot() noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	// Only accessed by the simulation thread
+	Model mModel;
+	const size_t mInputBufferSize;
+	DirectionInput mInputBuffer[MAX_INPUT_BUFFER_SIZE];
+	size_t mInputBufferIndex = 0;
+	Direction mUpDir = Direction::UP;
+	bool mWaitingForDive = false;
+	uint32_t mBackIndex = 0;
+
+	// Only accessed by the owning thread
+	uint32_t mFrontIndex = 1;
+	Direction mSentUpDir = Direction::UP;
+
+	// Shared
+	unique_ptr<Model> mSnapshots[3];
+	std::atomic<uint32_t> mMiddleIndex; // Index of middle snapshot | FRESH_SNAPSHOT_BIT
+	sfz::SPSCQueue<SimulationCommand, QUEUE_CAPACITY> mCommands;
+	sfz::SPSCQueue<Event, QUEUE_CAPACITY> mEvents;
+	std::atomic<bool> mPaused{false};
+	std::atomic<bool> mQuit{false};
+
+	std::thread mThread; // Declared last so that it starts after all other members are initialized
+};
+
+} // namespace s3
+#endif
\ No newline at end of file
@@ -1,11 +1,36 @@
 #include "Assets.hpp"
 
+#include <iostream>
 #include <new>
 #include <string>
+#include <vector>
+
+#include <sfz/gl/TextureContainer.hpp>
+#include <sfz/gl/TexturePacker.hpp>
+#include <sfz/util/AssetArchive.hpp>
+#include <sfz/util/IO.hpp>
+#include <sfz/util/MappedFile.hpp>
 
 namespace s3 {
 
+using sfz::AssetView;
 using std::string;
+using std::vector;
+
+// Static variables
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Opened by Assets::load() and kept open until Assets::destroy(), the music is streamed from it.
+static sfz::AssetArchive* archivePtr = nullptr;
+
+// Assets missing from the archive (or all of them if there is none) are mapped from the loose
+// files in the assets directory instead. They are unmapped as soon as the assets are loaded.
+static vector<sfz::MappedFile> looseFiles;
+
+// Padding between the images in ATLAS_128, must match the --atlas flag given to the asset packer
+// in CMakeLists.txt. Only mip levels 0-3 (log2 of the padding) are used, smaller levels would
+// bleed between the tiles.
+static const int ATLAS_128_PADDING = 8;
 
 // Static functions
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -22,96 +47,88 @@ static const string& assetsPath() noexcept
 	return ASSETS_PATH;
 }
 
-static const string& snakeTexturePath() noexcept
+static const string& archivePath() noexcept
 {
-	static const string SNAKE_TEXTURE_PATH{assetsPath() + "128pix/"};
-	return SNAKE_TEXTURE_PATH;
+	static const string ARCHIVE_PATH{basePath() + "assets.pak"};
+	return ARCHIVE_PATH;
 }
 
-static const string& texturePath() noexcept
+static const string& fontAtlasCachePath() noexcept
 {
-	static const string TEXTURE_PATH{assetsPath() + "textures/"};
-	return TEXTURE_PATH;
+	// Next to config.ini, the install directory might not be writable
+	static const string CACHE_PATH{sfz::gameBaseFolderPath() + "/snakium-cubed/font_atlas.cache"};
+	return CACHE_PATH;
 }
 
-static const char* modelPath() noexcept
+/** Returns the contents of the asset, name is relative to the assets directory. */
+static AssetView assetView(const char* name) noexcept
 {
-	static const string path = assetsPath() + "models/";
-	return path.c_str();
+	if (archivePtr != nullptr && archivePtr->isValid()) {
+		AssetView view = archivePtr->find(name);
+		if (view.isValid()) return view;
+		std::cerr << "\"" << name << "\" is not in the asset archive, loading loose file instead\n";
+	}
+
+	looseFiles.emplace_back((assetsPath() + name).c_str());
+	AssetView view;
+	if (looseFiles.back().isValid()) {
+		view.data = looseFiles.back().data();
+		view.size = looseFiles.back().size();
+	}
+	return view;
 }
 
-// Assets: Singleton instance
-// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
-
-static Assets* assetsInstancePtr = nullptr;
+static vector<AssetView> assetViews(const string& dir, const vector<string>& filenames) noexcept
+{
+	vector<AssetView> views;
+	for (const string& filename : filenames) {
+		views.push_back(assetView((dir + filename).c_str()));
+	}
+	return views;
+}
 
-Assets& Assets::INSTANCE() noexcept
+static Texture loadTexture(const char* name) noexcept
 {
-	return *assetsInstancePtr;
+	// Prefers the container baked by the asset packer, only decodes the image if there is none or
+	// if it can't be used by the driver
+	if (archivePtr != nullptr && archivePtr->isValid()) {
+		const string bakedName = gl::bakedTextureName(name);
+		AssetView baked = archivePtr->find(bakedName.c_str());
+		if (baked.isValid()) {
+			Texture texture = Texture::fromContainer(baked.data, baked.size, bakedName.c_str());
+			if (texture.isValid()) return texture;
+		}
+	}
+
+	AssetView view = assetView(name);
+	return Texture::fromMemory(view.data, view.size, name);
 }
 
-void Assets::load() noexcept
+static gl::SimpleModel loadModel(const char* filename) noexcept
 {
-	sfz_assert_debug(assetsInstancePtr == nullptr);
-	assetsInstancePtr = new (std::nothrow) Assets();
+	AssetView view = assetView((string("models/") + filename).c_str());
+	return gl::SimpleModel{filename, view.data, view.size};
 }
 
-void Assets::destroy() noexcept
+static SoundEffect loadSoundEffect(const char* name) noexcept
 {
-	sfz_assert_debug(assetsInstancePtr != nullptr);
-	delete assetsInstancePtr;
+	AssetView view = assetView(name);
+	return SoundEffect{view.data, view.size, name};
 }
 
-// Assets: Private constructors & destructors
-// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+static Music loadMusic(const char* name) noexcept
+{
+	// Streamed while playing, so the loose file can't be used after it has been unmapped
+	if (archivePtr != nullptr && archivePtr->isValid()) {
+		AssetView view = archivePtr->find(name);
+		if (view.isValid()) return Music{view.data, view.size, name};
+	}
+	return Music{(assetsPath() + name).c_str()};
+}
 
-Assets::Assets() noexcept
-:
-	spriteBatch{3000},
-	fontRenderer{(assetsPath() + "fonts/SaniTrixieSans.ttf").c_str(), 2048, 2048, 125.0f, 3000},
-
-
-	HEAD_D2U_F1{Texture::fromFile((snakeTexturePath() + "head_d2u_f1_128.png").c_str())},
-	HEAD_D2U_F2{Texture::fromFile((snakeTexturePath() + "head_d2u_f2_128.png").c_str())},
-
-	PRE_HEAD_D2U_F1{Texture::fromFile((snakeTexturePath() + "pre_head_d2u_f1_128.png").c_str())},
-	PRE_HEAD_D2U_DIG_F1{Texture::fromFile((snakeTexturePath() + "pre_head_d2u_dig_f1_128.png").c_str())},
-	PRE_HEAD_D2R_F1{Texture::fromFile((snakeTexturePath() + "pre_head_d2r_f1_128.png").c_str())},
-	PRE_HEAD_D2R_DIG_F1{Texture::fromFile((snakeTexturePath() + "pre_head_d2r_dig_f1_128.png").c_str())},
-
-	DEAD_PRE_HEAD_D2U_F1{Texture::fromFile((snakeTexturePath() + "dead_pre_head_d2u_f1_128.png").c_str())},
-	DEAD_PRE_HEAD_D2U_DIG_F1{Texture::fromFile((snakeTexturePath() + "dead_pre_head_d2u_dig_f1_128.png").c_str())},
-	DEAD_PRE_HEAD_D2R_F1{Texture::fromFile((snakeTexturePath() + "dead_pre_head_d2r_f1_128.png").c_str())},
-	DEAD_PRE_HEAD_D2R_DIG_F1{Texture::fromFile((snakeTexturePath() + "dead_pre_head_d2r_dig_f1_128.png").c_str())},
-
-	BODY_D2U{Texture::fromFile((snakeTexturePath() + "body_d2u_128.png").c_str())},
-	BODY_D2U_DIG{Texture::fromFile((snakeTexturePath() + "body_d2u_dig_128.png").c_str())},
-	BODY_D2R{Texture::fromFile((snakeTexturePath() + "body_d2r_128.png").c_str())},
-	BODY_D2R_DIG{Texture::fromFile((snakeTexturePath() + "body_d2r_dig_128.png").c_str())},
-
-	TAIL_D2U_F1{Texture::fromFile((snakeTexturePath() + "tail_d2u_f1_128.png").c_str())},
-	TAIL_D2U_F2{Texture::fromFile((snakeTexturePath() + "tail_d2u_f2_128.png").c_str())},
-	TAIL_D2U_DIG_F1{Texture::fromFile((snakeTexturePath() + "tail_d2u_dig_f1_128.png").c_str())},
-	TAIL_D2U_DIG_F2{Texture::fromFile((snakeTexturePath() + "tail_d2u_dig_f2_128.png").c_str())},
-	TAIL_D2R_F1{Texture::fromFile((snakeTexturePath() + "tail_d2r_f1_128.png").c_str())},
-	TAIL_D2R_F2{Texture::fromFile((snakeTexturePath() + "tail_d2r_f2_128.png").c_str())},
-	TAIL_D2R_DIG_F1{Texture::fromFile((snakeTexturePath() + "tail_d2r_dig_f1_128.png").c_str())},
-	TAIL_D2R_DIG_F2{Texture::fromFile((snakeTexturePath() + "tail_d2r_dig_f2_128.png").c_str())},
-
-	BUTTON_LEFT{Texture::fromFile((snakeTexturePath() + "button_left_128.png").c_str())},
-	BUTTON_LEFT_TOUCHED{Texture::fromFile((snakeTexturePath() + "button_left_touched_128.png").c_str())},
-	BUTTON_LEFT_DISABLED{Texture::fromFile((snakeTexturePath() + "button_left_disabled_128.png").c_str())},
-	BUTTON_MIDDLE_TOUCHED{Texture::fromFile((snakeTexturePath() + "button_middle_touched_128.png").c_str())},
-	BUTTON_RIGHT{Texture::fromFile((snakeTexturePath() + "button_right_128.png").c_str())},
-	BUTTON_RIGHT_TOUCHED{Texture::fromFile((snakeTexturePath() + "button_right_touched_128.png").c_str())},
-	BUTTON_RIGHT_DISABLED{Texture::fromFile((snakeTexturePath() + "button_right_disabled_128.png").c_str())},
-
-	OBJECT{Texture::fromFile((snakeTexturePath() + "object_128.png").c_str())},
-	BONUS_OBJECT{Texture::fromFile((snakeTexturePath() + "bonus_object_128.png").c_str())},
-	FILLED{Texture::fromFile((snakeTexturePath() + "filled_64.png").c_str())},
-	TILE_FACE{Texture::fromFile((snakeTexturePath() + "tile_face_128.png").c_str())},
-
-	ATLAS_128{snakeTexturePath(), {
+static const vector<string>& atlas128Filenames() noexcept
+{
+	static const vector<string> FILENAMES{
 		"head_d2u_f1_128.png",
 		"head_d2u_f2_128.png",
 		"pre_head_d2u_f1_128.png",
@@ -150,8 +167,101 @@ Assets::Assets() noexcept
 		"bonus_object_128.png",
 		"filled_64.png",
 		"tile_face_128.png"
+	};
+	return FILENAMES;
+}
+
+static gl::TexturePacker loadAtlas128() noexcept
+{
+	// Prefers the atlas baked by the asset packer, only packs it here if there is none or if it
+	// doesn't contain all images
+	if (archivePtr != nullptr && archivePtr->isValid()) {
+		AssetView baked = archivePtr->find(gl::bakedAtlasName("128pix/").c_str());
+		if (baked.isValid()) {
+			gl::TexturePacker atlas{baked, "128pix/"};
+			bool complete = atlas.isValid();
+			for (const string& filename : atlas128Filenames()) {
+				if (!complete) break;
+				complete = atlas.textureRegion(filename) != nullptr;
+			}
+			if (complete) return atlas;
+		}
+	}
+
+	return gl::TexturePacker{"128pix/", atlas128Filenames(), assetViews("128pix/", atlas128Filenames()),
+	                         ATLAS_128_PADDING};
+}
 
-	}},
+// Assets: Singleton instance
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static Assets* assetsInstancePtr = nullptr;
+
+Assets& Assets::INSTANCE() noexcept
+{
+	return *assetsInstancePtr;
+}
+
+void Assets::load() noexcept
+{
+	sfz_assert_debug(assetsInstancePtr == nullptr);
+	archivePtr = new (std::nothrow) sfz::AssetArchive(archivePath().c_str());
+	if (!archivePtr->isValid()) {
+		std::cerr << "No asset archive at \"" << archivePath() << "\", loading loose files\n";
+	}
+	assetsInstancePtr = new (std::nothrow) Assets();
+}
+
+void Assets::destroy() noexcept
+{
+	sfz_assert_debug(assetsInstancePtr != nullptr);
+	delete assetsInstancePtr;
+	delete archivePtr; // After the assets, the music is streamed from it
+	archivePtr = nullptr;
+}
+
+// Asset loading functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+Program loadProgram(const char* vertexName, const char* fragmentName,
+                    void(*bindAttribFragFunc)(uint32_t shaderProgram)) noexcept
+{
+	const string vertexPath = assetsPath() + vertexName;
+	const string fragmentPath = assetsPath() + fragmentName;
+	if (archivePtr != nullptr && archivePtr->isValid()) {
+		AssetView vertexSrc = archivePtr->find(vertexName);
+		AssetView fragmentSrc = archivePtr->find(fragmentName);
+		if (vertexSrc.isValid() && fragmentSrc.isValid()) {
+			return Program::fromMemory(vertexSrc.str(), vertexSrc.size, vertexPath.c_str(),
+			                           fragmentSrc.str(), fragmentSrc.size, fragmentPath.c_str(),
+			                           bindAttribFragFunc);
+		}
+	}
+	return Program::fromFile(vertexPath.c_str(), fragmentPath.c_str(), bindAttribFragFunc);
+}
+
+Program loadPostProcessProgram(const char* fragmentName) noexcept
+{
+	const string fragmentPath = assetsPath() + fragmentName;
+	if (archivePtr != nullptr && archivePtr->isValid()) {
+		AssetView fragmentSrc = archivePtr->find(fragmentName);
+		if (fragmentSrc.isValid()) {
+			return Program::postProcessFromMemory(fragmentSrc.str(), fragmentSrc.size, fragmentPath.c_str());
+		}
+	}
+	return Program::postProcessFromFile(fragmentPath.c_str());
+}
+
+// Assets: Private constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+Assets::Assets() noexcept
+:
+	spriteBatch{3000},
+	fontRenderer{assetView("fonts/SaniTrixieSans.ttf"), "fonts/SaniTrixieSans.ttf", 2048, 2048, 125.0f, 3000,
+	             gl::TextureFiltering::ANISOTROPIC_16, fontAtlasCachePath().c_str()},
+
+	ATLAS_128{loadAtlas128()},
 	HEAD_D2U_F1_REG{*ATLAS_128.textureRegion("head_d2u_f1_128.png")},
 	HEAD_D2U_F2_REG{*ATLAS_128.textureRegion("head_d2u_f2_128.png")},
 		
@@ -160,10 +270,10 @@ Assets::Assets() noexcept
 	PRE_HEAD_D2R_F1_REG{*ATLAS_128.textureRegion("pre_head_d2r_f1_128.png")},
 	PRE_HEAD_D2R_DIG_F1_REG{*ATLAS_128.textureRegion("pre_head_d2r_dig_f1_128.png")},
 
-	DEAD_PRE_HEAD_D2U_F1_REG{*ATLAS_128.textureRegion("head_d2u_f1_128.png")},
-	DEAD_PRE_HEAD_D2U_DIG_F1_REG{*ATLAS_128.textureRegion("head_d2u_f1_128.png")},
-	DEAD_PRE_HEAD_D2R_F1_REG{*ATLAS_128.textureRegion("head_d2u_f1_128.png")},
-	DEAD_PRE_HEAD_D2R_DIG_F1_REG{*ATLAS_128.textureRegion("head_d2u_f1_128.png")},
+	DEAD_PRE_HEAD_D2U_F1_REG{*ATLAS_128.textureRegion("dead_pre_head_d2u_f1_128.png")},
+	DEAD_PRE_HEAD_D2U_DIG_F1_REG{*ATLAS_128.textureRegion("dead_pre_head_d2u_dig_f1_128.png")},
+	DEAD_PRE_HEAD_D2R_F1_REG{*ATLAS_128.textureRegion("dead_pre_head_d2r_f1_128.png")},
+	DEAD_PRE_HEAD_D2R_DIG_F1_REG{*ATLAS_128.textureRegion("dead_pre_head_d2r_dig_f1_128.png")},
 
 	BODY_D2U_REG{*ATLAS_128.textureRegion("body_d2u_128.png")},
 	BODY_D2U_DIG_REG{*ATLAS_128.textureRegion("body_d2u_dig_128.png")},
@@ -192,110 +302,113 @@ Assets::Assets() noexcept
 	FILLED_REG{*ATLAS_128.textureRegion("filled_64.png")},
 	TILE_FACE_REG{*ATLAS_128.textureRegion("tile_face_128.png")},
 
-	SNAKIUM_LOGO(Texture::fromFile((texturePath() + "logos/snakium_logo.png").c_str())),
-	CREDITS_LOGO(Texture::fromFile((texturePath() + "logos/credits_logo.png").c_str())),
-
-	HEAD_D2U_F1_MODEL{modelPath(), "head_d2u_f1.obj"},
-	HEAD_D2U_F1_PROJECTION_MODEL{modelPath(), "head_d2u_f1_projection.obj"},
-	HEAD_D2U_DIG_F1_MODEL{modelPath(), "head_d2u_dig_f1.obj"},
-	HEAD_D2U_F2_MODEL{modelPath(), "head_d2u_f2.obj"},
-	HEAD_D2U_F2_PROJECTION_MODEL{modelPath(), "head_d2u_f2_projection.obj"},
-	HEAD_D2U_DIG_F2_MODEL{modelPath(), "head_d2u_dig_f2.obj"},
-
-	PRE_HEAD_D2U_F1_MODEL{modelPath(), "pre_head_d2u_f1.obj"},
-	PRE_HEAD_D2U_F1_PROJECTION_MODEL{modelPath(), "pre_head_d2u_f1_projection.obj"},
-	PRE_HEAD_D2U_DIG_F1_MODEL{modelPath(), "pre_head_d2u_dig_f1.obj"},
-	PRE_HEAD_D2U_DIG_F1_PROJECTION_MODEL{modelPath(), "pre_head_d2u_dig_f1_projection.obj"},
-	PRE_HEAD_D2R_F1_MODEL{modelPath(), "pre_head_d2r_f1.obj"},
-	PRE_HEAD_D2R_F1_PROJECTION_MODEL{modelPath(), "pre_head_d2r_f1_projection.obj"},
-	PRE_HEAD_D2R_DIG_F1_MODEL{modelPath(), "pre_head_d2r_dig_f1.obj"},
-	PRE_HEAD_D2R_DIG_F1_PROJECTION_MODEL{modelPath(), "pre_head_d2r_dig_f1_projection.obj"},
-	PRE_HEAD_D2L_F1_MODEL{modelPath(), "pre_head_d2l_f1.obj"},
-	PRE_HEAD_D2L_F1_PROJECTION_MODEL{modelPath(), "pre_head_d2l_f1_projection.obj"},
-	PRE_HEAD_D2L_DIG_F1_MODEL{modelPath(), "pre_head_d2l_dig_f1.obj"},
-	PRE_HEAD_D2L_DIG_F1_PROJECTION_MODEL{modelPath(), "pre_head_d2l_dig_f1_projection.obj"},
-
-	DEAD_PRE_HEAD_D2U_F1_MODEL{modelPath(), "dead_pre_head_d2u_f1.obj"},
-	DEAD_PRE_HEAD_D2U_DIG_F1_MODEL{modelPath(), "dead_pre_head_d2u_dig_f1.obj"},
-	DEAD_PRE_HEAD_D2R_F1_MODEL{modelPath(), "dead_pre_head_d2r_f1.obj"},
-	DEAD_PRE_HEAD_D2R_DIG_F1_MODEL{modelPath(), "dead_pre_head_d2r_dig_f1.obj"},
-	DEAD_PRE_HEAD_D2L_F1_MODEL{modelPath(), "dead_pre_head_d2l_f1.obj"},
-	DEAD_PRE_HEAD_D2L_DIG_F1_MODEL{modelPath(), "dead_pre_head_d2l_dig_f1.obj"},
-
-	BODY_D2U_MODEL{modelPath(), "body_d2u.obj"},
-	BODY_D2U_PROJECTION_MODEL{modelPath(), "body_d2u_projection.obj"},
-	BODY_D2U_DIG_MODEL{modelPath(), "body_d2u_dig.obj"},
-	BODY_D2U_DIG_PROJECTION_MODEL{modelPath(), "body_d2u_dig_projection.obj"},
-	BODY_D2R_MODEL{modelPath(), "body_d2r.obj"},
-	BODY_D2R_PROJECTION_MODEL{modelPath(), "body_d2r_projection.obj"},
-	BODY_D2R_DIG_MODEL{modelPath(), "body_d2r_dig.obj"},
-	BODY_D2R_DIG_PROJECTION_MODEL{modelPath(), "body_d2r_dig_projection.obj"},
-	BODY_D2L_MODEL{modelPath(), "body_d2l.obj"},
-	BODY_D2L_PROJECTION_MODEL{modelPath(), "body_d2l_projection.obj"},
-	BODY_D2L_DIG_MODEL{modelPath(), "body_d2l_dig.obj"},
-	BODY_D2L_DIG_PROJECTION_MODEL{modelPath(), "body_d2l_dig_projection.obj"},
-
-	TAIL_D2U_F1_MODEL{modelPath(), "tail_d2u_f1.obj"},
-	TAIL_D2U_F1_PROJECTION_MODEL{modelPath(), "tail_d2u_f1_projection.obj"},
-	TAIL_D2U_DIG_F1_MODEL{modelPath(), "tail_d2u_dig_f1.obj"},
-	TAIL_D2U_DIG_F1_PROJECTION_MODEL{modelPath(), "tail_d2u_dig_f1_projection.obj"},
-	TAIL_D2U_F2_MODEL{modelPath(), "tail_d2u_f2.obj"},
-	TAIL_D2U_F2_PROJECTION_MODEL{modelPath(), "tail_d2u_f2_projection.obj"},
-	TAIL_D2U_DIG_F2_MODEL{modelPath(), "tail_d2u_dig_f2.obj"},
-	TAIL_D2U_DIG_F2_PROJECTION_MODEL{modelPath(), "tail_d2u_dig_f2_projection.obj"},
-	TAIL_D2R_F1_MODEL{modelPath(), "tail_d2r_f1.obj"},
-	TAIL_D2R_F1_PROJECTION_MODEL{modelPath(), "tail_d2r_f1_projection.obj"},
-	TAIL_D2R_DIG_F1_MODEL{modelPath(), "tail_d2r_dig_f1.obj"},
-	TAIL_D2R_DIG_F1_PROJECTION_MODEL{modelPath(), "tail_d2r_dig_f1_projection.obj"},
-	TAIL_D2R_F2_MODEL{modelPath(), "tail_d2r_f2.obj"},
-	TAIL_D2R_F2_PROJECTION_MODEL{modelPath(), "tail_d2r_f2_projection.obj"},
-	TAIL_D2R_DIG_F2_MODEL{modelPath(), "tail_d2r_dig_f2.obj"},
-	TAIL_D2R_DIG_F2_PROJECTION_MODEL{modelPath(), "tail_d2r_dig_f2_projection.obj"},
-	TAIL_D2L_F1_MODEL{modelPath(), "tail_d2l_f1.obj"},
-	TAIL_D2L_F1_PROJECTION_MODEL{modelPath(), "tail_d2l_f1_projection.obj"},
-	TAIL_D2L_DIG_F1_MODEL{modelPath(), "tail_d2l_dig_f1.obj"},
-	TAIL_D2L_DIG_F1_PROJECTION_MODEL{modelPath(), "tail_d2l_dig_f1_projection.obj"},
-	TAIL_D2L_F2_MODEL{modelPath(), "tail_d2l_f2.obj"},
-	TAIL_D2L_F2_PROJECTION_MODEL{modelPath(), "tail_d2l_f2_projection.obj"},
-	TAIL_D2L_DIG_F2_MODEL{modelPath(), "tail_d2l_dig_f2.obj"},
-	TAIL_D2L_DIG_F2_PROJECTION_MODEL{modelPath(), "tail_d2l_dig_f2_projection.obj"},
-
-	DIVE_MODEL{modelPath(), "dive.obj"},
-	ASCEND_MODEL{modelPath(), "ascend.obj"},
-
-	OBJECT_PART1_MODEL{modelPath(), "object_part1.obj"},
-	OBJECT_PART2_MODEL{modelPath(), "object_part2.obj"},
-	OBJECT_PART3_MODEL{modelPath(), "object_part3.obj"},
-	OBJECT_PART4_MODEL{modelPath(), "object_part4.obj"},
-	BONUS_OBJECT_MODEL{modelPath(), "bonus_object.obj"},
-
-	TILE_DECORATION_MODEL{modelPath(), "tile_decoration.obj"},
-	TILE_PROJECTION_MODEL{modelPath(), "tile_projection.obj"},
-
-	SKYSPHERE_MODEL{modelPath(), "skysphere.obj"},
-	GROUND_MODEL{modelPath(), "ground.obj"},
-
-	NOT_FOUND_MODEL{modelPath(), "notfound.obj"},
-
-	GAME_MUSIC{(assetsPath() + "audio/music/game_music.wav").c_str()},
-
-	GAME_OVER_SFX{(assetsPath() + "audio/sfx/game_over.wav").c_str()},
-	SHIFT_INITIATED_SFX{(assetsPath() + "audio/sfx/shift_initiated.wav").c_str()},
-	SHIFT_ASCEND_SFX{(assetsPath() + "audio/sfx/shift_ascend.wav").c_str()},
-
-	OBJECT_EATEN_LATE_SFX{(assetsPath() + "audio/sfx/object_eaten_late.wav").c_str()},
-	OBJECT_EATEN_LATE_SHIFT_SFX{(assetsPath() + "audio/sfx/object_eaten_late_shift.wav").c_str()},
-	OBJECT_EATEN_SFX{(assetsPath() + "audio/sfx/object_eaten.wav").c_str()},
-	OBJECT_EATEN_SHIFT_SFX{(assetsPath() + "audio/sfx/object_eaten_shift.wav").c_str()},
-
-	BONUS_OBJECT_ADDED_SFX{(assetsPath() + "audio/sfx/bonus_object_added.wav").c_str()},
-	BONUS_OBJECT_EATEN_SFX{(assetsPath() + "audio/sfx/bonus_object_eaten.wav").c_str()},
-	BONUS_OBJECT_EATEN_SHIFT_SFX{(assetsPath() + "audio/sfx/bonus_object_eaten_shift.wav").c_str()},
-	BONUS_OBJECT_MISSED_SFX{(assetsPath() + "audio/sfx/bonus_object_missed.wav").c_str()},
-
-	MENU_SELECTED_SFX{(assetsPath() + "audio/sfx/menu_selected.wav").c_str()},
-	MENU_ACTIVATED_SFX{(assetsPath() + "audio/sfx/menu_activated.wav").c_str()}
-{ }
+	SNAKIUM_LOGO(loadTexture("textures/logos/snakium_logo.png")),
+	CREDITS_LOGO(loadTexture("textures/logos/credits_logo.png")),
+
+	HEAD_D2U_F1_MODEL{loadModel("head_d2u_f1.obj")},
+	HEAD_D2U_F1_PROJECTION_MODEL{loadModel("head_d2u_f1_projection.obj")},
+	HEAD_D2U_DIG_F1_MODEL{loadModel("head_d2u_dig_f1.obj")},
+	HEAD_D2U_F2_MODEL{loadModel("head_d2u_f2.obj")},
+	HEAD_D2U_F2_PROJECTION_MODEL{loadModel("head_d2u_f2_projection.obj")},
+	HEAD_D2U_DIG_F2_MODEL{loadModel("head_d2u_dig_f2.obj")},
+
+	PRE_HEAD_D2U_F1_MODEL{loadModel("pre_head_d2u_f1.obj")},
+	PRE_HEAD_D2U_F1_PROJECTION_MODEL{loadModel("pre_head_d2u_f1_projection.obj")},
+	PRE_HEAD_D2U_DIG_F1_MODEL{loadModel("pre_head_d2u_dig_f1.obj")},
+	PRE_HEAD_D2U_DIG_F1_PROJECTION_MODEL{loadModel("pre_head_d2u_dig_f1_projection.obj")},
+	PRE_HEAD_D2R_F1_MODEL{loadModel("pre_head_d2r_f1.obj")},
+	PRE_HEAD_D2R_F1_PROJECTION_MODEL{loadModel("pre_head_d2r_f1_projection.obj")},
+	PRE_HEAD_D2R_DIG_F1_MODEL{loadModel("pre_head_d2r_dig_f1.obj")},
+	PRE_HEAD_D2R_DIG_F1_PROJECTION_MODEL{loadModel("pre_head_d2r_dig_f1_projection.obj")},
+	PRE_HEAD_D2L_F1_MODEL{loadModel("pre_head_d2l_f1.obj")},
+	PRE_HEAD_D2L_F1_PROJECTION_MODEL{loadModel("pre_head_d2l_f1_projection.obj")},
+	PRE_HEAD_D2L_DIG_F1_MODEL{loadModel("pre_head_d2l_dig_f1.obj")},
+	PRE_HEAD_D2L_DIG_F1_PROJECTION_MODEL{loadModel("pre_head_d2l_dig_f1_projection.obj")},
+
+	DEAD_PRE_HEAD_D2U_F1_MODEL{loadModel("dead_pre_head_d2u_f1.obj")},
+	DEAD_PRE_HEAD_D2U_DIG_F1_MODEL{loadModel("dead_pre_head_d2u_dig_f1.obj")},
+	DEAD_PRE_HEAD_D2R_F1_MODEL{loadModel("dead_pre_head_d2r_f1.obj")},
+	DEAD_PRE_HEAD_D2R_DIG_F1_MODEL{loadModel("dead_pre_head_d2r_dig_f1.obj")},
+	DEAD_PRE_HEAD_D2L_F1_MODEL{loadModel("dead_pre_head_d2l_f1.obj")},
+	DEAD_PRE_HEAD_D2L_DIG_F1_MODEL{loadModel("dead_pre_head_d2l_dig_f1.obj")},
+
+	BODY_D2U_MODEL{loadModel("body_d2u.obj")},
+	BODY_D2U_PROJECTION_MODEL{loadModel("body_d2u_projection.obj")},
+	BODY_D2U_DIG_MODEL{loadModel("body_d2u_dig.obj")},
+	BODY_D2U_DIG_PROJECTION_MODEL{loadModel("body_d2u_dig_projection.obj")},
+	BODY_D2R_MODEL{loadModel("body_d2r.obj")},
+	BODY_D2R_PROJECTION_MODEL{loadModel("body_d2r_projection.obj")},
+	BODY_D2R_DIG_MODEL{loadModel("body_d2r_dig.obj")},
+	BODY_D2R_DIG_PROJECTION_MODEL{loadModel("body_d2r_dig_projection.obj")},
+	BODY_D2L_MODEL{loadModel("body_d2l.obj")},
+	BODY_D2L_PROJECTION_MODEL{loadModel("body_d2l_projection.obj")},
+	BODY_D2L_DIG_MODEL{loadModel("body_d2l_dig.obj")},
+	BODY_D2L_DIG_PROJECTION_MODEL{loadModel("body_d2l_dig_projection.obj")},
+
+	TAIL_D2U_F1_MODEL{loadModel("tail_d2u_f1.obj")},
+	TAIL_D2U_F1_PROJECTION_MODEL{loadModel("tail_d2u_f1_projection.obj")},
+	TAIL_D2U_DIG_F1_MODEL{loadModel("tail_d2u_dig_f1.obj")},
+	TAIL_D2U_DIG_F1_PROJECTION_MODEL{loadModel("tail_d2u_dig_f1_projection.obj")},
+	TAIL_D2U_F2_MODEL{loadModel("tail_d2u_f2.obj")},
+	TAIL_D2U_F2_PROJECTION_MODEL{loadModel("tail_d2u_f2_projection.obj")},
+	TAIL_D2U_DIG_F2_MODEL{loadModel("tail_d2u_dig_f2.obj")},
+	TAIL_D2U_DIG_F2_PROJECTION_MODEL{loadModel("tail_d2u_dig_f2_projection.obj")},
+	TAIL_D2R_F1_MODEL{loadModel("tail_d2r_f1.obj")},
+	TAIL_D2R_F1_PROJECTION_MODEL{loadModel("tail_d2r_f1_projection.obj")},
+	TAIL_D2R_DIG_F1_MODEL{loadModel("tail_d2r_dig_f1.obj")},
+	TAIL_D2R_DIG_F1_PROJECTION_MODEL{loadModel("tail_d2r_dig_f1_projection.obj")},
+	TAIL_D2R_F2_MODEL{loadModel("tail_d2r_f2.obj")},
+	TAIL_D2R_F2_PROJECTION_MODEL{loadModel("tail_d2r_f2_projection.obj")},
+	TAIL_D2R_DIG_F2_MODEL{loadModel("tail_d2r_dig_f2.obj")},
+	TAIL_D2R_DIG_F2_PROJECTION_MODEL{loadModel("tail_d2r_dig_f2_projection.obj")},
+	TAIL_D2L_F1_MODEL{loadModel("tail_d2l_f1.obj")},
+	TAIL_D2L_F1_PROJECTION_MODEL{loadModel("tail_d2l_f1_projection.obj")},
+	TAIL_D2L_DIG_F1_MODEL{loadModel("tail_d2l_dig_f1.obj")},
+	TAIL_D2L_DIG_F1_PROJECTION_MODEL{loadModel("tail_d2l_dig_f1_projection.obj")},
+	TAIL_D2L_F2_MODEL{loadModel("tail_d2l_f2.obj")},
+	TAIL_D2L_F2_PROJECTION_MODEL{loadModel("tail_d2l_f2_projection.obj")},
+	TAIL_D2L_DIG_F2_MODEL{loadModel("tail_d2l_dig_f2.obj")},
+	TAIL_D2L_DIG_F2_PROJECTION_MODEL{loadModel("tail_d2l_dig_f2_projection.obj")},
+
+	DIVE_MODEL{loadModel("dive.obj")},
+	ASCEND_MODEL{loadModel("ascend.obj")},
+
+	OBJECT_PART1_MODEL{loadModel("object_part1.obj")},
+	OBJECT_PART2_MODEL{loadModel("object_part2.obj")},
+	OBJECT_PART3_MODEL{loadModel("object_part3.obj")},
+	OBJECT_PART4_MODEL{loadModel("object_part4.obj")},
+	BONUS_OBJECT_MODEL{loadModel("bonus_object.obj")},
+
+	TILE_DECORATION_MODEL{loadModel("tile_decoration.obj")},
+	TILE_PROJECTION_MODEL{loadModel("tile_projection.obj")},
+
+	SKYSPHERE_MODEL{loadModel("skysphere.obj")},
+	GROUND_MODEL{loadModel("ground.obj")},
+
+	NOT_FOUND_MODEL{loadModel("notfound.obj")},
+
+	GAME_MUSIC{loadMusic("audio/music/game_music.wav")},
+
+	GAME_OVER_SFX{loadSoundEffect("audio/sfx/game_over.wav")},
+	SHIFT_INITIATED_SFX{loadSoundEffect("audio/sfx/shift_initiated.wav")},
+	SHIFT_ASCEND_SFX{loadSoundEffect("audio/sfx/shift_ascend.wav")},
+
+	OBJECT_EATEN_LATE_SFX{loadSoundEffect("audio/sfx/object_eaten_late.wav")},
+	OBJECT_EATEN_LATE_SHIFT_SFX{loadSoundEffect("audio/sfx/object_eaten_late_shift.wav")},
+	OBJECT_EATEN_SFX{loadSoundEffect("audio/sfx/object_eaten.wav")},
+	OBJECT_EATEN_SHIFT_SFX{loadSoundEffect("audio/sfx/object_eaten_shift.wav")},
+
+	BONUS_OBJECT_ADDED_SFX{loadSoundEffect("audio/sfx/bonus_object_added.wav")},
+	BONUS_OBJECT_EATEN_SFX{loadSoundEffect("audio/sfx/bonus_object_eaten.wav")},
+	BONUS_OBJECT_EATEN_SHIFT_SFX{loadSoundEffect("audio/sfx/bonus_object_eaten_shift.wav")},
+	BONUS_OBJECT_MISSED_SFX{loadSoundEffect("audio/sfx/bonus_object_missed.wav")},
+
+	MENU_SELECTED_SFX{loadSoundEffect("audio/sfx/menu_selected.wav")},
+	MENU_ACTIVATED_SFX{loadSoundEffect("audio/sfx/menu_activated.wav")}
+{
+	// Everything has been uploaded or copied, the loose files aren't needed anymore
+	vector<sfz::MappedFile>().swap(looseFiles);
+}
 
 Assets::~Assets() noexcept
 {
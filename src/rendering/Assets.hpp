@@ -2,6 +2,8 @@
 #ifndef S3_ASSETS_HPP
 #define S3_ASSETS_HPP
 
+#include <cstdint>
+
 #include <sfz/GL.hpp>
 
 #include <sfz/gl/SimpleModel.hpp> // TODO: Temp
@@ -11,9 +13,11 @@
 
 namespace s3 {
 
+using gl::Program;
 using gl::Texture;
 using sdl::Music;
 using sdl::SoundEffect;
+using std::uint32_t;
 
 // Assets class
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -24,6 +28,11 @@ public:
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 	static Assets& INSTANCE() noexcept;
+
+	/**
+	 * @brief Loads all assets, from the asset archive (assets.pak) next to the executable if it exists
+	 * Assets missing from the archive are loaded from the loose files in the assets directory.
+	 */
 	static void load() noexcept;
 	static void destroy() noexcept;
 
@@ -33,46 +42,7 @@ public:
 	gl::SpriteBatch spriteBatch;
 	gl::FontRenderer fontRenderer;
 
-	Texture HEAD_D2U_F1,
-	        HEAD_D2U_F2,
-
-	        PRE_HEAD_D2U_F1,
-	        PRE_HEAD_D2U_DIG_F1,
-	        PRE_HEAD_D2R_F1,
-	        PRE_HEAD_D2R_DIG_F1,
-
-	        DEAD_PRE_HEAD_D2U_F1,
-	        DEAD_PRE_HEAD_D2U_DIG_F1,
-	        DEAD_PRE_HEAD_D2R_F1,
-	        DEAD_PRE_HEAD_D2R_DIG_F1,
-
-	        BODY_D2U,
-	        BODY_D2U_DIG,
-	        BODY_D2R,
-	        BODY_D2R_DIG,
-
-	        TAIL_D2U_F1,
-	        TAIL_D2U_F2,
-	        TAIL_D2U_DIG_F1,
-	        TAIL_D2U_DIG_F2,
-	        TAIL_D2R_F1,
-	        TAIL_D2R_F2,
-	        TAIL_D2R_DIG_F1,
-	        TAIL_D2R_DIG_F2,
-
-	        BUTTON_LEFT,
-	        BUTTON_LEFT_TOUCHED,
-	        BUTTON_LEFT_DISABLED,
-	        BUTTON_MIDDLE_TOUCHED,
-	        BUTTON_RIGHT,
-	        BUTTON_RIGHT_TOUCHED,
-	        BUTTON_RIGHT_DISABLED,
-
-	        OBJECT,
-	        BONUS_OBJECT,
-	        FILLED,
-	        TILE_FACE;
-	
+	// The 128pix images, the regions are used both by the GUI and by ClassicRenderer
 	gl::TexturePacker ATLAS_128;
 	gl::TextureRegion HEAD_D2U_F1_REG,
 	                  HEAD_D2U_F2_REG,
@@ -229,6 +199,21 @@ private:
 	~Assets() noexcept;
 };
 
+// Asset loading functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Loads a program from the asset archive, or from the loose files if it isn't in it
+ * The names are relative to the assets directory. reload() always reads the loose files, so
+ * shaders can still be edited while the game is running. Only valid between Assets::load() and
+ * Assets::destroy().
+ */
+Program loadProgram(const char* vertexName, const char* fragmentName,
+                    void(*bindAttribFragFunc)(uint32_t shaderProgram) = nullptr) noexcept;
+
+/** @brief See loadProgram(), uses the default post process vertex shader */
+Program loadPostProcessProgram(const char* fragmentName) noexcept;
+
 } // namespace s3
 
 #endif
\ No newline at end of file
@@ -37,6 +37,7 @@ Camera::Camera() noexcept
 	mTargetCamUp = mCamUp;
 
 	mDiveInProgress = false;
+	mDiveFinished = false;
 	mDiveFixUpDir = false;
 	mDiveInvertUpDir = false;
 	mDiveTargetCamDir = mCamDir;
@@ -48,8 +49,10 @@ Camera::Camera() noexcept
 // Camera: Public methods
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-void Camera::update(Model& model, float delta) noexcept
+void Camera::update(const Model& model, float delta) noexcept
 {
+	mDiveFinished = false;
+
 	Position headPos, preHeadPos;
 	Direction headTo;
 	if (!model.isGameOver()) {
@@ -102,7 +105,7 @@ void Camera::update(Model& model, float delta) noexcept
 				if ((diffAngle - angleToMove) < 0) {
 					angleToMove = diffAngle;
 					mDiveInProgress = false;
-					model.updateSetProgress(0.75f); // TODO: Ugly hack.
+					mDiveFinished = true;
 				}
 				mat3 rotMat = sfz::rotationMatrix3(mDiveTargetCamDirRotAxis, angleToMove);
 				mCamDir = normalize(rotMat * mCamDir);
@@ -112,7 +115,7 @@ void Camera::update(Model& model, float delta) noexcept
 				}
 			} else {
 				mDiveInProgress = false;
-				model.updateSetProgress(0.75f); // TODO: Ugly hack.
+				mDiveFinished = true;
 			}
 		}
 
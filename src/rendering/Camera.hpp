@@ -34,9 +34,11 @@ public:
 	inline Direction upDir() const noexcept { return mUpDir; }
 	inline float dist() const noexcept { return mCamDist; }
 	inline bool delayModelUpdate() const noexcept { return mDiveInProgress; }
+	/** @brief Whether a dive was finished during the last update, the model should then continue */
+	inline bool diveFinished() const noexcept { return mDiveFinished; }
 	inline const ViewFrustum& viewFrustum() const noexcept { return mViewFrustum; }
 
-	void update(Model& model, float delta) noexcept;
+	void update(const Model& model, float delta) noexcept;
 	void onResize(float fov, float aspect) noexcept;
 
 private:
@@ -49,7 +51,7 @@ private:
 	Direction mUpDir, mLastCubeSide;
 	vec3 mTargetCamUp;
 
-	bool mDiveInProgress, mDiveFixUpDir, mDiveInvertUpDir;
+	bool mDiveInProgress, mDiveFixUpDir, mDiveInvertUpDir, mDiveFinished;
 	vec3 mDiveTargetCamDir, mDiveTargetCamDirRotAxis;
 
 	ViewFrustum mViewFrustum;
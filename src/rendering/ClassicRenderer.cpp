@@ -1,6 +1,7 @@
 #include "rendering/ClassicRenderer.hpp"
 
 #include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/StateCache.hpp>
 #include <sfz/math/Vector.hpp>
 
 #include "rendering/Assets.hpp"
@@ -25,11 +26,13 @@ static gl::Program compileStandardShaderProgram() noexcept
 		out vec2 texCoord;
 
 		uniform mat4 modelViewProj;
+		uniform vec2 uvMin; // The region of the atlas to sample
+		uniform vec2 uvMax;
 
 		void main()
 		{
 			gl_Position = modelViewProj * vec4(position, 1);
-			texCoord = texCoordIn;
+			texCoord = mix(uvMin, uvMax, texCoordIn);
 		}
 	)", R"(
 		#version 330
@@ -52,7 +55,7 @@ static gl::Program compileStandardShaderProgram() noexcept
 	});
 }
 
-static const gl::Texture& getTileTexture(const SnakeTile *tilePtr, Direction side, float progress, bool gameOver) noexcept
+static const gl::TextureRegion& getTileRegion(const SnakeTile *tilePtr, Direction side, float progress, bool gameOver) noexcept
 {
 	Assets& assets = Assets::INSTANCE();
 
@@ -60,64 +63,70 @@ static const gl::Texture& getTileTexture(const SnakeTile *tilePtr, Direction sid
 	              s3::isRightTurn(side, tilePtr->from, tilePtr->to);
 
 	switch (tilePtr->type) {
-	case s3::TileType::EMPTY: return assets.TILE_FACE;
-	case s3::TileType::OBJECT: return assets.OBJECT;
-	case s3::TileType::BONUS_OBJECT: return assets.BONUS_OBJECT;
+	case s3::TileType::EMPTY: return assets.TILE_FACE_REG;
+	case s3::TileType::OBJECT: return assets.OBJECT_REG;
+	case s3::TileType::BONUS_OBJECT: return assets.BONUS_OBJECT_REG;
 
 	case s3::TileType::HEAD:
 		if (progress <= 0.5f) { // Frame 1
-			return assets.HEAD_D2U_F1;
+			return assets.HEAD_D2U_F1_REG;
 		} else { // Frame 2
-			return assets.HEAD_D2U_F2;
+			return assets.HEAD_D2U_F2_REG;
 		}
 	case s3::TileType::PRE_HEAD:
 		if (progress <= 0.5f) { // Frame 1
-			if (!isTurn) return !gameOver ? assets.PRE_HEAD_D2U_F1 : assets.DEAD_PRE_HEAD_D2U_F1;
-			else return !gameOver ? assets.PRE_HEAD_D2R_F1 : assets.DEAD_PRE_HEAD_D2R_F1;
+			if (!isTurn) return !gameOver ? assets.PRE_HEAD_D2U_F1_REG : assets.DEAD_PRE_HEAD_D2U_F1_REG;
+			else return !gameOver ? assets.PRE_HEAD_D2R_F1_REG : assets.DEAD_PRE_HEAD_D2R_F1_REG;
 		} else { // Frame 2
-			if (!isTurn) return assets.BODY_D2U;
-			else return assets.BODY_D2R;
+			if (!isTurn) return assets.BODY_D2U_REG;
+			else return assets.BODY_D2R_REG;
 		}
 	case s3::TileType::BODY:
-		if (!isTurn) return assets.BODY_D2U;
-		else return assets.BODY_D2R;
+		if (!isTurn) return assets.BODY_D2U_REG;
+		else return assets.BODY_D2R_REG;
 	case s3::TileType::TAIL:
 		if (progress <= 0.5f) { // Frame 1
-			if (!isTurn) return assets.TAIL_D2U_F1;
-			else return assets.TAIL_D2R_F1;
+			if (!isTurn) return assets.TAIL_D2U_F1_REG;
+			else return assets.TAIL_D2R_F1_REG;
 		} else { // Frame 2
-			if (!isTurn) return assets.TAIL_D2U_F2;
-			else return assets.TAIL_D2R_F2;
+			if (!isTurn) return assets.TAIL_D2U_F2_REG;
+			else return assets.TAIL_D2R_F2_REG;
 		}
 
 	case s3::TileType::HEAD_DIGESTING:
 		if (progress <= 0.5f) { // Frame 1
-			return assets.HEAD_D2U_F1;
+			return assets.HEAD_D2U_F1_REG;
 		} else { // Frame 2
-			return assets.HEAD_D2U_F2;
+			return assets.HEAD_D2U_F2_REG;
 		}
 	case s3::TileType::PRE_HEAD_DIGESTING:
 		if (progress <= 0.5f) { // Frame 1
-			if (!isTurn) return !gameOver ? assets.PRE_HEAD_D2U_DIG_F1 : assets.DEAD_PRE_HEAD_D2U_DIG_F1;
-			else return !gameOver ? assets.PRE_HEAD_D2R_DIG_F1 : assets.DEAD_PRE_HEAD_D2R_DIG_F1;
+			if (!isTurn) return !gameOver ? assets.PRE_HEAD_D2U_DIG_F1_REG : assets.DEAD_PRE_HEAD_D2U_DIG_F1_REG;
+			else return !gameOver ? assets.PRE_HEAD_D2R_DIG_F1_REG : assets.DEAD_PRE_HEAD_D2R_DIG_F1_REG;
 		} else { // Frame 2
-			if (!isTurn) return assets.BODY_D2U_DIG;
-			else return assets.BODY_D2R_DIG;
+			if (!isTurn) return assets.BODY_D2U_DIG_REG;
+			else return assets.BODY_D2R_DIG_REG;
 		}
 	case s3::TileType::BODY_DIGESTING:
-		if (!isTurn) return assets.BODY_D2U_DIG;
-		else return assets.BODY_D2R_DIG;
+		if (!isTurn) return assets.BODY_D2U_DIG_REG;
+		else return assets.BODY_D2R_DIG_REG;
 	case s3::TileType::TAIL_DIGESTING:
 		if (progress <= 0.5f) { // Frame 1
-			if (!isTurn) return assets.TAIL_D2U_DIG_F1;
-			else return assets.TAIL_D2R_DIG_F1;
+			if (!isTurn) return assets.TAIL_D2U_DIG_F1_REG;
+			else return assets.TAIL_D2R_DIG_F1_REG;
 		} else { // Frame 2
-			if (!isTurn) return assets.TAIL_D2U_DIG_F2;
-			else return assets.TAIL_D2R_DIG_F2;
+			if (!isTurn) return assets.TAIL_D2U_DIG_F2_REG;
+			else return assets.TAIL_D2R_DIG_F2_REG;
 		}
 	}
 }
 
+static void setRegion(const gl::Program& program, const gl::TextureRegion& region) noexcept
+{
+	gl::setUniform(program, "uvMin", region.mUVMin);
+	gl::setUniform(program, "uvMax", region.mUVMax);
+}
+
 static float getTileAngleRad(Direction side, const SnakeTile* tile) noexcept
 {
 	Direction up = defaultUp(side);
@@ -206,25 +215,27 @@ ClassicRenderer::ClassicRenderer() noexcept
 void ClassicRenderer::render(const Model& model, const Camera& cam, const AABB2D& viewport) noexcept
 {
 	Assets& assets = Assets::INSTANCE();
+	gl::StateCache& glState = gl::StateCache::INSTANCE();
 
 	//glClearDepth(1.0f);
 	glDepthFunc(GL_LESS);
-	glEnable(GL_DEPTH_TEST);
+	glState.enable(GL_DEPTH_TEST);
 
 	// Clearing screen
 	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Enable blending
-	glEnable(GL_BLEND);
+	glState.enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Disable culling
-	glDisable(GL_CULL_FACE);
+	glState.disable(GL_CULL_FACE);
 
-	glViewport(viewport.min.x, viewport.min.y, viewport.width(), viewport.height());
+	glState.bindFramebuffer(0);
+	glState.viewport(viewport);
 
-	glUseProgram(mProgram.handle());
+	glState.useProgram(mProgram.handle());
 
 	const auto& viewFrustum = cam.viewFrustum();
 
@@ -232,9 +243,9 @@ void ClassicRenderer::render(const Model& model, const Camera& cam, const AABB2D
 
 	if (!mProgram.isValid()) std::cout << "PROGRAM NON VALID\n";
 
-	// Only one texture is used when rendering SnakeTiles
+	// All SnakeTiles are rendered from the 128pix atlas, only the sampled region changes
 	gl::setUniform(mProgram, "tex", 0);
-	glActiveTexture(GL_TEXTURE0);
+	glState.bindTexture(0, assets.ATLAS_128.texture());
 
 	// Render all SnakeTiles
 	const size_t tilesPerSide = model.config().gridWidth*model.config().gridWidth;
@@ -265,7 +276,7 @@ void ClassicRenderer::render(const Model& model, const Camera& cam, const AABB2D
 				// Render tile face
 				sfz::translation(transform, tilePosToVector(model, tilePos));
 				gl::setUniform(mProgram, "modelViewProj", viewProj * transform);
-				glBindTexture(GL_TEXTURE_2D, assets.TILE_FACE.handle());
+				setRegion(mProgram, assets.TILE_FACE_REG);
 				mTile.render();
 
 				// Render snake sprite for non-empty tiles
@@ -274,8 +285,8 @@ void ClassicRenderer::render(const Model& model, const Camera& cam, const AABB2D
 				// Tile Sprite Transform
 				sfz::translation(transform, translation(transform) + snakeFloatVec);
 				gl::setUniform(mProgram, "modelViewProj", viewProj * transform);
-				glBindTexture(GL_TEXTURE_2D,
-					getTileTexture(tilePtr, tilePos.side, model.progress(), model.isGameOver()).handle());
+				setRegion(mProgram,
+					getTileRegion(tilePtr, tilePos.side, model.progress(), model.isGameOver()));
 				if (isLeftTurn(tilePos.side, tilePtr->from, tilePtr->to)) mXFlippedTile.render();
 				else mTile.render();
 			}
@@ -292,8 +303,8 @@ void ClassicRenderer::render(const Model& model, const Camera& cam, const AABB2D
 				if (tilePtr->type != s3::TileType::EMPTY) {
 					sfz::translation(transform, tilePosToVector(model, tilePos) + snakeFloatVec);
 					gl::setUniform(mProgram, "modelViewProj", viewProj * transform);
-					glBindTexture(GL_TEXTURE_2D,
-						getTileTexture(tilePtr, tilePos.side, model.progress(), model.isGameOver()).handle());
+					setRegion(mProgram,
+						getTileRegion(tilePtr, tilePos.side, model.progress(), model.isGameOver()));
 					if (isLeftTurn(tilePos.side, tilePtr->from, tilePtr->to)) mXFlippedTile.render();
 					else mTile.render();
 				}
@@ -301,7 +312,7 @@ void ClassicRenderer::render(const Model& model, const Camera& cam, const AABB2D
 				// Render tile face
 				sfz::translation(transform, tilePosToVector(model, tilePos));
 				gl::setUniform(mProgram, "modelViewProj", viewProj * transform);
-				glBindTexture(GL_TEXTURE_2D, assets.TILE_FACE.handle());
+				setRegion(mProgram, assets.TILE_FACE_REG);
 				mTile.render();
 			}
 		}
@@ -322,8 +333,8 @@ void ClassicRenderer::render(const Model& model, const Camera& cam, const AABB2D
 
 		// Render dead head
 		gl::setUniform(mProgram, "modelViewProj", viewProj * transform);
-		glBindTexture(GL_TEXTURE_2D,
-			getTileTexture(deadHeadPtr, deadHeadPos.side, model.progress(), model.isGameOver()).handle());
+		setRegion(mProgram,
+			getTileRegion(deadHeadPtr, deadHeadPos.side, model.progress(), model.isGameOver()));
 		if (isLeftTurn(deadHeadPos.side, deadHeadPtr->from, deadHeadPtr->to)) mXFlippedTile.render();
 		else mTile.render();
 	}
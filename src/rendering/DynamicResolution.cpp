@@ -0,0 +1,122 @@
+#include "rendering/DynamicResolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <sfz/gl/OpenGL.hpp>
+
+namespace s3 {
+
+// Statics
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static const float SMOOTHING_FACTOR = 0.1f; // Weight of the newest sample
+
+// The GPU time is kept between these fractions of the target frametime
+static const float LOW_LOAD = 0.75f;
+static const float HIGH_LOAD = 0.92f;
+static const float TARGET_LOAD = 0.85f;
+
+// Number of frames to wait after an adjustment, gives the smoothed timings time to catch up
+static const uint32_t ADJUSTMENT_INTERVAL = 8;
+static const float MAX_SCALE_STEP = 0.05f;
+
+// DynamicResolution: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+DynamicResolution::DynamicResolution() noexcept
+{
+	glGenQueries(NUM_TIMER_QUERIES, mQueries);
+}
+
+DynamicResolution::~DynamicResolution() noexcept
+{
+	glDeleteQueries(NUM_TIMER_QUERIES, mQueries);
+}
+
+// DynamicResolution: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void DynamicResolution::beginGpuTimer() noexcept
+{
+	readBackQueries();
+
+	// Skip timing this frame if the GPU is so far behind that all queries are still pending
+	if (mNumPendingQueries == NUM_TIMER_QUERIES) return;
+
+	const uint32_t index = (mOldestQuery + mNumPendingQueries) % NUM_TIMER_QUERIES;
+	glBeginQuery(GL_TIME_ELAPSED, mQueries[index]);
+	mTimerActive = true;
+}
+
+void DynamicResolution::endGpuTimer() noexcept
+{
+	if (!mTimerActive) return;
+	glEndQuery(GL_TIME_ELAPSED);
+	mTimerActive = false;
+	mNumPendingQueries += 1;
+}
+
+void DynamicResolution::update(float cpuFrametime, float targetFrametime, float minScale) noexcept
+{
+	mCpuFrametime += SMOOTHING_FACTOR * (cpuFrametime - mCpuFrametime);
+	mFramesSinceAdjustment += 1;
+	if (mGpuFrametime <= 0.0f || mFramesSinceAdjustment < ADJUSTMENT_INTERVAL) return;
+
+	const float gpuLoad = mGpuFrametime / targetFrametime;
+	const bool missingTarget = mCpuFrametime > (targetFrametime * 1.1f);
+
+	// Only lower the resolution on missed frames if the GPU is a likely culprit, there is nothing
+	// to gain from it when CPU bound.
+	float newScale = mScale;
+	if (gpuLoad > HIGH_LOAD || (missingTarget && gpuLoad > LOW_LOAD)) {
+		newScale = mScale * std::sqrt(TARGET_LOAD / std::max(gpuLoad, TARGET_LOAD + 0.01f));
+	} else if (gpuLoad < LOW_LOAD) {
+		newScale = mScale * std::sqrt(TARGET_LOAD / gpuLoad);
+	}
+
+	// The number of pixels is proportional to scale², hence the square roots above
+	newScale = std::max(mScale - MAX_SCALE_STEP, std::min(newScale, mScale + MAX_SCALE_STEP));
+	newScale = std::max(std::min(minScale, 1.0f), std::min(newScale, 1.0f));
+
+	if (newScale != mScale) {
+		mScale = newScale;
+		mFramesSinceAdjustment = 0;
+	}
+}
+
+void DynamicResolution::reset() noexcept
+{
+	mScale = 1.0f;
+	mFramesSinceAdjustment = 0;
+}
+
+vec2i DynamicResolution::subRect(vec2i fullDimensions) const noexcept
+{
+	return vec2i{std::max((int)std::round(fullDimensions.x * mScale), 1),
+	             std::max((int)std::round(fullDimensions.y * mScale), 1)};
+}
+
+// DynamicResolution: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void DynamicResolution::readBackQueries() noexcept
+{
+	while (mNumPendingQueries > 0) {
+		const uint32_t query = mQueries[mOldestQuery];
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE) return;
+
+		GLuint64 elapsedNs = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs);
+		const float elapsed = float(double(elapsedNs) / 1000000000.0);
+		if (mGpuFrametime <= 0.0f) mGpuFrametime = elapsed;
+		else mGpuFrametime += SMOOTHING_FACTOR * (elapsed - mGpuFrametime);
+
+		mOldestQuery = (mOldestQuery + 1) % NUM_TIMER_QUERIES;
+		mNumPendingQueries -= 1;
+	}
+}
+
+} // namespace s3
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef S3_RENDERING_DYNAMIC_RESOLUTION_HPP
+#define S3_RENDERING_DYNAMIC_RESOLUTION_HPP
+
+#include <cstdint>
+
+#include <sfz/math/Vector.hpp>
+
+namespace s3 {
+
+using sfz::vec2;
+using sfz::vec2i;
+using std::uint32_t;
+
+// DynamicResolution class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Controls the fraction of the internal resolution that is rendered to each frame
+ *
+ * The GPU time of each frame is measured with timer queries between beginGpuTimer() and
+ * endGpuTimer(). Results are read back a few frames later to avoid stalling, so measurements lag
+ * slightly behind. update() smoothes the measured GPU time and the CPU frametime and adjusts
+ * scale() so that the GPU time stays just below the target frametime. The scale is applied to
+ * both axes and is never changed by more than a few percent at a time to avoid visible pumping.
+ *
+ * Framebuffers are expected to be allocated at full internal resolution, only the lower left
+ * subRect() of each of them is rendered to.
+ */
+class DynamicResolution final {
+public:
+	// Constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const uint32_t NUM_TIMER_QUERIES = 4;
+
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	DynamicResolution(const DynamicResolution&) = delete;
+	DynamicResolution& operator= (const DynamicResolution&) = delete;
+
+	DynamicResolution() noexcept;
+	~DynamicResolution() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void beginGpuTimer() noexcept;
+	void endGpuTimer() noexcept;
+
+	/**
+	 * @brief Updates the scale using the latest timings
+	 * @param cpuFrametime the duration of the last frame in seconds
+	 * @param targetFrametime the frametime to aim for in seconds
+	 * @param minScale the lowest allowed scale, the highest is always 1
+	 */
+	void update(float cpuFrametime, float targetFrametime, float minScale) noexcept;
+
+	/** @brief Goes back to full resolution, e.g. when dynamic resolution is disabled. */
+	void reset() noexcept;
+
+	/** @brief Returns the lower left sub-rect of a full size target that should be rendered to. */
+	vec2i subRect(vec2i fullDimensions) const noexcept;
+
+	inline float scale() const noexcept { return mScale; }
+	inline float gpuFrametime() const noexcept { return mGpuFrametime; }
+
+private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void readBackQueries() noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	uint32_t mQueries[NUM_TIMER_QUERIES];
+	uint32_t mOldestQuery = 0;
+	uint32_t mNumPendingQueries = 0;
+	bool mTimerActive = false;
+
+	float mScale = 1.0f;
+	float mGpuFrametime = 0.0f; // Smoothed, 0 until the first result arrives
+	float mCpuFrametime = 0.0f; // Smoothed
+	uint32_t mFramesSinceAdjustment = 0;
+};
+
+} // namespace s3
+#endif
\ No newline at end of file
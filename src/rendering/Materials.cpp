@@ -1,6 +1,8 @@
 #include "rendering/Materials.hpp"
 
-#include <cstdio>
+#include <cstring>
+
+#include <sfz/gl/OpenGL.hpp>
 
 namespace s3 {
 
@@ -43,22 +45,75 @@ const Material* getMaterials() noexcept
 	return materials;
 }
 
-void stupidSetUniformMaterials(const gl::Program& program, const char* name,
-                               const Material* materials, uint32_t numMaterials) noexcept
+// Materials uniform buffer: Statics
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Matches the std140 layout of the Material struct in the shaders: vec3s are aligned to 16 bytes
+// and the size of each array element is rounded up to a multiple of 16 bytes.
+struct Std140Material final {
+	vec3 diffuse;
+	float padding0;
+	vec3 specular;
+	float padding1;
+	vec3 emissive;
+	float shininess;
+	float opaque;
+	float padding2[3];
+};
+
+static_assert(sizeof(Std140Material) == 64, "Std140Material is padded");
+
+// MaterialsBuffer: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+MaterialsBuffer::MaterialsBuffer() noexcept
 {
-	char buffer[128];
+	glGenBuffers(1, &mUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, mUBO);
+	glBufferData(GL_UNIFORM_BUFFER, MAX_NUM_MATERIALS * sizeof(Std140Material), NULL, GL_STATIC_DRAW);
+	this->upload(getMaterials(), NUM_MATERIAL_IDS);
+}
+
+MaterialsBuffer::~MaterialsBuffer() noexcept
+{
+	glDeleteBuffers(1, &mUBO);
+}
+
+// MaterialsBuffer: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void MaterialsBuffer::upload(const Material* materials, uint32_t numMaterials) noexcept
+{
+	if (numMaterials > MAX_NUM_MATERIALS) numMaterials = MAX_NUM_MATERIALS;
+
+	Std140Material buffer[MAX_NUM_MATERIALS];
+	std::memset(buffer, 0, sizeof(buffer));
 	for (uint32_t i = 0; i < numMaterials; ++i) {
-		std::snprintf(buffer, sizeof(buffer), "%s[%u].%s", name, i, "diffuse");
-		gl::setUniform(program, buffer, materials[i].diffuse);
-		std::snprintf(buffer, sizeof(buffer), "%s[%u].%s", name, i, "specular");
-		gl::setUniform(program, buffer, materials[i].specular);
-		std::snprintf(buffer, sizeof(buffer), "%s[%u].%s", name, i, "emissive");
-		gl::setUniform(program, buffer, materials[i].emissive);
-		std::snprintf(buffer, sizeof(buffer), "%s[%u].%s", name, i, "shininess");
-		gl::setUniform(program, buffer, materials[i].shininess);
-		std::snprintf(buffer, sizeof(buffer), "%s[%u].%s", name, i, "opaque");
-		gl::setUniform(program, buffer, materials[i].opaque);
+		buffer[i].diffuse = materials[i].diffuse;
+		buffer[i].specular = materials[i].specular;
+		buffer[i].emissive = materials[i].emissive;
+		buffer[i].shininess = materials[i].shininess;
+		buffer[i].opaque = materials[i].opaque;
 	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, mUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(buffer), buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void MaterialsBuffer::bind() const noexcept
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, MATERIALS_BINDING_POINT, mUBO);
+}
+
+// Materials uniform buffer: Functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void bindMaterialsBlock(const gl::Program& program) noexcept
+{
+	uint32_t blockIndex = glGetUniformBlockIndex(program.handle(), "MaterialsBlock");
+	if (blockIndex == GL_INVALID_INDEX) return;
+	glUniformBlockBinding(program.handle(), blockIndex, MATERIALS_BINDING_POINT);
 }
 
 } // namespace s3
\ No newline at end of file
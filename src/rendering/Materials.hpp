@@ -46,10 +46,50 @@ const uint32_t NUM_MATERIAL_IDS = 12;
 
 const Material* getMaterials() noexcept;
 
-/** Warning, stupidly slow. Should really use a uniform buffer instead. */
-void stupidSetUniformMaterials(const gl::Program& program, const char* name,
-                               const Material* materials = getMaterials(),
-                               uint32_t numMaterials = NUM_MATERIAL_IDS) noexcept;
+// Materials uniform buffer
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** The uniform buffer binding point the materials are always bound to. */
+const uint32_t MATERIALS_BINDING_POINT = 0;
+
+/** The size of the uMaterials array in the shaders' MaterialsBlock, must be >= NUM_MATERIAL_IDS. */
+const uint32_t MAX_NUM_MATERIALS = 20;
+
+/**
+ * @brief A uniform buffer containing the material table in std140 layout
+ * Shaders access the materials through the following uniform block:
+ * layout(std140) uniform MaterialsBlock { Material uMaterials[20]; };
+ * Each program using the block needs to call bindMaterialsBlock() once after it has been linked.
+ */
+class MaterialsBuffer final {
+public:
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	MaterialsBuffer(const MaterialsBuffer&) = delete;
+	MaterialsBuffer& operator= (const MaterialsBuffer&) = delete;
+
+	/** @brief Creates the buffer and uploads the materials returned by getMaterials() */
+	MaterialsBuffer() noexcept;
+	~MaterialsBuffer() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Replaces the contents of the buffer, only needs to be called when materials change */
+	void upload(const Material* materials, uint32_t numMaterials) noexcept;
+
+	/** @brief Binds the buffer to MATERIALS_BINDING_POINT */
+	void bind() const noexcept;
+
+	inline uint32_t handle() const noexcept { return mUBO; }
+
+private:
+	uint32_t mUBO = 0;
+};
+
+/** @brief Connects the program's MaterialsBlock to MATERIALS_BINDING_POINT, needed after (re)linking */
+void bindMaterialsBlock(const gl::Program& program) noexcept;
 
 } // namespace s3
 #endif
\ No newline at end of file
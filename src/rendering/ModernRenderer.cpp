@@ -1,8 +1,9 @@
 #include "rendering/ModernRenderer.hpp"
 
 #include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/RenderTargetPool.hpp>
+#include <sfz/gl/StateCache.hpp>
 #include <sfz/math/Vector.hpp>
-#include <sfz/util/IO.hpp>
 
 #include "GlobalConfig.hpp"
 #include "rendering/Assets.hpp"
@@ -18,10 +19,17 @@ using sfz::vec4;
 // Statics
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
+static vec2 toFloat(vec2i v) noexcept
+{
+	return vec2{(float)v.x, (float)v.y};
+}
+
 const uint32_t GBUFFER_LINEAR_DEPTH_INDEX = 0;
 const uint32_t GBUFFER_NORMAL_INDEX = 1;
 const uint32_t GBUFFER_MATERIAL_INDEX = 2;
 const uint32_t GBUFFER_BLUR_WEIGHTS_INDEX = 3;
+const uint32_t GBUFFER_EMISSIVE_INDEX = 4; // Only present if emissive is fused into the GBuffer pass
+const uint32_t GBUFFER_VELOCITY_INDEX = 5; // Only present if temporal upsampling is enabled
 
 static void stupidSetSpotlightUniform(const gl::Program& program, const char* name, const Spotlight& spotlight,
                                       const mat4& viewMatrix, const mat4& invViewMatrix) noexcept
@@ -54,47 +62,67 @@ static void stupidSetSpotlightUniform(const gl::Program& program, const char* na
 
 ModernRenderer::ModernRenderer() noexcept
 {
-	mGBufferGenProgram = Program::fromFile((sfz::basePath() + "assets/shaders/gbuffer_gen.vert").c_str(),
-	                                       (sfz::basePath() + "assets/shaders/gbuffer_gen.frag").c_str(),
+	mGBufferGenProgram = loadProgram("shaders/gbuffer_gen.vert",
+	                                 "shaders/gbuffer_gen.frag",
 		[](uint32_t shaderProgram) {
 		glBindAttribLocation(shaderProgram, 0, "inPosition");
 		glBindAttribLocation(shaderProgram, 1, "inNormal");
 		glBindFragDataLocation(shaderProgram, 0, "outFragLinearDepth");
 		glBindFragDataLocation(shaderProgram, 1, "outFragNormal");
-		glBindFragDataLocation(shaderProgram, 2, "outFragEmissive");
-		glBindFragDataLocation(shaderProgram, 3, "outFragMaterialId");
-		glBindFragDataLocation(shaderProgram, 4, "outBlurWeights");
+		glBindFragDataLocation(shaderProgram, 2, "outFragMaterialId");
+		glBindFragDataLocation(shaderProgram, 3, "outBlurWeights");
+		glBindFragDataLocation(shaderProgram, 4, "outFragEmissive");
+		glBindFragDataLocation(shaderProgram, 5, "outFragVelocity");
 	});
 
-	mTransparencyProgram = Program::fromFile((sfz::basePath() + "assets/shaders/transparency.vert").c_str(),
-	                                         (sfz::basePath() + "assets/shaders/transparency.frag").c_str(),
+	mTransparencyProgram = loadProgram("shaders/transparency.vert",
+	                                   "shaders/transparency.frag",
 		[](uint32_t shaderProgram) {
 		glBindAttribLocation(shaderProgram, 0, "inPosition");
 		glBindAttribLocation(shaderProgram, 1, "inNormal");
 		glBindFragDataLocation(shaderProgram, 0, "outFragColor");
 	});
 
-	mEmissiveGenProgram = Program::postProcessFromFile((sfz::basePath() + "assets/shaders/emissive_gen.frag").c_str());
+	mTransparencyOITProgram = loadProgram("shaders/transparency_oit.vert",
+	                                      "shaders/transparency_oit.frag",
+		[](uint32_t shaderProgram) {
+		glBindAttribLocation(shaderProgram, 0, "inPosition");
+		glBindAttribLocation(shaderProgram, 1, "inNormal");
+		glBindFragDataLocation(shaderProgram, 0, "outFragAccumulation");
+		glBindFragDataLocation(shaderProgram, 1, "outFragWeight");
+	});
+
+	mEmissiveGenProgram = loadPostProcessProgram("shaders/emissive_gen.frag");
 
-	mShadowMapProgram = Program::fromFile((sfz::basePath() + "assets/shaders/shadow_map.vert").c_str(),
-	                                      (sfz::basePath() + "assets/shaders/shadow_map.frag").c_str(),
+	mShadowMapProgram = loadProgram("shaders/shadow_map.vert",
+	                                "shaders/shadow_map.frag",
 		[](uint32_t shaderProgram) {
 		glBindAttribLocation(shaderProgram, 0, "inPosition");
 		glBindAttribLocation(shaderProgram, 1, "inNormal");
 		glBindFragDataLocation(shaderProgram, 0, "outFragColor");
 	});
 
-	mStencilLightProgram = Program::fromFile((sfz::basePath() + "assets/shaders/stencil_light.vert").c_str(),
-	                                         (sfz::basePath() + "assets/shaders/stencil_light.frag").c_str(),
+	mStencilLightProgram = loadProgram("shaders/stencil_light.vert",
+	                                   "shaders/stencil_light.frag",
 		[](uint32_t shaderProgram) {
 		glBindAttribLocation(shaderProgram, 0, "inPosition");
 	});
 
-	mSpotlightShadingProgram = Program::postProcessFromFile((sfz::basePath() + "assets/shaders/spotlight_shading.frag").c_str());
+	mSpotlightShadingProgram = loadPostProcessProgram("shaders/spotlight_shading.frag");
+
+	mLightShaftsProgram = loadPostProcessProgram("shaders/light_shafts.frag");
 
-	mLightShaftsProgram = Program::postProcessFromFile((sfz::basePath() + "assets/shaders/light_shafts.frag").c_str());
+	mLightShaftsResolveProgram = loadPostProcessProgram("shaders/light_shafts_resolve.frag");
 
-	mGlobalShadingProgram = Program::postProcessFromFile((sfz::basePath() + "assets/shaders/global_shading.frag").c_str());
+	mGlobalShadingProgram = loadPostProcessProgram("shaders/global_shading.frag");
+
+	bindMaterialsBlock(mGBufferGenProgram);
+	bindMaterialsBlock(mTransparencyProgram);
+	bindMaterialsBlock(mTransparencyOITProgram);
+	bindInstancesBlock(mTransparencyOITProgram);
+	bindMaterialsBlock(mEmissiveGenProgram);
+	bindMaterialsBlock(mSpotlightShadingProgram);
+	bindMaterialsBlock(mGlobalShadingProgram);
 
 	
 	mAmbientLight = vec3(0.05f);
@@ -120,6 +148,28 @@ void ModernRenderer::render(const Model& model, const Camera& cam, vec2 drawable
 {
 	GlobalConfig& cfg = GlobalConfig::INSTANCE();
 	Assets& assets = Assets::INSTANCE();
+	gl::StateCache& glState = gl::StateCache::INSTANCE();
+	gl::RenderTargetPool& pool = gl::RenderTargetPool::INSTANCE();
+
+	// Update time and blur weights
+	mTime += delta;
+	mTime = std::fmod(mTime, 5000.0f);
+	float snakeBlurWeight;
+	if (model.hasTimeShiftBonus()) {
+		snakeBlurWeight = 3.2f + (0.5f * (1.0f + std::sin(mTime * model.currentSpeed() * 2.5f))) * 2.0f;
+	} else {
+		snakeBlurWeight = 1.0 + (0.5f * (1.0f + std::sin(mTime * model.currentSpeed() * 2.5f))) * 0.75f;
+	}
+
+	// View Matrix and Projection Matrix
+	const auto& viewFrustum = cam.viewFrustum();
+	const mat4 viewMatrix = viewFrustum.viewMatrix();
+	const mat4 invViewMatrix = inverse(viewMatrix);
+	const mat4 unjitteredProjMatrix = viewFrustum.projMatrix();
+
+	// Start building the opaque render commands on the worker thread, the model must not be
+	// modified until the commands have been retrieved below
+	mCommandBuilder.startBuild(model, viewMatrix, snakeBlurWeight, delta);
 
 	// Ensure framebuffers are of correct size
 	vec2i internalRes;
@@ -129,322 +179,429 @@ void ModernRenderer::render(const Model& model, const Camera& cam, vec2 drawable
 		float aspect = drawableDim.x / drawableDim.y;
 		internalRes = vec2i{(int)std::round(cfg.gc.internalResolutionY * aspect), cfg.gc.internalResolutionY};
 	}
-	if (mGBuffer.dimensions() != internalRes) {
-		vec2i blurRes{(int)(internalRes.x*cfg.gc.blurResScaling), (int)(internalRes.y*cfg.gc.blurResScaling)};
-		vec2i spotlightRes{(int)(internalRes.x*cfg.gc.spotlightResScaling), (int)(internalRes.y*cfg.gc.spotlightResScaling)};
-		vec2i lightShaftsRes{(int)(internalRes.x*cfg.gc.lightShaftsResScaling), (int)(internalRes.y*cfg.gc.lightShaftsResScaling)};
+	if (mInternalRes != internalRes || mFusedEmissive != cfg.fusedEmissive
+	 || mBlurAlgorithm != cfg.gc.blurAlgorithm || mLightShafts != cfg.gc.lightShafts
+	 || mTemporalUpsampling != cfg.gc.temporalUpsampling
+	 || mOrderIndependentTransparency != cfg.orderIndependentTransparency) {
+		mInternalRes = internalRes;
+		mFusedEmissive = cfg.fusedEmissive;
+		mBlurAlgorithm = cfg.gc.blurAlgorithm;
+		mLightShafts = cfg.gc.lightShafts;
+		mTemporalUpsampling = cfg.gc.temporalUpsampling;
+		mOrderIndependentTransparency = cfg.orderIndependentTransparency;
+		mBlurRes = vec2i{(int)(internalRes.x*cfg.gc.blurResScaling), (int)(internalRes.y*cfg.gc.blurResScaling)};
+		mSpotlightRes = vec2i{(int)(internalRes.x*cfg.gc.spotlightResScaling), (int)(internalRes.y*cfg.gc.spotlightResScaling)};
+		mLightShaftsRes = vec2i{std::max((int)(internalRes.x*cfg.gc.lightShaftsResScaling), 1),
+		                        std::max((int)(internalRes.y*cfg.gc.lightShaftsResScaling), 1)};
 		
-		mGBuffer = FramebufferBuilder{internalRes}
-		          .addTexture(GBUFFER_LINEAR_DEPTH_INDEX, FBTextureFormat::R_F32, FBTextureFiltering::NEAREST)
-		          .addTexture(GBUFFER_NORMAL_INDEX, FBTextureFormat::RGB_F32, FBTextureFiltering::NEAREST)
-		          .addTexture(GBUFFER_MATERIAL_INDEX, FBTextureFormat::R_INT_U8, FBTextureFiltering::NEAREST)
-		          .addTexture(GBUFFER_BLUR_WEIGHTS_INDEX, FBTextureFormat::R_F16, FBTextureFiltering::NEAREST)
-		          .addDepthBuffer(FBDepthFormat::F32)
-		          .build();
-
-		mTransparencyFB = FramebufferBuilder{internalRes}
-		                 .addTexture(0, FBTextureFormat::RGBA_U8, FBTextureFiltering::NEAREST)
-		                 .build();
-		mTransparencyFB.attachExternalDepthBuffer(mGBuffer.depthBuffer());
+		mGBufferDesc = FramebufferBuilder{internalRes}
+		              .addTexture(GBUFFER_LINEAR_DEPTH_INDEX, FBTextureFormat::R_F32, FBTextureFiltering::NEAREST)
+		              .addTexture(GBUFFER_NORMAL_INDEX, FBTextureFormat::RGB_F32, FBTextureFiltering::NEAREST)
+		              .addTexture(GBUFFER_MATERIAL_INDEX, FBTextureFormat::R_INT_U8, FBTextureFiltering::NEAREST)
+		              .addTexture(GBUFFER_BLUR_WEIGHTS_INDEX, FBTextureFormat::R_F16, FBTextureFiltering::NEAREST)
+		              .addDepthBuffer(FBDepthFormat::F32);
+
+		// All attachments of a framebuffer share its size, so fused emissive is written at full
+		// resolution and downsampled by the first blur pass.
+		if (mFusedEmissive) {
+			mGBufferDesc.addTexture(GBUFFER_EMISSIVE_INDEX, FBTextureFormat::RGB_F16, FBTextureFiltering::LINEAR);
+		}
+		if (mTemporalUpsampling) {
+			mGBufferDesc.addTexture(GBUFFER_VELOCITY_INDEX, FBTextureFormat::RG_F16, FBTextureFiltering::NEAREST);
+		}
+		mTemporalUpsampler.reset();
+
+		// OIT accumulates unbounded weighted sums, so it needs float targets
+		if (mOrderIndependentTransparency) {
+			mTransparencyDesc = FramebufferBuilder{internalRes}
+			                   .addTexture(0, FBTextureFormat::RGBA_F16, FBTextureFiltering::NEAREST)
+			                   .addTexture(1, FBTextureFormat::R_F16, FBTextureFiltering::NEAREST);
+		} else {
+			mTransparencyDesc = FramebufferBuilder{internalRes}
+			                   .addTexture(0, FBTextureFormat::RGBA_U8, FBTextureFiltering::NEAREST);
+		}
 		
-		mSpotlightShadingFB = FramebufferBuilder{spotlightRes}
-		                     .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR)
-		                     .addStencilBuffer()
-		                     .build();
-
-		/*mLightShaftsFB = FramebufferBuilder{lightShaftsRes}
-		                .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR)
-		                .addStencilBuffer()
-		                .build();*/
+		mSpotlightShadingDesc = FramebufferBuilder{mSpotlightRes}
+		                       .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR)
+		                       .addStencilBuffer();
+
+		mLightShaftsDesc = FramebufferBuilder{mLightShaftsRes}
+		                  .addTexture(0, FBTextureFormat::RGB_F16, FBTextureFiltering::NEAREST)
+		                  .addStencilBuffer();
+
+		// The history outlives the frame, so it is owned here instead of by the pool
+		for (Framebuffer& history : mLightShaftsHistory) {
+			if (mLightShafts) {
+				history = FramebufferBuilder{mLightShaftsRes}
+				         .addTexture(0, FBTextureFormat::RGBA_F16, FBTextureFiltering::LINEAR)
+				         .build();
+			} else {
+				history = Framebuffer{};
+			}
+		}
+		glState.invalidate();
+		mLightShaftsHistoryValid = false;
 		
-		mGlobalShadingFB = FramebufferBuilder{internalRes}
-		                  .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR)
-		                  .build();
+		mGlobalShadingDesc = FramebufferBuilder{internalRes}
+		                    .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR);
 		
-		mEmissiveFB = FramebufferBuilder{blurRes}
-		             .addTexture(0, FBTextureFormat::RGB_F16, FBTextureFiltering::LINEAR)
-		             .build();
-
-		mGaussianBlur = gl::GaussianBlur{blurRes, 2, 1.0f};
+		mEmissiveDesc = FramebufferBuilder{mBlurRes}
+		               .addTexture(0, FBTextureFormat::RGB_F16, FBTextureFiltering::LINEAR);
+
+		if (mBlurAlgorithm == 1) {
+			mDualFilterBlur = gl::DualFilterBlur{mBlurRes, 2};
+		} else {
+			mGaussianBlur = gl::GaussianBlur{mBlurRes, 2, 1.0f};
+		}
 		
 		std::cout << "Resized framebuffers"
 		          << "\nGBuffer && Global Shading resolution: " << internalRes
-		          << "\nEmissive & Blur resolution: " << blurRes
-		          << "\nSpotlight shading resolution: " << spotlightRes
-		          << "\nLight Shafts resolution: " << lightShaftsRes
+		          << "\nEmissive & Blur resolution: " << mBlurRes
+		          << "\nSpotlight shading resolution: " << mSpotlightRes
+		          << "\nLight Shafts resolution: " << mLightShaftsRes
 		          << "\n\n";
 	}
 	
+	// Dynamic resolution, framebuffers are allocated at full internal resolution and only their
+	// lower left sub-rects are rendered to. Post process shaders sample the same sub-rects by
+	// scaling their uv coordinates.
+	if (cfg.dynamicResolution) {
+		mDynamicRes.update(delta, cfg.dynamicResTargetMs / 1000.0f, cfg.dynamicResMinScale);
+	} else {
+		mDynamicRes.reset();
+	}
+	const vec2i renderRes = mDynamicRes.subRect(mInternalRes);
+	const vec2i emissiveRes = mDynamicRes.subRect(mBlurRes);
+	const vec2i spotlightRes = mDynamicRes.subRect(mSpotlightRes);
+	const vec2i lightShaftsRes = mDynamicRes.subRect(mLightShaftsRes);
+	const vec2 uvScale = vec2{(float)renderRes.x, (float)renderRes.y}
+	                   / vec2{(float)mInternalRes.x, (float)mInternalRes.y};
+	const vec2 lightShaftsUVScale = toFloat(lightShaftsRes) / toFloat(mLightShaftsRes);
+
+	// Temporal upsampling renders each frame with a different subpixel offset, everything
+	// rendered at internal resolution uses the jittered projection matrix
+	mat4 projMatrix = unjitteredProjMatrix;
+	if (mTemporalUpsampling) {
+		mTemporalUpsampler.newFrame();
+		projMatrix = mTemporalUpsampler.jitterProjMatrix(unjitteredProjMatrix, renderRes);
+	}
+	const mat4 invProjMatrix = inverse(projMatrix);
+
 	// Recompile shader programs if continuous shader reload is enabled
 	if (cfg.continuousShaderReload) {
 		mGBufferGenProgram.reload();
 		mTransparencyProgram.reload();
+		mTransparencyOITProgram.reload();
 		mEmissiveGenProgram.reload();
 		mShadowMapProgram.reload();
 		mSpotlightShadingProgram.reload();
 		mLightShaftsProgram.reload();
+		mLightShaftsResolveProgram.reload();
 		mGlobalShadingProgram.reload();
+		mTemporalUpsampler.reloadProgram();
+
+		// Uniform block bindings are lost when a program is relinked
+		Program* materialPrograms[] = {&mGBufferGenProgram, &mTransparencyProgram, &mEmissiveGenProgram,
+		                               &mSpotlightShadingProgram, &mGlobalShadingProgram};
+		for (Program* program : materialPrograms) {
+			if (!program->wasReloaded()) continue;
+			bindMaterialsBlock(*program);
+			program->clearWasReloadedFlag();
+		}
+		if (mTransparencyOITProgram.wasReloaded()) {
+			bindMaterialsBlock(mTransparencyOITProgram);
+			bindInstancesBlock(mTransparencyOITProgram);
+			mTransparencyOITProgram.clearWasReloadedFlag();
+		}
 	}
 
-	// Update time and blur weights
-	mTime += delta;
-	mTime = std::fmod(mTime, 5000.0f);
-	float snakeBlurWeight;
-	if (model.hasTimeShiftBonus()) {
-		snakeBlurWeight = 3.2f + (0.5f * (1.0f + std::sin(mTime * model.currentSpeed() * 2.5f))) * 2.0f;
-	} else {
-		snakeBlurWeight = 1.0 + (0.5f * (1.0f + std::sin(mTime * model.currentSpeed() * 2.5f))) * 0.75f;
-	}
+	// Materials are read from a uniform buffer shared by all programs
+	mMaterialsBuffer.bind();
+
+	mDynamicRes.beginGpuTimer();
 
 	// Rendering GBuffer
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	glEnable(GL_DEPTH_TEST);
+	glState.enable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);
-	glDisable(GL_BLEND);
-	glEnable(GL_CULL_FACE);
+	glState.disable(GL_BLEND);
+	glState.enable(GL_CULL_FACE);
+
+	Framebuffer& gbuffer = pool.acquire(mGBufferDesc);
 
-	glUseProgram(mGBufferGenProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, mGBuffer.fbo());
-	glViewport(0, 0, mGBuffer.width(), mGBuffer.height());
+	glState.useProgram(mGBufferGenProgram.handle());
+	glState.bindFramebuffer(gbuffer.fbo());
+	glState.viewport(renderRes);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClearDepth(1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// View Matrix and Projection Matrix uniforms
-	const auto& viewFrustum = cam.viewFrustum();
-	const mat4 viewMatrix = viewFrustum.viewMatrix();
-	const mat4 invViewMatrix = inverse(viewMatrix);
-	const mat4 projMatrix = viewFrustum.projMatrix();
-	const mat4 invProjMatrix = inverse(projMatrix);
 	gl::setUniform(mGBufferGenProgram, "uProjMatrix", projMatrix);
 	gl::setUniform(mGBufferGenProgram, "uViewMatrix", viewMatrix);
 	gl::setUniform(mGBufferGenProgram, "uFarPlaneDist", viewFrustum.far());
+	gl::setUniform(mGBufferGenProgram, "uUnjitteredViewProjMatrix", unjitteredProjMatrix * viewMatrix);
+	gl::setUniform(mGBufferGenProgram, "uPrevViewProjMatrix", mPrevProjMatrix * mPrevViewMatrix);
 
 	// Render things
 	renderBackground(mGBufferGenProgram, viewMatrix);
-	renderCube(model, mGBufferGenProgram, viewMatrix);
-	renderSnake(model, mGBufferGenProgram, viewMatrix, snakeBlurWeight);
-	renderObjects(model, mGBufferGenProgram, viewMatrix);
+	const RenderCommandList& commands = mCommandBuilder.waitForList();
+	submitRenderCommands(mGBufferGenProgram, commands.opaque);
 
 	// Rendering transparent objects
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	glEnable(GL_DEPTH_TEST);
+	glState.enable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);
-
-	// S(rc) = value written by fragment shader
-	// D(est) = value already in framebuffer
-	// O(ut) = resulting value
-	//
-	// Blend function for colors: Orgb = Sa*Srgb + (1-Sa)*Drgb
-	// We want the final alpha value in the framebuffer (Fa) to fulfill:
-	// (1-Fa) = "the amount of non-transparent background visible"
-	//
-	// This gives us the following blend equation for alpha values: Oa = Sa + Da - Sa*Da
-	// Rewritten: Oa = Sa + Da*(1-Sa)
-	glEnable(GL_BLEND);
+	glState.enable(GL_BLEND);
 	glBlendEquation(GL_FUNC_ADD);
-	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
-
-	glEnable(GL_CULL_FACE);
-
-	glUseProgram(mTransparencyProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, mTransparencyFB.fbo());
-	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-	glClear(GL_COLOR_BUFFER_BIT);
-
-	gl::setUniform(mTransparencyProgram, "uProjMatrix", projMatrix);
-	gl::setUniform(mTransparencyProgram, "uViewMatrix", viewMatrix);
-	stupidSetUniformMaterials(mTransparencyProgram, "uMaterials");
-	gl::setUniform(mTransparencyProgram, "uAmbientLight", mAmbientLight);
-	
-	renderSnakeProjection(model, mTransparencyProgram, viewMatrix, viewFrustum.pos());
-	renderTransparentCube(model, mTransparencyProgram, viewMatrix, viewFrustum.pos());
+	glState.enable(GL_CULL_FACE);
+
+	// Shares the depth buffer of the GBuffer, detached again before being released to the pool
+	Framebuffer& transparencyFB = pool.acquire(mTransparencyDesc);
+	transparencyFB.attachExternalDepthBuffer(gbuffer.depthBuffer());
+
+	if (mOrderIndependentTransparency) {
+		// Weighted blended order independent transparency
+		//
+		// Texture 0 rgb accumulates the weighted premultiplied colors: Orgb = Srgb + Drgb
+		// Texture 1 accumulates the weights: Or = Sr + Dr
+		// Texture 0 alpha is the product of (1-Sa) of all fragments, i.e. the revealage: Oa = Da*(1-Sa)
+		//
+		// Separate blend functions per draw buffer need GL 4.0, so the revealage is packed into
+		// the alpha of the accumulation texture and the weights get a texture of their own.
+		glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+		glDepthMask(GL_FALSE);
+
+		glState.useProgram(mTransparencyOITProgram.handle());
+		glState.bindFramebuffer(transparencyFB.fbo());
+		const float accumulationClear[] = {0.0f, 0.0f, 0.0f, 1.0f};
+		const float weightClear[] = {0.0f, 0.0f, 0.0f, 0.0f};
+		glClearBufferfv(GL_COLOR, 0, accumulationClear);
+		glClearBufferfv(GL_COLOR, 1, weightClear);
+
+		gl::setUniform(mTransparencyOITProgram, "uProjMatrix", projMatrix);
+		gl::setUniform(mTransparencyOITProgram, "uViewMatrix", viewMatrix);
+		gl::setUniform(mTransparencyOITProgram, "uAmbientLight", mAmbientLight);
+
+		// Order doesn't matter, so every mesh is a single instanced draw call
+		submitRenderCommandsInstanced(mInstanceBuffer, commands.transparent);
+
+		glDepthMask(GL_TRUE);
+	} else {
+		// S(rc) = value written by fragment shader
+		// D(est) = value already in framebuffer
+		// O(ut) = resulting value
+		//
+		// Blend function for colors: Orgb = Sa*Srgb + (1-Sa)*Drgb
+		// We want the final alpha value in the framebuffer (Fa) to fulfill:
+		// (1-Fa) = "the amount of non-transparent background visible"
+		//
+		// This gives us the following blend equation for alpha values: Oa = Sa + Da - Sa*Da
+		// Rewritten: Oa = Sa + Da*(1-Sa)
+		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
+
+		glState.useProgram(mTransparencyProgram.handle());
+		glState.bindFramebuffer(transparencyFB.fbo());
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		gl::setUniform(mTransparencyProgram, "uProjMatrix", projMatrix);
+		gl::setUniform(mTransparencyProgram, "uViewMatrix", viewMatrix);
+		gl::setUniform(mTransparencyProgram, "uAmbientLight", mAmbientLight);
+
+		renderSnakeProjection(model, mTransparencyProgram, viewMatrix, viewFrustum.pos());
+		renderTransparentCube(model, mTransparencyProgram, viewMatrix, viewFrustum.pos());
+	}
 
 
 	// Emissive texture & blur
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
-	glEnable(GL_CULL_FACE);
+	glState.disable(GL_DEPTH_TEST);
+	glState.disable(GL_BLEND);
+	glState.enable(GL_CULL_FACE);
 
-	glUseProgram(mEmissiveGenProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, mEmissiveFB.fbo());
-	glViewport(0, 0, mEmissiveFB.width(), mEmissiveFB.height());
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT);
+	Framebuffer& emissiveFB = pool.acquire(mEmissiveDesc);
 
-	gl::setUniform(mEmissiveGenProgram, "uInvProjMatrix", invProjMatrix);
-	//gl::setUniform(mEmissiveGenProgram, "uFarPlaneDist", viewFrustum.far());
+	if (!mFusedEmissive) {
+		glState.useProgram(mEmissiveGenProgram.handle());
+		glState.bindFramebuffer(emissiveFB.fbo());
+		glState.viewport(emissiveRes);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, mGBuffer.texture(GBUFFER_MATERIAL_INDEX));
-	gl::setUniform(mEmissiveGenProgram, "uMaterialIdTexture", 0);	
+		gl::setUniform(mEmissiveGenProgram, "uInvProjMatrix", invProjMatrix);
+		gl::setUniform(mEmissiveGenProgram, "uUVScale", uvScale);
+		//gl::setUniform(mEmissiveGenProgram, "uFarPlaneDist", viewFrustum.far());
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, mGBuffer.texture(GBUFFER_BLUR_WEIGHTS_INDEX));
-	gl::setUniform(mEmissiveGenProgram, "uBlurWeightsTexture", 1);
+		glState.bindTexture(0, gbuffer.texture(GBUFFER_MATERIAL_INDEX));
+		gl::setUniform(mEmissiveGenProgram, "uMaterialIdTexture", 0);	
 
-	stupidSetUniformMaterials(mEmissiveGenProgram, "uMaterials");
+		glState.bindTexture(1, gbuffer.texture(GBUFFER_BLUR_WEIGHTS_INDEX));
+		gl::setUniform(mEmissiveGenProgram, "uBlurWeightsTexture", 1);
 
-	mPostProcessQuad.render();
+		mPostProcessQuad.render();
+	}
 	
 	const float blurRadiusFactor = 0.03f;
-	int blurRadius = std::round(mEmissiveFB.height() * blurRadiusFactor);
+	int blurRadius = std::round(emissiveRes.y * blurRadiusFactor);
 	blurRadius = std::max(blurRadius, 2);
 	blurRadius = ((blurRadius % 2) != 0) ? blurRadius + 1 : blurRadius;
 
-	if (mGaussianBlur.setBlurParams(blurRadius, blurRadius*0.75f, true)) {
-		/*char buffer[256];
-		std::cout << "Updated gaussian blur samples (radius = " << mGaussianBlur.radius()
-		          << ", sigma = " << mGaussianBlur.sigma() << "):\n";
-		for (int i = 0; i < mGaussianBlur.radius(); ++i) {
-			std::snprintf(buffer, sizeof(buffer), "%i: %.5f\n", i, mGaussianBlur.samples()[i]);
-			std::cout << buffer;
-		}*/
+	// Both blurs read the fused emissive texture at full resolution and downsample it themselves
+	const uint32_t emissiveSrcTex = mFusedEmissive ? gbuffer.texture(GBUFFER_EMISSIVE_INDEX) : emissiveFB.texture(0);
+	if (mBlurAlgorithm == 1) {
+		mDualFilterBlur.setRadius(blurRadius);
+		if (mFusedEmissive) mDualFilterBlur.applyDownsampling(emissiveFB.fbo(), emissiveSrcTex, uvScale, emissiveRes);
+		else mDualFilterBlur.apply(emissiveFB.fbo(), emissiveSrcTex, emissiveFB.dimensions(), emissiveRes);
+	} else {
+		if (mGaussianBlur.setBlurParams(blurRadius, blurRadius*0.75f, true)) {
+			/*char buffer[256];
+			std::cout << "Updated gaussian blur samples (radius = " << mGaussianBlur.radius()
+			          << ", sigma = " << mGaussianBlur.sigma() << "):\n";
+			for (int i = 0; i < mGaussianBlur.radius(); ++i) {
+				std::snprintf(buffer, sizeof(buffer), "%i: %.5f\n", i, mGaussianBlur.samples()[i]);
+				std::cout << buffer;
+			}*/
+		}
+		if (mFusedEmissive) mGaussianBlur.applyDownsampling(emissiveFB.fbo(), emissiveSrcTex, uvScale, emissiveRes);
+		else mGaussianBlur.apply(emissiveFB.fbo(), emissiveSrcTex, emissiveFB.dimensions(), emissiveRes);
 	}
-	mGaussianBlur.apply(mEmissiveFB.fbo(), mEmissiveFB.texture(0), mEmissiveFB.dimensions());
 
 	// Spotlights (Shadow Map + Shading + Lightshafts)
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
+	Framebuffer& spotlightShadingFB = pool.acquire(mSpotlightShadingDesc);
+
 	// Binding textures (textures may not be bound in loop)
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, mGBuffer.texture(GBUFFER_LINEAR_DEPTH_INDEX));
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, mGBuffer.texture(GBUFFER_NORMAL_INDEX));
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, mGBuffer.texture(GBUFFER_MATERIAL_INDEX));
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, mSpotlightShadingFB.texture(0));
-	//glActiveTexture(GL_TEXTURE4);
-	//glBindTexture(GL_TEXTURE_2D, mLightShaftsFB.texture(0));
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, mShadowMapHighRes.depthTexture());
+	glState.bindTexture(0, gbuffer.texture(GBUFFER_LINEAR_DEPTH_INDEX));
+	glState.bindTexture(1, gbuffer.texture(GBUFFER_NORMAL_INDEX));
+	glState.bindTexture(2, gbuffer.texture(GBUFFER_MATERIAL_INDEX));
+	glState.bindTexture(3, spotlightShadingFB.texture(0));
+	glState.bindTexture(5, mShadowMapHighRes.depthTexture());
 	//glActiveTexture(GL_TEXTURE6);
 	//glBindTexture(GL_TEXTURE_2D, mShadowMapLowRes.depthTexture());
 
 	
-	glUseProgram(mSpotlightShadingProgram.handle());
+	glState.useProgram(mSpotlightShadingProgram.handle());
 	
 	// Set common Spotlight shading uniforms
 	gl::setUniform(mSpotlightShadingProgram, "uInvProjMatrix", invProjMatrix);
 	gl::setUniform(mSpotlightShadingProgram, "uFarPlaneDist", viewFrustum.far());
+	gl::setUniform(mSpotlightShadingProgram, "uUVScale", uvScale);
 	gl::setUniform(mSpotlightShadingProgram, "uLinearDepthTexture", 0);
 	gl::setUniform(mSpotlightShadingProgram, "uNormalTexture", 1);
 	gl::setUniform(mSpotlightShadingProgram, "uMaterialIdTexture", 2);
 	gl::setUniform(mSpotlightShadingProgram, "uShadowMap", 5);
-	stupidSetUniformMaterials(mSpotlightShadingProgram, "uMaterials");
 	// Clear Spotlight shading texture
-	glBindFramebuffer(GL_FRAMEBUFFER, mSpotlightShadingFB.fbo());
-	glViewport(0, 0, mSpotlightShadingFB.width(), mSpotlightShadingFB.height());
+	glState.bindFramebuffer(spotlightShadingFB.fbo());
+	glState.viewport(spotlightRes);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 	
-	glUseProgram(mLightShaftsProgram.handle());
-	
-	// Set common volumetric shadows uniforms
-	gl::setUniform(mLightShaftsProgram, "uInvProjMatrix", invProjMatrix);
-	gl::setUniform(mLightShaftsProgram, "uFarPlaneDist", viewFrustum.far());
-	gl::setUniform(mLightShaftsProgram, "uLinearDepthTexture", 0);
-	gl::setUniform(mLightShaftsProgram, "uShadowMap", 6);
-	
-	// Clear volumetric shadows texture
-	/*glBindFramebuffer(GL_FRAMEBUFFER, mLightShaftsFB.fbo());
-	glViewport(0, 0, mLightShaftsFB.width(), mLightShaftsFB.height());
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT);*/
+	// Light shafts are ray marched at low resolution with few samples per pixel, the interleaved
+	// sample offsets are then accumulated over time by the resolve pass below.
+	Framebuffer* lightShaftsFB = nullptr;
+	if (mLightShafts) {
+		lightShaftsFB = &pool.acquire(mLightShaftsDesc);
+		mLightShaftsFrameIndex = (mLightShaftsFrameIndex + 1) % 64;
+
+		glState.useProgram(mLightShaftsProgram.handle());
+
+		// Set common volumetric shadows uniforms
+		gl::setUniform(mLightShaftsProgram, "uInvProjMatrix", invProjMatrix);
+		gl::setUniform(mLightShaftsProgram, "uFarPlaneDist", viewFrustum.far());
+		gl::setUniform(mLightShaftsProgram, "uUVScale", uvScale);
+		gl::setUniform(mLightShaftsProgram, "uLinearDepthTexture", 0);
+		gl::setUniform(mLightShaftsProgram, "uShadowMap", 5);
+		gl::setUniform(mLightShaftsProgram, "uFrameIndex", mLightShaftsFrameIndex);
+
+		// Clear volumetric shadows texture
+		glState.bindFramebuffer(lightShaftsFB->fbo());
+		glState.viewport(lightShaftsRes);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
 
 	
 
-	glDisable(GL_BLEND);
+	glState.disable(GL_BLEND);
 
 	for (size_t i = 0; i < mSpotlights.size(); ++i) {
 		auto& spotlight = mSpotlights[i];
 		const auto& lightFrustum = spotlight.viewFrustum();
 
-		glUseProgram(mShadowMapProgram.handle());
+		glState.useProgram(mShadowMapProgram.handle());
 
-		glEnable(GL_DEPTH_TEST);
+		glState.enable(GL_DEPTH_TEST);
 		glDepthFunc(GL_LESS);
 		//glEnable(GL_POLYGON_OFFSET_FILL);
 		//glPolygonOffset(5.0f, 25.0f);
-		glEnable(GL_CULL_FACE);
+		glState.enable(GL_CULL_FACE);
 		glCullFace(GL_FRONT);
 
 		gl::setUniform(mShadowMapProgram, "uViewProjMatrix", lightFrustum.projMatrix() * lightFrustum.viewMatrix());
 
 		// Set high res shadow map fbo, clear it and render it
-		glBindFramebuffer(GL_FRAMEBUFFER, mShadowMapHighRes.fbo());
-		glViewport(0, 0, mShadowMapHighRes.width(), mShadowMapHighRes.height());
-		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-		glClearDepth(1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		renderCube(model, mShadowMapProgram, viewMatrix);
-		renderSnake(model, mShadowMapProgram, viewMatrix, snakeBlurWeight);
-		renderObjects(model, mShadowMapProgram, viewMatrix);
-		renderOpaqueSnakeProjection(model, mShadowMapProgram, lightFrustum.viewMatrix());
-
-		// Set low res shadow map fbo, clear it and render it
-		// TODO: Might want to downscale high res shadow map for better quality low res shadow map?
-		/*glBindFramebuffer(GL_FRAMEBUFFER, mShadowMapLowRes.fbo());
-		glViewport(0, 0, mShadowMapLowRes.width(), mShadowMapLowRes.height());
+		glState.bindFramebuffer(mShadowMapHighRes.fbo());
+		glState.viewport(mShadowMapHighRes.dimensions());
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 		glClearDepth(1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		renderOpaque(model, mShadowMapProgram, lightFrustum.viewMatrix());
-		renderOpaqueSnakeProjection(model, mShadowMapProgram, lightFrustum.viewMatrix());*/
+		submitRenderCommands(mShadowMapProgram, commands.opaque);
+		submitRenderCommands(mShadowMapProgram, commands.shadowOnly);
 
 		//glDisable(GL_POLYGON_OFFSET_FILL);
 		glCullFace(GL_BACK);
 		
-		glDisable(GL_DEPTH_TEST);
-		glDisable(GL_CULL_FACE);
+		glState.disable(GL_DEPTH_TEST);
+		glState.disable(GL_CULL_FACE);
 
 
 		// Spotlight & light shafts stencil buffer
-		glUseProgram(mStencilLightProgram.handle());
+		glState.useProgram(mStencilLightProgram.handle());
 		
-		glDisable(GL_CULL_FACE);
-		glEnable(GL_STENCIL_TEST);
+		glState.disable(GL_CULL_FACE);
+		glState.enable(GL_STENCIL_TEST);
 		glStencilFunc(GL_ALWAYS, 0, 0xFF);
 		glStencilOp(GL_INCR, GL_INCR, GL_INCR);
 		
 		gl::setUniform(mStencilLightProgram, "uViewProjMatrix", projMatrix * viewMatrix);
 		gl::setUniform(mStencilLightProgram, "uModelMatrix", spotlight.viewFrustumTransform());
 
-		glBindFramebuffer(GL_FRAMEBUFFER, mSpotlightShadingFB.fbo());
-		glViewport(0, 0, mSpotlightShadingFB.width(), mSpotlightShadingFB.height());
+		glState.bindFramebuffer(spotlightShadingFB.fbo());
+		glState.viewport(spotlightRes);
 		glClearStencil(0);
 		glClear(GL_STENCIL_BUFFER_BIT);
 
 		spotlight.renderViewFrustum();
 
-		/*glBindFramebuffer(GL_FRAMEBUFFER, mLightShaftsFB.fbo());
-		glViewport(0, 0, mLightShaftsFB.width(), mLightShaftsFB.height());
-		glClearStencil(0);
-		glClear(GL_STENCIL_BUFFER_BIT);
+		if (lightShaftsFB != nullptr) {
+			glState.bindFramebuffer(lightShaftsFB->fbo());
+			glState.viewport(lightShaftsRes);
+			glClearStencil(0);
+			glClear(GL_STENCIL_BUFFER_BIT);
 
-		spotlight.renderViewFrustum();*/
+			spotlight.renderViewFrustum();
+		}
 
 
-		glEnable(GL_CULL_FACE);
+		glState.enable(GL_CULL_FACE);
 		glStencilFunc(GL_NOTEQUAL, 0, 0xFF); // Pass stencil test if not 0.
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 
-		glEnable(GL_BLEND);
+		glState.enable(GL_BLEND);
 		glBlendEquation(GL_FUNC_ADD);
 		glBlendFunc(GL_ONE, GL_ONE);
 
 
 		// Spotlight shading 
-		glUseProgram(mSpotlightShadingProgram.handle());
-		glBindFramebuffer(GL_FRAMEBUFFER, mSpotlightShadingFB.fbo());
-		glViewport(0, 0, mSpotlightShadingFB.width(), mSpotlightShadingFB.height());
+		glState.useProgram(mSpotlightShadingProgram.handle());
+		glState.bindFramebuffer(spotlightShadingFB.fbo());
+		glState.viewport(spotlightRes);
 
 		stupidSetSpotlightUniform(mSpotlightShadingProgram, "uSpotlight", spotlight, viewMatrix, invViewMatrix);
 		
@@ -452,62 +609,109 @@ void ModernRenderer::render(const Model& model, const Camera& cam, vec2 drawable
 
 
 		// Light shafts
-		/*glUseProgram(mLightShaftsProgram.handle());
-		glBindFramebuffer(GL_FRAMEBUFFER, mLightShaftsFB.fbo());
-		glViewport(0, 0, mLightShaftsFB.width(), mLightShaftsFB.height());
+		if (lightShaftsFB != nullptr) {
+			glState.useProgram(mLightShaftsProgram.handle());
+			glState.bindFramebuffer(lightShaftsFB->fbo());
+			glState.viewport(lightShaftsRes);
 
-		stupidSetSpotlightUniform(mLightShaftsProgram, "uSpotlight", spotlight, viewMatrix, invViewMatrix);
+			stupidSetSpotlightUniform(mLightShaftsProgram, "uSpotlight", spotlight, viewMatrix, invViewMatrix);
 
-		mPostProcessQuad.render();*/
+			mPostProcessQuad.render();
+		}
 		
 
-		glDisable(GL_STENCIL_TEST);
+		glState.disable(GL_STENCIL_TEST);
+	}
+
+	// Light shafts temporal resolve
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	if (lightShaftsFB != nullptr) {
+		glState.disable(GL_BLEND);
+		glState.disable(GL_CULL_FACE);
+
+		const Framebuffer& history = mLightShaftsHistory[mLightShaftsHistoryIndex];
+		const Framebuffer& prevHistory = mLightShaftsHistory[1 - mLightShaftsHistoryIndex];
+
+		glState.useProgram(mLightShaftsResolveProgram.handle());
+		glState.bindFramebuffer(history.fbo());
+		glState.viewport(lightShaftsRes);
+
+		gl::setUniform(mLightShaftsResolveProgram, "uInvProjMatrix", invProjMatrix);
+		gl::setUniform(mLightShaftsResolveProgram, "uFarPlaneDist", viewFrustum.far());
+		gl::setUniform(mLightShaftsResolveProgram, "uUVScale", uvScale);
+		gl::setUniform(mLightShaftsResolveProgram, "uCurrToPrevViewMatrix", mPrevViewMatrix * invViewMatrix);
+		gl::setUniform(mLightShaftsResolveProgram, "uPrevProjMatrix", mPrevProjMatrix);
+		gl::setUniform(mLightShaftsResolveProgram, "uLightShaftsRectDim", toFloat(lightShaftsRes));
+		gl::setUniform(mLightShaftsResolveProgram, "uHistoryUVScale", mPrevLightShaftsUVScale);
+		gl::setUniform(mLightShaftsResolveProgram, "uHistoryValid", mLightShaftsHistoryValid ? 1 : 0);
+
+		glState.bindTexture(0, gbuffer.texture(GBUFFER_LINEAR_DEPTH_INDEX));
+		gl::setUniform(mLightShaftsResolveProgram, "uLinearDepthTexture", 0);
+
+		glState.bindTexture(1, lightShaftsFB->texture(0));
+		gl::setUniform(mLightShaftsResolveProgram, "uLightShaftsTexture", 1);
+
+		glState.bindTexture(2, prevHistory.texture(0));
+		gl::setUniform(mLightShaftsResolveProgram, "uHistoryTexture", 2);
+
+		mPostProcessQuad.render();
+		pool.release(*lightShaftsFB);
+
+		mPrevLightShaftsUVScale = lightShaftsUVScale;
+		mLightShaftsHistoryValid = true;
 	}
 
 
 	// Global shading
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
-	glDisable(GL_CULL_FACE);
+	glState.disable(GL_DEPTH_TEST);
+	glState.disable(GL_BLEND);
+	glState.disable(GL_CULL_FACE);
+
+	Framebuffer& globalShadingFB = pool.acquire(mGlobalShadingDesc);
 
-	glUseProgram(mGlobalShadingProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, mGlobalShadingFB.fbo());
-	glViewport(0, 0, mGlobalShadingFB.width(), mGlobalShadingFB.height());
+	glState.useProgram(mGlobalShadingProgram.handle());
+	glState.bindFramebuffer(globalShadingFB.fbo());
+	glState.viewport(renderRes);
 
-	stupidSetUniformMaterials(mGlobalShadingProgram, "uMaterials");
 	gl::setUniform(mGlobalShadingProgram, "uAmbientLight", mAmbientLight);
 
 	gl::setUniform(mGlobalShadingProgram, "uInvProjMatrix", invProjMatrix);
 	gl::setUniform(mGlobalShadingProgram, "uFarPlaneDist", viewFrustum.far());
+	gl::setUniform(mGlobalShadingProgram, "uUVScale", uvScale);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, mGBuffer.texture(GBUFFER_LINEAR_DEPTH_INDEX));
+	glState.bindTexture(0, gbuffer.texture(GBUFFER_LINEAR_DEPTH_INDEX));
 	gl::setUniform(mGlobalShadingProgram, "uLinearDepthTexture", 0);
 
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, mGBuffer.texture(GBUFFER_NORMAL_INDEX));
+	glState.bindTexture(1, gbuffer.texture(GBUFFER_NORMAL_INDEX));
 	gl::setUniform(mGlobalShadingProgram, "uNormalTexture", 1);
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, mGBuffer.texture(GBUFFER_MATERIAL_INDEX));
+	glState.bindTexture(2, gbuffer.texture(GBUFFER_MATERIAL_INDEX));
 	gl::setUniform(mGlobalShadingProgram, "uMaterialIdTexture", 2);
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, mTransparencyFB.texture(0));
+	glState.bindTexture(3, transparencyFB.texture(0));
 	gl::setUniform(mGlobalShadingProgram, "uTransparencyTexture", 3);
+	gl::setUniform(mGlobalShadingProgram, "uOrderIndependentTransparency", mOrderIndependentTransparency ? 1 : 0);
+	if (mOrderIndependentTransparency) {
+		glState.bindTexture(7, transparencyFB.texture(1));
+		gl::setUniform(mGlobalShadingProgram, "uTransparencyWeightTexture", 7);
+	}
 
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, mSpotlightShadingFB.texture(0));
+	glState.bindTexture(4, spotlightShadingFB.texture(0));
 	gl::setUniform(mGlobalShadingProgram, "uSpotlightShadingTexture", 4);
 
-	/*glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, mLightShaftsFB.texture(0));
-	gl::setUniform(mGlobalShadingProgram, "uLightShaftsTexture", 5);*/
+	gl::setUniform(mGlobalShadingProgram, "uLightShafts", mLightShafts ? 1 : 0);
+	if (mLightShafts) {
+		glState.bindTexture(5, mLightShaftsHistory[mLightShaftsHistoryIndex].texture(0));
+		gl::setUniform(mGlobalShadingProgram, "uLightShaftsTexture", 5);
+		gl::setUniform(mGlobalShadingProgram, "uLightShaftsUVFactor", lightShaftsUVScale / uvScale);
+		gl::setUniform(mGlobalShadingProgram, "uLightShaftsRectDim", toFloat(lightShaftsRes));
+		mLightShaftsHistoryIndex = 1 - mLightShaftsHistoryIndex;
+	}
 
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, mEmissiveFB.texture(0));
+	glState.bindTexture(6, emissiveFB.texture(0));
 	gl::setUniform(mGlobalShadingProgram, "uBlurredEmissiveTexture", 6);
 
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -515,17 +719,50 @@ void ModernRenderer::render(const Model& model, const Camera& cam, vec2 drawable
 
 	mPostProcessQuad.render();
 
+	// Everything except the final image (and the GBuffer if upsampling temporally) is dead at
+	// this point
+	transparencyFB.attachExternalDepthBuffer(0);
+	pool.release(transparencyFB);
+	pool.release(emissiveFB);
+	pool.release(spotlightShadingFB);
+
 
 	// Scale and draw resulting image to screen
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, drawableDim.x, drawableDim.y);
-	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	const vec2i drawableRes{(int)drawableDim.x, (int)drawableDim.y};
+	if (mTemporalUpsampling) {
+		const Framebuffer& upsampled = mTemporalUpsampler.upsample(globalShadingFB.texture(0),
+		    gbuffer.texture(GBUFFER_VELOCITY_INDEX), gbuffer.texture(GBUFFER_LINEAR_DEPTH_INDEX),
+		    globalShadingFB.dimensions(), renderRes, drawableRes);
+		pool.release(gbuffer);
+		pool.release(globalShadingFB);
+
+		// Already at output resolution, so just copy it. Only the read framebuffer is changed
+		// behind the state cache's back, and it is restored afterwards.
+		glState.bindFramebuffer(0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, upsampled.fbo());
+		glBlitFramebuffer(0, 0, drawableRes.x, drawableRes.y, 0, 0, drawableRes.x, drawableRes.y,
+		                  GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	} else {
+		pool.release(gbuffer);
+
+		glState.bindFramebuffer(0);
+		glState.viewport(0, 0, drawableDim.x, drawableDim.y);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		mScaler.changeScalingAlgorithm(static_cast<gl::ScalingAlgorithm>(cfg.gc.scalingAlgorithm));
+		mScaler.scale(0, AABB2D{drawableDim/2.0f, drawableDim}, globalShadingFB.texture(0),
+		              globalShadingFB.dimensionsFloat(), vec2{(float)renderRes.x, (float)renderRes.y});
+		pool.release(globalShadingFB);
+	}
+
+	mPrevViewMatrix = viewMatrix;
+	mPrevProjMatrix = unjitteredProjMatrix;
 
-	mScaler.changeScalingAlgorithm(static_cast<gl::ScalingAlgorithm>(cfg.gc.scalingAlgorithm));
-	mScaler.scale(0, drawableDim, mGlobalShadingFB.texture(0), mGlobalShadingFB.dimensionsFloat());
+	mDynamicRes.endGpuTimer();
 }
 
 } // namespace s3
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <vector>
 
+#include <sfz/gl/DualFilterBlur.hpp>
 #include <sfz/gl/Framebuffer.hpp>
 #include <sfz/gl/GaussianBlur.hpp>
 #include <sfz/gl/Program.hpp>
@@ -14,6 +15,10 @@
 
 #include "gamelogic/Model.hpp"
 #include "rendering/Camera.hpp"
+#include "rendering/DynamicResolution.hpp"
+#include "rendering/Materials.hpp"
+#include "rendering/RenderCommands.hpp"
+#include "rendering/TemporalUpsampler.hpp"
 
 namespace s3 {
 
@@ -45,21 +50,48 @@ public:
 
 	void render(const Model& model, const Camera& cam, vec2 drawableDim, float delta) noexcept;
 
+	inline const DynamicResolution& dynamicResolution() const noexcept { return mDynamicRes; }
+
 private:
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 	gl::PostProcessQuad mPostProcessQuad;
 	Program mGBufferGenProgram, mTransparencyProgram, mEmissiveGenProgram, mShadowMapProgram, mStencilLightProgram,
-	        mSpotlightShadingProgram, mLightShaftsProgram, mGlobalShadingProgram;
+	        mSpotlightShadingProgram, mLightShaftsProgram, mLightShaftsResolveProgram, mGlobalShadingProgram,
+	        mTransparencyOITProgram;
+	MaterialsBuffer mMaterialsBuffer;
+	InstanceBuffer mInstanceBuffer;
 	gl::Scaler mScaler;
-	gl::GaussianBlur mGaussianBlur;
-	Framebuffer mGBuffer, mTransparencyFB, mEmissiveFB, mSpotlightShadingFB/*, mLightShaftsFB*/, mGlobalShadingFB;
+	gl::GaussianBlur mGaussianBlur; // Only one of the blurs is initialized, see blurAlgorithm
+	gl::DualFilterBlur mDualFilterBlur;
+	vec2i mInternalRes{-1}, mBlurRes{-1}, mSpotlightRes{-1}, mLightShaftsRes{-1};
+	bool mFusedEmissive = false, mLightShafts = false, mTemporalUpsampling = false, mOrderIndependentTransparency = false;
+	int32_t mBlurAlgorithm = -1;
+	FramebufferBuilder mGBufferDesc, mTransparencyDesc, mEmissiveDesc, mSpotlightShadingDesc, mLightShaftsDesc,
+	                   mGlobalShadingDesc; // Acquired from the RenderTargetPool each frame
 	vec3 mAmbientLight;
 	vector<Spotlight> mSpotlights;
 	Framebuffer mShadowMapHighRes/*, mShadowMapLowRes*/;
 
+	// Matrices of the previous frame (without jitter), used to reproject temporal effects
+	mat4 mPrevViewMatrix = sfz::identityMatrix4<float>();
+	mat4 mPrevProjMatrix = sfz::identityMatrix4<float>();
+
+	// Light shafts are accumulated over several frames, the resolved result of the previous frame
+	// is kept to be reprojected.
+	Framebuffer mLightShaftsHistory[2];
+	uint32_t mLightShaftsHistoryIndex = 0;
+	bool mLightShaftsHistoryValid = false;
+	vec2 mPrevLightShaftsUVScale{1.0f};
+	int32_t mLightShaftsFrameIndex = 0;
+
+	TemporalUpsampler mTemporalUpsampler;
+
 	float mTime = 0.0f;
+	DynamicResolution mDynamicRes;
+
+	RenderCommandBuilder mCommandBuilder;
 };
 
 } // namespace s3
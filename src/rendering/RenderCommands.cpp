@@ -0,0 +1,377 @@
+#include "rendering/RenderCommands.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <sfz/gl/OpenGL.hpp>
+
+#include "GameLogic.hpp"
+#include "rendering/Assets.hpp"
+#include "rendering/Materials.hpp"
+#include "rendering/RenderingUtils.hpp"
+
+namespace s3 {
+
+// Statics
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static mat4 tileTransform(const Model& model, const SnakeTile* tilePtr, Position tilePos,
+                          const mat4& tileScaling) noexcept
+{
+	mat4 transform = tileSpaceRotation(tilePos.side) * tileScaling;
+	transform *= sfz::yRotationMatrix4(getTileAngleRad(tilePos.side, tilePtr));
+	sfz::translation(transform, tilePosToVector(model, tilePos));
+	return transform;
+}
+
+static void addCommand(vector<RenderCommand>& commands, SimpleModel* mesh, uint32_t materialId,
+                       float blurWeight, const mat4& modelMatrix, const mat4& prevModelMatrix,
+                       const mat4& normalMatrix) noexcept
+{
+	RenderCommand cmd;
+	cmd.mesh = mesh;
+	cmd.materialId = materialId;
+	cmd.blurWeight = blurWeight;
+	cmd.modelMatrix = modelMatrix;
+	cmd.prevModelMatrix = prevModelMatrix;
+	cmd.normalMatrix = normalMatrix;
+	commands.push_back(cmd);
+}
+
+// Tiles never move, the snake is animated by switching between meshes depending on progress
+static void addCommand(vector<RenderCommand>& commands, SimpleModel* mesh, uint32_t materialId,
+                       float blurWeight, const mat4& modelMatrix, const mat4& normalMatrix) noexcept
+{
+	addCommand(commands, mesh, materialId, blurWeight, modelMatrix, modelMatrix, normalMatrix);
+}
+
+static void addSnakeTileCommands(vector<RenderCommand>& commands, const Model& model,
+                                 const SnakeTile* tilePtr, Position tilePos, const mat4& tileScaling,
+                                 const mat4& viewMatrix, float blurWeight) noexcept
+{
+	Assets& assets = Assets::INSTANCE();
+
+	const mat4 transform = tileTransform(model, tilePtr, tilePos, tileScaling);
+	const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
+
+	// Dive & ascend models
+	if (isDive(tilePos.side, tilePtr->to)) {
+		addCommand(commands, &assets.DIVE_MODEL, MATERIAL_ID_TILE_DIVE_ASCEND, blurWeight,
+		           transform, normalMatrix);
+	} else if (isAscend(tilePos.side, tilePtr->from) &&
+	           tilePtr->type != TileType::TAIL && tilePtr->type != TileType::TAIL_DIGESTING) {
+		addCommand(commands, &assets.ASCEND_MODEL, MATERIAL_ID_TILE_DIVE_ASCEND, blurWeight,
+		           transform, normalMatrix);
+	}
+
+	// Tile model
+	SimpleModel& tileModel = getTileModel(tilePtr, tilePos.side, model.progress(), model.isGameOver());
+	addCommand(commands, &tileModel, tileMaterialId(tilePtr), blurWeight, transform, normalMatrix);
+}
+
+static void addProjectionCommand(vector<RenderCommand>& commands, const Model& model,
+                                 const SnakeTile* tilePtr, Position tilePos, const mat4& tileScaling,
+                                 const mat4& viewMatrix) noexcept
+{
+	SimpleModel* projModelPtr = getTileProjectionModelPtr(tilePtr, tilePos.side, model.progress());
+	if (projModelPtr == nullptr) return;
+
+	const mat4 transform = tileTransform(model, tilePtr, tilePos, tileScaling);
+	const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
+	addCommand(commands, projModelPtr, MATERIAL_ID_TILE_PROJECTION, 0.0f, transform, normalMatrix);
+}
+
+// Objects are animated by the time since they were created, so evaluating these at the time of
+// the previous frame gives their previous transforms
+static mat4 objectPartTransform(const mat4& transform, uint32_t part, float t) noexcept
+{
+	switch (part) {
+	case 0: return transform * sfz::translationMatrix(vec3{0.0f, std::sin(t * 1.2f) * 1.25f, 0.0f});
+	case 1: return transform * sfz::yRotationMatrix4(t * 0.8f);
+	case 2: return transform * sfz::yRotationMatrix4(-t * 1.25f);
+	default: return transform * sfz::yRotationMatrix4(t * 1.1f);
+	}
+}
+
+static mat4 bonusObjectTransform(const mat4& transform, float t) noexcept
+{
+	return transform * sfz::zRotationMatrix4(t * 1.6f)
+	                 * sfz::yRotationMatrix4(t * 1.1f)
+	                 * sfz::xRotationMatrix4(t * 0.75f);
+}
+
+static bool meshOrder(const RenderCommand& lhs, const RenderCommand& rhs) noexcept
+{
+	return lhs.mesh < rhs.mesh;
+}
+
+static bool commandOrder(const RenderCommand& lhs, const RenderCommand& rhs) noexcept
+{
+	if (lhs.mesh != rhs.mesh) return lhs.mesh < rhs.mesh;
+	if (lhs.materialId != rhs.materialId) return lhs.materialId < rhs.materialId;
+	return lhs.blurWeight < rhs.blurWeight;
+}
+
+// RenderCommandList: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void RenderCommandList::clear() noexcept
+{
+	opaque.clear();
+	shadowOnly.clear();
+	transparent.clear();
+}
+
+// Render command functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void buildRenderCommands(const Model& model, const mat4& viewMatrix, float snakeBlurWeight,
+                         float delta, RenderCommandList& list) noexcept
+{
+	Assets& assets = Assets::INSTANCE();
+	list.clear();
+
+	const mat4 tileScaling = sfz::scalingMatrix4(1.0f / (16.0f * (float)model.config().gridWidth));
+
+	for (size_t i = 0; i < model.numTiles(); ++i) {
+		const SnakeTile* tilePtr = model.tilePtr(i);
+		Position tilePos = model.tilePosition(tilePtr);
+
+		// Tile decoration
+		const mat4 transform = tileTransform(model, tilePtr, tilePos, tileScaling);
+		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
+		addCommand(list.opaque, &assets.TILE_DECORATION_MODEL, tileDecorationMaterialId(tilePtr), 1.0f,
+		           transform, normalMatrix);
+
+		if (!isSnake(tilePtr)) continue;
+		addSnakeTileCommands(list.opaque, model, tilePtr, tilePos, tileScaling, viewMatrix, snakeBlurWeight);
+		addProjectionCommand(list.shadowOnly, model, tilePtr, tilePos, tileScaling, viewMatrix);
+		addProjectionCommand(list.transparent, model, tilePtr, tilePos, tileScaling, viewMatrix);
+	}
+
+	// Dead snake head if game over
+	if (model.isGameOver()) {
+		const SnakeTile* tilePtr = model.deadHeadPtr();
+		Position tilePos = model.deadHeadPos();
+		addSnakeTileCommands(list.opaque, model, tilePtr, tilePos, tileScaling, viewMatrix, snakeBlurWeight);
+		addProjectionCommand(list.shadowOnly, model, tilePtr, tilePos, tileScaling, viewMatrix);
+		addProjectionCommand(list.transparent, model, tilePtr, tilePos, tileScaling, viewMatrix);
+	}
+
+	// Cube sides
+	const mat4 sideScaling = sfz::scalingMatrix4(1.0f / 16.0f);
+	for (uint8_t i = 0; i < 6; ++i) {
+		const Direction side = static_cast<Direction>(i);
+		mat4 transform = tileSpaceRotation(side) * sideScaling;
+		sfz::translation(transform, toVector(side) * 0.5f);
+		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
+		addCommand(list.transparent, &assets.TILE_PROJECTION_MODEL, MATERIAL_ID_CUBE_SIDE, 0.0f,
+		           transform, normalMatrix);
+	}
+
+	// Objects
+	for (const auto& object : model.objects()) {
+		Position tilePos = object.position;
+		const SnakeTile* tilePtr = model.tilePtr(tilePos);
+		const float t = object.timeSinceCreation;
+		const float prevT = std::max(t - delta, 0.0f);
+
+		const mat4 transform = tileTransform(model, tilePtr, tilePos, tileScaling);
+		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
+		const uint32_t materialId = tileMaterialId(tilePtr);
+
+		if (tilePtr->type == TileType::OBJECT) {
+			float blurWeight;
+			if (object.earlyLife > 0) {
+				blurWeight = 2.5f + (0.5f * (1.0f + std::sin(t * model.currentSpeed() * 2.5f))) * 1.5f;
+			} else {
+				blurWeight = 0.5f + (0.5f * (1.0f + std::sin(t * model.currentSpeed() * 2.0f))) * 0.75f;
+			}
+			SimpleModel* parts[] = {&assets.OBJECT_PART1_MODEL, &assets.OBJECT_PART2_MODEL,
+			                        &assets.OBJECT_PART3_MODEL, &assets.OBJECT_PART4_MODEL};
+			for (uint32_t part = 0; part < 4; ++part) {
+				addCommand(list.opaque, parts[part], materialId, blurWeight,
+				           objectPartTransform(transform, part, t),
+				           objectPartTransform(transform, part, prevT), normalMatrix);
+			}
+		} else if (tilePtr->type == TileType::BONUS_OBJECT) {
+			float blurWeight = 3.0f + (0.5f * (1.0f + std::sin(t * model.currentSpeed() * 4.0f))) * 2.5f;
+			addCommand(list.opaque, &assets.BONUS_OBJECT_MODEL, materialId, blurWeight,
+			           bonusObjectTransform(transform, t), bonusObjectTransform(transform, prevT), normalMatrix);
+		} else {
+			sfz_error("Invalid object");
+		}
+	}
+
+	std::sort(list.opaque.begin(), list.opaque.end(), commandOrder);
+	std::sort(list.shadowOnly.begin(), list.shadowOnly.end(), commandOrder);
+	std::sort(list.transparent.begin(), list.transparent.end(), meshOrder);
+}
+
+void submitRenderCommands(const Program& program, const vector<RenderCommand>& commands) noexcept
+{
+	const int modelMatrixLoc = glGetUniformLocation(program.handle(), "uModelMatrix");
+	const int prevModelMatrixLoc = glGetUniformLocation(program.handle(), "uPrevModelMatrix");
+	const int normalMatrixLoc = glGetUniformLocation(program.handle(), "uNormalMatrix");
+	const int materialIdLoc = glGetUniformLocation(program.handle(), "uMaterialId");
+	const int blurWeightLoc = glGetUniformLocation(program.handle(), "uBlurWeight");
+
+	const RenderCommand* prev = nullptr;
+	for (const RenderCommand& cmd : commands) {
+		if (prev == nullptr || prev->materialId != cmd.materialId) {
+			gl::setUniform(materialIdLoc, cmd.materialId);
+		}
+		if (prev == nullptr || prev->blurWeight != cmd.blurWeight) {
+			gl::setUniform(blurWeightLoc, cmd.blurWeight);
+		}
+		gl::setUniform(modelMatrixLoc, cmd.modelMatrix);
+		gl::setUniform(prevModelMatrixLoc, cmd.prevModelMatrix);
+		gl::setUniform(normalMatrixLoc, cmd.normalMatrix);
+		cmd.mesh->render();
+		prev = &cmd;
+	}
+}
+
+void submitRenderCommandsInstanced(InstanceBuffer& buffer, const vector<RenderCommand>& commands) noexcept
+{
+	buffer.bind();
+
+	size_t first = 0;
+	while (first < commands.size()) {
+		size_t last = first + 1;
+		while (last < commands.size() && last - first < MAX_NUM_INSTANCES &&
+		       commands[last].mesh == commands[first].mesh) {
+			++last;
+		}
+
+		const uint32_t numInstances = (uint32_t)(last - first);
+		buffer.upload(commands.data() + first, numInstances);
+		commands[first].mesh->renderInstanced(numInstances);
+		first = last;
+	}
+}
+
+// InstanceBuffer: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+struct Std140Instance final {
+	mat4 modelMatrix;
+	uint32_t materialId;
+	uint32_t padding[3];
+};
+
+static_assert(sizeof(Std140Instance) == 80, "Std140Instance is padded");
+
+InstanceBuffer::InstanceBuffer() noexcept
+{
+	glGenBuffers(1, &mUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, mUBO);
+	glBufferData(GL_UNIFORM_BUFFER, MAX_NUM_INSTANCES * sizeof(Std140Instance), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+InstanceBuffer::~InstanceBuffer() noexcept
+{
+	glDeleteBuffers(1, &mUBO);
+}
+
+// InstanceBuffer: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void InstanceBuffer::upload(const RenderCommand* commands, uint32_t numCommands) noexcept
+{
+	if (numCommands > MAX_NUM_INSTANCES) numCommands = MAX_NUM_INSTANCES;
+
+	Std140Instance buffer[MAX_NUM_INSTANCES];
+	std::memset(buffer, 0, sizeof(buffer));
+	for (uint32_t i = 0; i < numCommands; ++i) {
+		buffer[i].modelMatrix = commands[i].modelMatrix;
+		buffer[i].materialId = commands[i].materialId;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, mUBO);
+	glBufferData(GL_UNIFORM_BUFFER, MAX_NUM_INSTANCES * sizeof(Std140Instance), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, numCommands * sizeof(Std140Instance), buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void InstanceBuffer::bind() const noexcept
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, INSTANCES_BINDING_POINT, mUBO);
+}
+
+// InstanceBuffer: Functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void bindInstancesBlock(const Program& program) noexcept
+{
+	uint32_t blockIndex = glGetUniformBlockIndex(program.handle(), "InstancesBlock");
+	if (blockIndex == GL_INVALID_INDEX) return;
+	glUniformBlockBinding(program.handle(), blockIndex, INSTANCES_BINDING_POINT);
+}
+
+// RenderCommandBuilder: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+RenderCommandBuilder::RenderCommandBuilder() noexcept
+:
+	mThread{&RenderCommandBuilder::workerLoop, this}
+{ }
+
+RenderCommandBuilder::~RenderCommandBuilder() noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock{mMutex};
+		mQuit = true;
+	}
+	mCondVar.notify_all();
+	mThread.join();
+}
+
+// RenderCommandBuilder: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void RenderCommandBuilder::startBuild(const Model& model, const mat4& viewMatrix,
+                                      float snakeBlurWeight, float delta) noexcept
+{
+	{
+		std::unique_lock<std::mutex> lock{mMutex};
+		mCondVar.wait(lock, [this]() { return !mHasWork; });
+		mModelPtr = &model;
+		mViewMatrix = viewMatrix;
+		mSnakeBlurWeight = snakeBlurWeight;
+		mDelta = delta;
+		mHasWork = true;
+	}
+	mCondVar.notify_all();
+}
+
+const RenderCommandList& RenderCommandBuilder::waitForList() noexcept
+{
+	std::unique_lock<std::mutex> lock{mMutex};
+	mCondVar.wait(lock, [this]() { return !mHasWork; });
+	return mList;
+}
+
+// RenderCommandBuilder: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void RenderCommandBuilder::workerLoop() noexcept
+{
+	std::unique_lock<std::mutex> lock{mMutex};
+	while (true) {
+		mCondVar.wait(lock, [this]() { return mHasWork || mQuit; });
+		if (mQuit) return;
+
+		// The main thread only touches the work members while mHasWork is false
+		lock.unlock();
+		buildRenderCommands(*mModelPtr, mViewMatrix, mSnakeBlurWeight, mDelta, mList);
+		lock.lock();
+
+		mHasWork = false;
+		mCondVar.notify_all();
+	}
+}
+
+} // namespace s3
\ No newline at end of file
@@ -0,0 +1,184 @@
+#pragma once
+#ifndef S3_RENDERING_RENDER_COMMANDS_HPP
+#define S3_RENDERING_RENDER_COMMANDS_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sfz/math/Matrix.hpp>
+#include <sfz/gl/Program.hpp>
+#include <sfz/gl/SimpleModel.hpp>
+
+#include "gamelogic/Model.hpp"
+
+namespace s3 {
+
+using gl::Program;
+using gl::SimpleModel;
+using sfz::mat4;
+using std::size_t;
+using std::uint32_t;
+using std::vector;
+
+// RenderCommand struct
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** @brief Everything needed to issue a single draw call of a mesh */
+struct RenderCommand final {
+	SimpleModel* mesh;
+	uint32_t materialId;
+	float blurWeight;
+	mat4 modelMatrix;
+	mat4 prevModelMatrix; // Model matrix of the previous frame, used for motion vectors
+	mat4 normalMatrix; // inverse(transpose(viewMatrix * modelMatrix))
+};
+
+// RenderCommandList struct
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+struct RenderCommandList final {
+	// Cube decorations, snake and objects. Rendered into both the GBuffer and the shadow maps.
+	vector<RenderCommand> opaque;
+
+	// Opaque variants of the snake projections, only rendered into the shadow maps.
+	vector<RenderCommand> shadowOnly;
+
+	// Snake projections and cube sides, unsorted by depth. Only used by the order independent
+	// transparency path, the sorted path renders them directly in back to front order.
+	vector<RenderCommand> transparent;
+
+	void clear() noexcept;
+};
+
+// Render command functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Fills the list with commands for the geometry in the model
+ * Only reads from the model and the (immutable) assets, so it is safe to call from any thread as
+ * long as the model isn't modified at the same time. The opaque and shadow only commands are
+ * sorted by mesh, material and blur weight, the transparent ones only by mesh.
+ * @param delta the time since the previous frame, the animated objects are evaluated this far back
+ *              in time to get their previous model matrices
+ */
+void buildRenderCommands(const Model& model, const mat4& viewMatrix, float snakeBlurWeight,
+                         float delta, RenderCommandList& list) noexcept;
+
+/**
+ * @brief Issues the draw calls for the specified commands using the currently bound program
+ * Uniforms are only updated when they change between consecutive commands. The program needs to
+ * have uModelMatrix, uPrevModelMatrix, uNormalMatrix, uMaterialId and uBlurWeight uniforms, unused
+ * ones are ignored.
+ */
+void submitRenderCommands(const Program& program, const vector<RenderCommand>& commands) noexcept;
+
+// InstanceBuffer class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** The uniform buffer binding point the instances are always bound to. */
+const uint32_t INSTANCES_BINDING_POINT = 1;
+
+/** The size of the uInstances array in the shaders' InstancesBlock. */
+const uint32_t MAX_NUM_INSTANCES = 128;
+
+/**
+ * @brief A uniform buffer containing per instance data for instanced draw calls, in std140 layout
+ * Shaders access the instances through the following uniform block, indexed by gl_InstanceID:
+ * struct Instance { mat4 modelMatrix; uvec4 materialId; };
+ * layout(std140) uniform InstancesBlock { Instance uInstances[128]; };
+ * Each program using the block needs to call bindInstancesBlock() once after it has been linked.
+ */
+class InstanceBuffer final {
+public:
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	InstanceBuffer(const InstanceBuffer&) = delete;
+	InstanceBuffer& operator= (const InstanceBuffer&) = delete;
+
+	InstanceBuffer() noexcept;
+	~InstanceBuffer() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/**
+	 * @brief Replaces the contents of the buffer with the specified commands
+	 * The previous storage is orphaned first, so this doesn't wait for draw calls still reading it.
+	 */
+	void upload(const RenderCommand* commands, uint32_t numCommands) noexcept;
+
+	/** @brief Binds the buffer to INSTANCES_BINDING_POINT */
+	void bind() const noexcept;
+
+	inline uint32_t handle() const noexcept { return mUBO; }
+
+private:
+	uint32_t mUBO = 0;
+};
+
+/** @brief Connects the program's InstancesBlock to INSTANCES_BINDING_POINT, needed after (re)linking */
+void bindInstancesBlock(const Program& program) noexcept;
+
+/**
+ * @brief Issues one instanced draw call per run of commands sharing the same mesh
+ * The commands should be sorted by mesh, runs longer than MAX_NUM_INSTANCES are split. Only the
+ * model matrix and material id of each command are used, the program reads them from its
+ * InstancesBlock.
+ */
+void submitRenderCommandsInstanced(InstanceBuffer& buffer, const vector<RenderCommand>& commands) noexcept;
+
+// RenderCommandBuilder class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Builds RenderCommandLists on a worker thread
+ * The model passed to startBuild() must not be modified until waitForList() has returned. The
+ * returned list stays valid until the next call to startBuild().
+ */
+class RenderCommandBuilder final {
+public:
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	RenderCommandBuilder(const RenderCommandBuilder&) = delete;
+	RenderCommandBuilder& operator= (const RenderCommandBuilder&) = delete;
+
+	RenderCommandBuilder() noexcept;
+	~RenderCommandBuilder() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void startBuild(const Model& model, const mat4& viewMatrix, float snakeBlurWeight, float delta) noexcept;
+	const RenderCommandList& waitForList() noexcept;
+
+private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void workerLoop() noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	std::mutex mMutex;
+	std::condition_variable mCondVar;
+	bool mHasWork = false;
+	bool mQuit = false;
+
+	const Model* mModelPtr = nullptr;
+	mat4 mViewMatrix;
+	float mSnakeBlurWeight = 0.0f;
+	float mDelta = 0.0f;
+	RenderCommandList mList;
+
+	std::thread mThread; // Declared last so that it starts after all other members are initialized
+};
+
+} // namespace s3
+#endif
\ No newline at end of file
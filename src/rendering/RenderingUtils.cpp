@@ -303,6 +303,7 @@ void renderBackground(Program& program, const mat4& viewMatrix) noexcept
 	const mat4 skyModelMatrix = sfz::scalingMatrix4(5.0f);
 	const mat4 skyNormalMatrix = sfz::inverse(sfz::transpose(viewMatrix * skyModelMatrix));
 	gl::setUniform(program, "uModelMatrix", skyModelMatrix);
+	gl::setUniform(program, "uPrevModelMatrix", skyModelMatrix);
 	gl::setUniform(program, "uNormalMatrix", skyNormalMatrix);
 	setUniform(program, "uMaterialId", MATERIAL_ID_SKY);
 	gl::setUniform(program, "uBlurWeight", 0.0f);
@@ -310,221 +311,6 @@ void renderBackground(Program& program, const mat4& viewMatrix) noexcept
 	assets.SKYSPHERE_MODEL.render();
 }
 
-void renderOpaqueSnakeProjection(const Model& model, Program& program, const mat4& viewMatrix) noexcept
-{
-	Assets& assets = Assets::INSTANCE();
-
-	const mat4 tileScaling = sfz::scalingMatrix4(1.0f / (16.0f * (float)model.config().gridWidth));
-
-	for (size_t i = 0; i < model.numTiles(); ++i) {
-		const SnakeTile* tilePtr = model.tilePtr(i);
-		Position tilePos = model.tilePosition(tilePtr);
-
-		mat4 tileSpaceRot = tileSpaceRotation(tilePos.side);
-		mat4 tileSpaceRotScaling = tileSpaceRot * tileScaling;
-
-		// Calculate base transform
-		mat4 transform = tileSpaceRotScaling;
-		transform *= sfz::yRotationMatrix4(getTileAngleRad(tilePos.side, tilePtr));
-		sfz::translation(transform, tilePosToVector(model, tilePos));
-
-		// Set uniforms
-		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
-		gl::setUniform(program, "uModelMatrix", transform);
-		gl::setUniform(program, "uNormalMatrix", normalMatrix);
-
-		// Render tile projection
-		setUniform(program, "uMaterialId", MATERIAL_ID_TILE_PROJECTION);
-		gl::setUniform(program, "uBlurWeight", 0.0f);
-		auto* tileProjModelPtr = getTileProjectionModelPtr(tilePtr, tilePos.side, model.progress());
-		if (tileProjModelPtr != nullptr) tileProjModelPtr->render();
-	}
-
-	// Render dead snake head projection if game over
-	if (model.isGameOver()) {
-		const SnakeTile* tilePtr = model.deadHeadPtr();
-		Position tilePos = model.deadHeadPos();
-
-		mat4 tileSpaceRot = tileSpaceRotation(tilePos.side);
-		mat4 tileSpaceRotScaling = tileSpaceRot * tileScaling;
-
-		// Calculate base transform
-		mat4 transform = tileSpaceRotScaling;
-		transform *= sfz::yRotationMatrix4(getTileAngleRad(tilePos.side, tilePtr));
-		sfz::translation(transform, tilePosToVector(model, tilePos));
-
-		// Set uniforms
-		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
-		gl::setUniform(program, "uModelMatrix", transform);
-		gl::setUniform(program, "uNormalMatrix", normalMatrix);
-
-		// Render tile model
-		setUniform(program, "uMaterialId", MATERIAL_ID_TILE_PROJECTION);
-		gl::setUniform(program, "uBlurWeight", 0.0f);
-		getTileProjectionModelPtr(tilePtr, tilePos.side, model.progress())->render();
-	}
-}
-
-void renderCube(const Model& model, Program& program, const mat4& viewMatrix) noexcept
-{
-	Assets& assets = Assets::INSTANCE();
-
-	const mat4 tileScaling = sfz::scalingMatrix4(1.0f / (16.0f * (float)model.config().gridWidth));
-
-	for (size_t i = 0; i < model.numTiles(); ++i) {
-		const SnakeTile* tilePtr = model.tilePtr(i);
-		Position tilePos = model.tilePosition(tilePtr);
-
-		// Calculate base transform
-		mat4 tileSpaceRot = tileSpaceRotation(tilePos.side);
-		mat4 tileSpaceRotScaling = tileSpaceRot * tileScaling;
-		mat4 transform = tileSpaceRotScaling;
-		transform *= sfz::yRotationMatrix4(getTileAngleRad(tilePos.side, tilePtr));
-		sfz::translation(transform, tilePosToVector(model, tilePos));
-
-		// Set uniforms
-		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
-		gl::setUniform(program, "uModelMatrix", transform);
-		gl::setUniform(program, "uNormalMatrix", normalMatrix);
-
-		// Render tile decoration
-		gl::setUniform(program, "uBlurWeight", 1.0f);
-		setUniform(program, "uMaterialId", tileDecorationMaterialId(tilePtr));
-		assets.TILE_DECORATION_MODEL.render();
-	}
-}
-
-void renderSnake(const Model& model, Program& program, const mat4& viewMatrix, float blurWeight) noexcept
-{
-	Assets& assets = Assets::INSTANCE();
-	
-	const mat4 tileScaling = sfz::scalingMatrix4(1.0f / (16.0f * (float)model.config().gridWidth));
-
-	gl::setUniform(program, "uBlurWeight", blurWeight);
-
-	for (size_t i = 0; i < model.numTiles(); ++i) {
-		const SnakeTile* tilePtr = model.tilePtr(i);
-		Position tilePos = model.tilePosition(tilePtr);
-
-		// Skip non-snake tiles
-		if (!isSnake(tilePtr)) continue;
-
-		// Calculate base transform
-		mat4 tileSpaceRot = tileSpaceRotation(tilePos.side);
-		mat4 tileSpaceRotScaling = tileSpaceRot * tileScaling;
-		mat4 transform = tileSpaceRotScaling;
-		transform *= sfz::yRotationMatrix4(getTileAngleRad(tilePos.side, tilePtr));
-		sfz::translation(transform, tilePosToVector(model, tilePos));
-
-		// Set uniforms
-		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
-		gl::setUniform(program, "uModelMatrix", transform);
-		gl::setUniform(program, "uNormalMatrix", normalMatrix);
-
-		// Render dive & ascend models
-		if (isDive(tilePos.side, tilePtr->to)) {
-			setUniform(program, "uMaterialId", MATERIAL_ID_TILE_DIVE_ASCEND);
-			assets.DIVE_MODEL.render();
-		} else if (isAscend(tilePos.side, tilePtr->from) &&
-			tilePtr->type != TileType::TAIL && tilePtr->type != TileType::TAIL_DIGESTING) {
-			setUniform(program, "uMaterialId", MATERIAL_ID_TILE_DIVE_ASCEND);
-			assets.ASCEND_MODEL.render();
-		}
-
-		// Render tile model
-		setUniform(program, "uMaterialId", tileMaterialId(tilePtr));
-		getTileModel(tilePtr, tilePos.side, model.progress(), model.isGameOver()).render();
-	}
-
-	// Render dead snake head if game over (opaque)
-	if (model.isGameOver()) {
-		const SnakeTile* tilePtr = model.deadHeadPtr();
-		Position tilePos = model.deadHeadPos();
-
-		// Calculate base transform
-		mat4 tileSpaceRot = tileSpaceRotation(tilePos.side);
-		mat4 tileSpaceRotScaling = tileSpaceRot * tileScaling;
-		mat4 transform = tileSpaceRotScaling;
-		transform *= sfz::yRotationMatrix4(getTileAngleRad(tilePos.side, tilePtr));
-		sfz::translation(transform, tilePosToVector(model, tilePos));
-
-		// Set uniforms
-		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
-		gl::setUniform(program, "uModelMatrix", transform);
-		gl::setUniform(program, "uNormalMatrix", normalMatrix);
-
-		// Render dive & ascend models
-		if (isDive(tilePos.side, tilePtr->to)) {
-			setUniform(program, "uMaterialId", MATERIAL_ID_TILE_DIVE_ASCEND);
-			assets.DIVE_MODEL.render();
-		} else if (isAscend(tilePos.side, tilePtr->from) &&
-			tilePtr->type != TileType::TAIL && tilePtr->type != TileType::TAIL_DIGESTING) {
-			setUniform(program, "uMaterialId", MATERIAL_ID_TILE_DIVE_ASCEND);
-			assets.ASCEND_MODEL.render();
-		}
-
-		// Render tile model
-		setUniform(program, "uMaterialId", tileMaterialId(tilePtr));
-		getTileModel(tilePtr, tilePos.side, model.progress(), model.isGameOver()).render();
-	}
-}
-
-void renderObjects(const Model& model, Program& program, const mat4& viewMatrix) noexcept
-{
-	Assets& assets = Assets::INSTANCE();
-
-	const mat4 tileScaling = sfz::scalingMatrix4(1.0f / (16.0f * (float)model.config().gridWidth));
-
-	const auto& objects = model.objects();
-	for (const auto& object : objects) {
-		Position tilePos = object.position;
-		const SnakeTile* tilePtr = model.tilePtr(tilePos);
-
-		float blurWeight = 0.0f;
-		if (tilePtr->type == TileType::OBJECT) {
-			if (object.earlyLife > 0) {
-				blurWeight = 2.5f + (0.5f * (1.0f + std::sin(object.timeSinceCreation * model.currentSpeed() * 2.5f))) * 1.5f;
-			} else {
-				blurWeight = 0.5f + (0.5f * (1.0f + std::sin(object.timeSinceCreation * model.currentSpeed() * 2.0f))) * 0.75f;
-			}
-		} else if (tilePtr->type == TileType::BONUS_OBJECT) {
-			blurWeight = 3.0f + (0.5f * (1.0f + std::sin(object.timeSinceCreation * model.currentSpeed() * 4.0f))) * 2.5f;
-		}
-		gl::setUniform(program, "uBlurWeight", blurWeight);
-		
-		// Calculate base transform
-		mat4 tileSpaceRot = tileSpaceRotation(tilePos.side);
-		mat4 tileSpaceRotScaling = tileSpaceRot * tileScaling;
-		mat4 transform = tileSpaceRotScaling;
-		transform *= sfz::yRotationMatrix4(getTileAngleRad(tilePos.side, tilePtr));
-		sfz::translation(transform, tilePosToVector(model, tilePos));
-
-		// Set uniforms
-		const mat4 normalMatrix = sfz::inverse(sfz::transpose(viewMatrix * transform));
-		gl::setUniform(program, "uNormalMatrix", normalMatrix);
-
-		// Render tile model
-		setUniform(program, "uMaterialId", tileMaterialId(tilePtr));
-		if (tilePtr->type == TileType::OBJECT) {
-			gl::setUniform(program, "uModelMatrix", transform * sfz::translationMatrix(vec3{0.0f, std::sin(object.timeSinceCreation * 1.2f) * 1.25f, 0.0f}));
-			assets.OBJECT_PART1_MODEL.render();
-			gl::setUniform(program, "uModelMatrix", transform * sfz::yRotationMatrix4(object.timeSinceCreation * 0.8f));
-			assets.OBJECT_PART2_MODEL.render();
-			gl::setUniform(program, "uModelMatrix", transform * sfz::yRotationMatrix4(-object.timeSinceCreation * 1.25f));
-			assets.OBJECT_PART3_MODEL.render();
-			gl::setUniform(program, "uModelMatrix", transform * sfz::yRotationMatrix4(object.timeSinceCreation * 1.1f));
-			assets.OBJECT_PART4_MODEL.render();
-		} else if (tilePtr->type == TileType::BONUS_OBJECT) {
-			gl::setUniform(program, "uModelMatrix", transform * sfz::zRotationMatrix4(object.timeSinceCreation * 1.6f)
-			                                                  * sfz::yRotationMatrix4(object.timeSinceCreation * 1.1f)
-			                                                  * sfz::xRotationMatrix4(object.timeSinceCreation * 0.75f));
-			assets.BONUS_OBJECT_MODEL.render();
-		} else {
-			sfz_error("Invalid object");
-		}
-	}
-}
-
 void renderTransparentCube(const Model& model, Program& program, const mat4& viewMatrix, vec3 camPos, size_t firstSide, size_t lastSide) noexcept
 {
 	Assets& assets = Assets::INSTANCE();
@@ -47,14 +47,6 @@ bool isSnake(const SnakeTile* tilePtr) noexcept;
 
 void renderBackground(Program& program, const mat4& viewMatrix) noexcept;
 
-void renderOpaqueSnakeProjection(const Model& model, Program& program, const mat4& viewMatrix) noexcept;
-
-void renderCube(const Model& model, Program& program, const mat4& viewMatrix) noexcept;
-
-void renderSnake(const Model& model, Program& program, const mat4& viewMatrix, float blurWeight) noexcept;
-
-void renderObjects(const Model& model, Program& program, const mat4& viewMatrix) noexcept;
-
 void renderTransparentCube(const Model& model, Program& program, const mat4& viewMatrix, vec3 camPos, size_t firstSide = 0, size_t lastSide = 5) noexcept;
 
 void renderSnakeProjection(const Model& model, Program& program, const mat4& viewMatrix, vec3 camPos, size_t firstSide = 0, size_t lastSide = 5) noexcept;
@@ -0,0 +1,123 @@
+#include "rendering/TemporalUpsampler.hpp"
+
+#include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/StateCache.hpp>
+#include <sfz/math/MatrixSupport.hpp>
+
+#include "rendering/Assets.hpp"
+
+namespace s3 {
+
+using gl::FBTextureFiltering;
+using gl::FBTextureFormat;
+using gl::FramebufferBuilder;
+
+// Statics
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+static float halton(uint32_t index, uint32_t base) noexcept
+{
+	float result = 0.0f;
+	float fraction = 1.0f;
+	while (index > 0) {
+		fraction /= (float)base;
+		result += fraction * (float)(index % base);
+		index /= base;
+	}
+	return result;
+}
+
+static vec2 toFloat(vec2i v) noexcept
+{
+	return vec2{(float)v.x, (float)v.y};
+}
+
+// TemporalUpsampler: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+TemporalUpsampler::TemporalUpsampler() noexcept
+{
+	mProgram = loadPostProcessProgram("shaders/temporal_upsample.frag");
+}
+
+// TemporalUpsampler: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void TemporalUpsampler::newFrame() noexcept
+{
+	mJitterIndex = (mJitterIndex + 1) % NUM_JITTER_SAMPLES;
+}
+
+mat4 TemporalUpsampler::jitterProjMatrix(const mat4& projMatrix, vec2i renderRes) const noexcept
+{
+	// Translating in clip space moves everything by the same number of pixels regardless of depth
+	const vec2 ndcOffset = (2.0f * jitter()) / toFloat(renderRes);
+	return sfz::translationMatrix(ndcOffset.x, ndcOffset.y, 0.0f) * projMatrix;
+}
+
+const Framebuffer& TemporalUpsampler::upsample(uint32_t colorTexture, uint32_t velocityTexture,
+                                               uint32_t linearDepthTexture, vec2i colorDimensions,
+                                               vec2i renderRes, vec2i outputRes) noexcept
+{
+	gl::StateCache& glState = gl::StateCache::INSTANCE();
+
+	if (mHistory[0].dimensions() != outputRes) {
+		for (Framebuffer& history : mHistory) {
+			history = FramebufferBuilder{outputRes}
+			         .addTexture(0, FBTextureFormat::RGB_F16, FBTextureFiltering::LINEAR)
+			         .build();
+		}
+		glState.invalidate();
+		mHistoryValid = false;
+	}
+
+	const Framebuffer& history = mHistory[mHistoryIndex];
+	const Framebuffer& prevHistory = mHistory[1 - mHistoryIndex];
+
+	glState.disable(GL_BLEND);
+	glState.disable(GL_DEPTH_TEST);
+	glState.disable(GL_CULL_FACE);
+
+	glState.useProgram(mProgram.handle());
+	glState.bindFramebuffer(history.fbo());
+	glState.viewport(outputRes);
+
+	gl::setUniform(mProgram, "uRenderRes", toFloat(renderRes));
+	gl::setUniform(mProgram, "uOutputRes", toFloat(outputRes));
+	gl::setUniform(mProgram, "uColorUVScale", toFloat(renderRes) / toFloat(colorDimensions));
+	gl::setUniform(mProgram, "uJitter", jitter());
+	gl::setUniform(mProgram, "uHistoryValid", mHistoryValid ? 1 : 0);
+
+	glState.bindTexture(0, colorTexture);
+	gl::setUniform(mProgram, "uColorTexture", 0);
+	glState.bindTexture(1, velocityTexture);
+	gl::setUniform(mProgram, "uVelocityTexture", 1);
+	glState.bindTexture(2, linearDepthTexture);
+	gl::setUniform(mProgram, "uLinearDepthTexture", 2);
+	glState.bindTexture(3, prevHistory.texture(0));
+	gl::setUniform(mProgram, "uHistoryTexture", 3);
+
+	mPostProcessQuad.render();
+
+	mHistoryIndex = 1 - mHistoryIndex;
+	mHistoryValid = true;
+	return history;
+}
+
+void TemporalUpsampler::reset() noexcept
+{
+	mHistoryValid = false;
+}
+
+void TemporalUpsampler::reloadProgram() noexcept
+{
+	mProgram.reload();
+}
+
+vec2 TemporalUpsampler::jitter() const noexcept
+{
+	// Halton indices start at 1, index 0 would give no jitter at all
+	return vec2{halton(mJitterIndex + 1, 2), halton(mJitterIndex + 1, 3)} - vec2{0.5f};
+}
+
+} // namespace s3
\ No newline at end of file
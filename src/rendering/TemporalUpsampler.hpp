@@ -0,0 +1,99 @@
+#pragma once
+#ifndef S3_RENDERING_TEMPORAL_UPSAMPLER_HPP
+#define S3_RENDERING_TEMPORAL_UPSAMPLER_HPP
+
+#include <cstdint>
+
+#include <sfz/gl/Framebuffer.hpp>
+#include <sfz/gl/PostProcessQuad.hpp>
+#include <sfz/gl/Program.hpp>
+#include <sfz/math/Matrix.hpp>
+#include <sfz/math/Vector.hpp>
+
+namespace s3 {
+
+using gl::Framebuffer;
+using gl::Program;
+using sfz::mat4;
+using sfz::vec2;
+using sfz::vec2i;
+using std::uint32_t;
+
+// TemporalUpsampler class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Reconstructs output resolution images from several jittered lower resolution frames
+ *
+ * Every frame the projection matrix is offset by a different subpixel amount (a Halton sequence),
+ * so over NUM_JITTER_SAMPLES frames each output pixel is covered by samples at many different
+ * positions. Each new frame is blended into a history buffer at output resolution, which is first
+ * reprojected using per-pixel motion vectors. Samples landing close to the center of an output
+ * pixel are given more weight than ones further away.
+ *
+ * To avoid ghosting the reprojected history is clamped to the range of the colors around the new
+ * sample, and it is discarded completely where it falls outside the screen.
+ */
+class TemporalUpsampler final {
+public:
+	// Constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const uint32_t NUM_JITTER_SAMPLES = 8;
+
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	TemporalUpsampler(const TemporalUpsampler&) = delete;
+	TemporalUpsampler& operator= (const TemporalUpsampler&) = delete;
+
+	TemporalUpsampler() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/** @brief Advances to the next jitter offset, should be called once before rendering a frame. */
+	void newFrame() noexcept;
+
+	/**
+	 * @brief Returns the projection matrix offset by the jitter of the current frame
+	 * @param renderRes the resolution rendered at, the jitter is within one pixel of it
+	 */
+	mat4 jitterProjMatrix(const mat4& projMatrix, vec2i renderRes) const noexcept;
+
+	/**
+	 * @brief Blends the latest frame into the history and returns the framebuffer containing it
+	 * All input textures are only read in their lower left renderRes sub-rect, see
+	 * DynamicResolution.
+	 * @param colorTexture the shaded frame, rendered with the jittered projection matrix
+	 * @param velocityTexture screen space motion since the previous frame in uv coordinates
+	 * @param linearDepthTexture used to pick the motion vector of the closest surface at edges
+	 * @param colorDimensions the dimensions of the full input textures
+	 * @param outputRes the resolution to upsample to, the history is reset if it changes
+	 */
+	const Framebuffer& upsample(uint32_t colorTexture, uint32_t velocityTexture, uint32_t linearDepthTexture,
+	                            vec2i colorDimensions, vec2i renderRes, vec2i outputRes) noexcept;
+
+	/** @brief Discards the history, e.g. after a camera cut or when the renderer was reconfigured. */
+	void reset() noexcept;
+
+	/** @brief Reloads the shader, see gl::Program::reload(). */
+	void reloadProgram() noexcept;
+
+	/** @brief Returns the current jitter in pixels, within [-0.5, 0.5] on both axes. */
+	vec2 jitter() const noexcept;
+
+private:
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	Program mProgram;
+	gl::PostProcessQuad mPostProcessQuad;
+	Framebuffer mHistory[2];
+	uint32_t mHistoryIndex = 0;
+	bool mHistoryValid = false;
+	uint32_t mJitterIndex = 0;
+};
+
+} // namespace s3
+#endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <sfz/GL.hpp>
 #include <sfz/gl/OpenGL.hpp>
 #include <sfz/gl/Scaler.hpp>
+#include <sfz/gl/StateCache.hpp>
 
 #include "GameLogic.hpp"
 #include "GlobalConfig.hpp"
@@ -33,41 +34,12 @@ static const std::string& assetsPath() noexcept
 
 static const float TIME_UNTIL_GAME_OVER_SCREEN = 2.5f;
 
-static void updateInputBuffer(Model& model, Camera& cam, DirectionInput* inputBufferPtr,
-                              size_t bufferSize, size_t& index, DirectionInput dirInput) noexcept
-{
-	GlobalConfig& cfg = GlobalConfig::INSTANCE();
-
-	sfz_assert_debug(cfg.inputBufferSize <= bufferSize);
-	sfz_assert_debug(index <= cfg.inputBufferSize);
-
-	if (index == 0) {
-		if (!model.isChangingDirection(cam.upDir(), dirInput)) {
-			return;
-		}
-		inputBufferPtr[index] = dirInput;
-		index += 1;
-	}
-	else if (index < cfg.inputBufferSize) {
-		if (inputBufferPtr[index-1] == dirInput ||
-		    inputBufferPtr[index-1] == opposite(dirInput)) {
-			return;
-		}
-		inputBufferPtr[index] = dirInput;
-		index += 1;
-	}
-	else {
-		inputBufferPtr[cfg.inputBufferSize-1] = dirInput;
-		index = cfg.inputBufferSize;
-	}
-}
-
 // GameScreen: Constructors & destructors
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 GameScreen::GameScreen(const ModelConfig& modelCfg) noexcept
 :
-	mModel{modelCfg},
+	mSimulation{modelCfg, (size_t)GlobalConfig::INSTANCE().inputBufferSize},
 
 	mShortTermPerfStats{20}, 
 	mLongerTermPerfStats{120},
@@ -121,14 +93,18 @@ UpdateOp GameScreen::update(UpdateState& state)
 	mLongerTermPerfStats.addSample(state.delta);
 	mLongestTermPerfStats.addSample(state.delta);
 
+	// Retrieve the latest state from the simulation thread
+	mSimulation.acquireLatestSnapshot();
+	const Model& model = mSimulation.snapshot();
+
 	// Small dive hack
 	if (mCam.delayModelUpdate()) {
-		mInputBufferIndex = 0;
+		mSimulation.clearInputBuffer();
 		mWasShift = true;
 	}
 
 	// Play shift ascend sound
-	if (mWasShift && !mCam.delayModelUpdate() && !mModel.isGameOver()) {
+	if (mWasShift && !mCam.delayModelUpdate() && !model.isGameOver()) {
 		mWasShift = false;
 		if (cfg.sfxVolume > 0) {
 			Mix_Volume(-1, int32_t(std::round(cfg.sfxVolume * 12.8f)));
@@ -143,27 +119,27 @@ UpdateOp GameScreen::update(UpdateState& state)
 			case SDL_KEYDOWN:
 				switch (event.key.keysym.sym) {
 				case SDLK_SPACE:
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::SHIFT);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::SHIFT);
 					break;
 				case SDLK_UP:
 				case 'w':
 				case 'W':
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::UP);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::UP);
 					break;
 				case SDLK_DOWN:
 				case 's':
 				case 'S':
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::DOWN);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::DOWN);
 					break;
 				case SDLK_LEFT:
 				case 'a':
 				case 'A':
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::LEFT);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::LEFT);
 					break;
 				case SDLK_RIGHT:
 				case 'd':
 				case 'D':
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::RIGHT);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::RIGHT);
 					break;
 				}
 				break;
@@ -175,11 +151,14 @@ UpdateOp GameScreen::update(UpdateState& state)
 				case SDLK_F2:
 					mUseModernRenderer = !mUseModernRenderer;
 					break;
+				case SDLK_F3:
+					gl::GpuMemoryTracker::INSTANCE().printReport();
+					break;
 
 				case SDLK_ESCAPE:
-					if (mModel.isGameOver()) {
+					if (model.isGameOver()) {
 						return UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
-						                std::shared_ptr<sfz::BaseScreen>{new NewHighScoreScreen{mModel.config(), mModel.stats()}}};
+						                std::shared_ptr<sfz::BaseScreen>{new NewHighScoreScreen{model.config(), model.stats()}}};
 					} else {
 						mIsPaused = true;
 						Mix_PauseMusic();
@@ -222,30 +201,30 @@ UpdateOp GameScreen::update(UpdateState& state)
 				float largestProj = std::max(upProj, std::max(downProj, std::max(leftProj, rightProj)));
 
 				if (largestProj == upProj) {
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::UP);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::UP);
 				}
 				else if (largestProj == downProj) {
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::DOWN);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::DOWN);
 				}
 				else if (largestProj == leftProj) {
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::LEFT);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::LEFT);
 				}
 				else if (largestProj == rightProj) {
-					updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::RIGHT);
+					mSimulation.pushInput(mCam.upDir(), DirectionInput::RIGHT);
 				}
 			}
 
 
 			if (ctrl.padUp == sdl::ButtonState::UP) {
-				updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::UP);
+				mSimulation.pushInput(mCam.upDir(), DirectionInput::UP);
 			} else if (ctrl.padDown == sdl::ButtonState::UP) {
-				updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::DOWN);
+				mSimulation.pushInput(mCam.upDir(), DirectionInput::DOWN);
 			} else if (ctrl.padLeft == sdl::ButtonState::UP) {
-				updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::LEFT);
+				mSimulation.pushInput(mCam.upDir(), DirectionInput::LEFT);
 			} else if (ctrl.padRight == sdl::ButtonState::UP) {
-				updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::RIGHT);
+				mSimulation.pushInput(mCam.upDir(), DirectionInput::RIGHT);
 			} else if (ctrl.a == sdl::ButtonState::UP) {
-				updateInputBuffer(mModel, mCam, mInputBuffer, 5, mInputBufferIndex, DirectionInput::SHIFT);
+				mSimulation.pushInput(mCam.upDir(), DirectionInput::SHIFT);
 			} else if (ctrl.start == sdl::ButtonState::UP) {
 				mIsPaused = true;
 				Mix_PauseMusic();
@@ -264,32 +243,26 @@ UpdateOp GameScreen::update(UpdateState& state)
 				Mix_ResumeMusic();
 			}
 		}
+		mSimulation.setPaused(mIsPaused);
 		mPauseSystem.update(data, state.delta);
 		return mUpdateOp;
 	}
+	mSimulation.setPaused(mIsPaused);
 
 	// Game over updating
-	if (mModel.isGameOver()) {
+	if (model.isGameOver()) {
 		if (mTimeSinceGameOver >= TIME_UNTIL_GAME_OVER_SCREEN) {
 			return UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
-			                std::shared_ptr<sfz::BaseScreen>{new NewHighScoreScreen{mModel.config(), mModel.stats()}}};
+			                std::shared_ptr<sfz::BaseScreen>{new NewHighScoreScreen{model.config(), model.stats()}}};
 		}
 		mTimeSinceGameOver += state.delta;
 	}
 
-	if (mInputBufferIndex > 0) mModel.changeDirection(mCam.upDir(), mInputBuffer[0]);
-	if (!mCam.delayModelUpdate()) mModel.update(state.delta);
-
-	// Handle model events
-	Event event = mModel.popEvent();
-	while (event != Event::NONE) {
+	// Handle simulation events, the model itself is stepped on the simulation thread
+	Event event;
+	while (mSimulation.tryPopEvent(event)) {
 		if (event == Event::STATE_CHANGE) {
-			if (mInputBufferIndex > 0) {
-				mInputBufferIndex -= 1;
-				for (size_t i = 0; i < (cfg.inputBufferSize-1); ++i) {
-					mInputBuffer[i] = mInputBuffer[i+1];
-				}
-			}
+			continue;
 		}
 		else if (event == Event::GAME_OVER) {
 			sdl::stopMusic(150);
@@ -332,11 +305,12 @@ UpdateOp GameScreen::update(UpdateState& state)
 				sfz_assert_debug(false);
 			}
 		}
-		event = mModel.popEvent();
 	}
 
 	mCam.onResize(60.0f, (float)state.window.drawableWidth()/(float)state.window.drawableHeight());
-	mCam.update(mModel, state.delta);
+	mCam.update(model, state.delta);
+	mSimulation.setUpDir(mCam.upDir());
+	if (mCam.diveFinished()) mSimulation.finishDive();
 
 	return mUpdateOp;
 }
@@ -344,24 +318,26 @@ UpdateOp GameScreen::update(UpdateState& state)
 void GameScreen::render(UpdateState& state)
 {
 	GlobalConfig& cfg = GlobalConfig::INSTANCE();
+	gl::StateCache& glState = gl::StateCache::INSTANCE();
+	const Model& model = mSimulation.snapshot();
 
 	if (mUseModernRenderer) {
-		mModernRenderer.render(mModel, mCam, state.window.drawableDimensions(), state.delta);
+		mModernRenderer.render(model, mCam, state.window.drawableDimensions(), state.delta);
 	} else {
-		mClassicRenderer.render(mModel, mCam, AABB2D{state.window.drawableDimensions()/2.0f, state.window.drawableDimensions()});
+		mClassicRenderer.render(model, mCam, AABB2D{state.window.drawableDimensions()/2.0f, state.window.drawableDimensions()});
 	}
 
 	vec2 drawableDim = state.window.drawableDimensions();
 	const sfz::AABB2D guiCam = gui::calculateGUICamera(drawableDim, MENU_SYSTEM_DIM);
 
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_BLEND);
+	glState.disable(GL_DEPTH_TEST);
+	glState.enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_CULL_FACE);
+	glState.enable(GL_CULL_FACE);
 
-	glUseProgram(0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, drawableDim.x, drawableDim.y);
+	glState.useProgram(0);
+	glState.bindFramebuffer(0);
+	glState.viewport(drawableDim);
 
 	// Render text
 	gl::FontRenderer& font = Assets::INSTANCE().fontRenderer;
@@ -370,7 +346,7 @@ void GameScreen::render(UpdateState& state)
 	font.horizontalAlign(gl::HorizontalAlign::CENTER);
 
 	char scoreBuffer[128];
-	std::snprintf(scoreBuffer, 128, "Score: %i", totalScore(mModel.stats(), mModel.config()));
+	std::snprintf(scoreBuffer, 128, "Score: %i", totalScore(model.stats(), model.config()));
 
 	const float size = 8.0f;
 	const vec2 bgOffs = vec2{0.02f, -0.02f} * size;
@@ -384,7 +360,7 @@ void GameScreen::render(UpdateState& state)
 	font.write(vec2{MENU_DIM.x / 2.0f, MENU_DIM.y}, size, scoreBuffer);
 	font.end(0, drawableDim, vec4{0.84f, 1.0f, 0.84f, 1.0f});
 
-	if (mModel.isGameOver()) {
+	if (model.isGameOver()) {
 
 		font.verticalAlign(gl::VerticalAlign::MIDDLE);
 		font.horizontalAlign(gl::HorizontalAlign::CENTER);
@@ -411,6 +387,29 @@ void GameScreen::render(UpdateState& state)
 		std::snprintf(longerTermPerfBuffer, 128, "Last %i frames: %s", mLongerTermPerfStats.currentNumSamples(), mLongerTermPerfStats.to_string());
 		char longestTermPerfBuffer[128];
 		std::snprintf(longestTermPerfBuffer, 128, "Last %i frames: %s", mLongestTermPerfStats.currentNumSamples(), mLongestTermPerfStats.to_string());
+		const gl::StateCacheStats& glStats = glState.stats();
+		char glStateBuffer[128];
+		const DynamicResolution& dynRes = mModernRenderer.dynamicResolution();
+		std::snprintf(glStateBuffer, 128, "GL state changes: %u issued, %u skipped, Resolution scale: %.0f%% (GPU: %.1fms)",
+		              glStats.numIssued, glStats.numSkipped, dynRes.scale() * 100.0f, dynRes.gpuFrametime() * 1000.0f);
+		const gl::FramePacer& pacer = *state.framePacer;
+		char cpuWaitBuffer[192];
+		std::snprintf(cpuWaitBuffer, 192, "CPU wait (max %u frames in flight): %s", pacer.maxFramesInFlight(), pacer.cpuWaitStats().to_string());
+		const gl::RenderTargetPoolStats& poolStats = gl::RenderTargetPool::INSTANCE().stats();
+		char poolBuffer[128];
+		std::snprintf(poolBuffer, 128, "Render targets: %u, %.1f MiB allocated, %.1f MiB peak in use", poolStats.numTargets,
+		              poolStats.bytesAllocated / (1024.0f * 1024.0f), poolStats.peakBytesInUse / (1024.0f * 1024.0f));
+		const gl::GpuMemoryStats& memStats = gl::GpuMemoryTracker::INSTANCE().stats();
+		const float MIB = 1024.0f * 1024.0f;
+		char gpuMemoryBuffer[192];
+		std::snprintf(gpuMemoryBuffer, 192, "GPU memory: %.1f MiB (textures %.1f, framebuffers %.1f, meshes %.1f, sprite batches %.1f), F3 for details",
+		              memStats.totalBytes / MIB,
+		              memStats.bytes[(uint32_t)gl::GpuMemoryCategory::TEXTURE] / MIB,
+		              memStats.bytes[(uint32_t)gl::GpuMemoryCategory::FRAMEBUFFER] / MIB,
+		              memStats.bytes[(uint32_t)gl::GpuMemoryCategory::MESH] / MIB,
+		              memStats.bytes[(uint32_t)gl::GpuMemoryCategory::SPRITE_BATCH] / MIB);
+		char gpuLatencyBuffer[192];
+		std::snprintf(gpuLatencyBuffer, 192, "GPU latency: %s", pacer.gpuLatencyStats().to_string());
 
 		float fontSize = state.window.drawableHeight()/32.0f;
 		float offset = fontSize*0.04f;
@@ -420,12 +419,22 @@ void GameScreen::render(UpdateState& state)
 		font.horizontalAlign(gl::HorizontalAlign::LEFT);
 
 		font.begin(state.window.drawableDimensions()/2.0f, state.window.drawableDimensions());
+		font.write(vec2{offset, bottomOffset + fontSize*7.35f - offset}, fontSize, gpuMemoryBuffer);
+		font.write(vec2{offset, bottomOffset + fontSize*6.30f - offset}, fontSize, poolBuffer);
+		font.write(vec2{offset, bottomOffset + fontSize*5.25f - offset}, fontSize, gpuLatencyBuffer);
+		font.write(vec2{offset, bottomOffset + fontSize*4.20f - offset}, fontSize, cpuWaitBuffer);
+		font.write(vec2{offset, bottomOffset + fontSize*3.15f - offset}, fontSize, glStateBuffer);
 		font.write(vec2{offset, bottomOffset + fontSize*2.10f - offset}, fontSize, shortTermPerfBuffer);
 		font.write(vec2{offset, bottomOffset + fontSize*1.05f - offset}, fontSize, longerTermPerfBuffer);
 		font.write(vec2{offset, bottomOffset - offset}, fontSize, longestTermPerfBuffer);
 		font.end(0, state.window.drawableDimensions(), sfz::vec4{0.0f, 0.0f, 0.0f, 1.0f});
 
 		font.begin(state.window.drawableDimensions()/2.0f, state.window.drawableDimensions());
+		font.write(vec2{0.0f, bottomOffset + fontSize*7.35f}, fontSize, gpuMemoryBuffer);
+		font.write(vec2{0.0f, bottomOffset + fontSize*6.30f}, fontSize, poolBuffer);
+		font.write(vec2{0.0f, bottomOffset + fontSize*5.25f}, fontSize, gpuLatencyBuffer);
+		font.write(vec2{0.0f, bottomOffset + fontSize*4.20f}, fontSize, cpuWaitBuffer);
+		font.write(vec2{0.0f, bottomOffset + fontSize*3.15f}, fontSize, glStateBuffer);
 		font.write(vec2{0.0f, bottomOffset + fontSize*2.10f}, fontSize, shortTermPerfBuffer);
 		font.write(vec2{0.0f, bottomOffset + fontSize*1.05f}, fontSize, longerTermPerfBuffer);
 		font.write(vec2{0.0f, bottomOffset}, fontSize, longestTermPerfBuffer);
@@ -433,7 +442,7 @@ void GameScreen::render(UpdateState& state)
 	}
 
 	// Clean up
-	glUseProgram(0);
+	glState.useProgram(0);
 }
 
 } // namespace s3
\ No newline at end of file
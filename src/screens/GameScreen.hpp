@@ -9,6 +9,7 @@
 #include <sfz/Screens.hpp>
 #include <sfz/util/FrametimeStats.hpp>
 
+#include "gamelogic/Simulation.hpp"
 #include "rendering/Camera.hpp"
 #include "rendering/ClassicRenderer.hpp"
 #include "rendering/ModernRenderer.hpp"
@@ -46,7 +47,7 @@ private:
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	Model mModel;
+	Simulation mSimulation;
 	Camera mCam;
 	ClassicRenderer mClassicRenderer;
 	ModernRenderer mModernRenderer;
@@ -54,9 +55,6 @@ private:
 	float mTimeSinceGameOver = 0.0f;
 	bool mWasShift = false;
 
-	DirectionInput mInputBuffer[5];
-	size_t mInputBufferIndex = 0;
-
 	sfz::FrametimeStats mShortTermPerfStats, mLongerTermPerfStats, mLongestTermPerfStats;
 
 	bool mIsPaused = false;
@@ -1,6 +1,10 @@
 #include "screens/HighScoreScreen.hpp"
 
+#include <algorithm>
+#include <string>
+
 #include "sfz/gl/OpenGL.hpp"
+#include "sfz/gl/StateCache.hpp"
 
 #include "rendering/Assets.hpp"
 #include "screens/MainMenuScreen.hpp"
@@ -15,17 +19,18 @@ using std::shared_ptr;
 // HighScoreScreen: Constructors & destructors
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-HighScoreScreen::HighScoreScreen() noexcept
+HighScoreScreen::HighScoreScreen(size_t page) noexcept
 :
-	mGuiSystem{sfz::Rectangle{MENU_SYSTEM_DIM/2.0f, MENU_SYSTEM_DIM}}
+	mGuiSystem{sfz::Rectangle{MENU_SYSTEM_DIM/2.0f, MENU_SYSTEM_DIM}},
+	mPage{page}
 {
 	using namespace gui;
-	auto& a = Assets::INSTANCE();
+	const ScoreLog& scoreLog = ScoreLog::INSTANCE();
 
-	bool hasScores = loadScores(mScores);
+	bool hasScores = scoreLog.numEntries() > 0;
 	const float buttonWidth = MENU_DIM.x * 0.4f;
 	float restPadding;
-	if (hasScores) restPadding = calcRestPadding(3.0f, 0.0f, 9.0f, 4.0f);
+	if (hasScores) restPadding = calcRestPadding(3.0f, 0.0f, 3.0f * NUM_SCORES_PER_PAGE, 4.0f);
 	else restPadding = calcRestPadding(0.0f, 0.0f, 2.0f, 1.0f);
 
 	const float scoreStrRatio = 0.3f;
@@ -39,7 +44,7 @@ HighScoreScreen::HighScoreScreen() noexcept
 	addTitle(mGuiSystem, new TextItem{"High Scores"});
 	addStandardPadding(mGuiSystem);
 	
-	// Error text if high scores couldn't be loaded
+	// Error text if there are no high scores
 	if (!hasScores) {
 		addHeading3(mGuiSystem, new TextItem{"Could not load high scores file"});
 		addHeading3(mGuiSystem, new TextItem{"(this is normal if no high scores has been made)"});
@@ -50,53 +55,57 @@ HighScoreScreen::HighScoreScreen() noexcept
 		return;
 	}
 
-	addHeading1(mGuiSystem, new TextItem{"Standard"});
-	for (size_t i = 0; i < NUM_SCORES_SAVED; ++i) {
-		ThreeSplitContainer* tsc = new ThreeSplitContainer{scoreStrRatio, scoreButtonRatio};
-		addHeading3(mGuiSystem, tsc);
-		tsc->setLeft(new TextItem{std::to_string(totalScore(mScores.standardResults[i], STANDARD_CONFIG)), HorizontalAlign::LEFT}, scoreStrWidth, HorizontalAlign::RIGHT);
-		tsc->setMiddle(new TextItem{mScores.standardNames[i], HorizontalAlign::LEFT}, scoreNameWidth);
-		tsc->setRight(new Button{"Details", [this, i](Button&) {
-			this->mUpdateOp = UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
-			                           shared_ptr<BaseScreen>{new ResultScreen{STANDARD_CONFIG, this->mScores.standardResults[i], true}}};
-		}}, scoreButtonWidth, HorizontalAlign::LEFT);
-		if (i >= mScores.numStandardResults) tsc->rightItem->disable();
-	}
-	addStandardPadding(mGuiSystem);
-	
-	addHeading1(mGuiSystem, new TextItem{"Large"});
-	for (size_t i = 0; i < NUM_SCORES_SAVED; ++i) {
-		ThreeSplitContainer* tsc = new ThreeSplitContainer{scoreStrRatio, scoreButtonRatio};
-		addHeading3(mGuiSystem, tsc);
-		tsc->setLeft(new TextItem{std::to_string(totalScore(mScores.largeResults[i], LARGE_CONFIG)), HorizontalAlign::LEFT}, scoreStrWidth, HorizontalAlign::RIGHT);
-		tsc->setMiddle(new TextItem{mScores.largeNames[i], HorizontalAlign::LEFT}, scoreNameWidth);
-		tsc->setRight(new Button{"Details", [this, i](Button&) {
-			this->mUpdateOp = UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
-			                           shared_ptr<BaseScreen>{new ResultScreen{LARGE_CONFIG, this->mScores.largeResults[i], true}}};
-		}}, scoreButtonWidth, HorizontalAlign::LEFT);
-		if (i >= mScores.numLargeResults) tsc->rightItem->disable();
-	}
-	addStandardPadding(mGuiSystem);
-
-	addHeading1(mGuiSystem, new TextItem{"Giant"});
-	for (size_t i = 0; i < NUM_SCORES_SAVED; ++i) {
-		ThreeSplitContainer* tsc = new ThreeSplitContainer{scoreStrRatio, scoreButtonRatio};
-		addHeading3(mGuiSystem, tsc);
-		tsc->setLeft(new TextItem{std::to_string(totalScore(mScores.giantResults[i], STANDARD_CONFIG)), HorizontalAlign::LEFT}, scoreStrWidth, HorizontalAlign::RIGHT);
-		tsc->setMiddle(new TextItem{mScores.giantNames[i], HorizontalAlign::LEFT}, scoreNameWidth);
-		tsc->setRight(new Button{"Details", [this, i](Button&) {
-			this->mUpdateOp = UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
-			                           shared_ptr<BaseScreen>{new ResultScreen{GIANT_CONFIG, this->mScores.giantResults[i], true}}};
-		}}, scoreButtonWidth, HorizontalAlign::LEFT);
-		if (i >= mScores.numGiantResults) tsc->rightItem->disable();
-	}
-	addStandardPadding(mGuiSystem);
+	const size_t firstRank = page * NUM_SCORES_PER_PAGE;
+	size_t maxNumScores = 0;
+	auto addScores = [&](const char* heading, const ModelConfig& cfg) {
+		const size_t numScores = scoreLog.numScores(cfg);
+		maxNumScores = std::max(maxNumScores, numScores);
+
+		addHeading1(mGuiSystem, new TextItem{heading});
+		for (size_t i = firstRank; i < firstRank + NUM_SCORES_PER_PAGE; ++i) {
+			ThreeSplitContainer* tsc = new ThreeSplitContainer{scoreStrRatio, scoreButtonRatio};
+			addHeading3(mGuiSystem, tsc);
+			if (i >= numScores) {
+				tsc->setLeft(new TextItem{"", HorizontalAlign::LEFT}, scoreStrWidth, HorizontalAlign::RIGHT);
+				tsc->setMiddle(new TextItem{"", HorizontalAlign::LEFT}, scoreNameWidth);
+				tsc->setRight(new Button{"Details", [](Button&) {}}, scoreButtonWidth, HorizontalAlign::LEFT);
+				tsc->rightItem->disable();
+				continue;
+			}
+
+			const ScoreEntry& entry = scoreLog.entry(cfg, i);
+			const char* name = entry.name[0] != '\0' ? entry.name : "-";
+			tsc->setLeft(new TextItem{std::to_string(i + 1) + ". " + std::to_string(entry.score), HorizontalAlign::LEFT}, scoreStrWidth, HorizontalAlign::RIGHT);
+			tsc->setMiddle(new TextItem{name, HorizontalAlign::LEFT}, scoreNameWidth);
+			const Stats stats = entry.stats;
+			tsc->setRight(new Button{"Details", [this, cfg, stats](Button&) {
+				this->mUpdateOp = UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
+				                           shared_ptr<BaseScreen>{new ResultScreen{cfg, stats, true}}};
+			}}, scoreButtonWidth, HorizontalAlign::LEFT);
+		}
+		addStandardPadding(mGuiSystem);
+	};
+	addScores("Standard", STANDARD_CONFIG);
+	addScores("Large", LARGE_CONFIG);
+	addScores("Giant", GIANT_CONFIG);
 
 	// Navbar
-	addNavbar(mGuiSystem, new Button{"Back", [this](Button&) {
+	ThreeSplitContainer* navbar = new ThreeSplitContainer{0.3f, 0.3f};
+	addNavbar(mGuiSystem, navbar, restPadding);
+	navbar->setLeft(new Button{"Previous", [this](Button&) {
+		this->mUpdateOp = UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
+		                           shared_ptr<BaseScreen>{new HighScoreScreen{this->mPage - 1}}};
+	}}, MENU_DIM.x * 0.25f, HorizontalAlign::CENTER);
+	navbar->setMiddle(new Button{"Back", [this](Button&) {
 		this->mUpdateOp = UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
 		                           shared_ptr<BaseScreen>{new MainMenuScreen{}}};
-	}}, restPadding, buttonWidth);
+	}}, MENU_DIM.x * 0.25f);
+	navbar->setRight(new Button{"Next", [this](Button&) {
+		this->mUpdateOp = UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
+		                           shared_ptr<BaseScreen>{new HighScoreScreen{this->mPage + 1}}};
+	}}, MENU_DIM.x * 0.25f, HorizontalAlign::CENTER);
+	if (page == 0) navbar->leftItem->disable();
+	if (firstRank + NUM_SCORES_PER_PAGE >= maxNumScores) navbar->rightItem->disable();
 }
 
 // HighScoreScreen: Overriden screen methods
@@ -126,7 +135,7 @@ void HighScoreScreen::render(UpdateState& state)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Enable blending
-	glEnable(GL_BLEND);
+	gl::StateCache::INSTANCE().enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Sizes
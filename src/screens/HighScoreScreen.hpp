@@ -24,7 +24,8 @@ public:
 	HighScoreScreen& operator= (const HighScoreScreen&) = delete;
 	~HighScoreScreen() noexcept = default;
 
-	HighScoreScreen() noexcept;
+	/** @param page which page of scores to show, NUM_SCORES_PER_PAGE per config */
+	HighScoreScreen(size_t page = 0) noexcept;
 
 	// Overriden screen methods
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -38,7 +39,7 @@ private:
 
 	gui::System mGuiSystem;
 	UpdateOp mUpdateOp = sfz::SCREEN_NO_OP;
-	ScoreBundle mScores;
+	size_t mPage;
 };
 
 } // namespace s3
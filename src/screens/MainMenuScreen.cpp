@@ -96,7 +96,7 @@ void MainMenuScreen::render(UpdateState& state)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Enable blending
-	glEnable(GL_BLEND);
+	gl::StateCache::INSTANCE().enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Sizes
@@ -1,6 +1,7 @@
 #include "screens/ModeSelectScreen.hpp"
 
 #include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/StateCache.hpp>
 
 #include "gamelogic/ModelConfig.hpp"
 #include "GlobalConfig.hpp"
@@ -82,7 +83,7 @@ void ModeSelectScreen::render(UpdateState& state)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Enable blending
-	glEnable(GL_BLEND);
+	gl::StateCache::INSTANCE().enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Sizes
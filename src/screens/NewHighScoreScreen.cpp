@@ -21,17 +21,15 @@ static std::mt19937_64 createRNGGenerator(void) noexcept
 	return std::mt19937_64(rnd_dev());
 }
 
-static bool isValidScoreConfig(const ModelConfig& cfg) noexcept
+static const char* ordinalSuffix(int32_t number) noexcept
 {
-	return cfg == STANDARD_CONFIG || cfg == LARGE_CONFIG || cfg == GIANT_CONFIG;
-}
-
-static ScoreConfigType cfgToType(const ModelConfig& cfg) noexcept
-{
-	if (cfg == STANDARD_CONFIG) return ScoreConfigType::STANDARD;
-	if (cfg == LARGE_CONFIG) return ScoreConfigType::LARGE;
-	if (cfg == GIANT_CONFIG) return ScoreConfigType::GIANT;
-	sfz_error("Logic error! Impossible config!");
+	if (number % 100 >= 11 && number % 100 <= 13) return "th";
+	switch (number % 10) {
+	case 1: return "st";
+	case 2: return "nd";
+	case 3: return "rd";
+	default: return "th";
+	}
 }
 
 // NewHighScoreScreen: Constructors & destructors
@@ -47,15 +45,11 @@ NewHighScoreScreen::NewHighScoreScreen(const ModelConfig& lastModelCfg, const St
 	snprintf(mNameStr, sizeof(mNameStr), "");
 	mNameStrIndex = 0;
 	
-	if (!isValidScoreConfig(lastModelCfg)) {
-		mIsHighScore = false;
-		return;
-	}
-
-	ScoreBundle scores = createEmptyScoreBundle();
-	loadScores(scores);
-	int rank = checkScoreRank(scores, cfgToType(lastModelCfg), results);
-	if (rank == -1) {
+	// Every game is logged, but only games making it onto the first page are given a name
+	ScoreLog& scoreLog = ScoreLog::INSTANCE();
+	int32_t rank = scoreLog.rank(lastModelCfg, results);
+	if (rank > int32_t(NUM_SCORES_PER_PAGE)) {
+		scoreLog.add(lastModelCfg, results, nullptr);
 		mIsHighScore = false;
 		return;
 	}
@@ -71,8 +65,8 @@ NewHighScoreScreen::NewHighScoreScreen(const ModelConfig& lastModelCfg, const St
 	std::snprintf(tmp, sizeof(tmp), "Score: %i", totalScore(results, lastModelCfg));
 	addHeading1(mGuiSystem, new TextItem{tmp, HorizontalAlign::LEFT}, strWidth, HorizontalAlign::CENTER);
 
-	const char* rankStr = rank == 1 ? "Ranked 1st" : rank == 2 ? "Ranked 2nd" : "Ranked 3rd";
-	addHeading3(mGuiSystem, new TextItem{rankStr, HorizontalAlign::LEFT}, strWidth, HorizontalAlign::CENTER);
+	std::snprintf(tmp, sizeof(tmp), "Ranked %i%s", rank, ordinalSuffix(rank));
+	addHeading3(mGuiSystem, new TextItem{tmp, HorizontalAlign::LEFT}, strWidth, HorizontalAlign::CENTER);
 
 	addStandardPadding(mGuiSystem);
 	mNameItemPtr = new TextItem{"Enter name: ", HorizontalAlign::LEFT};
@@ -95,14 +89,8 @@ NewHighScoreScreen::NewHighScoreScreen(const ModelConfig& lastModelCfg, const St
 
 	// Navbar
 	const float restPadding = calcRestPadding(1.0f, 2.0f, 1.0f, 2.0f);
-	addNavbar(mGuiSystem, new Button{"Save", [this, scores](Button&) {
-		auto tmpScores = scores;
-		int rank = tryAddScoreToBundle(tmpScores, cfgToType(this->lastModelConfig), this->results, this->mNameStr);
-		if (rank != -1) {
-			if (writeScores(tmpScores)) {
-				std::cout << "Wrote scores to file!\n";
-			}
-		}
+	addNavbar(mGuiSystem, new Button{"Save", [this](Button&) {
+		ScoreLog::INSTANCE().add(this->lastModelConfig, this->results, this->mNameStr);
 		this->mUpdateOp = UpdateOp{sfz::UpdateOpType::SWITCH_SCREEN,
 		                           shared_ptr<BaseScreen>{new ResultScreen{this->lastModelConfig, this->results, false}}};
 	}}, restPadding, MENU_DIM.x * 0.4f);
@@ -196,7 +184,7 @@ void NewHighScoreScreen::render(UpdateState& state)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Enable blending
-	glEnable(GL_BLEND);
+	gl::StateCache::INSTANCE().enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Sizes
@@ -215,6 +203,7 @@ void NewHighScoreScreen::updateNameItem() noexcept
 	char tmp[128];
 	snprintf(tmp, sizeof(tmp), "Enter name: %s", mNameStr);
 	mNameItemPtr->text = tmp;
+	mNameItemPtr->markDirty();
 
 	if (mNameStrIndex == 0) {
 		mGuiSystem.items().back()->disable();
@@ -180,7 +180,7 @@ OptionsGraphicsScreen::OptionsGraphicsScreen() noexcept
 	}, stateAlignOffset}};
 	addHeading3(scrollList, mSpotlightResMultiChoicePtr);
 	
-	/*mLightShaftResMultiChoicePtr = shared_ptr<BaseItem>{new MultiChoiceSelector{"Volumetric lighting resolution", {}, [this]() {
+	mLightShaftResMultiChoicePtr = shared_ptr<BaseItem>{new MultiChoiceSelector{"Volumetric lighting resolution", {}, [this]() {
 		float val = this->cfgData.gc.lightShaftsResScaling;
 		const float eps = 0.01f;
 		int i = 0;
@@ -192,16 +192,44 @@ OptionsGraphicsScreen::OptionsGraphicsScreen() noexcept
 	}, [this](int choice) {
 		this->cfgData.gc.lightShaftsResScaling = 0.05f + ((float)choice)*0.05f;
 	}, stateAlignOffset}};
-	addHeading3(scrollList, mLightShaftResMultiChoicePtr);*/
+	if (this->cfgData.gc.lightShafts) {
+		mLightShaftResMultiChoicePtr->enable();
+	} else {
+		mLightShaftResMultiChoicePtr->disable();
+	}
+	addHeading3(scrollList, mLightShaftResMultiChoicePtr);
 	
 	addStandardPadding(scrollList);
 	addHeading2(scrollList, shared_ptr<BaseItem>{new TextItem{"Misc", gl::HorizontalAlign::LEFT}});
 
-	addHeading3(scrollList, shared_ptr<BaseItem>{new MultiChoiceSelector{"Scaling algorithm", {"Nearest", "Bilinear", "2x2 Nearest", "2x2 Bilinear", "4x4 Nearest", "4x4 Bilinear", "Bicubic Bspline", "Lanczos-2", "Lanczos-3"}, [this]() {
+	addHeading3(scrollList, shared_ptr<BaseItem>{new MultiChoiceSelector{"Scaling algorithm", {"Nearest", "Bilinear", "2x2 Nearest", "2x2 Bilinear", "4x4 Nearest", "4x4 Bilinear", "Bicubic Bspline", "Lanczos-2", "Lanczos-3", "Lanczos-2 (separable)", "Lanczos-3 (separable)"}, [this]() {
 		return this->cfgData.gc.scalingAlgorithm;
 	}, [this](int choice) {
 		this->cfgData.gc.scalingAlgorithm = choice;
 	}, stateAlignOffset}});
+
+	addHeading3(scrollList, shared_ptr<BaseItem>{new MultiChoiceSelector{"Emissive blur", {"Gaussian", "Dual filter"}, [this]() {
+		return this->cfgData.gc.blurAlgorithm;
+	}, [this](int choice) {
+		this->cfgData.gc.blurAlgorithm = choice;
+	}, stateAlignOffset}});
+
+	addHeading3(scrollList, shared_ptr<BaseItem>{new OnOffSelector{"Temporal upsampling", [this]() {
+		return this->cfgData.gc.temporalUpsampling;
+	}, [this]() {
+		this->cfgData.gc.temporalUpsampling = !this->cfgData.gc.temporalUpsampling;
+	}, stateAlignOffset}});
+
+	addHeading3(scrollList, shared_ptr<BaseItem>{new OnOffSelector{"Volumetric lighting", [this]() {
+		return this->cfgData.gc.lightShafts;
+	}, [this]() {
+		this->cfgData.gc.lightShafts = !this->cfgData.gc.lightShafts;
+		if (this->cfgData.gc.lightShafts) {
+			this->mLightShaftResMultiChoicePtr->enable();
+		} else {
+			this->mLightShaftResMultiChoicePtr->disable();
+		}
+	}, stateAlignOffset}});
 }
 
 // OptionsGraphicsScreen: Overriden screen methods
@@ -246,7 +274,7 @@ void OptionsGraphicsScreen::render(UpdateState& state)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Enable blending
-	glEnable(GL_BLEND);
+	gl::StateCache::INSTANCE().enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Sizes
@@ -316,12 +344,12 @@ void OptionsGraphicsScreen::updateResolutionStrings() noexcept
 	MultiChoiceSelector& internalResMultiChoice = *static_cast<MultiChoiceSelector*>(mInternalResMultiChoicePtr.get());
 	MultiChoiceSelector& blurResMultiChoice = *static_cast<MultiChoiceSelector*>(mBlurResMultiChoicePtr.get());
 	MultiChoiceSelector& spotlightResMultiChoice = *static_cast<MultiChoiceSelector*>(mSpotlightResMultiChoicePtr.get());
-	//MultiChoiceSelector& lightShaftResMultiChoice = *static_cast<MultiChoiceSelector*>(mLightShaftResMultiChoicePtr.get());
+	MultiChoiceSelector& lightShaftResMultiChoice = *static_cast<MultiChoiceSelector*>(mLightShaftResMultiChoicePtr.get());
 
 	internalResMultiChoice.choiceNames = mInternalResStrs;
 	blurResMultiChoice.choiceNames = vector<string>{mSecondaryResFactorStrs.begin(), mSecondaryResFactorStrs.begin()+20};
 	spotlightResMultiChoice.choiceNames = mSecondaryResFactorStrs;
-	//lightShaftResMultiChoice.choiceNames = mSecondaryResFactorStrs;
+	lightShaftResMultiChoice.choiceNames = vector<string>{mSecondaryResFactorStrs.begin(), mSecondaryResFactorStrs.begin()+20};
 }
 
 } // namespace s3
\ No newline at end of file
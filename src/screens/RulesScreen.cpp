@@ -1,6 +1,7 @@
 #include "screens/RulesScreen.hpp"
 
 #include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/StateCache.hpp>
 
 #include "gamelogic/ModelConfig.hpp"
 #include "GlobalConfig.hpp"
@@ -78,7 +79,7 @@ void RulesScreen::render(UpdateState& state)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Enable blending
-	glEnable(GL_BLEND);
+	gl::StateCache::INSTANCE().enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Sizes
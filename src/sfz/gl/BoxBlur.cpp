@@ -1,8 +1,12 @@
 #include "sfz/gl/BoxBlur.hpp"
 
 #include <algorithm>
+#include <cstdio>
+#include <ostream>
 
 #include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/RenderTargetPool.hpp>
+#include <sfz/gl/StateCache.hpp>
 
 namespace gl {
 
@@ -95,6 +99,59 @@ static const char* VERTICAL_SOURCE = R"(
 	}
 )";
 
+// Each pass sums 8 texels uStep apart along uAxis (0 = x, 1 = y), so after k passes along an axis
+// every texel holds the sum of the 8^k texels up to and including itself.
+static const char* PREFIX_SUM_SOURCE = R"(
+	#version 330
+
+	out vec4 outFragColor;
+
+	uniform sampler2D uSrcTex;
+	uniform int uStep;
+	uniform int uAxis;
+
+	void main()
+	{
+		ivec2 coord = ivec2(gl_FragCoord.xy);
+		ivec2 step = ivec2(0);
+		step[uAxis] = uStep;
+
+		vec4 sum = vec4(0.0);
+		for (int i = 0; i < 8; ++i) {
+			ivec2 sampleCoord = coord - i * step;
+			if (sampleCoord.x < 0 || sampleCoord.y < 0) break;
+			sum += texelFetch(uSrcTex, sampleCoord, 0);
+		}
+		outFragColor = sum;
+	}
+)";
+
+static const char* SUMMED_AREA_LOOKUP_SOURCE = R"(
+	#version 330
+
+	out vec4 outFragColor;
+
+	uniform sampler2D uSatTex;
+	uniform int uRadius;
+
+	void main()
+	{
+		ivec2 coord = ivec2(gl_FragCoord.xy);
+		ivec2 maxCoord = textureSize(uSatTex, 0) - ivec2(1);
+
+		// Inclusive box, sums outside the texture are 0
+		ivec2 lo = max(coord - ivec2(uRadius), ivec2(0));
+		ivec2 hi = min(coord + ivec2(uRadius), maxCoord);
+		vec4 sum = texelFetch(uSatTex, hi, 0);
+		if (lo.x > 0) sum -= texelFetch(uSatTex, ivec2(lo.x - 1, hi.y), 0);
+		if (lo.y > 0) sum -= texelFetch(uSatTex, ivec2(hi.x, lo.y - 1), 0);
+		if (lo.x > 0 && lo.y > 0) sum += texelFetch(uSatTex, lo - ivec2(1), 0);
+
+		vec2 boxDim = vec2(hi - lo + ivec2(1));
+		outFragColor = sum / (boxDim.x * boxDim.y);
+	}
+)";
+
 // BoxBlur: Constructors & destructors
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -102,6 +159,8 @@ BoxBlur::BoxBlur(vec2i dimensions) noexcept
 :
 	mHorizontalBlurProgram{Program::postProcessFromSource(HORIZONTAL_SOURCE)},
 	mVerticalBlurProgram{Program::postProcessFromSource(VERTICAL_SOURCE)},
+	mPrefixSumProgram{Program::postProcessFromSource(PREFIX_SUM_SOURCE)},
+	mSummedAreaLookupProgram{Program::postProcessFromSource(SUMMED_AREA_LOOKUP_SOURCE)},
 	mTempFB{FramebufferBuilder{dimensions}.addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR).build()}
 {
 	glGenSamplers(1, &mSamplerObject);
@@ -115,18 +174,24 @@ BoxBlur::BoxBlur(BoxBlur&& other) noexcept
 {
 	mHorizontalBlurProgram = std::move(other.mHorizontalBlurProgram);
 	mVerticalBlurProgram = std::move(other.mVerticalBlurProgram);
+	mPrefixSumProgram = std::move(other.mPrefixSumProgram);
+	mSummedAreaLookupProgram = std::move(other.mSummedAreaLookupProgram);
 	mTempFB = std::move(other.mTempFB);
 	mPostProcessQuad = std::move(other.mPostProcessQuad);
 	std::swap(this->mSamplerObject, other.mSamplerObject);
+	std::swap(this->mMode, other.mMode);
 }
 
 BoxBlur& BoxBlur::operator= (BoxBlur&& other) noexcept
 {
 	mHorizontalBlurProgram = std::move(other.mHorizontalBlurProgram);
 	mVerticalBlurProgram = std::move(other.mVerticalBlurProgram);
+	mPrefixSumProgram = std::move(other.mPrefixSumProgram);
+	mSummedAreaLookupProgram = std::move(other.mSummedAreaLookupProgram);
 	mTempFB = std::move(other.mTempFB);
 	mPostProcessQuad = std::move(other.mPostProcessQuad);
 	std::swap(this->mSamplerObject, other.mSamplerObject);
+	std::swap(this->mMode, other.mMode);
 	return *this;
 }
 
@@ -141,17 +206,28 @@ BoxBlur::~BoxBlur() noexcept
 void BoxBlur::apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, int32_t radius) noexcept
 {
 	sfz_assert_debug(srcDimensions == mTempFB.dimensions());
+	bool useSummedAreaTable = (mMode == BoxBlurMode::SUMMED_AREA_TABLE)
+	   || (mMode == BoxBlurMode::AUTOMATIC && radius >= SUMMED_AREA_TABLE_MIN_RADIUS);
+	if (useSummedAreaTable) applySummedAreaTable(dstFBO, srcTexture, srcDimensions, radius);
+	else applySampled(dstFBO, srcTexture, srcDimensions, radius);
+}
+
+// BoxBlur: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void BoxBlur::applySampled(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, int32_t radius) noexcept
+{
 	sfz_assert_debug(((radius % 2) == 0));
 	vec2 srcDimFloat{(float)srcDimensions.x, (float)srcDimensions.y};
+	StateCache& glState = StateCache::INSTANCE();
 
-	glUseProgram(mHorizontalBlurProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, mTempFB.fbo());
-	glViewport(0, 0, mTempFB.width(), mTempFB.height());
+	glState.useProgram(mHorizontalBlurProgram.handle());
+	glState.bindFramebuffer(mTempFB.fbo());
+	glState.viewport(mTempFB.dimensions());
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, srcTexture);
+	glState.bindTexture(0, srcTexture);
 	gl::setUniform(mHorizontalBlurProgram, "uSrcTex", 0);
 	glBindSampler(0, mSamplerObject);
 	gl::setUniform(mHorizontalBlurProgram, "uSrcDim", srcDimFloat);
@@ -159,14 +235,13 @@ void BoxBlur::apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, i
 
 	mPostProcessQuad.render();
 
-	glUseProgram(mVerticalBlurProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, dstFBO);
-	glViewport(0, 0, srcDimensions.x, srcDimensions.y);
+	glState.useProgram(mVerticalBlurProgram.handle());
+	glState.bindFramebuffer(dstFBO);
+	glState.viewport(srcDimensions);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, mTempFB.texture(0));
+	glState.bindTexture(0, mTempFB.texture(0));
 	gl::setUniform(mVerticalBlurProgram, "uSrcTex", 0);
 	glBindSampler(0, mSamplerObject);
 	gl::setUniform(mVerticalBlurProgram, "uSrcDim", srcDimFloat);
@@ -175,10 +250,111 @@ void BoxBlur::apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, i
 	mPostProcessQuad.render();
 
 	// Cleanup
-	glUseProgram(0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glBindTexture(GL_TEXTURE_2D, 0);
 	glBindSampler(0, 0);
 }
 
+void BoxBlur::applySummedAreaTable(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, int32_t radius) noexcept
+{
+	StateCache& glState = StateCache::INSTANCE();
+	RenderTargetPool& pool = RenderTargetPool::INSTANCE();
+
+	// Sums of a whole row or column need full float precision, so the table is built by ping
+	// ponging between two float targets
+	FramebufferBuilder tableDesc = FramebufferBuilder{srcDimensions}
+	                              .addTexture(0, FBTextureFormat::RGB_F32, FBTextureFiltering::NEAREST);
+	const Framebuffer* tables[2] = {&pool.acquire(tableDesc), &pool.acquire(tableDesc)};
+	uint32_t readTexture = srcTexture;
+	int32_t writeIndex = 0;
+
+	glState.useProgram(mPrefixSumProgram.handle());
+	glState.viewport(srcDimensions);
+	gl::setUniform(mPrefixSumProgram, "uSrcTex", 0);
+
+	for (int32_t axis = 0; axis < 2; ++axis) {
+		const int32_t size = (axis == 0) ? srcDimensions.x : srcDimensions.y;
+		gl::setUniform(mPrefixSumProgram, "uAxis", axis);
+		for (int32_t step = 1; step < size; step *= 8) {
+			glState.bindFramebuffer(tables[writeIndex]->fbo());
+			glState.bindTexture(0, readTexture);
+			gl::setUniform(mPrefixSumProgram, "uStep", step);
+
+			mPostProcessQuad.render();
+
+			readTexture = tables[writeIndex]->texture(0);
+			writeIndex = 1 - writeIndex;
+		}
+	}
+
+	glState.useProgram(mSummedAreaLookupProgram.handle());
+	glState.bindFramebuffer(dstFBO);
+	glState.bindTexture(0, readTexture);
+	gl::setUniform(mSummedAreaLookupProgram, "uSatTex", 0);
+	gl::setUniform(mSummedAreaLookupProgram, "uRadius", radius);
+
+	mPostProcessQuad.render();
+
+	pool.release(*tables[0]);
+	pool.release(*tables[1]);
+}
+
+// Benchmark
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void benchmarkBoxBlur(std::ostream& out) noexcept
+{
+	const vec2i RESOLUTIONS[] = {vec2i{1280, 720}, vec2i{1920, 1080}, vec2i{2560, 1440}, vec2i{3840, 2160}};
+	const int32_t RADII[] = {4, 8, 16, 32, 64, 128};
+	const int32_t NUM_ITERATIONS = 20;
+
+	uint32_t query = 0;
+	glGenQueries(1, &query);
+	char buffer[128];
+
+	out << "Box blur benchmark, ms per blur (" << NUM_ITERATIONS << " iterations each)\n";
+	std::snprintf(buffer, sizeof(buffer), "%-10s %-8s %10s %10s\n", "Resolution", "Radius", "Sampled", "SAT");
+	out << buffer;
+
+	for (vec2i res : RESOLUTIONS) {
+		Framebuffer srcFB = FramebufferBuilder{res}
+		                   .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR)
+		                   .build();
+		Framebuffer dstFB = FramebufferBuilder{res}
+		                   .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR)
+		                   .build();
+		BoxBlur blur{res};
+		StateCache::INSTANCE().invalidate(); // Building binds framebuffers behind its back
+
+		StateCache::INSTANCE().bindFramebuffer(srcFB.fbo());
+		glClearColor(0.5f, 0.25f, 1.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		for (int32_t radius : RADII) {
+			float results[2];
+			const BoxBlurMode modes[2] = {BoxBlurMode::SAMPLED, BoxBlurMode::SUMMED_AREA_TABLE};
+			for (int32_t m = 0; m < 2; ++m) {
+				blur.mode(modes[m]);
+				blur.apply(dstFB.fbo(), srcFB.texture(0), res, radius); // Warm up
+				glFinish();
+
+				glBeginQuery(GL_TIME_ELAPSED, query);
+				for (int32_t i = 0; i < NUM_ITERATIONS; ++i) {
+					blur.apply(dstFB.fbo(), srcFB.texture(0), res, radius);
+				}
+				glEndQuery(GL_TIME_ELAPSED);
+
+				GLuint64 elapsedNs = 0;
+				glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs);
+				results[m] = float(double(elapsedNs) / 1000000.0 / double(NUM_ITERATIONS));
+			}
+
+			std::snprintf(buffer, sizeof(buffer), "%4ix%-5i %-8i %10.3f %10.3f\n",
+			              res.x, res.y, radius, results[0], results[1]);
+			out << buffer;
+		}
+	}
+
+	glDeleteQueries(1, &query);
+	out.flush();
+}
+
 } // namespace gl
\ No newline at end of file
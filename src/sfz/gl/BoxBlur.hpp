@@ -3,6 +3,7 @@
 #define SFZ_GL_BOX_BLUR_HPP
 
 #include <cstdint>
+#include <iosfwd>
 
 #include <sfz/gl/Framebuffer.hpp>
 #include <sfz/gl/PostProcessQuad.hpp>
@@ -15,8 +16,32 @@ using sfz::vec2i;
 using std::int32_t;
 using std::uint32_t;
 
+// Box blur mode enum
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+enum class BoxBlurMode : int32_t {
+	// Summed-area table for radii of at least BoxBlur::SUMMED_AREA_TABLE_MIN_RADIUS
+	AUTOMATIC = 0,
+
+	// Horizontal and vertical pass sampling every pixel in the box, cost is linear in radius
+	SAMPLED = 1,
+
+	// Builds a summed-area table of the texture in log8(width) + log8(height) passes and reads
+	// each box sum from its four corners. Cost only depends on resolution, not radius. The
+	// box is cut off at the borders instead of repeating the edge pixels.
+	SUMMED_AREA_TABLE = 2
+};
+
+// BoxBlur class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
 class BoxBlur final {
 public:
+	// Constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const int32_t SUMMED_AREA_TABLE_MIN_RADIUS = 32;
+
 	// Constructors & destructors
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -40,15 +65,34 @@ public:
 	 */
 	void apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, int32_t radius) noexcept;
 
+	inline BoxBlurMode mode() const noexcept { return mMode; }
+	inline void mode(BoxBlurMode mode) noexcept { mMode = mode; }
+
 private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void applySampled(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, int32_t radius) noexcept;
+	void applySummedAreaTable(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, int32_t radius) noexcept;
+
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	
-	Program mHorizontalBlurProgram, mVerticalBlurProgram;
+	Program mHorizontalBlurProgram, mVerticalBlurProgram, mPrefixSumProgram, mSummedAreaLookupProgram;
 	Framebuffer mTempFB;
 	PostProcessQuad mPostProcessQuad;
 	uint32_t mSamplerObject = 0;
+	BoxBlurMode mMode = BoxBlurMode::AUTOMATIC;
 };
 
+// Benchmark
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief Times both box blur modes for a range of radii and resolutions, printing the results
+ * Requires a current OpenGL context. Run the game with --benchmark-box-blur to use.
+ */
+void benchmarkBoxBlur(std::ostream& out) noexcept;
+
 } // namespace sfz
 #endif
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "sfz/gl/DualFilterBlur.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/RenderTargetPool.hpp>
+#include <sfz/gl/StateCache.hpp>
+
+namespace gl {
+
+// Statics
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+// uHalfPixel is half a pixel of the destination, i.e. a whole pixel of the source when
+// downsampling and a quarter of a pixel of the source when upsampling. The levels come from the
+// RenderTargetPool and hold undefined data outside of their rects, so all taps are clamped to
+// uUVMax, the center of the last texel of the source rect.
+
+static const char* DOWNSAMPLE_SOURCE = R"(
+	#version 330
+
+	in vec2 uvCoord;
+	out vec4 outFragColor;
+
+	uniform sampler2D uSrcTex;
+	uniform vec2 uHalfPixel;
+	uniform vec2 uUVMax;
+
+	vec4 sampleSrc(vec2 coord)
+	{
+		return texture(uSrcTex, min(coord, uUVMax));
+	}
+
+	void main()
+	{
+		// 5 bilinear samples covering 4x4 source pixels, the center 2x2 weighted higher
+		vec4 result = sampleSrc(uvCoord) * 4.0;
+		result += sampleSrc(uvCoord - uHalfPixel);
+		result += sampleSrc(uvCoord + uHalfPixel);
+		result += sampleSrc(uvCoord + vec2(uHalfPixel.x, -uHalfPixel.y));
+		result += sampleSrc(uvCoord - vec2(uHalfPixel.x, -uHalfPixel.y));
+		outFragColor = result / 8.0;
+	}
+)";
+
+static const char* UPSAMPLE_SOURCE = R"(
+	#version 330
+
+	in vec2 uvCoord;
+	out vec4 outFragColor;
+
+	uniform sampler2D uSrcTex;
+	uniform vec2 uHalfPixel;
+	uniform vec2 uUVMax;
+
+	vec4 sampleSrc(vec2 coord)
+	{
+		return texture(uSrcTex, min(coord, uUVMax));
+	}
+
+	void main()
+	{
+		// 8 bilinear samples in a tent shaped pattern around the pixel
+		vec2 hp = uHalfPixel;
+		vec4 result = sampleSrc(uvCoord + vec2(-hp.x * 2.0, 0.0));
+		result += sampleSrc(uvCoord + vec2(-hp.x, hp.y)) * 2.0;
+		result += sampleSrc(uvCoord + vec2(0.0, hp.y * 2.0));
+		result += sampleSrc(uvCoord + vec2(hp.x, hp.y)) * 2.0;
+		result += sampleSrc(uvCoord + vec2(hp.x * 2.0, 0.0));
+		result += sampleSrc(uvCoord + vec2(hp.x, -hp.y)) * 2.0;
+		result += sampleSrc(uvCoord + vec2(0.0, -hp.y * 2.0));
+		result += sampleSrc(uvCoord + vec2(-hp.x, -hp.y)) * 2.0;
+		outFragColor = result / 12.0;
+	}
+)";
+
+static vec2i halfDimensions(vec2i dimensions) noexcept
+{
+	return vec2i{std::max(dimensions.x / 2, 1), std::max(dimensions.y / 2, 1)};
+}
+
+static vec2 toFloat(vec2i v) noexcept
+{
+	return vec2{(float)v.x, (float)v.y};
+}
+
+static vec2 lastTexelCenter(vec2i rect, vec2i dimensions) noexcept
+{
+	return (toFloat(rect) - vec2{0.5f}) / toFloat(dimensions);
+}
+
+// DualFilterBlur: Constructors & destructors
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+DualFilterBlur::DualFilterBlur(vec2i dimensions, int32_t radius) noexcept
+:
+	mDownsampleProgram{Program::postProcessFromSource(DOWNSAMPLE_SOURCE)},
+	mUpsampleProgram{Program::postProcessFromSource(UPSAMPLE_SOURCE)},
+	mDimensions{dimensions}
+{
+	glGenSamplers(1, &mSamplerObject);
+	glSamplerParameteri(mSamplerObject, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glSamplerParameteri(mSamplerObject, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glSamplerParameteri(mSamplerObject, GL_TEXTURE_WRAP_S, GL_CLAMP);
+	glSamplerParameteri(mSamplerObject, GL_TEXTURE_WRAP_T, GL_CLAMP);
+
+	setRadius(radius);
+}
+
+DualFilterBlur::DualFilterBlur(DualFilterBlur&& other) noexcept
+{
+	mDownsampleProgram = std::move(other.mDownsampleProgram);
+	mUpsampleProgram = std::move(other.mUpsampleProgram);
+	std::swap(this->mDimensions, other.mDimensions);
+	mPostProcessQuad = std::move(other.mPostProcessQuad);
+	std::swap(this->mSamplerObject, other.mSamplerObject);
+
+	std::swap(this->mRadius, other.mRadius);
+	std::swap(this->mNumLevels, other.mNumLevels);
+}
+
+DualFilterBlur& DualFilterBlur::operator= (DualFilterBlur&& other) noexcept
+{
+	mDownsampleProgram = std::move(other.mDownsampleProgram);
+	mUpsampleProgram = std::move(other.mUpsampleProgram);
+	std::swap(this->mDimensions, other.mDimensions);
+	mPostProcessQuad = std::move(other.mPostProcessQuad);
+	std::swap(this->mSamplerObject, other.mSamplerObject);
+
+	std::swap(this->mRadius, other.mRadius);
+	std::swap(this->mNumLevels, other.mNumLevels);
+	return *this;
+}
+
+DualFilterBlur::~DualFilterBlur() noexcept
+{
+	glDeleteSamplers(1, &mSamplerObject);
+}
+
+// DualFilterBlur: Public methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void DualFilterBlur::apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions) noexcept
+{
+	apply(dstFBO, srcTexture, srcDimensions, srcDimensions);
+}
+
+void DualFilterBlur::apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, vec2i rectDimensions) noexcept
+{
+	sfz_assert_debug(srcDimensions == mDimensions);
+	applyPasses(dstFBO, srcTexture, toFloat(rectDimensions) / toFloat(srcDimensions), rectDimensions);
+}
+
+void DualFilterBlur::applyDownsampling(uint32_t dstFBO, uint32_t srcTexture, vec2 srcUVScale, vec2i rectDimensions) noexcept
+{
+	applyPasses(dstFBO, srcTexture, srcUVScale, rectDimensions);
+}
+
+bool DualFilterBlur::setRadius(int32_t radius) noexcept
+{
+	sfz_assert_debug(radius > 0);
+	if (mRadius == radius) return false;
+
+	mRadius = radius;
+	int32_t numLevels = (int32_t)std::round(std::log2((float)radius));
+	mNumLevels = std::max(1, std::min(numLevels, MAX_NUM_LEVELS));
+	return true;
+}
+
+// DualFilterBlur: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void DualFilterBlur::applyPasses(uint32_t dstFBO, uint32_t srcTexture, vec2 srcUVScale, vec2i rectDimensions) noexcept
+{
+	StateCache& glState = StateCache::INSTANCE();
+	RenderTargetPool& pool = RenderTargetPool::INSTANCE();
+
+	// Level 0 is the destination, the rest are halved in size for each level
+	const Framebuffer* levels[MAX_NUM_LEVELS + 1];
+	vec2i levelDims[MAX_NUM_LEVELS + 1];
+	vec2i levelRects[MAX_NUM_LEVELS + 1];
+	levels[0] = nullptr;
+	levelDims[0] = mDimensions;
+	levelRects[0] = rectDimensions;
+	for (int32_t i = 1; i <= mNumLevels; ++i) {
+		levelDims[i] = halfDimensions(levelDims[i-1]);
+		levelRects[i] = halfDimensions(levelRects[i-1]);
+		levels[i] = &pool.acquire(FramebufferBuilder{levelDims[i]}
+		                          .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR));
+	}
+
+	// Every pass overwrites the whole sub-rect it renders to and only samples inside the rect of
+	// the previous one, so no clearing is necessary
+	glBindSampler(0, mSamplerObject);
+
+	glState.useProgram(mDownsampleProgram.handle());
+	gl::setUniform(mDownsampleProgram, "uSrcTex", 0);
+	for (int32_t i = 1; i <= mNumLevels; ++i) {
+		glState.bindFramebuffer(levels[i]->fbo());
+		glState.viewport(levelRects[i]);
+
+		if (i == 1) {
+			glState.bindTexture(0, srcTexture);
+			gl::setUniform(mDownsampleProgram, "uUVScale", srcUVScale);
+			// Exact if the source has the internal resolution, conservative if it is larger
+			gl::setUniform(mDownsampleProgram, "uUVMax", srcUVScale - vec2{0.5f} / toFloat(levelDims[0]));
+		} else {
+			glState.bindTexture(0, levels[i-1]->texture(0));
+			gl::setUniform(mDownsampleProgram, "uUVScale", toFloat(levelRects[i-1]) / toFloat(levelDims[i-1]));
+			gl::setUniform(mDownsampleProgram, "uUVMax", lastTexelCenter(levelRects[i-1], levelDims[i-1]));
+		}
+		gl::setUniform(mDownsampleProgram, "uHalfPixel", vec2{0.5f} / toFloat(levelDims[i]));
+
+		mPostProcessQuad.render();
+	}
+
+	glState.useProgram(mUpsampleProgram.handle());
+	gl::setUniform(mUpsampleProgram, "uSrcTex", 0);
+	for (int32_t i = mNumLevels - 1; i >= 0; --i) {
+		glState.bindFramebuffer((i == 0) ? dstFBO : levels[i]->fbo());
+		glState.viewport(levelRects[i]);
+
+		glState.bindTexture(0, levels[i+1]->texture(0));
+		gl::setUniform(mUpsampleProgram, "uUVScale", toFloat(levelRects[i+1]) / toFloat(levelDims[i+1]));
+		gl::setUniform(mUpsampleProgram, "uUVMax", lastTexelCenter(levelRects[i+1], levelDims[i+1]));
+		gl::setUniform(mUpsampleProgram, "uHalfPixel", vec2{0.5f} / toFloat(levelDims[i]));
+
+		mPostProcessQuad.render();
+	}
+
+	// Cleanup
+	glBindSampler(0, 0);
+	for (int32_t i = 1; i <= mNumLevels; ++i) {
+		pool.release(*levels[i]);
+	}
+}
+
+} // namespace gl
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+#ifndef SFZ_GL_DUAL_FILTER_BLUR_HPP
+#define SFZ_GL_DUAL_FILTER_BLUR_HPP
+
+#include <cstdint>
+
+#include <sfz/gl/Framebuffer.hpp>
+#include <sfz/gl/PostProcessQuad.hpp>
+#include <sfz/gl/Program.hpp>
+#include <sfz/math/Vector.hpp>
+
+namespace gl {
+
+using sfz::vec2;
+using sfz::vec2i;
+using std::int32_t;
+using std::uint32_t;
+
+// Dual filter blur class
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/**
+ * @brief A blur made from a pyramid of downsample and upsample passes (dual Kawase filter)
+ *
+ * The texture is repeatedly downsampled to half resolution, then upsampled back again level by
+ * level. Each pass takes a handful of bilinear samples, so the blur grows wider with every
+ * level while the total cost stays at roughly two fullscreen passes regardless of its size. The
+ * result is not a true gaussian, but is close enough for glow effects.
+ *
+ * The intermediate framebuffers are acquired from the RenderTargetPool only while applying the
+ * blur. The source texture is only read by the first pass, so it may be attached to dstFBO.
+ */
+class DualFilterBlur final {
+public:
+	// Constants
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	static const int32_t MAX_NUM_LEVELS = 6;
+
+	// Constructors & destructors
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	DualFilterBlur() = default;
+	DualFilterBlur(const DualFilterBlur&) = delete;
+	DualFilterBlur& operator= (const DualFilterBlur&) = delete;
+
+	DualFilterBlur(vec2i dimensions, int32_t radius) noexcept;
+
+	DualFilterBlur(DualFilterBlur&& other) noexcept;
+	DualFilterBlur& operator= (DualFilterBlur&& other) noexcept;
+	~DualFilterBlur() noexcept;
+
+	// Public methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/**
+	 * @brief Applies the blur filter to the texture and writes it to the specifed fbo
+	 * @param srcDimensions the dimensions of the texture, needs to be same as the internal
+	 *                      resolution of this DualFilterBlur object.
+	 */
+	void apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions) noexcept;
+
+	/**
+	 * @brief Applies the blur filter to the lower left sub-rect of the texture
+	 * The result is written to the same sub-rect of the specified fbo.
+	 * @param srcDimensions the dimensions of the whole texture, see above
+	 * @param rectDimensions the dimensions of the sub-rect to blur
+	 */
+	void apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, vec2i rectDimensions) noexcept;
+
+	/**
+	 * @brief Applies the blur filter to a texture larger than the internal resolution
+	 * The first downsample pass reads the texture directly, see GaussianBlur::applyDownsampling().
+	 * @param srcUVScale the fraction of the texture to blur, see Scaler
+	 * @param rectDimensions the dimensions of the lower left sub-rect of the fbo to write to
+	 */
+	void applyDownsampling(uint32_t dstFBO, uint32_t srcTexture, vec2 srcUVScale, vec2i rectDimensions) noexcept;
+
+	/**
+	 * @brief Sets the approximate radius of the blur in pixels
+	 * Every level doubles the radius, so the number of levels used is log2(radius) rounded.
+	 * @return whether the radius was changed or not
+	 */
+	bool setRadius(int32_t radius) noexcept;
+
+	// Getters
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	inline int32_t radius() const noexcept { return mRadius; }
+	inline int32_t numLevels() const noexcept { return mNumLevels; }
+
+private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void applyPasses(uint32_t dstFBO, uint32_t srcTexture, vec2 srcUVScale, vec2i rectDimensions) noexcept;
+
+	// Private members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	Program mDownsampleProgram, mUpsampleProgram;
+	vec2i mDimensions{-1};
+	PostProcessQuad mPostProcessQuad;
+	uint32_t mSamplerObject = 0;
+
+	int32_t mRadius = -1;
+	int32_t mNumLevels = 1;
+};
+
+} // namespace gl
+#endif
\ No newline at end of file
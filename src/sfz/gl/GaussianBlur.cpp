@@ -5,6 +5,8 @@
 #include <new>
 
 #include <sfz/gl/OpenGL.hpp>
+#include <sfz/gl/RenderTargetPool.hpp>
+#include <sfz/gl/StateCache.hpp>
 
 namespace gl {
 
@@ -55,17 +57,18 @@ static const char* HORIZONTAL_SOURCE_NAIVE = R"(
 
 	uniform sampler2D uSrcTex;
 	uniform vec2 uSrcDim;
+	uniform vec2 uUVMax; // Taps are clamped to the blurred sub-rect
 	uniform float uGaussianSamples[257];
 	uniform int uRadius;
 
 	void main()
 	{
 		vec2 offs = vec2(1.0 / uSrcDim.x, 0.0);
-		vec4 result = uGaussianSamples[0] * texture(uSrcTex, uvCoord);
+		vec4 result = uGaussianSamples[0] * texture(uSrcTex, min(uvCoord, uUVMax));
 		for (int i = 1; i <= uRadius; ++i) {
 			vec2 sampleOffs = float(i) * offs;
-			result += uGaussianSamples[i] * texture(uSrcTex, uvCoord - sampleOffs);
-			result += uGaussianSamples[i] * texture(uSrcTex, uvCoord + sampleOffs);
+			result += uGaussianSamples[i] * texture(uSrcTex, min(uvCoord - sampleOffs, uUVMax));
+			result += uGaussianSamples[i] * texture(uSrcTex, min(uvCoord + sampleOffs, uUVMax));
 		}
 		outFragColor = result;
 	}
@@ -79,17 +82,18 @@ static const char* VERTICAL_SOURCE_NAIVE = R"(
 
 	uniform sampler2D uSrcTex;
 	uniform vec2 uSrcDim;
+	uniform vec2 uUVMax; // Taps are clamped to the blurred sub-rect
 	uniform float uGaussianSamples[257];
 	uniform int uRadius;
 
 	void main()
 	{
 		vec2 offs = vec2(0.0, 1.0 / uSrcDim.y);
-		vec4 result = uGaussianSamples[0] * texture(uSrcTex, uvCoord);
+		vec4 result = uGaussianSamples[0] * texture(uSrcTex, min(uvCoord, uUVMax));
 		for (int i = 1; i <= uRadius; ++i) {
 			vec2 sampleOffs = float(i) * offs;
-			result += uGaussianSamples[i] * texture(uSrcTex, uvCoord - sampleOffs);
-			result += uGaussianSamples[i] * texture(uSrcTex, uvCoord + sampleOffs);
+			result += uGaussianSamples[i] * texture(uSrcTex, min(uvCoord - sampleOffs, uUVMax));
+			result += uGaussianSamples[i] * texture(uSrcTex, min(uvCoord + sampleOffs, uUVMax));
 		}
 		outFragColor = result;
 	}
@@ -103,6 +107,7 @@ static const char* HORIZONTAL_SOURCE_INTERPOLATED_SAMPLING = R"(
 
 	uniform sampler2D uSrcTex;
 	uniform vec2 uSrcDim;
+	uniform vec2 uUVMax; // Taps are clamped to the blurred sub-rect
 	uniform float uGaussianSamples[257];
 	uniform int uRadius;
 
@@ -111,12 +116,12 @@ static const char* HORIZONTAL_SOURCE_INTERPOLATED_SAMPLING = R"(
 		vec2 offs = vec2(1.0 / uSrcDim.x, 0.0);
 		vec2 halfOffs = offs * 0.5;
 
-		vec4 result = uGaussianSamples[0] * texture(uSrcTex, uvCoord);
+		vec4 result = uGaussianSamples[0] * texture(uSrcTex, min(uvCoord, uUVMax));
 		for (int i = 1; i <= uRadius; i += 2) {
 			vec2 sampleOffs = (float(i) * offs) + halfOffs;
 			float weight = uGaussianSamples[i] + uGaussianSamples[i+1];
-			result += weight * texture(uSrcTex, uvCoord - sampleOffs);
-			result += weight * texture(uSrcTex, uvCoord + sampleOffs);
+			result += weight * texture(uSrcTex, min(uvCoord - sampleOffs, uUVMax));
+			result += weight * texture(uSrcTex, min(uvCoord + sampleOffs, uUVMax));
 		}
 
 		outFragColor = result;
@@ -131,6 +136,7 @@ static const char* VERTICAL_SOURCE_INTERPOLATED_SAMPLING = R"(
 
 	uniform sampler2D uSrcTex;
 	uniform vec2 uSrcDim;
+	uniform vec2 uUVMax; // Taps are clamped to the blurred sub-rect
 	uniform float uGaussianSamples[257];
 	uniform int uRadius;
 
@@ -139,12 +145,12 @@ static const char* VERTICAL_SOURCE_INTERPOLATED_SAMPLING = R"(
 		vec2 offs = vec2(0.0, 1.0 / uSrcDim.y);
 		vec2 halfOffs = offs * 0.5;
 
-		vec4 result = uGaussianSamples[0] * texture(uSrcTex, uvCoord);
+		vec4 result = uGaussianSamples[0] * texture(uSrcTex, min(uvCoord, uUVMax));
 		for (int i = 1; i <= uRadius; i += 2) {
 			vec2 sampleOffs = (float(i) * offs) + halfOffs;
 			float weight = uGaussianSamples[i] + uGaussianSamples[i+1];
-			result += weight * texture(uSrcTex, uvCoord - sampleOffs);
-			result += weight * texture(uSrcTex, uvCoord + sampleOffs);
+			result += weight * texture(uSrcTex, min(uvCoord - sampleOffs, uUVMax));
+			result += weight * texture(uSrcTex, min(uvCoord + sampleOffs, uUVMax));
 		}
 
 		outFragColor = result;
@@ -160,7 +166,7 @@ GaussianBlur::GaussianBlur(vec2i dimensions, int32_t radius, float sigma, bool i
 	mVerticalBlurProgram{Program::postProcessFromSource(VERTICAL_SOURCE_NAIVE)},
 	mHorizontalBlurInterpolatedProgram{Program::postProcessFromSource(HORIZONTAL_SOURCE_INTERPOLATED_SAMPLING)},
 	mVerticalBlurInterpolatedProgram{Program::postProcessFromSource(VERTICAL_SOURCE_INTERPOLATED_SAMPLING)},
-	mTempFB{FramebufferBuilder{dimensions}.addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR).build()}
+	mDimensions{dimensions}
 {
 	glGenSamplers(1, &mSamplerObject);
 	glSamplerParameteri(mSamplerObject, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -177,7 +183,7 @@ GaussianBlur::GaussianBlur(GaussianBlur&& other) noexcept
 	mVerticalBlurProgram = std::move(other.mVerticalBlurProgram);
 	mHorizontalBlurInterpolatedProgram = std::move(other.mHorizontalBlurInterpolatedProgram);
 	mVerticalBlurInterpolatedProgram = std::move(other.mVerticalBlurInterpolatedProgram);
-	mTempFB = std::move(other.mTempFB);
+	std::swap(this->mDimensions, other.mDimensions);
 	mPostProcessQuad = std::move(other.mPostProcessQuad);
 	std::swap(this->mSamplerObject, other.mSamplerObject);
 
@@ -193,7 +199,7 @@ GaussianBlur& GaussianBlur::operator= (GaussianBlur&& other) noexcept
 	mVerticalBlurProgram = std::move(other.mVerticalBlurProgram);
 	mHorizontalBlurInterpolatedProgram = std::move(other.mHorizontalBlurInterpolatedProgram);
 	mVerticalBlurInterpolatedProgram = std::move(other.mVerticalBlurInterpolatedProgram);
-	mTempFB = std::move(other.mTempFB);
+	std::swap(this->mDimensions, other.mDimensions);
 	mPostProcessQuad = std::move(other.mPostProcessQuad);
 	std::swap(this->mSamplerObject, other.mSamplerObject);
 
@@ -214,69 +220,100 @@ GaussianBlur::~GaussianBlur() noexcept
 
 void GaussianBlur::apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions) noexcept
 {
-	sfz_assert_debug(srcDimensions == mTempFB.dimensions());
-	vec2 srcDimFloat{(float)srcDimensions.x, (float)srcDimensions.y};
+	apply(dstFBO, srcTexture, srcDimensions, srcDimensions);
+}
+
+void GaussianBlur::apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, vec2i rectDimensions) noexcept
+{
+	sfz_assert_debug(srcDimensions == mDimensions);
+	vec2 uvScale = vec2{(float)rectDimensions.x, (float)rectDimensions.y}
+	             / vec2{(float)srcDimensions.x, (float)srcDimensions.y};
+	applyPasses(dstFBO, srcTexture, uvScale, rectDimensions);
+}
+
+void GaussianBlur::applyDownsampling(uint32_t dstFBO, uint32_t srcTexture, vec2 srcUVScale, vec2i rectDimensions) noexcept
+{
+	applyPasses(dstFBO, srcTexture, srcUVScale, rectDimensions);
+}
+
+bool GaussianBlur::setBlurParams(int32_t radius, float sigma, bool interpolatedSamples) noexcept
+{
+	sfz_assert_debug(radius > 0);
+	sfz_assert_debug(radius < 257);
+	sfz_assert_debug((radius % 2) == 0);
+	sfz_assert_debug(sigma > 0.0f);
+
+	if (mRadius == radius && mSigma == sigma) {
+		return false;
+	}
+
+	mRadius = radius;
+	mSigma = sigma;
+	mSamples = unique_ptr<float[]>{new (std::nothrow) float[radius+1]};
+	mInterpolatedSamples = interpolatedSamples;
+	calculateGaussians(&mSamples[0], radius, sigma);
+	normalizeGaussianSamples(&mSamples[0], radius);
+	return true;
+}
+
+// GaussianBlur: Private methods
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void GaussianBlur::applyPasses(uint32_t dstFBO, uint32_t srcTexture, vec2 srcUVScale, vec2i rectDimensions) noexcept
+{
+	// Sample offsets are always in pixels of the internal resolution, the source texture of the
+	// horizontal pass may be larger in which case the bilinear sampler downsamples it.
+	vec2 dimFloat{(float)mDimensions.x, (float)mDimensions.y};
+	vec2 uvScale = vec2{(float)rectDimensions.x, (float)rectDimensions.y} / dimFloat;
+
+	// The texels outside the sub-rect are undefined. Taps are clamped to the center of the last
+	// texel at the internal resolution, for a larger source this stays a bit further inside.
+	vec2 halfTexel = vec2{0.5f} / dimFloat;
 
 	const auto& horizBlurProgram = mInterpolatedSamples ? mHorizontalBlurInterpolatedProgram : mHorizontalBlurProgram;
 	const auto& vertBlurProgram = mInterpolatedSamples ? mVerticalBlurInterpolatedProgram : mVerticalBlurProgram;
-
-	glUseProgram(horizBlurProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, mTempFB.fbo());
-	glViewport(0, 0, mTempFB.width(), mTempFB.height());
+	StateCache& glState = StateCache::INSTANCE();
+	RenderTargetPool& pool = RenderTargetPool::INSTANCE();
+	const Framebuffer& tempFB = pool.acquire(FramebufferBuilder{mDimensions}
+	                            .addTexture(0, FBTextureFormat::RGB_U8, FBTextureFiltering::LINEAR));
+
+	glState.useProgram(horizBlurProgram.handle());
+	glState.bindFramebuffer(tempFB.fbo());
+	glState.viewport(rectDimensions);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, srcTexture);
+	glState.bindTexture(0, srcTexture);
 	glBindSampler(0, mSamplerObject);
 	gl::setUniform(horizBlurProgram, "uSrcTex", 0);
-	gl::setUniform(horizBlurProgram, "uSrcDim", srcDimFloat);
+	gl::setUniform(horizBlurProgram, "uSrcDim", dimFloat);
 	gl::setUniform(horizBlurProgram, "uGaussianSamples", &mSamples[0], mRadius);
 	gl::setUniform(horizBlurProgram, "uRadius", mRadius);
+	gl::setUniform(horizBlurProgram, "uUVScale", srcUVScale);
+	gl::setUniform(horizBlurProgram, "uUVMax", srcUVScale - halfTexel);
 
 	mPostProcessQuad.render();
 
-	glUseProgram(vertBlurProgram.handle());
-	glBindFramebuffer(GL_FRAMEBUFFER, dstFBO);
-	glViewport(0, 0, srcDimensions.x, srcDimensions.y);
+	glState.useProgram(vertBlurProgram.handle());
+	glState.bindFramebuffer(dstFBO);
+	glState.viewport(rectDimensions);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, mTempFB.texture(0));
+	glState.bindTexture(0, tempFB.texture(0));
 	glBindSampler(0, mSamplerObject);
 	gl::setUniform(vertBlurProgram, "uSrcTex", 0);
-	gl::setUniform(vertBlurProgram, "uSrcDim", srcDimFloat);
+	gl::setUniform(vertBlurProgram, "uSrcDim", dimFloat);
 	gl::setUniform(vertBlurProgram, "uGaussianSamples", &mSamples[0], mRadius);
 	gl::setUniform(vertBlurProgram, "uRadius", mRadius);
+	gl::setUniform(vertBlurProgram, "uUVScale", uvScale);
+	gl::setUniform(vertBlurProgram, "uUVMax", uvScale - halfTexel);
 
 	mPostProcessQuad.render();
 
 	// Cleanup
-	glUseProgram(0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glBindTexture(GL_TEXTURE_2D, 0);
 	glBindSampler(0, 0);
-}
-
-bool GaussianBlur::setBlurParams(int32_t radius, float sigma, bool interpolatedSamples) noexcept
-{
-	sfz_assert_debug(radius > 0);
-	sfz_assert_debug(radius < 257);
-	sfz_assert_debug((radius % 2) == 0);
-	sfz_assert_debug(sigma > 0.0f);
-
-	if (mRadius == radius && mSigma == sigma) {
-		return false;
-	}
-
-	mRadius = radius;
-	mSigma = sigma;
-	mSamples = unique_ptr<float[]>{new (std::nothrow) float[radius+1]};
-	mInterpolatedSamples = interpolatedSamples;
-	calculateGaussians(&mSamples[0], radius, sigma);
-	normalizeGaussianSamples(&mSamples[0], radius);
-	return true;
+	pool.release(tempFB);
 }
 
 } // namespace gl
\ No newline at end of file
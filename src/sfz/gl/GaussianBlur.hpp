@@ -12,6 +12,7 @@
 
 namespace gl {
 
+using sfz::vec2;
 using sfz::vec2i;
 using std::int32_t;
 using std::uint32_t;
@@ -21,7 +22,9 @@ using std::unique_ptr;
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
 /**
- * @brief A class holding a shader and framebuffer for calculating gaussian blur
+ * @brief A class holding the shaders for calculating gaussian blur
+ *
+ * The intermediate framebuffer is acquired from the RenderTargetPool only while applying the blur.
  *
  * The size of the blur is controlled by two parameters, radius and sigma. Sigma is the standard
  * deviation of the gaussian blur kernel (in pixels) while radius is the amount of pixels to
@@ -57,6 +60,24 @@ public:
 	 */
 	void apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions) noexcept;
 
+	/**
+	 * @brief Applies the gaussian blur filter to the lower left sub-rect of the texture
+	 * The result is written to the same sub-rect of the specified fbo.
+	 * @param srcDimensions the dimensions of the whole texture, see above
+	 * @param rectDimensions the dimensions of the sub-rect to blur
+	 */
+	void apply(uint32_t dstFBO, uint32_t srcTexture, vec2i srcDimensions, vec2i rectDimensions) noexcept;
+
+	/**
+	 * @brief Applies the gaussian blur filter to a texture larger than the internal resolution
+	 * The horizontal pass samples the texture with bilinear filtering, downsampling it to the
+	 * internal resolution without a separate pass. The kernel is still measured in pixels at the
+	 * internal resolution.
+	 * @param srcUVScale the fraction of the texture to blur, see Scaler
+	 * @param rectDimensions the dimensions of the lower left sub-rect of the fbo to write to
+	 */
+	void applyDownsampling(uint32_t dstFBO, uint32_t srcTexture, vec2 srcUVScale, vec2i rectDimensions) noexcept;
+
 	/**
 	* @brief Applies the gaussian blur filter to the texture and writes it to the specifed fbo
 	* @param radius the amount of pixels to sample in a direction (pixels sampled = 2*radius + 1)
@@ -73,12 +94,17 @@ public:
 	inline const float* samples() const noexcept { return &mSamples[0]; }
 
 private:
+	// Private methods
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	void applyPasses(uint32_t dstFBO, uint32_t srcTexture, vec2 srcUVScale, vec2i rectDimensions) noexcept;
+
 	// Private members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	
 	Program mHorizontalBlurProgram, mVerticalBlurProgram,
 	        mHorizontalBlurInterpolatedProgram, mVerticalBlurInterpolatedProgram;
-	Framebuffer mTempFB;
+	vec2i mDimensions{-1};
 	PostProcessQuad mPostProcessQuad;
 	uint32_t mSamplerObject = 0;
 
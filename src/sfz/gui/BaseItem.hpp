@@ -47,6 +47,31 @@ public:
 	virtual void enable() = 0;
 	virtual void disable() = 0;
 
+	// Dirty tracking
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	/**
+	 * @brief Returns whether the item has changed since it was last drawn into System's layer
+	 * The selected and enabled state are compared against what was drawn, other changes (e.g. of
+	 * the text) have to be flagged with markDirty(). Items are also dirty while their renderer is
+	 * animating, containers when any of their items are.
+	 */
+	virtual bool isDirty() const
+	{
+		return mDirty || isSelected() != mDrawnSelected || isEnabled() != mDrawnEnabled ||
+		       (renderer != nullptr && renderer->isAnimating());
+	}
+
+	/** @brief Called by System once the item has been drawn */
+	virtual void clearDirty()
+	{
+		mDirty = false;
+		mDrawnSelected = isSelected();
+		mDrawnEnabled = isEnabled();
+	}
+
+	inline void markDirty() noexcept { mDirty = true; }
+
 	// Public members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	
@@ -65,6 +90,14 @@ public:
 	{
 		return bounds(rect.position());
 	}
+
+protected:
+	// Protected members
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	bool mDirty = true;
+	bool mDrawnSelected = false;
+	bool mDrawnEnabled = false;
 };
 
 } // namespace gui
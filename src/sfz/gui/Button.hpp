@@ -53,7 +53,7 @@ public:
 	// Public members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	string text;
+	string text; // Call markDirty() after changing
 	function<void(Button&)> activateFunc = nullptr;
 
 private:
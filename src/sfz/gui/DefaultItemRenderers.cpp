@@ -283,7 +283,8 @@ ItemRendererFactory<MultiChoiceSelector> defaultMultiChoiceSelectorRendererFacto
 
 			// State calculations and string
 			vec2 statePos = pos;
-			statePos.x += std::max(mc.stateAlignOffset, font.measureStringWidth(size, (mc.text + " ").c_str()));
+			const float textWidth = font.measureStringWidth(size, mc.text.c_str()) + font.measureStringWidth(size, " ");
+			statePos.x += std::max(mc.stateAlignOffset, textWidth);
 			int state = mc.checkStateFunc();
 			bool stateInRange = 0 <= state && state <= ((int)mc.choiceNames.size()-1);
 			static const string otherStr{"other"};
@@ -389,7 +390,8 @@ ItemRendererFactory<OnOffSelector> defaultOnOffSelectorRendererFactory() noexcep
 
 			// State calculations and string
 			vec2 offPos = pos;
-			offPos.x += std::max(oo.stateAlignOffset, font.measureStringWidth(size, (oo.text + " ").c_str()));
+			const float textWidth = font.measureStringWidth(size, oo.text.c_str()) + font.measureStringWidth(size, " ");
+			offPos.x += std::max(oo.stateAlignOffset, textWidth);
 			bool state = oo.checkStateFunc();
 			static const string onStr = "On";
 			static const string offStr = "Off";
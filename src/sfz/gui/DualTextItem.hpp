@@ -56,7 +56,7 @@ public:
 	// Public members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	string leftText;
+	string leftText; // Call markDirty() after changing either text
 	string rightText;
 	float alignOffset;
 	HorizontalAlign leftHAlign;
@@ -25,6 +25,7 @@ class ItemRenderer {
 public:
 	virtual void update(float delta) { } // Optional
 	virtual void updateOnActivate() { } // Optional
+	virtual bool isAnimating() const { return false; } // Optional, redrawn every frame while true
 	virtual void draw(vec2 basePos, uint32_t fbo, const AABB2D& viewport, const AABB2D& cam) = 0;
 	virtual ~ItemRenderer() = default;
 };
@@ -193,4 +193,19 @@ void MultiChoiceSelector::disable()
 	mSelected = false;
 }
 
+// MultiChoiceSelector: Dirty tracking overriden from BaseItem
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool MultiChoiceSelector::isDirty() const
+{
+	// The state may be changed from elsewhere, e.g. by another item
+	return BaseItem::isDirty() || checkStateFunc() != mDrawnState;
+}
+
+void MultiChoiceSelector::clearDirty()
+{
+	BaseItem::clearDirty();
+	mDrawnState = checkStateFunc();
+}
+
 } // namespace gui
\ No newline at end of file
@@ -93,10 +93,16 @@ public:
 	virtual void enable() override final;
 	virtual void disable() override final;
 
+	// Dirty tracking overriden from BaseItem
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	virtual bool isDirty() const override final;
+	virtual void clearDirty() override final;
+
 	// Public members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	string text;
+	string text; // Call markDirty() after changing
 	vector<string> choiceNames;
 	function<int(void)> checkStateFunc; // Should return < 0 if unknown state
 	function<void(int)> changeStateFunc;
@@ -108,6 +114,7 @@ private:
 
 	bool mSelected = false;
 	bool mEnabled = true;
+	int mDrawnState = -1;
 };
 
 } // namespace gui
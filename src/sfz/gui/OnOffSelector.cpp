@@ -135,4 +135,19 @@ void OnOffSelector::disable()
 	mSelected = false;
 }
 
+// OnOffSelector: Dirty tracking overriden from BaseItem
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool OnOffSelector::isDirty() const
+{
+	// The state may be changed from elsewhere, e.g. by another item
+	return BaseItem::isDirty() || checkStateFunc() != mDrawnState;
+}
+
+void OnOffSelector::clearDirty()
+{
+	BaseItem::clearDirty();
+	mDrawnState = checkStateFunc();
+}
+
 } // namespace gui
\ No newline at end of file
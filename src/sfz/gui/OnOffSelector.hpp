@@ -68,10 +68,16 @@ public:
 	virtual void enable() override final;
 	virtual void disable() override final;
 
+	// Dirty tracking overriden from BaseItem
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	virtual bool isDirty() const override final;
+	virtual void clearDirty() override final;
+
 	// Public members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	string text;
+	string text; // Call markDirty() after changing
 	function<bool(void)> checkStateFunc;
 	function<void(void)> changeStateFunc;
 	float stateAlignOffset;
@@ -82,6 +88,7 @@ private:
 
 	bool mSelected = false;
 	bool mEnabled = true;
+	bool mDrawnState = false;
 };
 
 } // namespace gui
@@ -219,6 +219,25 @@ void ScrollListContainer::disable()
 	mEnabled = false;
 }
 
+// ScrollListContainer: Dirty tracking overriden from BaseItem
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool ScrollListContainer::isDirty() const
+{
+	if (BaseItem::isDirty() || mCurrentScrollOffset != mDrawnScrollOffset) return true;
+	for (auto& i : items) {
+		if (i->isDirty()) return true;
+	}
+	return false;
+}
+
+void ScrollListContainer::clearDirty()
+{
+	BaseItem::clearDirty();
+	mDrawnScrollOffset = mCurrentScrollOffset;
+	for (auto& i : items) i->clearDirty();
+}
+
 // ScrollListContainer: Private methods
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -58,6 +58,12 @@ public:
 	virtual void enable() override final;
 	virtual void disable() override final;
 
+	// Dirty tracking overriden from BaseItem
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	virtual bool isDirty() const override final;
+	virtual void clearDirty() override final;
+
 	// Public members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -81,6 +87,7 @@ private:
 	bool mEnabled = true;
 	vec2 mNextItemTopPos;
 	int mCurrentSelectedIndex = -1;
+	float mDrawnScrollOffset = 0.0f;
 };
 
 } // namespace gui
@@ -220,6 +220,22 @@ void SideSplitContainer::disable()
 	mEnabled = false;
 }
 
+// SideSplitContainer: Dirty tracking overriden from BaseItem
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool SideSplitContainer::isDirty() const
+{
+	return BaseItem::isDirty() || (leftItem != nullptr && leftItem->isDirty()) ||
+	       (rightItem != nullptr && rightItem->isDirty());
+}
+
+void SideSplitContainer::clearDirty()
+{
+	BaseItem::clearDirty();
+	if (leftItem != nullptr) leftItem->clearDirty();
+	if (rightItem != nullptr) rightItem->clearDirty();
+}
+
 // SideSplitContainer: Private methods
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -60,6 +60,12 @@ public:
 	virtual void enable() override final;
 	virtual void disable() override final;
 
+	// Dirty tracking overriden from BaseItem
+	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+	virtual bool isDirty() const override final;
+	virtual void clearDirty() override final;
+
 	// Public members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
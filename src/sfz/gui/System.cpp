@@ -1,13 +1,28 @@
 #include "sfz/gui/System.hpp"
 
+#include <cmath>
 #include <iostream>
 
 #include "sfz/geometry/Intersection.hpp"
+#include "sfz/gl/OpenGL.hpp"
+#include "sfz/gl/StateCache.hpp"
+#include "sfz/gl/TextureRegion.hpp"
+#include "sfz/gui/GUIUtils.hpp"
 
 #include "rendering/Assets.hpp" // TODO: Hilariously unportable include, remove later
 
 namespace gui {
 
+// Static functions
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+/** @brief The bounds of an item padded to also cover what renderers draw just outside of them */
+static AABB2D paddedBounds(const BaseItem& item, vec2 basePos) noexcept
+{
+	const float padding = 0.25f * item.dim.y; // E.g. text shadows and descenders
+	return AABB2D{basePos + item.offset, item.dim + vec2{2.0f * padding}};
+}
+
 // System: Constructors & destructors
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -151,7 +166,76 @@ void System::draw(uint32_t fbo, vec2 viewportDim, const AABB2D& cam)
 
 void System::draw(uint32_t fbo, const AABB2D& viewport, const AABB2D& cam)
 {
-	for (auto& i : mItems) i->draw(mBounds.position(), fbo, viewport, cam);
+	gl::StateCache& glState = gl::StateCache::INSTANCE();
+	const vec2 basePos = mBounds.position();
+
+	// Recreates the layer if the viewport dimensions have changed
+	const vec2i layerDim{(int32_t)std::round(viewport.width()), (int32_t)std::round(viewport.height())};
+	if (layerDim.x <= 0 || layerDim.y <= 0) return;
+	if (!mLayer.isValid() || mLayer.dimensions() != layerDim) {
+		mLayer = gl::FramebufferBuilder{layerDim}
+		         .addTexture(0, gl::FBTextureFormat::RGBA_U8, gl::FBTextureFiltering::NEAREST)
+		         .build();
+		glState.invalidate(); // Building binds the framebuffer and texture behind the cache's back
+		mLayerValid = false;
+	}
+	if (cam != mLayerCam) {
+		mLayerCam = cam;
+		mLayerValid = false;
+	}
+	const vec2 layerDimFloat{(float)layerDim.x, (float)layerDim.y};
+	const AABB2D layerViewport{layerDimFloat / 2.0f, layerDimFloat};
+
+	// Finds the items that need to be redrawn
+	mDirtyItems.clear();
+	for (auto& i : mItems) {
+		if (!mLayerValid || i->isDirty()) mDirtyItems.push_back(i.get());
+	}
+
+	if (!mDirtyItems.empty()) {
+		const float clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		glState.bindFramebuffer(mLayer.fbo());
+
+		// Alpha is accumulated so the layer ends up premultiplied
+		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+		if (!mLayerValid) {
+			glClearBufferfv(GL_COLOR, 0, clearColor);
+			for (auto& i : mItems) i->draw(basePos, mLayer.fbo(), layerViewport, cam);
+			mLayerValid = true;
+		} else {
+			// Clears the region of each dirty item and redraws everything overlapping it, clipped
+			// to the region
+			glEnable(GL_SCISSOR_TEST);
+			for (BaseItem* dirtyItem : mDirtyItems) {
+				const AABB2D region = paddedBounds(*dirtyItem, basePos);
+				const AABB2D pixels = calculateViewport(layerViewport, cam, region);
+				const int32_t x = (int32_t)std::floor(pixels.min.x);
+				const int32_t y = (int32_t)std::floor(pixels.min.y);
+				glScissor(x, y, (int32_t)std::ceil(pixels.max.x) - x, (int32_t)std::ceil(pixels.max.y) - y);
+				glClearBufferfv(GL_COLOR, 0, clearColor);
+				for (auto& i : mItems) {
+					if (!sfz::overlaps(paddedBounds(*i, basePos), region)) continue;
+					i->draw(basePos, mLayer.fbo(), layerViewport, cam);
+				}
+			}
+			glDisable(GL_SCISSOR_TEST);
+		}
+		for (BaseItem* dirtyItem : mDirtyItems) dirtyItem->clearDirty();
+	}
+
+	// Composites the layer, then restores the blend function the items are drawn with
+	gl::SpriteBatch& sb = s3::Assets::INSTANCE().spriteBatch;
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	sb.begin(cam);
+	sb.draw(cam, gl::TextureRegion{vec2{0.0f}, vec2{1.0f}});
+	sb.end(fbo, viewport, mLayer.texture(0));
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void System::markDirty() noexcept
+{
+	mLayerValid = false;
 }
 
 // System: Private methods
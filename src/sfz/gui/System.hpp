@@ -8,6 +8,7 @@
 
 #include "sfz/geometry/AABB2D.hpp"
 #include "sfz/gl/Alignment.hpp"
+#include "sfz/gl/Framebuffer.hpp"
 #include "sfz/math/Vector.hpp"
 #include "sfz/sdl/ButtonState.hpp"
 
@@ -20,7 +21,9 @@ using gl::HorizontalAlign;
 
 using sfz::AABB2D;
 using sfz::vec2;
+using sfz::vec2i;
 
+using std::int32_t;
 using std::shared_ptr;
 using std::uint32_t;
 using std::vector;
@@ -28,6 +31,14 @@ using std::vector;
 // System class
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
+/**
+ * @brief A vertical list of items, with input handling and selection
+ *
+ * The items are drawn into a cached layer which is then composited onto the target framebuffer as
+ * a single textured quad, premultiplied by alpha. The layer is only redrawn where items are dirty
+ * (see BaseItem::isDirty()), so a menu that isn't being interacted with costs one quad per frame.
+ * The whole layer is redrawn if the viewport dimensions or the camera changes.
+ */
 class System final {
 public:
 	// Constructors & destructors
@@ -52,6 +63,9 @@ public:
 	void draw(uint32_t fbo, vec2 viewportDim, const AABB2D& cam);
 	void draw(uint32_t fbo, const AABB2D& viewport, const AABB2D& cam);
 
+	/** @brief Redraws the whole layer next draw(), e.g. if the item renderers' settings changed */
+	void markDirty() noexcept;
+
 	// Getters
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	
@@ -72,6 +86,11 @@ private:
 	vector<shared_ptr<BaseItem>> mItems;
 	vec2 mNextItemTopPos;
 	int mCurrentSelectedIndex = -1;
+
+	gl::Framebuffer mLayer;
+	AABB2D mLayerCam;
+	bool mLayerValid = false;
+	vector<BaseItem*> mDirtyItems;
 };
 
 } // namespace gui
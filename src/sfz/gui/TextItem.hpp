@@ -52,7 +52,7 @@ public:
 	// Public members
 	// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-	string text;
+	string text; // Call markDirty() after changing
 	HorizontalAlign hAlign;
 };
 
@@ -307,6 +307,24 @@ void ThreeSplitContainer::disable()
 	mEnabled = false;
 }
 
+// ThreeSplitContainer: Dirty tracking overriden from BaseItem
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool ThreeSplitContainer::isDirty() const
+{
+	return BaseItem::isDirty() || (leftItem != nullptr && leftItem->isDirty()) ||
+	       (middleItem != nullptr && middleItem->isDirty()) ||
+	       (rightItem != nullptr && rightItem->isDirty());
+}
+
+void ThreeSplitContainer::clearDirty()
+{
+	BaseItem::clearDirty();
+	if (leftItem != nullptr) leftItem->clearDirty();
+	if (middleItem != nullptr) middleItem->clearDirty();
+	if (rightItem != nullptr) rightItem->clearDirty();
+}
+
 // ThreeSplitContainer: Private methods
 // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
@@ -19,6 +19,17 @@ Music::Music(const char* path) noexcept
 	}
 }
 
+Music::Music(const std::uint8_t* data, std::size_t size, const char* name) noexcept
+{
+	Mix_Music* tmpPtr = Mix_LoadMUS_RW(SDL_RWFromConstMem(data, (int)size), 1);
+	if (tmpPtr == NULL) {
+		std::cerr << "Mix_LoadMUS_RW() failed for \"" << name << "\", error: "
+		          << Mix_GetError() << std::endl;
+	} else {
+		this->ptr = tmpPtr;
+	}
+}
+
 Music::Music(Music&& other) noexcept
 {
 	std::swap(this->ptr, other.ptr);
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include <SDL_mixer.h>
 
 namespace sdl {
@@ -19,6 +22,15 @@ public:
 	Music& operator= (const Music&) = delete;
 
 	Music(const char* path) noexcept;
+
+	/**
+	 * @brief Loads from a file already in memory, e.g. a view of an AssetArchive
+	 * The music is streamed from the data while playing, so it needs to stay valid for as long
+	 * as this Music exists.
+	 * @param name only used in error messages
+	 */
+	Music(const std::uint8_t* data, std::size_t size, const char* name) noexcept;
+
 	Music(Music&& other) noexcept;
 	Music& operator= (Music&& other) noexcept;
 	~Music() noexcept;
@@ -23,6 +23,19 @@ SoundEffect::SoundEffect(const char* path) noexcept
 	}
 }
 
+SoundEffect::SoundEffect(const std::uint8_t* data, std::size_t size, const char* name) noexcept
+{
+	// SDL_OpenAudio() must have been called before this
+
+	Mix_Chunk* tmpPtr = Mix_LoadWAV_RW(SDL_RWFromConstMem(data, (int)size), 1);
+	if (tmpPtr == NULL) {
+		std::cerr << "Mix_LoadWAV_RW() failed for \"" << name << "\", error: "
+		          << Mix_GetError() << std::endl;
+	} else {
+		this->ptr = tmpPtr;
+	}
+}
+
 SoundEffect::SoundEffect(SoundEffect&& other) noexcept
 {
 	std::swap(this->ptr, other.ptr);
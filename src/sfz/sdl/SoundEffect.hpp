@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include <SDL_mixer.h>
 
 namespace sdl {
@@ -19,6 +22,14 @@ public:
 	SoundEffect& operator= (const SoundEffect&) = delete;
 
 	SoundEffect(const char* path) noexcept;
+
+	/**
+	 * @brief Loads from a file already in memory, e.g. a view of an AssetArchive
+	 * The data is copied, so it only needs to stay valid during construction.
+	 * @param name only used in error messages
+	 */
+	SoundEffect(const std::uint8_t* data, std::size_t size, const char* name) noexcept;
+
 	SoundEffect(SoundEffect&& other) noexcept;
 	SoundEffect& operator= (SoundEffect&& other) noexcept;
 	~SoundEffect() noexcept;
@@ -0,0 +1,146 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sfz/gl/TextureContainer.hpp>
+#include <sfz/gl/TexturePacker.hpp>
+#include <sfz/util/AssetArchive.hpp>
+#include <sfz/util/IO.hpp>
+#include <sfz/util/MappedFile.hpp>
+
+// Packs the files listed in a manifest (one path per line, relative to the assets directory) into
+// an archive which Assets::load() can read. Run by the asset-archive build target.
+//
+// Every png is also baked into a texture container (see sfz/gl/TextureContainer.hpp) stored next
+// to it in the archive, optionally block compressed. The pngs in a directory given with --atlas are
+// instead packed into a single baked atlas (see gl::bakeTextureAtlas()). The pngs themselves are
+// only kept with --compress-textures, they are then needed if the driver doesn't support S3TC.
+//
+// Usage: s3-asset-packer [--compress-textures] [--atlas <directory> <padding>]... <assets directory>
+//                        <manifest> <archive>
+
+struct AtlasDir {
+	std::string dirPath;
+	int padding;
+	std::vector<std::string> filenames;
+	std::vector<sfz::AssetView> files;
+};
+
+static bool isImage(const std::string& name) noexcept
+{
+	return name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	using sfz::AssetView;
+	using std::string;
+	using std::vector;
+
+	bool compressTextures = false;
+	vector<AtlasDir> atlases;
+	while (argc > 4 && std::strncmp(argv[1], "--", 2) == 0) {
+		if (std::strcmp(argv[1], "--compress-textures") == 0) {
+			compressTextures = true;
+			argv += 1;
+			argc -= 1;
+		} else if (std::strcmp(argv[1], "--atlas") == 0 && argc > 6) {
+			AtlasDir atlas;
+			atlas.dirPath = argv[2];
+			if (atlas.dirPath.back() != '/') atlas.dirPath += '/';
+			atlas.padding = std::atoi(argv[3]);
+			atlases.push_back(atlas);
+			argv += 3;
+			argc -= 3;
+		} else {
+			break;
+		}
+	}
+	if (argc != 4) {
+		std::cerr << "Usage: s3-asset-packer [--compress-textures] [--atlas <directory> <padding>]... "
+		          << "<assets directory> <manifest> <archive>" << std::endl;
+		return 1;
+	}
+
+	string rootPath = argv[1];
+	if (!rootPath.empty() && rootPath.back() != '/' && rootPath.back() != '\\') rootPath += '/';
+
+	if (!sfz::fileExists(argv[2])) {
+		std::cerr << "Couldn't open manifest \"" << argv[2] << "\"" << std::endl;
+		return 1;
+	}
+	std::istringstream manifest{sfz::readTextFile(argv[2])};
+	vector<string> names;
+	string line;
+	while (std::getline(manifest, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty()) continue;
+		names.push_back(line);
+	}
+
+	// Maps all assets, and bakes the images
+	vector<sfz::MappedFile> files;
+	vector<vector<uint8_t>> bakedTextures;
+	vector<string> bakedNames;
+	files.reserve(names.size());
+	for (const string& name : names) {
+		files.emplace_back((rootPath + name).c_str());
+		if (!files.back().isValid()) {
+			std::cerr << "Couldn't read asset \"" << name << "\"" << std::endl;
+			return 1;
+		}
+		if (!isImage(name)) continue;
+
+		AssetView view;
+		view.data = files.back().data();
+		view.size = files.back().size();
+		bool inAtlas = false;
+		for (AtlasDir& atlas : atlases) {
+			if (name.compare(0, atlas.dirPath.size(), atlas.dirPath) != 0) continue;
+			atlas.filenames.push_back(name.substr(atlas.dirPath.size()));
+			atlas.files.push_back(view);
+			inAtlas = true;
+			break;
+		}
+		if (inAtlas) continue;
+
+		bakedTextures.push_back(gl::bakeTextureContainerFromImage(files.back().data(), files.back().size(),
+		                        name.c_str(), gl::TextureFormat::RGBA, compressTextures));
+		if (bakedTextures.back().empty()) return 1;
+		bakedNames.push_back(gl::bakedTextureName(name));
+	}
+
+	for (const AtlasDir& atlas : atlases) {
+		bakedTextures.push_back(gl::bakeTextureAtlas(atlas.filenames, atlas.files, atlas.padding, 256, 256,
+		                                             compressTextures));
+		if (bakedTextures.back().empty()) return 1;
+		bakedNames.push_back(gl::bakedAtlasName(atlas.dirPath));
+	}
+
+	// Uncompressed containers can always be loaded, so the pngs are left out unless compressing
+	vector<string> packedNames;
+	vector<AssetView> contents;
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (!compressTextures && isImage(names[i])) continue;
+		AssetView view;
+		view.data = files[i].data();
+		view.size = files[i].size();
+		packedNames.push_back(names[i]);
+		contents.push_back(view);
+	}
+	for (size_t i = 0; i < bakedTextures.size(); ++i) {
+		AssetView view;
+		view.data = bakedTextures[i].data();
+		view.size = bakedTextures[i].size();
+		packedNames.push_back(bakedNames[i]);
+		contents.push_back(view);
+	}
+
+	if (!sfz::writeAssetArchive(argv[3], packedNames, contents)) return 1;
+	std::cout << "Packed " << packedNames.size() << " assets (" << bakedTextures.size() << " baked textures and atlases) into \""
+	          << argv[3] << "\"" << std::endl;
+	return 0;
+}
\ No newline at end of file